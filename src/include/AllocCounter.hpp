@@ -0,0 +1,32 @@
+// AllocCounter.hpp
+// Heap allocation counting for FileMgr
+//
+// Replaces the global operator new/delete with versions that count every
+// allocation made by the calling thread, and provides allocator functions
+// for Dear ImGui that feed the same counters. The main loop samples the UI
+// thread's counters around a frame to show how many allocations the frame
+// made (the steady-state target is zero). Background threads (scanner,
+// sorter, watcher) are not included in the UI thread's counts.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// -----------------------------------------------------------------------------
+// AllocCounter
+// -----------------------------------------------------------------------------
+struct AllocCounter {
+    // Counters of one thread
+    struct Totals {
+        std::uint64_t count = 0;   // Allocations since the thread started
+        std::uint64_t bytes = 0;   // Bytes requested by those allocations
+    };
+
+    // Get the allocation counters of the calling thread
+    static Totals GetThreadTotals();
+
+    // Allocator functions for ImGui::SetAllocatorFunctions()
+    static void* ImGuiAlloc(std::size_t size, void* userData);
+    static void ImGuiFree(void* ptr, void* userData);
+};
@@ -0,0 +1,175 @@
+// ChecksumCache.hpp
+// Background file checksums for the file list's Checksum column
+//
+// The file list asks for the checksum of a file when its row becomes
+// visible or is selected, and reads the result every frame; nothing is
+// hashed for rows that are never shown. Each request is a slot: it is
+// queued, hashed by a small pool of workers (newest requests first, so the
+// rows on screen are served before the ones scrolled past) and then holds
+// the checksum as hex text. A queued slot that has not been looked at for a
+// few frames is dropped from the queue unless it is pinned (selected), and
+// is queued again when its row comes back into view.
+//
+// Results are cached by file identity: volume and file id (inode), size and
+// modification time, read from the open file. A file that was renamed or
+// listed again keeps its checksum; a file that changed gets a new one. The
+// slots are cleared when the listing is replaced; the cache is not.
+//
+// Two algorithms: XXH64 (fast, for comparing files) and SHA-256 (for
+// comparing against published checksums).
+//
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// ChecksumCache class
+// -----------------------------------------------------------------------------
+class ChecksumCache {
+public:
+    enum class Algorithm { XxHash64, Sha256 };
+
+    // State of a slot
+    enum class State { Idle, Queued, Hashing, Done, Failed };
+
+    // Counters since the cache was created
+    struct Stats {
+        std::uint64_t hashed = 0;          // Files read and hashed
+        std::uint64_t cacheHits = 0;       // Requests answered from the cache
+        std::uint64_t failed = 0;          // Files that could not be read
+        std::uint64_t bytes = 0;           // Bytes hashed
+        std::chrono::microseconds hashTime{0};  // Time spent hashing (all workers)
+        std::size_t queued = 0;            // Slots waiting for a worker
+        std::size_t slots = 0;
+        std::size_t cached = 0;            // Checksums in the cache
+        int threads = 0;
+    };
+
+    // Longest checksum text including the terminator (SHA-256 in hex)
+    static constexpr std::size_t kTextSize = 65;
+
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    // Constructor (the workers start with the first request)
+    // @param threads Number of workers
+    explicit ChecksumCache(int threads = 2);
+
+    // Destructor - stops the workers
+    ~ChecksumCache();
+
+    ChecksumCache(const ChecksumCache&) = delete;
+    ChecksumCache& operator=(const ChecksumCache&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Select the algorithm (clears the slots if it changes)
+    void SetAlgorithm(Algorithm algorithm);
+
+    // Get the selected algorithm
+    Algorithm GetAlgorithm() const { return m_algorithm; }
+
+    // Ask for the checksum of a file
+    // @param path   Full path of the file
+    // @param pinned Keep it queued even while it is not looked at
+    // @return Slot id (never 0)
+    std::uint32_t Request(const std::filesystem::path& path, bool pinned);
+
+    // Keep a slot queued even while it is not looked at
+    void Pin(std::uint32_t id);
+
+    // Read a slot (marks it as wanted this frame; an idle slot is queued again)
+    // @param id   Slot id from Request()
+    // @param text Receives the checksum as hex text when the state is Done
+    // @return State of the slot (Idle for an id from before ClearSlots())
+    State Get(std::uint32_t id, char* text, std::size_t size);
+
+    // Advance the frame counter (queued slots not read for a few frames expire)
+    void NextFrame() { ++m_frame; }
+
+    // Forget all slots (the listing they belong to is gone)
+    void ClearSlots();
+
+    // Get the counters
+    Stats GetStats() const;
+
+private:
+    // File identity and algorithm of a cached checksum
+    struct Key {
+        std::uint64_t device;
+        std::uint64_t id;
+        std::uint64_t size;
+        std::int64_t writeTime;
+        int algorithm;
+
+        bool operator==(const Key& other) const {
+            return device == other.device && id == other.id && size == other.size &&
+                   writeTime == other.writeTime && algorithm == other.algorithm;
+        }
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            std::uint64_t h = key.id * 0x9E3779B97F4A7C15ULL ^ key.device ^ (key.size << 1) ^
+                              (std::uint64_t)key.writeTime * 0xC2B2AE3D27D4EB4FULL ^ (std::uint64_t)key.algorithm;
+            return (std::size_t)(h ^ (h >> 29));
+        }
+    };
+
+    using Text = std::array<char, kTextSize>;
+
+    // One requested file
+    struct Slot {
+        std::filesystem::path path;
+        State state = State::Queued;
+        bool pinned = false;
+        std::uint64_t wanted = 0;          // Frame the slot was last read in
+        Text text{};
+    };
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    int m_threadCount;
+    std::vector<std::thread> m_workers;        // Started by the first request
+    std::atomic<bool> m_stop{false};
+    std::atomic<std::uint64_t> m_frame{0};
+    std::atomic<std::uint64_t> m_generation{0};    // Bumped by ClearSlots() and SetAlgorithm()
+    Algorithm m_algorithm = Algorithm::XxHash64;
+
+    mutable std::mutex m_mutex;                // Guards the fields below
+    std::condition_variable m_cv;              // Slot queued or stopping
+    std::vector<Slot> m_slots;                 // Slot id - 1
+    std::vector<std::uint32_t> m_queue;        // Queued slot ids, newest last
+    std::unordered_map<Key, Text, KeyHash> m_cache;
+    Stats m_stats;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Queue a slot and start the workers if needed (called with m_mutex held)
+    void Enqueue(std::uint32_t id);
+
+    // Worker thread: hash queued slots until stopped
+    void WorkerLoop();
+
+    // Hash one file, using the cache when its identity is known
+    // @param text Receives the checksum text
+    // @return False if the file could not be read or the slot was cleared
+    bool Compute(const std::filesystem::path& path, Algorithm algorithm, std::uint64_t generation,
+                 std::vector<char>& buffer, Text& text);
+};
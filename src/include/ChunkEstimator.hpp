@@ -0,0 +1,182 @@
+// ChunkEstimator.hpp
+// Block-level deduplication estimate for FileMgr
+//
+// Estimates how much a tree would shrink in a deduplicating backup store,
+// where files are cut into variable-size chunks and each distinct chunk is
+// stored once. Unlike whole-file duplicates this also finds data shared by
+// files that differ elsewhere (versions of a document, disk images, logs
+// with a common start).
+//
+// Every file is cut with FastCDC: a gear rolling hash over the bytes, a cut
+// where the hash matches a mask, normalized chunking (a stricter mask below
+// the 8 KB average, a looser one above) and 2 KB / 64 KB minimum and maximum
+// chunk sizes. Cuts depend only on the nearby bytes, so an insertion moves
+// the chunk boundaries along with the data and the following chunks still
+// match. Each chunk is fingerprinted with XXH64.
+//
+// The fingerprints are kept in an open-addressing table of fixed size. When
+// it fills up, only the chunks whose fingerprint ends in one more zero bit
+// are kept (half of them, chosen by content, so the same chunk is kept or
+// dropped everywhere) and the counts are scaled up accordingly. Memory stays
+// within the limit however large the tree is; the estimate becomes a sample.
+//
+// The walk and the chunking run together on a pool of workers. Results are
+// kept per top-level folder: its bytes and the unique bytes first seen in
+// it (the unique bytes of all folders add up to the tree's), readable while
+// the job runs.
+//
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DirEnumerator.hpp"
+
+// -----------------------------------------------------------------------------
+// ChunkEstimator class
+// -----------------------------------------------------------------------------
+class ChunkEstimator {
+public:
+    // Job parameters
+    struct Options {
+        int threads = 0;                   // Workers (0 = EntrySorter::DefaultThreadCount())
+        std::size_t memory = 64 << 20;     // Size of the fingerprint table in bytes
+    };
+
+    // Totals of one top-level folder (or of the files directly in the root)
+    struct Folder {
+        std::string name;                  // UTF-8 name; empty for files in the root
+        std::uint64_t files = 0;
+        std::uint64_t bytes = 0;           // Bytes chunked so far
+        std::uint64_t uniqueBytes = 0;     // Bytes of chunks first seen here (estimate)
+    };
+
+    // Progress and totals of the current (or last) job
+    struct Stats {
+        std::size_t files = 0;             // Files chunked
+        std::size_t folders = 0;
+        std::size_t failed = 0;            // Files that could not be read
+        std::uint64_t bytes = 0;           // Bytes chunked
+        std::uint64_t chunks = 0;
+        std::uint64_t uniqueBytes = 0;     // Bytes of distinct chunks (estimate)
+        std::uint64_t uniqueChunks = 0;    // Distinct chunks (estimate)
+        std::size_t sampled = 0;           // Fingerprints in the table
+        std::size_t capacity = 0;          // Fingerprints the table holds before sampling more
+        int sampleShift = 0;               // One chunk in 2^sampleShift is tracked
+        int threads = 0;
+        bool running = false;
+        bool cancelled = false;
+        std::chrono::microseconds time{0}; // Elapsed time (so far)
+    };
+
+    // Chunk size limits (FastCDC with an 8 KB average)
+    static constexpr std::size_t kMinChunk = 2 * 1024;
+    static constexpr std::size_t kAvgChunk = 8 * 1024;
+    static constexpr std::size_t kMaxChunk = 64 * 1024;
+
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    ChunkEstimator() = default;
+
+    // Destructor - stops the job and joins the workers
+    ~ChunkEstimator();
+
+    ChunkEstimator(const ChunkEstimator&) = delete;
+    ChunkEstimator& operator=(const ChunkEstimator&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Start estimating a tree (stops the previous job)
+    // @param root    Folder whose subtree is chunked
+    // @param options Parameters
+    void Start(const std::filesystem::path& root, const Options& options);
+
+    // Stop the job (the results so far stay readable)
+    void Cancel();
+
+    // Check whether the job is still running
+    bool IsRunning() const;
+
+    // Get the progress and totals
+    Stats GetStats() const;
+
+    // Get the per-folder totals
+    // @param out Receives the folders (replaced), in the order they were found
+    void GetFolders(std::vector<Folder>& out) const;
+
+    // Get the folder of the current or last job
+    const std::filesystem::path& GetRoot() const { return m_root; }
+
+private:
+    // One fingerprint of the table (fingerprint 0 marks an empty slot)
+    struct Entry {
+        std::uint64_t fingerprint;
+        std::uint32_t size;
+        std::uint32_t folder;              // Folder the chunk was first seen in
+    };
+
+    // A chunk waiting to be added to the table
+    struct Chunk {
+        std::uint64_t fingerprint;
+        std::uint32_t size;
+    };
+
+    // A folder to list or a file to chunk
+    struct Item {
+        std::filesystem::path path;
+        std::uint32_t folder;              // Index into m_folders
+        int depth;                         // -1 for a file
+    };
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    std::filesystem::path m_root;
+    Options m_options;
+    std::vector<std::thread> m_workers;
+    std::atomic<bool> m_cancel{false};
+    std::atomic<int> m_sampleShift{0};         // Copy readable without the lock
+    std::chrono::steady_clock::time_point m_startTime;
+
+    mutable std::mutex m_mutex;                // Guards the fields below
+    std::condition_variable m_cv;              // Work added or job finished
+    std::vector<Item> m_items;                 // Shared stack of folders and files
+    int m_idle = 0;                            // Workers waiting for items
+    std::vector<Entry> m_table;                // Open addressing, power-of-two size
+    int m_tableBits = 0;                       // log2 of the table size
+    std::size_t m_entries = 0;
+    std::uint64_t m_sampledBytes = 0;          // Sizes of the fingerprints in the table
+    std::vector<Folder> m_folders;
+    std::vector<std::uint64_t> m_folderSampled;    // Sampled unique bytes per folder
+    Stats m_stats;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Worker thread: list folders and chunk files until the tree is done
+    void WorkerLoop();
+
+    // List a folder and push its subfolders and files
+    void ListFolder(const Item& item, DirEnumerator& enumerator);
+
+    // Cut a file into chunks and add them to the table
+    void ChunkFile(const Item& item, std::vector<char>& buffer, std::vector<Chunk>& chunks);
+
+    // Add chunks of one folder to the table (called with m_mutex held)
+    void AddChunks(const std::vector<Chunk>& chunks, std::uint32_t folder);
+
+    // Keep only the fingerprints sampled at the next shift (called with m_mutex held)
+    void RaiseSampleShift();
+};
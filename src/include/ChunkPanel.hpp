@@ -0,0 +1,71 @@
+// ChunkPanel.hpp
+// "Block Dedupe Estimate" window for FileMgr
+//
+// Runs a ChunkEstimator on the current folder and shows how much the tree
+// would shrink with block-level deduplication: the bytes read, the unique
+// bytes and the saving, overall and per top-level folder. The folder table
+// is refreshed a few times per second while the job runs, largest folder
+// first; double-clicking a folder shows it in the file list.
+//
+// The memory limit bounds the fingerprint table; once it is full the
+// figures are estimated from a sample of the chunks, which the window says.
+//
+#pragma once
+
+#include <imgui.h>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+#include "ChunkEstimator.hpp"
+
+// -----------------------------------------------------------------------------
+// ChunkPanel class
+// -----------------------------------------------------------------------------
+class ChunkPanel {
+public:
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Show the window for a folder (a running job keeps its folder)
+    // @param root Folder whose subtree the next job covers
+    void Open(const std::filesystem::path& root);
+
+    // Draw the window (does nothing while it is closed)
+    void Draw();
+
+    // Set callback for showing a folder in the file list
+    // @param callback Function called with the full path of the folder
+    void SetOnNavigate(std::function<void(const std::filesystem::path&)> callback) {
+        m_onNavigate = callback;
+    }
+
+private:
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    ChunkEstimator m_estimator;
+    std::vector<ChunkEstimator::Folder> m_folders;     // Largest first
+    std::chrono::steady_clock::time_point m_foldersTime;   // Last refresh of m_folders
+    bool m_foldersFinal = false;               // Refreshed after the job ended
+    std::filesystem::path m_root;              // Folder of the next job
+    std::string m_rootLabel;                   // m_root as UTF-8 (for drawing)
+    int m_memory = 1;                          // Index into the memory limit choices
+    int m_threads = 0;                         // 0 until the window is first opened
+    int m_selected = -1;                       // Selected row
+    bool m_open = false;
+    std::function<void(const std::filesystem::path&)> m_onNavigate;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Start a job on m_root
+    void StartEstimate();
+
+    // Draw the table of top-level folders
+    void DrawFolders();
+};
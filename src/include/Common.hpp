@@ -0,0 +1,77 @@
+// Common.hpp
+// Small helpers shared by the FileMgr sources
+//
+// ElapsedSince() times the statistics and benchmarks, ErrorText() turns an
+// OS error code into a message, and ToHex() formats checksums.
+// SequentialFile opens a file read-only for one front-to-back pass (the OS
+// is told to read ahead) and reports the identity of what it opened:
+// volume, file id, size and write time, taken from the open handle, so a
+// result can be cached for exactly the version of the file that was read.
+//
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// Time since t on the steady clock
+inline std::chrono::microseconds ElapsedSince(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t);
+}
+
+// Message for an OS error code
+// @param code errno value, or GetLastError() on Windows
+std::string ErrorText(int code);
+
+// Format a digest as lowercase hex
+// @param digest Bytes to format
+// @param size   Bytes in digest
+// @param text   Receives 2 * size digits and a terminating '\0'
+void ToHex(const unsigned char* digest, std::size_t size, char* text);
+
+// Format a digest as lowercase hex
+// @return 2 * size digits
+std::string ToHex(const unsigned char* digest, std::size_t size);
+
+// -----------------------------------------------------------------------------
+// SequentialFile class
+// -----------------------------------------------------------------------------
+class SequentialFile {
+public:
+    // Open a regular file for sequential reading
+    // @param path File to open (IsOpen() is false for folders and errors)
+    explicit SequentialFile(const std::filesystem::path& path);
+
+    // Destructor - closes the file
+    ~SequentialFile();
+
+    SequentialFile(const SequentialFile&) = delete;
+    SequentialFile& operator=(const SequentialFile&) = delete;
+
+    // Check whether a regular file was opened
+    bool IsOpen() const { return m_ok; }
+
+    // Identity of the opened file
+    std::uint64_t Device() const { return m_device; }
+    std::uint64_t Id() const { return m_id; }
+    std::uint64_t Size() const { return m_size; }
+    std::int64_t WriteTime() const { return m_writeTime; }   // Native units (ns on Linux, 100 ns on Windows)
+
+    // Read the next part of the file
+    // @return Bytes read, 0 at the end, -1 on error
+    std::int64_t Read(char* data, std::size_t size);
+
+private:
+#ifdef _WIN32
+    void* m_handle;                            // HANDLE (INVALID_HANDLE_VALUE if not open)
+#else
+    int m_fd = -1;
+#endif
+    bool m_ok = false;
+    std::uint64_t m_device = 0;
+    std::uint64_t m_id = 0;
+    std::uint64_t m_size = 0;
+    std::int64_t m_writeTime = 0;
+};
@@ -0,0 +1,173 @@
+// ContentSearch.hpp
+// Multithreaded recursive content search (grep) for FileMgr
+//
+// Searches the files below a folder for a literal string. A pool of worker
+// threads shares one queue of folders to list and files to search, so the
+// walk and the search run in parallel; files are preferred over folders to
+// keep the queue short. Large files are memory-mapped, small ones are read
+// into a per-thread buffer. The text is scanned 16 bytes at a time with SSE2
+// for the first and last byte of the literal (both cases of each when the
+// search ignores case) before candidates are compared in full. Files with a
+// NUL byte in their first 8 KB are treated as binary and skipped.
+//
+// Instead of walking the tree, a search can be given the list of files to
+// read (the candidates found by a TextIndex query).
+//
+// Matches (one per line, with the line number, column and a trimmed copy of
+// the line) are streamed to the UI in batches through Poll(). Cancel() or a
+// new Start() stops the workers between 4 MB segments of a file.
+//
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DirEnumerator.hpp"
+
+// -----------------------------------------------------------------------------
+// ContentSearch class
+// -----------------------------------------------------------------------------
+class ContentSearch {
+public:
+    // Search parameters
+    struct Options {
+        bool matchCase = false;            // False: ASCII letters match either case
+        int threads = 0;                   // Worker threads (0 = EntrySorter::DefaultThreadCount())
+        std::size_t maxMatches = 100000;   // Stop collecting after this many matches
+        std::size_t maxPerFile = 1000;     // Matches kept per file
+        std::vector<std::string> files;    // Search only these UTF-8 paths relative to the root
+                                           // (for example the candidates of a TextIndex query)
+    };
+
+    // One matching line
+    struct Match {
+        std::uint32_t file;                // Index into Results::files
+        std::uint32_t line;                // 1-based line number
+        std::uint32_t column;              // 1-based byte column of the match
+        std::string text;                  // Line text (trimmed to a window around the match)
+    };
+
+    // Matches taken from the workers
+    struct Results {
+        std::vector<std::string> files;    // UTF-8 paths relative to the root
+        std::vector<Match> matches;        // In the order they were found
+
+        void Clear() {
+            files.clear();
+            matches.clear();
+        }
+    };
+
+    // Progress of the current (or last) search
+    struct Stats {
+        std::size_t files = 0;             // Files searched
+        std::size_t folders = 0;           // Folders listed
+        std::size_t binary = 0;            // Files skipped as binary
+        std::size_t failed = 0;            // Files that could not be opened
+        std::size_t matches = 0;           // Matching lines found
+        std::uint64_t bytes = 0;           // Bytes searched
+        int threads = 0;
+        bool running = false;
+        bool truncated = false;            // maxMatches was reached
+        bool cancelled = false;
+        std::chrono::microseconds time{0}; // Elapsed time (so far)
+    };
+
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    ContentSearch() = default;
+
+    // Destructor - cancels the search and joins the workers
+    ~ContentSearch();
+
+    ContentSearch(const ContentSearch&) = delete;
+    ContentSearch& operator=(const ContentSearch&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Start searching (cancels the previous search)
+    // @param root    Folder whose subtree is searched
+    // @param literal UTF-8 text to find (empty does nothing)
+    // @param options Search parameters
+    void Start(const std::filesystem::path& root, const std::string& literal, const Options& options);
+
+    // Stop the current search and join its workers
+    void Cancel();
+
+    // Take the matches found since the last call
+    // @param out Receives the matches (appended; file indices are adjusted)
+    // @return True if matches were added
+    bool Poll(Results& out);
+
+    // Check whether workers are still running
+    bool IsRunning() const;
+
+    // Get the progress of the current or last search
+    Stats GetStats() const;
+
+    // Get the folder being searched
+    const std::filesystem::path& GetRoot() const { return m_root; }
+
+private:
+    // Queued work item
+    struct Work {
+        std::filesystem::path path;
+        std::string relative;              // UTF-8 path relative to the root
+        int depth;                         // Folder depth below the root
+    };
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    std::filesystem::path m_root;
+    std::string m_literal;
+    Options m_options;
+    std::vector<std::thread> m_workers;
+    std::atomic<bool> m_cancel{false};
+    std::atomic<bool> m_full{false};           // maxMatches was reached
+    std::atomic<std::size_t> m_matchCount{0};
+    std::chrono::steady_clock::time_point m_startTime;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_workCv;
+    std::deque<Work> m_folders;                // Folders waiting to be listed
+    std::deque<Work> m_files;                  // Files waiting to be searched
+    int m_idle = 0;                            // Workers waiting for work
+    bool m_done = false;                       // Queues are empty and every worker is idle
+    Results m_pending;                         // Matches not yet taken by Poll()
+    Stats m_stats;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Worker thread: take folders and files until the queues run dry
+    void WorkerLoop();
+
+    // List a folder, queueing its subfolders and files
+    void ListFolder(const Work& folder, DirEnumerator& enumerator);
+
+    // Search one file
+    // @param buffer Reusable read buffer of the calling worker
+    // @param out    Receives the matches of the file
+    void SearchFile(const Work& file, std::vector<char>& buffer, Results& out);
+
+    // Search the text of one file and append its matching lines
+    // @return Number of matches added
+    std::size_t SearchText(const char* text, std::size_t size, std::uint32_t file, Results& out);
+
+    // Merge a worker's matches into m_pending
+    void Flush(Results& local);
+};
@@ -0,0 +1,166 @@
+// Deduplicator.hpp
+// Space reclamation for duplicate files in FileMgr
+//
+// Takes the groups found by DuplicateFinder and, in every group, makes each
+// file after the first share its storage with the first file. Two methods:
+//
+//   Clone     The files stay separate (own names, attributes and future
+//             edits) but share their data blocks. On Linux this is the
+//             FIDEDUPERANGE ioctl (btrfs, XFS): the kernel locks both files,
+//             compares the bytes and shares the blocks only if they are
+//             equal, so a file changed since the search is never replaced.
+//             On Windows it is FSCTL_DUPLICATE_EXTENTS_TO_FILE (ReFS): both
+//             files are opened without write sharing, compared, and cloned
+//             while no one else can write to them.
+//
+//   HardLink  The file is replaced by a hard link to the first file, so both
+//             names are one file afterwards (an edit through one name shows
+//             through the other, and attributes are the first file's). Used
+//             only if the user opts in. The contents are compared first, the
+//             file is checked to be unchanged after the comparison, and the
+//             link is created under a temporary name and renamed over the
+//             file, which replaces it in one step. On Windows the rename uses
+//             POSIX semantics so the file stays open (and unwritable) until
+//             it is replaced; where that is not supported the file is closed,
+//             checked again (file id, size, write time) and replaced with
+//             MoveFileExW.
+//
+// Files that changed since the search, are on another volume or on a file
+// system without cloning are skipped and reported. The work runs on a few
+// background threads, one group at a time per thread, and can be stopped
+// between files.
+//
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DuplicateFinder.hpp"
+
+// -----------------------------------------------------------------------------
+// Deduplicator class
+// -----------------------------------------------------------------------------
+class Deduplicator {
+public:
+    enum class Method { Clone, HardLink };
+
+    // Parameters
+    struct Options {
+        Method method = Method::Clone;
+        int threads = 2;                   // Groups processed at the same time
+    };
+
+    // Progress of the current (or last) run
+    struct Stats {
+        std::size_t files = 0;             // Files to replace (all but the first of each group)
+        std::size_t processed = 0;
+        std::size_t replaced = 0;
+        std::size_t linked = 0;            // Already hard links to the first file
+        std::size_t changed = 0;           // Contents differ now; left alone
+        std::size_t unsupported = 0;       // Volume cannot clone or link these files
+        std::size_t failed = 0;
+        std::uint64_t bytesReclaimed = 0;  // Data now shared (Clone) or freed (HardLink)
+        std::uint64_t bytesCompared = 0;   // Bytes read for verification (HardLink, Windows Clone)
+        int threads = 0;
+        bool running = false;
+        bool cancelled = false;
+        std::chrono::microseconds time{0}; // Elapsed time (so far)
+    };
+
+    // A file that was not replaced
+    struct Problem {
+        std::string file;                  // UTF-8 path relative to the root
+        std::string reason;
+    };
+
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    Deduplicator() = default;
+
+    // Destructor - stops the run and joins the workers
+    ~Deduplicator();
+
+    Deduplicator(const Deduplicator&) = delete;
+    Deduplicator& operator=(const Deduplicator&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Start replacing duplicates (stops the previous run)
+    // @param root    Folder the group paths are relative to
+    // @param groups  Groups of identical files; the first file of each is kept
+    // @param options Parameters
+    void Start(const std::filesystem::path& root, std::vector<DuplicateFinder::Group> groups,
+               const Options& options);
+
+    // Stop after the files being processed
+    void Cancel();
+
+    // Take the problems reported since the last call
+    // @param out Receives the problems (appended)
+    // @return True if problems were added
+    bool Poll(std::vector<Problem>& out);
+
+    // Check whether the run is still going
+    bool IsRunning() const;
+
+    // Get the progress of the current or last run
+    Stats GetStats() const;
+
+    // Largest number of problems kept for Poll() per run
+    static constexpr std::size_t kMaxProblems = 10000;
+
+private:
+    // What happened to one file
+    enum class Outcome { Replaced, Linked, Changed, Unsupported, Failed };
+
+    // Result of one file
+    struct Result {
+        Outcome outcome = Outcome::Failed;
+        std::uint64_t reclaimed = 0;
+        std::uint64_t compared = 0;
+        std::string reason;                // For Changed, Unsupported and Failed
+    };
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    std::filesystem::path m_root;
+    Options m_options;
+    std::vector<DuplicateFinder::Group> m_groups;
+    std::vector<std::thread> m_workers;
+    std::atomic<bool> m_cancel{false};
+    std::atomic<std::size_t> m_nextGroup{0};
+    std::atomic<int> m_live{0};                // Workers still running
+    std::chrono::steady_clock::time_point m_startTime;
+
+    mutable std::mutex m_mutex;                // Guards the fields below
+    std::vector<Problem> m_problems;           // Not yet taken by Poll()
+    std::size_t m_problemCount = 0;            // Reported this run
+    Stats m_stats;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Worker thread: take groups until none are left
+    void WorkerLoop();
+
+    // Make one file share the storage of the kept file
+    Result Replace(const std::filesystem::path& keep, const std::filesystem::path& file, std::uint64_t size);
+
+    // Clone the kept file's blocks into the file if the contents are equal
+    Result Clone(const std::filesystem::path& keep, const std::filesystem::path& file, std::uint64_t size);
+
+    // Replace the file by a hard link to the kept file if the contents are equal
+    Result HardLink(const std::filesystem::path& keep, const std::filesystem::path& file, std::uint64_t size);
+};
@@ -0,0 +1,91 @@
+// DirEnumerator.hpp
+// Directory enumeration backends for FileMgr
+//
+// A DirEnumerator lists one directory and returns name, type, size and
+// modification time for every entry in bulk, so callers never need separate
+// per-entry metadata queries. Backends:
+// - Win32:    FindFirstFileExW with FindExInfoBasic + FIND_FIRST_EX_LARGE_FETCH
+//             (metadata comes straight from the directory listing)
+// - Linux:    getdents64 for names and d_type, then one statx per entry
+// - io_uring: Linux, getdents64 plus IORING_OP_STATX requests submitted in
+//             batches and completed out of order (UringEnumerator.cpp)
+// - Portable: std::filesystem::directory_iterator (fallback everywhere)
+//
+// Entries are delivered in chunks through a sink callback; returning false
+// from the sink stops the enumeration (used for cancellation).
+//
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// ScanEntry - one directory entry as produced by an enumerator
+// -----------------------------------------------------------------------------
+struct ScanEntry {
+    std::filesystem::path::string_type name;         // File name only (no parent)
+    bool isDirectory;                                // True for directories
+    bool isLink;                                     // Symbolic link or junction (the other fields describe the target)
+    std::uintmax_t size;                             // File size in bytes (0 for directories)
+    std::chrono::system_clock::time_point lastWriteTime; // Last modification time
+};
+
+// -----------------------------------------------------------------------------
+// Backend selection
+// -----------------------------------------------------------------------------
+enum class EnumBackend {
+    Auto,       // Best backend available on this platform
+    Native,     // Platform bulk API (falls back to Portable if unavailable)
+    Portable,   // std::filesystem only
+    IoUring     // Linux io_uring batched statx (falls back to Native)
+};
+
+// -----------------------------------------------------------------------------
+// DirEnumerator interface
+// -----------------------------------------------------------------------------
+class DirEnumerator {
+public:
+    // Receives a chunk of entries; may move from them. Return false to stop.
+    using Sink = std::function<bool(std::vector<ScanEntry>& chunk)>;
+
+    virtual ~DirEnumerator() = default;
+
+    // Short backend name for logs and statistics
+    virtual const char* GetName() const = 0;
+
+    // Enumerate a directory
+    // @param dir  Directory to list
+    // @param sink Called with each chunk of entries
+    // @param ec   Set on failure to open or read the directory
+    // @return False if the sink stopped the enumeration or an error occurred
+    virtual bool Enumerate(const std::filesystem::path& dir, const Sink& sink,
+                           std::error_code& ec) = 0;
+
+    // Create an enumerator for the requested backend
+    // @param backend Desired backend
+    // @return Enumerator instance (never null)
+    static std::unique_ptr<DirEnumerator> Create(EnumBackend backend);
+
+    // Check whether a backend can run here without falling back
+    // @param backend Backend to test
+    // @return True if Create(backend) yields that backend
+    static bool IsAvailable(EnumBackend backend);
+};
+
+// Read the modification time of a file or directory
+// @param path Path to query
+// @param out  Receives the modification time
+// @return False if the path cannot be queried
+bool QueryWriteTime(const std::filesystem::path& path, std::chrono::system_clock::time_point& out);
+
+#ifdef __linux__
+// Create the io_uring backend
+// @return Enumerator, or null if io_uring or IORING_OP_STATX is unavailable
+//         or a ring has already failed in this process
+std::unique_ptr<DirEnumerator> CreateUringEnumerator();
+#endif
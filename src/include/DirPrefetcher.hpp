@@ -0,0 +1,106 @@
+// DirPrefetcher.hpp
+// Speculative directory prefetcher for FileMgr
+//
+// Warms the SnapshotCache with directories the user is likely to open next
+// (the parent directory, the hovered row in the file list, the hovered node
+// in the sidebar) so that the following navigation paints from cache.
+//
+// The prefetcher is deliberately conservative:
+// - a fixed, small number of low-priority worker threads
+// - a short LIFO queue (the most recently hovered directory wins)
+// - directories with too many entries are abandoned
+// - a prefetch never evicts anything from the cache
+// - CancelAll() stops all work as soon as a real navigation starts
+//
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "SnapshotCache.hpp"
+
+// -----------------------------------------------------------------------------
+// DirPrefetcher class
+// -----------------------------------------------------------------------------
+class DirPrefetcher {
+public:
+    // Counters used to judge whether prefetching pays for itself
+    struct Stats {
+        std::uint64_t requested = 0;    // Requests accepted into the queue
+        std::uint64_t completed = 0;    // Snapshots stored in the cache
+        std::uint64_t cancelled = 0;    // Prefetches abandoned by CancelAll()
+        std::uint64_t skipped = 0;      // Too large, unreadable or no cache room
+        std::uint64_t used = 0;         // Navigations served by a prefetched snapshot
+    };
+
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    // Constructor - starts the worker threads
+    // @param cache       Snapshot cache to fill (must outlive this object)
+    // @param threadCount Number of worker threads (clamped to 1..2)
+    explicit DirPrefetcher(SnapshotCache* cache, int threadCount = 1);
+
+    // Destructor - cancels outstanding work and joins the workers
+    ~DirPrefetcher();
+
+    DirPrefetcher(const DirPrefetcher&) = delete;
+    DirPrefetcher& operator=(const DirPrefetcher&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Ask for a directory to be warmed (ignored if cached, queued or running)
+    // @param dir Directory to prefetch
+    void Request(const std::filesystem::path& dir);
+
+    // Drop the queue and abort prefetches in progress
+    void CancelAll();
+
+    // Record a navigation so prefetch usefulness can be measured
+    // @param dir      Directory navigated to
+    // @param cacheHit True if the navigation was served from the cache
+    void NoteNavigation(const std::filesystem::path& dir, bool cacheHit);
+
+    // Get a copy of the counters
+    Stats GetStats() const;
+
+private:
+    using Key = std::filesystem::path::string_type;
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    SnapshotCache* m_cache;                    // Cache to fill
+    std::vector<std::thread> m_workers;        // Low-priority worker threads
+    mutable std::mutex m_mutex;                // Guards everything below
+    std::condition_variable m_wakeCv;          // Signals workers
+    bool m_stop;                               // Shutdown flag
+    std::atomic<std::uint64_t> m_generation;   // Bumped by CancelAll()
+
+    std::deque<std::filesystem::path> m_queue; // Pending requests (back = newest)
+    std::unordered_set<Key> m_inFlight;        // Directories being read right now
+    std::deque<Key> m_prefetched;              // Stored by us and not yet visited
+    Stats m_stats;                             // Counters
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Worker thread main loop
+    void WorkerLoop();
+
+    // Read one directory and store it in the cache if it qualifies
+    // @param dir        Directory to read
+    // @param generation Generation at the time the request was taken
+    void Prefetch(const std::filesystem::path& dir, std::uint64_t generation);
+};
@@ -0,0 +1,162 @@
+// DirScanner.hpp
+// Background directory scanner for FileMgr
+//
+// Enumerates a directory on a worker thread and hands the results back to the
+// UI thread in small batches, so large folders start painting immediately
+// instead of freezing the window until the whole listing has been read.
+//
+// Every scan is tagged with a generation number. Starting a new scan or
+// calling Cancel() bumps the generation: the worker abandons the old scan at
+// the next chunk and any batches still queued for it are dropped by Poll().
+//
+// Entries are read through a pluggable DirEnumerator backend (see
+// DirEnumerator.hpp). The scanner has no UI dependencies and can be driven
+// headless.
+//
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "DirEnumerator.hpp"
+
+// -----------------------------------------------------------------------------
+// DirScanner class
+// -----------------------------------------------------------------------------
+class DirScanner {
+public:
+    // -------------------------------------------------------------------------
+    // Public structures
+    // -------------------------------------------------------------------------
+
+    // A group of entries delivered to the UI thread
+    struct Batch {
+        std::uint64_t generation;          // Scan this batch belongs to
+        std::vector<ScanEntry> entries;    // Entries read since the previous batch
+        bool finished;                     // True for the last batch of a scan
+        bool unchanged = false;            // Revalidation found the directory unmodified
+        std::chrono::system_clock::time_point dirWriteTime{}; // Directory mtime (final batch)
+    };
+
+    // Timing information for the most recent completed scan
+    struct Stats {
+        std::uint64_t generation = 0;                 // Scan the numbers refer to
+        const char* backend = "";                     // Enumeration backend used
+        std::size_t entryCount = 0;                   // Entries enumerated
+        std::chrono::microseconds timeToFirstBatch{0}; // Start() -> first batch queued
+        std::chrono::microseconds totalTime{0};       // Start() -> scan finished
+        bool cancelled = false;                       // Scan was superseded
+    };
+
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    // Constructor - starts the worker thread
+    DirScanner();
+
+    // Destructor - cancels any scan and joins the worker thread
+    ~DirScanner();
+
+    DirScanner(const DirScanner&) = delete;
+    DirScanner& operator=(const DirScanner&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Begin scanning a directory, cancelling any scan in progress
+    // @param dir Directory to enumerate
+    // @return Generation token identifying this scan
+    std::uint64_t Start(const std::filesystem::path& dir);
+
+    // Re-check a directory whose listing is already known
+    // If its modification time still equals knownWriteTime, a single finished
+    // batch with unchanged = true is delivered; otherwise a full scan runs.
+    // @param dir            Directory to check
+    // @param knownWriteTime Directory mtime recorded with the known listing
+    // @return Generation token identifying this scan
+    std::uint64_t StartRevalidate(const std::filesystem::path& dir,
+                                  std::chrono::system_clock::time_point knownWriteTime);
+
+    // Cancel the scan in progress (if any); queued batches are discarded
+    void Cancel();
+
+    // Move all batches queued for the current generation into out
+    // @param out Receives batches in scan order (appended)
+    // @return True if at least one batch was delivered
+    bool Poll(std::vector<Batch>& out);
+
+    // Block until a batch for the current generation is available or timeout
+    // Intended for headless drivers (ScanBenchmark); the UI thread should use Poll()
+    // @param timeout Maximum time to wait
+    // @return True if a batch of the current scan is ready (stale ones are ignored)
+    bool WaitForBatch(std::chrono::milliseconds timeout);
+
+    // Select the enumeration backend used by subsequent scans
+    // @param backend Backend to use
+    void SetBackend(EnumBackend backend);
+
+    // Get the backend selected with SetBackend()
+    EnumBackend GetBackend() const;
+
+    // Get the generation of the most recent Start()/Cancel()
+    std::uint64_t GetGeneration() const { return m_generation.load(); }
+
+    // Get statistics of the last scan that ran to completion or was cancelled
+    Stats GetLastStats() const;
+
+private:
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    std::thread m_worker;                      // Background worker
+    mutable std::mutex m_mutex;                // Guards everything below
+    std::condition_variable m_wakeCv;          // Signals the worker
+    std::condition_variable m_readyCv;         // Signals WaitForBatch()
+
+    // A pending scan request
+    struct Request {
+        std::filesystem::path dir;                       // Directory to scan
+        std::uint64_t generation = 0;                    // Generation token
+        std::chrono::steady_clock::time_point startTime; // When it was requested
+        EnumBackend backend = EnumBackend::Auto;         // Enumeration backend
+        bool revalidate = false;                         // Skip scan if mtime matches
+        std::chrono::system_clock::time_point knownWriteTime; // mtime to compare against
+    };
+
+    std::atomic<std::uint64_t> m_generation;   // Current scan generation
+    bool m_stop;                               // Worker shutdown flag
+    bool m_hasRequest;                         // m_request is waiting for the worker
+    Request m_request;                         // Most recent request
+    EnumBackend m_backend;                     // Backend for new scans
+
+    std::deque<Batch> m_ready;                 // Batches waiting for Poll()
+    Stats m_lastStats;                         // Statistics of the last scan
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Worker thread main loop
+    void WorkerLoop();
+
+    // Queue a request for the worker and return its generation
+    // @param request Request to queue (generation and timing are filled in)
+    std::uint64_t Submit(Request request);
+
+    // Enumerate one directory, pushing batches until done or superseded
+    // @param request Scan request
+    void ScanDirectory(const Request& request);
+
+    // Queue a batch for the UI thread if its generation is still current
+    // @return False if the scan has been superseded
+    bool PushBatch(Batch&& batch);
+};
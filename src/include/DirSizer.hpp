@@ -0,0 +1,250 @@
+// DirSizer.hpp
+// Parallel recursive folder sizes for FileMgr
+//
+// Computes the total size of every subfolder of a listed folder in the
+// background, so the Size column can show folders too. The tree is walked
+// by a pool of workers with one deque each: a worker pushes the subfolders
+// it finds onto its own deque and takes work from the back, and an idle
+// worker steals from the front of another worker's deque, so one deep
+// branch does not leave the other threads waiting.
+//
+// Each subfolder of the listed folder is a slot whose totals grow while the
+// walk runs and which is marked done when its last folder has been read;
+// the UI polls the slots every frame. Two sizes are kept: the logical size
+// (bytes in the files) and the allocated size (space taken on disk). A file
+// with several hard links is counted once, in whichever folder reaches it
+// first. Folders on another volume, symbolic links and junctions are not
+// followed.
+//
+// The totals read from each folder are cached by path together with the
+// folder's modification time. When the same folder is sized again and its
+// time is unchanged, its files are not enumerated again. A file that grows
+// in place does not change its folder's time, so such a change is only
+// picked up by a walk that bypasses the cache.
+//
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// DirSizer class
+// -----------------------------------------------------------------------------
+class DirSizer {
+public:
+    // Sizes of a folder tree
+    struct Totals {
+        std::uint64_t logical = 0;         // Bytes in the files
+        std::uint64_t allocated = 0;       // Bytes allocated on disk (files and folders)
+        std::uint64_t files = 0;
+        std::uint64_t folders = 0;         // Folders below the slot's folder
+    };
+
+    // Progress of one subfolder
+    struct Slot {
+        Totals totals;
+        bool done = false;                 // Every folder of the subtree has been read
+    };
+
+    // State of the walk
+    struct Stats {
+        std::uint64_t generation = 0;      // Bumped by every Start()
+        Totals total;                      // Whole listed folder
+        std::size_t visited = 0;           // Folders read so far
+        std::size_t cached = 0;            // Folders taken from the cache
+        std::size_t linked = 0;            // Hard links skipped as already counted
+        std::size_t steals = 0;            // Folders taken from another worker's deque
+        std::size_t errors = 0;            // Folders that could not be opened
+        std::size_t cacheEntries = 0;
+        int threads = 0;
+        bool running = false;
+        std::chrono::microseconds time{0}; // Duration of the walk (so far)
+    };
+
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    DirSizer() = default;
+
+    // Destructor - stops the walk
+    ~DirSizer();
+
+    DirSizer(const DirSizer&) = delete;
+    DirSizer& operator=(const DirSizer&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Size the subfolders of a folder in the background, stopping any walk
+    // in progress
+    // @param root     Listed folder
+    // @param children Names of its subfolders; children[k] is reported in slot k
+    // @param useCache Reuse the totals of folders whose time is unchanged
+    // @param threads  Worker threads (0 = EntrySorter::DefaultThreadCount())
+    // @return Generation of the new walk
+    std::uint64_t Start(const std::filesystem::path& root,
+                        const std::vector<std::filesystem::path::string_type>& children,
+                        bool useCache = true, int threads = 0);
+
+    // Stop the walk (the slots keep the totals reached so far)
+    void Cancel();
+
+    // Copy the progress of every slot (no allocation once out has the size)
+    // @param out Receives one Slot per child passed to Start()
+    void GetSlots(std::vector<Slot>& out) const;
+
+    // Get the state of the walk
+    Stats GetStats() const;
+
+    // Check whether the walk is still running
+    bool IsRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    // Get the generation of the current walk
+    std::uint64_t GetGeneration() const { return m_generation; }
+
+    // Block until the walk has finished
+    void Wait();
+
+    // Forget the cached folder totals
+    void ClearCache();
+
+private:
+    // A folder waiting to be read
+    struct Work {
+        std::filesystem::path path;
+        std::uint32_t slot;
+        std::uint32_t depth;
+    };
+
+    // Deque of one worker; the owner uses the back, thieves the front
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Work> items;
+    };
+
+    // Identity of a file with several links
+    struct FileKey {
+        std::uint64_t device;
+        std::uint64_t id;
+        bool operator==(const FileKey& other) const { return device == other.device && id == other.id; }
+    };
+
+    struct FileKeyHash {
+        std::size_t operator()(const FileKey& key) const {
+            return std::hash<std::uint64_t>()(key.id * 0x9E3779B97F4A7C15ull ^ key.device);
+        }
+    };
+
+    // A file that may also be reached through another link
+    struct LinkedFile {
+        FileKey key;
+        std::uint64_t logical;
+        std::uint64_t allocated;
+    };
+
+    // What a folder contained when it was last read
+    struct CacheEntry {
+        std::int64_t time = 0;             // Folder modification time (ns since the epoch)
+        Totals own;                        // The folder itself and its single-link files
+        std::vector<std::filesystem::path::string_type> subfolders;
+        std::vector<LinkedFile> linked;
+    };
+
+    // Running totals of a slot
+    struct SlotState {
+        std::atomic<std::uint64_t> logical{0};
+        std::atomic<std::uint64_t> allocated{0};
+        std::atomic<std::uint64_t> files{0};
+        std::atomic<std::uint64_t> folders{0};
+        std::atomic<std::int64_t> pending{0};  // Folders queued or being read
+    };
+
+    // Outcome of reading a folder
+    enum class ReadResult { Read, Cached, Skipped, Failed };
+
+    static constexpr std::size_t kShards = 16;
+
+    // Set of counted multi-link files, split to spread the locking
+    struct LinkShard {
+        std::mutex mutex;
+        std::unordered_set<FileKey, FileKeyHash> keys;
+    };
+
+    // Part of the folder cache, split to spread the locking
+    struct CacheShard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::filesystem::path::string_type, CacheEntry> entries;
+    };
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    std::vector<std::thread> m_workers;
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::atomic<bool> m_cancel{false};
+    std::atomic<bool> m_running{false};
+    std::atomic<std::int64_t> m_outstanding{0};    // Folders queued or being read
+    std::atomic<int> m_live{0};                    // Workers still running
+    std::uint64_t m_generation = 0;
+
+    std::filesystem::path m_root;
+    std::uint64_t m_rootDevice = 0;                // Volume of the root (other volumes are skipped)
+    bool m_useCache = true;
+    std::unordered_map<std::filesystem::path::string_type, std::uint32_t> m_childSlots;
+    std::unique_ptr<SlotState[]> m_slots;          // One per child, then one for the root's own files
+    std::size_t m_slotCount = 0;
+
+    LinkShard m_links[kShards];
+    CacheShard m_cache[kShards];
+
+    std::atomic<std::size_t> m_visited{0};
+    std::atomic<std::size_t> m_cached{0};
+    std::atomic<std::size_t> m_linked{0};
+    std::atomic<std::size_t> m_steals{0};
+    std::atomic<std::size_t> m_errors{0};
+    std::chrono::steady_clock::time_point m_start;
+    std::atomic<std::int64_t> m_elapsed{0};        // Microseconds, set when the walk ends
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Worker loop: read folders until none are left
+    void WorkerLoop(std::size_t self);
+
+    // Take a folder from the worker's own deque or steal one
+    bool Take(std::size_t self, Work& work);
+
+    // Queue a folder on a worker's deque
+    void Push(std::size_t self, Work work);
+
+    // Read one folder (or take it from the cache) and queue its subfolders
+    void Visit(std::size_t self, const Work& work);
+
+    // Read a folder, or account for it from the cache if its time is unchanged
+    // @param entry Receives what the folder contains (unless Cached)
+    // @return Skipped for a folder on another volume
+    ReadResult ReadFolder(std::size_t self, const Work& work, CacheEntry& entry);
+
+    // Add the totals of one folder to its slot and queue its subfolders
+    void Account(std::size_t self, const Work& work, const CacheEntry& entry);
+
+    // Count a multi-link file unless another link was counted already
+    // @return True if the file was not seen before
+    bool ClaimLink(const FileKey& key);
+
+    // Stop the workers and join them
+    void Stop();
+};
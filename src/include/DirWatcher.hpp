@@ -0,0 +1,164 @@
+// DirWatcher.hpp
+// Filesystem change notifications for FileMgr
+//
+// Watches a set of directories (non-recursively) on a background thread:
+// ReadDirectoryChangesW with an I/O completion port on Windows, inotify on
+// Linux. Individual events are not reported; a watched directory is only
+// marked as changed, and Poll() hands it out once it has been quiet for a
+// short time. A burst (e.g. a build writing thousands of files) therefore
+// becomes a single refresh, and a directory that never settles is still
+// reported at a bounded interval.
+//
+// When events are lost (inotify queue or notification buffer overflow) the
+// affected directories are reported anyway: the caller re-reads a reported
+// directory and diffs it, so it never needs the individual events.
+//
+// Network and FUSE filesystems (NFS, SMB, sshfs, ...) accept watches but
+// never report changes made by other machines, so directories on them, and
+// directories that cannot be watched at all, are also polled: their mtime
+// is re-checked at an adaptive interval that backs off while nothing
+// changes and tightens again after a change. All polls share a global
+// budget of stat calls per second.
+//
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// DirWatcher class
+// -----------------------------------------------------------------------------
+class DirWatcher {
+public:
+    // Counters for the statistics window
+    struct Stats {
+        const char* backend = "none";  // Notification API in use
+        std::size_t watched = 0;       // Directories with an active watch
+        std::uint64_t events = 0;      // Raw notifications received
+        std::uint64_t reported = 0;    // Debounced changes handed out by Poll()
+        std::uint64_t overflows = 0;   // Lost-event notifications
+
+        std::size_t polled = 0;        // Directories checked by polling
+        std::uint64_t polls = 0;       // mtime checks performed
+        std::uint64_t pollChanges = 0; // Changes found by polling
+        std::size_t overdue = 0;       // Due checks waiting for the stat budget
+        int pollsLastSecond = 0;       // Checks in the last full second
+        int statBudget = 0;            // Maximum checks per second
+        double minInterval = 0.0;      // Shortest / longest current interval (seconds)
+        double maxInterval = 0.0;
+    };
+
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    // Constructor - starts the watcher thread
+    // @param quietTime Report a directory after this long without events
+    // @param maxDelay  Report a busy directory at least this often
+    explicit DirWatcher(std::chrono::milliseconds quietTime = std::chrono::milliseconds(200),
+                        std::chrono::milliseconds maxDelay = std::chrono::milliseconds(1000));
+
+    // Destructor - removes all watches and joins the thread
+    ~DirWatcher();
+
+    DirWatcher(const DirWatcher&) = delete;
+    DirWatcher& operator=(const DirWatcher&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Replace the set of watched directories
+    // @param dirs Directories to watch (duplicates and missing ones are ignored)
+    void SetWatchedDirs(const std::vector<std::filesystem::path>& dirs);
+
+    // Take the directories whose changes have settled
+    // @param changed Receives the directories (cleared first)
+    // @return True if any directory changed
+    bool Poll(std::vector<std::filesystem::path>& changed);
+
+    // Check whether notifications are supported on this system
+    bool IsAvailable() const { return m_available; }
+
+    // Check whether a directory lives on a filesystem whose changes are not
+    // reliably reported (network and FUSE mounts)
+    static bool NeedsPolling(const std::filesystem::path& dir);
+
+    // Get current counters
+    Stats GetStats() const;
+
+private:
+    // -------------------------------------------------------------------------
+    // Internal structures
+    // -------------------------------------------------------------------------
+
+    // A watched directory with unreported events
+    struct Pending {
+        std::filesystem::path dir;
+        std::chrono::steady_clock::time_point first;   // First unreported event
+        std::chrono::steady_clock::time_point last;    // Most recent event
+    };
+
+    // A directory checked by polling its mtime
+    struct Polled {
+        std::filesystem::path dir;
+        std::chrono::system_clock::time_point writeTime; // Last seen mtime
+        bool known;                                      // writeTime is valid
+        std::chrono::milliseconds interval;              // Current polling interval
+        std::chrono::steady_clock::time_point due;       // Next check
+    };
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    std::chrono::milliseconds m_quietTime;     // Debounce: quiet period
+    std::chrono::milliseconds m_maxDelay;      // Debounce: upper bound
+    bool m_available;                          // Notification handle was created
+    void* m_handle;                            // I/O completion port (Windows) or inotify fd
+    void* m_wakeHandle;                        // eventfd that wakes the thread (Linux)
+
+    mutable std::mutex m_mutex;                // Guards everything below
+    bool m_stop;                               // Shutdown flag
+    bool m_dirsChanged;                        // m_dirs differs from the active watches
+    std::vector<std::filesystem::path> m_dirs; // Requested directories
+    std::unordered_map<std::filesystem::path::string_type, Pending> m_pending; // Keyed by path
+    Stats m_stats;
+
+    // Polling state, used by the watcher thread only
+    std::vector<Polled> m_polled;              // Directories to poll
+    double m_statTokens;                       // Token bucket for the stat budget
+    std::chrono::steady_clock::time_point m_tokenTime; // Last token refill
+    std::chrono::steady_clock::time_point m_rateStart; // Start of the current one-second window
+    int m_rateCount;                           // Checks in the current window
+
+    std::thread m_worker;                      // Watcher thread (owns all watch handles)
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Watcher thread main loop
+    void WorkerLoop();
+
+    // Record an event for a directory (called with m_mutex held)
+    void MarkChanged(const std::filesystem::path& dir, std::chrono::steady_clock::time_point now);
+
+    // Wake the watcher thread (stop or new directory set)
+    void Wake();
+
+    // Replace the set of polled directories (keeps the state of existing ones)
+    void SetPolled(const std::vector<std::filesystem::path>& dirs);
+
+    // Check whether a directory is currently polled
+    bool IsPolled(const std::filesystem::path& dir) const;
+
+    // Check the directories that are due, within the stat budget
+    // @return Milliseconds until the next check is due (-1 if nothing is polled)
+    int RunPolls();
+};
@@ -0,0 +1,126 @@
+// DisplayStrings.hpp
+// Preformatted row text for the file list
+//
+// Formatting a row (UTF-8 name, size with unit, local date) is far more
+// expensive than drawing it, so DisplayStrings formats every entry once,
+// when it arrives from the scanner, and keeps the results in one compact
+// per-directory character buffer. Draw() then only hands pointers to ImGui.
+//
+// Dates are converted with LocalTimeFormatter, which caches the local UTC
+// offset per day instead of calling localtime() for every entry. It uses
+// the reentrant localtime_r / localtime_s, so each thread can own one.
+//
+// Folder rows leave room for a size in their text, so recursive folder
+// sizes computed later can be written in place with SetSize().
+//
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "EntryStore.hpp"
+
+// -----------------------------------------------------------------------------
+// LocalTimeFormatter - "YYYY-MM-DD HH:MM" in local time with cached offsets
+// -----------------------------------------------------------------------------
+class LocalTimeFormatter {
+public:
+    // Format a time point in local time
+    // @param t    Time to format
+    // @param buf  Output buffer (at least 17 characters)
+    // @param size Size of buf
+    // @return Number of characters written (0 if the time cannot be converted)
+    std::size_t Format(std::chrono::system_clock::time_point t, char* buf, std::size_t size);
+
+    // Get the local UTC offset at a given time
+    // @param utcSeconds Seconds since the Unix epoch
+    // @param offset     Receives local minus UTC in seconds
+    // @return False if the C library cannot convert the time
+    bool GetUtcOffset(std::int64_t utcSeconds, std::int32_t& offset);
+
+private:
+    std::unordered_map<std::int64_t, std::int32_t> m_dayOffsets; // UTC day -> offset (or kMixedDay)
+
+    // Ask the C library for the offset at one instant (reentrant)
+    static bool QueryOffset(std::int64_t utcSeconds, std::int32_t& offset);
+};
+
+// -----------------------------------------------------------------------------
+// DisplayStrings class
+// -----------------------------------------------------------------------------
+class DisplayStrings {
+public:
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Drop all formatted rows (call whenever the EntryStore is replaced)
+    void Clear();
+
+    // Format the entries that were appended since the last call
+    // @param entries Store the rows belong to (storage indices must match)
+    void Update(const EntryStore& entries);
+
+    // Rebuild the rows for a new listing, copying the text of unchanged entries
+    // @param reuse   New index -> current row index (kNoIndex: format)
+    // @param entries New listing
+    void Remap(const std::vector<EntryStore::Index>& reuse, const EntryStore& entries);
+
+    // Number of formatted rows
+    std::size_t Size() const { return m_rows.size(); }
+
+    // Row text by storage index (null-terminated UTF-8)
+    const char* GetName(EntryStore::Index i) const { return m_text.data() + m_rows[i].offset; }
+    const char* GetSize(EntryStore::Index i) const { return GetName(i) + m_rows[i].nameLength + 1; }
+    const char* GetDate(EntryStore::Index i) const { return GetSize(i) + m_rows[i].sizeSlot + 1; }
+    // Extension without the dot (empty for folders and names without one)
+    const char* GetType(EntryStore::Index i) const { return GetName(i) + m_rows[i].typeOffset; }
+
+    // Replace the size text of a folder row (file rows are left unchanged)
+    // @param i    Storage index of a folder
+    // @param size Recursive size in bytes ("0 B" for an empty folder)
+    void SetSize(EntryStore::Index i, std::uint64_t size);
+
+    // Clear the size text of a folder row
+    void ClearSize(EntryStore::Index i);
+
+    // Approximate heap memory used
+    std::size_t GetMemoryBytes() const;
+
+    // Format a file size with a unit ("12 B", "3.4 KB", ...)
+    // @param size Size in bytes (0 gives an empty string)
+    // @param buf  Output buffer
+    // @param n    Size of buf
+    // @return Number of characters written
+    static std::size_t FormatSize(std::uint64_t size, char* buf, std::size_t n);
+
+private:
+    // One formatted row: name, size and date stored back to back at offset
+    struct Row {
+        std::uint32_t offset;       // Start of the name in m_text
+        std::uint16_t nameLength;   // Bytes, without terminator
+        std::uint16_t typeOffset;   // Start of the extension within the name
+        std::uint8_t sizeLength;
+        std::uint8_t sizeSlot;      // Bytes reserved for the size (folders reserve kFolderSizeSlot)
+        std::uint8_t dateLength;
+    };
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    std::vector<char> m_text;                  // name\0size\0date\0 for every row (size padded to sizeSlot)
+    std::vector<Row> m_rows;                   // Indexed by EntryStore storage index
+    LocalTimeFormatter m_time;                 // Cached time-zone offsets
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Grow the buffers for the rows from first to the end of entries (geometric)
+    void Reserve(const EntryStore& entries, std::size_t first);
+
+    // Format one entry and append its row
+    void FormatRow(const EntryStore& entries, EntryStore::Index index);
+};
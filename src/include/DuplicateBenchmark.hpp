@@ -0,0 +1,79 @@
+// DuplicateBenchmark.hpp
+// Duplicate finder benchmark for FileMgr (--duplicate-benchmark)
+//
+// Generates a synthetic tree below a folder: files of random sizes with
+// random contents, a share of them in a few common sizes (so many files
+// collide on size alone), planted duplicate sets of two to five copies,
+// near-duplicates that differ only in the middle (equal at both ends) and
+// hard links. Runs DuplicateFinder on it twice, with and without the
+// partial-hash stage, reports the time, the files hashed and the bytes read
+// by each stage, and checks that exactly the planted sets are found. The
+// tree is deterministic and is kept and reused by later runs.
+//
+// RunDedupe (--dedupe-benchmark) writes a fresh copy of the tree, finds the
+// duplicates, changes one of them after the search, and runs Deduplicator
+// on the groups: first with clones, then with hard links. After each pass it
+// checks that every file still has its own contents, that the changed file
+// was skipped, and reports the files replaced and the bytes reclaimed. On a
+// loopback btrfs or XFS mount the clone pass shares blocks; on tmpfs or
+// ext4 it reports the files as unsupported and the hard-link pass does the
+// work.
+//
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// DuplicateBenchmark class
+// -----------------------------------------------------------------------------
+class DuplicateBenchmark {
+public:
+    // Tree parameters
+    struct Options {
+        int files = 10000;                 // Unique files
+        int folders = 100;
+        int sets = 300;                    // Planted duplicate sets
+        int nearDuplicates = 200;          // Copies changed in the middle only
+        int hardLinks = 100;               // Extra names of unique files
+        std::uint64_t maxSize = 256 * 1024;    // Largest random file size
+        int threads = 0;                   // Hash workers (0 = EntrySorter::DefaultThreadCount())
+    };
+
+    // Run the benchmark and log the results
+    // @param dir     Folder for the tree (created if needed)
+    // @param options Tree parameters
+    // @return Process exit code (0 on success)
+    static int Run(const std::filesystem::path& dir, const Options& options);
+
+    // Deduplicate a fresh tree and check the result
+    // @param dir     Folder for the tree (its previous copy is deleted)
+    // @param options Tree parameters
+    // @return Process exit code (0 on success)
+    static int RunDedupe(const std::filesystem::path& dir, const Options& options);
+
+private:
+    // One file of the tree
+    struct FileSpec {
+        std::string relative;              // UTF-8 path relative to the tree
+        std::uint64_t size;
+        std::uint64_t seed;                // Contents are generated from the seed
+        std::uint64_t change;              // Offset of a changed byte, or ~0 for none
+        int linkTo;                        // Index of the file this is a hard link to, or -1
+        int set;                           // Planted duplicate set, or -1
+    };
+
+    // Plan the tree (the same every run)
+    static std::vector<FileSpec> Plan(const Options& options);
+
+    // Write the tree unless a complete one already exists
+    // @return False if a file could not be written
+    static bool Generate(const std::filesystem::path& tree, const std::vector<FileSpec>& files);
+
+    // Check that every file of the tree has its planned contents
+    // @param changed Index of a file whose first byte was flipped, or -1
+    // @return Number of files whose contents differ
+    static int Verify(const std::filesystem::path& tree, const std::vector<FileSpec>& files, int changed);
+};
@@ -0,0 +1,208 @@
+// DuplicateFinder.hpp
+// Duplicate file finder for FileMgr
+//
+// Finds files with identical contents below a folder in stages, so that
+// most files are never read in full:
+//
+//   1. The tree is walked and files are grouped by size; a file whose size
+//      no other file has cannot have a duplicate.
+//   2. Files that share a size are read only at both ends: the first and
+//      the last 16 KB are hashed. Files that differ there are dropped.
+//   3. Files that still collide are hashed in full with XXH64; files with
+//      equal size and hash are reported as duplicates.
+//
+// Files small enough to be read whole in stage 2 skip stage 3. Hard links
+// (several names for the same file, detected by volume and file id when the
+// file is opened) are not duplicates and are reported once. Symbolic links
+// are not followed.
+//
+// The hashing is done by a pool of workers, largest files first, and at most
+// a fixed number of them read from the disk at the same time (a spinning
+// disk is fastest with one or two); the others hash what they have read.
+// Each group of duplicates is streamed to the UI through Poll() as soon as
+// its last file has been hashed.
+//
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// DuplicateFinder class
+// -----------------------------------------------------------------------------
+class DuplicateFinder {
+public:
+    // Search parameters
+    struct Options {
+        int threads = 0;                   // Hash workers (0 = EntrySorter::DefaultThreadCount())
+        int reads = 0;                     // Files read at the same time (0 = one per worker)
+        std::uint64_t minSize = 1;         // Smaller files are ignored (all empty files are equal)
+        bool partialHash = true;           // Compare both ends before hashing whole files
+    };
+
+    // Files with identical contents
+    struct Group {
+        std::uint64_t size;                // Size of each file
+        std::uint64_t hash;                // XXH64 of the contents
+        std::vector<std::string> files;    // UTF-8 paths relative to the root, sorted
+
+        // Bytes freed by keeping one copy
+        std::uint64_t Reclaimable() const { return size * (files.size() - 1); }
+    };
+
+    enum class Phase { Idle, Walking, Hashing, Done };
+
+    // Progress of the current (or last) search
+    struct Stats {
+        Phase phase = Phase::Idle;
+        std::size_t files = 0;             // Files found by the walk
+        std::size_t folders = 0;
+        std::size_t candidates = 0;        // Files sharing their size with another file
+        std::uint64_t candidateBytes = 0;
+        std::size_t partialHashed = 0;     // Files hashed at both ends (or whole, if small)
+        std::size_t fullHashed = 0;        // Files hashed in full after a partial match
+        std::uint64_t bytesRead = 0;
+        std::size_t hardLinks = 0;         // Extra names of files already counted
+        std::size_t failed = 0;            // Files that could not be read or changed size
+        std::size_t groups = 0;            // Groups of duplicates found
+        std::size_t duplicates = 0;        // Files beyond the first of each group
+        std::uint64_t reclaimable = 0;     // Bytes in those files
+        int threads = 0;
+        int reads = 0;
+        bool running = false;
+        bool cancelled = false;
+        std::chrono::microseconds walkTime{0};
+        std::chrono::microseconds time{0}; // Elapsed time (so far)
+    };
+
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    DuplicateFinder() = default;
+
+    // Destructor - cancels the search and joins the workers
+    ~DuplicateFinder();
+
+    DuplicateFinder(const DuplicateFinder&) = delete;
+    DuplicateFinder& operator=(const DuplicateFinder&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Start searching (cancels the previous search)
+    // @param root    Folder whose subtree is searched
+    // @param options Search parameters
+    void Start(const std::filesystem::path& root, const Options& options);
+
+    // Stop the current search and join its workers
+    void Cancel();
+
+    // Take the groups found since the last call
+    // @param out Receives the groups (appended)
+    // @return True if groups were added
+    bool Poll(std::vector<Group>& out);
+
+    // Check whether the search is still running
+    bool IsRunning() const;
+
+    // Get the progress of the current or last search
+    Stats GetStats() const;
+
+    // Get the folder being searched
+    const std::filesystem::path& GetRoot() const { return m_root; }
+
+    // Bytes hashed at each end of a file in the partial stage
+    static constexpr std::size_t kBlockSize = 16 * 1024;
+
+private:
+    // A file that shares its size with another file
+    struct Candidate {
+        std::string relative;              // UTF-8 path relative to the root
+        std::uint64_t size;
+        std::uint64_t partial = 0;         // Hash of both ends
+        std::uint64_t full = 0;            // Hash of the contents (valid if complete)
+        std::uint64_t device = 0;          // Identity of the file (hard links share it)
+        std::uint64_t id = 0;
+        bool complete = false;             // full is valid
+        bool failed = false;
+    };
+
+    // Files whose hashes are being computed; resolved when pending reaches 0
+    struct Set {
+        std::vector<std::uint32_t> members;    // Indices into m_candidates
+        std::size_t pending;
+    };
+
+    // Next file to hash
+    struct Task {
+        std::uint32_t candidate;
+        std::uint32_t set;
+        bool full;
+    };
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    std::filesystem::path m_root;
+    Options m_options;
+    std::thread m_thread;                      // Walks, then runs the hash workers
+    std::atomic<bool> m_cancel{false};
+    std::chrono::steady_clock::time_point m_startTime;
+
+    std::vector<Candidate> m_candidates;       // Sorted by size, largest first
+    std::deque<Set> m_sets;                    // Size groups, then partial-hash groups
+    std::vector<Task> m_partialTasks;          // In size order
+    std::size_t m_nextPartial = 0;
+    std::deque<Task> m_fullTasks;              // Taken before partial tasks
+    int m_active = 0;                          // Workers hashing a file
+
+    std::mutex m_readMutex;                    // Limits the reads in flight
+    std::condition_variable m_readCv;
+    int m_freeReads = 0;
+
+    mutable std::mutex m_mutex;                // Guards the fields below and the tasks and sets above
+    std::condition_variable m_workCv;
+    std::vector<Group> m_pending;              // Groups not yet taken by Poll()
+    Stats m_stats;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Search thread: walk, group by size, hash
+    void Run();
+
+    // Walk the tree and keep the files that share a size
+    void Walk();
+
+    // Hash worker: take tasks until none are left
+    void WorkerLoop();
+
+    // Hash one file (both ends or whole)
+    // @param buffer Reusable read buffer of the calling worker
+    // @return Bytes read
+    std::uint64_t HashFile(Candidate& candidate, bool full, std::vector<char>& buffer);
+
+    // Split a finished set into smaller sets or groups (m_mutex held)
+    void Resolve(std::uint32_t set);
+
+    // Report files with the same hash as a group (m_mutex held)
+    void Emit(std::vector<std::uint32_t>& members);
+
+    // Wait for a read slot
+    void AcquireRead();
+
+    // Give back a read slot
+    void ReleaseRead();
+};
@@ -0,0 +1,110 @@
+// DuplicatePanel.hpp
+// "Find Duplicates" window for FileMgr
+//
+// Runs a DuplicateFinder on the current folder and lists the groups of
+// identical files as they are found, largest reclaimable space first. Each
+// group is a tree row ("3 copies of 12.4 MB") that expands to its files;
+// the rows are drawn through ImGuiListClipper, so only the visible ones are
+// submitted however many groups there are. While the search runs the list
+// is re-sorted a few times per second, not every frame.
+//
+// Double-clicking a file opens it; its context menu opens the containing
+// folder in the file list. Nothing is deleted from this window.
+//
+// "Deduplicate..." hands the groups to a Deduplicator, which keeps the first
+// file of each group and makes the others share its storage: as reflink
+// clones, or as hard links if the user chooses them and confirms that the
+// copies will then share edits. The work runs in the background; the window
+// shows the progress, the bytes reclaimed and the files that were skipped.
+//
+#pragma once
+
+#include <imgui.h>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Deduplicator.hpp"
+#include "DuplicateFinder.hpp"
+
+// -----------------------------------------------------------------------------
+// DuplicatePanel class
+// -----------------------------------------------------------------------------
+class DuplicatePanel {
+public:
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Show the window for a folder (a running search keeps its folder)
+    // @param root Folder whose subtree the next search covers
+    void Open(const std::filesystem::path& root);
+
+    // Draw the window (does nothing while it is closed)
+    void Draw();
+
+    // Set callback for opening a file
+    // @param callback Function called with the full path of the file
+    void SetOnOpen(std::function<void(const std::filesystem::path&)> callback) {
+        m_onOpen = callback;
+    }
+
+    // Set callback for showing a folder in the file list
+    // @param callback Function called with the full path of the folder
+    void SetOnNavigate(std::function<void(const std::filesystem::path&)> callback) {
+        m_onNavigate = callback;
+    }
+
+private:
+    // One row of the list: a group header or one of its files
+    struct Row {
+        std::uint32_t group;
+        std::int32_t file;                     // -1 for the group header
+    };
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    DuplicateFinder m_finder;
+    std::vector<DuplicateFinder::Group> m_groups;  // In the order they were found
+    std::vector<char> m_collapsed;             // Per group
+    std::vector<Row> m_rows;                   // Visible rows, largest reclaimable first
+    bool m_rowsDirty = false;
+    std::chrono::steady_clock::time_point m_rowsTime;  // Last rebuild of m_rows
+    std::filesystem::path m_root;              // Folder of the next search
+    std::string m_rootLabel;                   // m_root as UTF-8 (for drawing)
+    std::filesystem::path m_searchRoot;        // Folder the groups belong to
+    int m_minSize = 1;                         // Index into the minimum size choices
+    int m_threads = 0;                         // 0 until the window is first opened
+    int m_reads = 0;
+    Row m_selected{ ~0u, -1 };                 // Selected file (kept across rebuilds)
+    Deduplicator m_deduplicator;
+    std::vector<Deduplicator::Problem> m_problems;  // Files the last dedupe skipped
+    int m_dedupeMethod = 0;                    // 0 = clones, 1 = hard links
+    bool m_hardLinkConsent = false;            // Hard links confirmed in the dialog
+    bool m_open = false;
+    std::function<void(const std::filesystem::path&)> m_onOpen;
+    std::function<void(const std::filesystem::path&)> m_onNavigate;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Start a search of m_root
+    void StartSearch();
+
+    // Deduplicate the groups found by the last search
+    void StartDedupe();
+
+    // Draw the "Deduplicate..." button, its dialog and the progress line
+    void DrawDedupe(const DuplicateFinder::Stats& stats);
+
+    // Sort the groups and rebuild the visible rows
+    void RebuildRows();
+
+    // Draw the list of groups
+    void DrawGroups();
+};
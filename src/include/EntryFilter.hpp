@@ -0,0 +1,138 @@
+// EntryFilter.hpp
+// Type-ahead name filter for the file list
+//
+// Keeps a lowercase copy of every name of the current listing in one
+// buffer (names separated by '\0') and matches a pattern against it:
+// substring and glob patterns are found with a single SSE2 scan over the
+// whole buffer (first and last needle byte compared 16 positions at a time),
+// prefixes with one comparison per name. A glob is pre-filtered by its
+// longest literal run before the full match runs on the candidates.
+//
+// While the user only types more characters (the new pattern contains the
+// old one, or extends the old prefix), only the previous matches are
+// re-checked. Case folding covers ASCII; other characters match exactly.
+//
+// The buffer is built lazily from DisplayStrings when the filter box gets
+// focus (or the first pattern is set), and extended as scanned entries
+// arrive, like DisplayStrings.
+//
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DisplayStrings.hpp"
+#include "EntryStore.hpp"
+
+// How a filter pattern is matched against names
+enum class FilterMode {
+    Substring,      // Name contains the pattern
+    Prefix,         // Name starts with the pattern
+    Glob            // Whole name matches (* any run, ? one character)
+};
+
+// -----------------------------------------------------------------------------
+// EntryFilter class
+// -----------------------------------------------------------------------------
+class EntryFilter {
+public:
+    using Index = EntryStore::Index;
+
+    // Cost of the last pattern change
+    struct Stats {
+        std::size_t checked = 0;                       // Names examined (0 for a full buffer scan)
+        std::size_t matches = 0;                       // Names matching the pattern
+        bool narrowed = false;                         // Only previous matches were re-checked
+        std::chrono::microseconds time{ 0 };           // Time to compute the matches
+    };
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Drop all names and matches (call whenever the EntryStore is replaced);
+    // the pattern is kept and applied to the names added by Update()
+    void Clear();
+
+    // Add the rows formatted since the last call and match them
+    // @param display Formatted rows of the listing (storage indices)
+    // @return True if matches were added
+    bool Update(const DisplayStrings& display);
+
+    // Build the name buffer ahead of the first keystroke (e.g. when the
+    // filter box gets focus)
+    // @param display Formatted rows of the listing
+    void Prepare(const DisplayStrings& display);
+
+    // Set the pattern and recompute the matches
+    // @param pattern UTF-8 pattern (empty disables the filter)
+    // @param mode    How the pattern is matched
+    // @param display Formatted rows of the listing
+    void SetPattern(const std::string& pattern, FilterMode mode, const DisplayStrings& display);
+
+    // Check whether a pattern is set
+    bool IsActive() const { return !m_pattern.empty(); }
+
+    // Check whether an entry matches the pattern
+    bool Matches(Index i) const { return i < m_match.size() && m_match[i]; }
+
+    // Number of matching entries
+    std::size_t GetMatchCount() const { return m_matches.size(); }
+
+    // Counter that changes whenever the set of matches changes
+    std::uint64_t GetGeneration() const { return m_generation; }
+
+    // Get the cost of the last pattern change
+    const Stats& GetLastStats() const { return m_stats; }
+
+    // Approximate heap memory used
+    std::size_t GetMemoryBytes() const;
+
+    // Pick the mode for typed text: wildcards make a glob
+    // @param pattern Typed text
+    // @param typed   Mode chosen for plain text
+    static FilterMode DetectMode(const std::string& pattern, FilterMode typed);
+
+    // Match a glob against a lowercase name
+    // @param glob Lowercase pattern (* any run, ? one UTF-8 character)
+    // @param name Name to test
+    // @param size Bytes in name
+    static bool GlobMatch(const std::string& glob, const char* name, std::size_t size);
+
+private:
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    std::vector<char> m_text;                  // Lowercase names, each followed by '\0'
+    std::vector<std::uint32_t> m_offsets;      // Start of each name in m_text, plus the end
+    std::vector<std::uint8_t> m_match;         // Per storage index: name matches
+    std::vector<Index> m_matches;              // Matching storage indices, ascending
+    std::string m_pattern;                     // Lowercase pattern
+    std::string m_literal;                     // Longest literal run of a glob (pre-filter)
+    FilterMode m_mode = FilterMode::Substring;
+    std::uint64_t m_generation = 0;
+    Stats m_stats;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Append lowercase names for rows [Size(), display.Size())
+    void AppendNames(const DisplayStrings& display);
+
+    // Number of indexed names
+    std::size_t Size() const { return m_offsets.empty() ? 0 : m_offsets.size() - 1; }
+
+    // Match rows [first, Size()) and append them to the matches
+    // @return Number of matches added
+    std::size_t MatchRange(Index first);
+
+    // Check one name against the pattern
+    bool MatchRow(Index i) const;
+
+    // Find a needle in m_text[pos, stop)
+    // @return Position of the first occurrence, or stop if there is none
+    std::size_t Find(const std::string& needle, std::size_t pos, std::size_t stop) const;
+};
@@ -0,0 +1,286 @@
+// EntrySorter.hpp
+// Multi-column sort engine for the file list
+//
+// Sorting works on precomputed keys (SortKeys) instead of comparing names:
+// every name gets a case-insensitive, natural-order collation key ("file9"
+// before "file10") plus a 64-bit prefix that settles most comparisons
+// without touching the key arena. Size and date are copied into packed
+// integer columns.
+//
+// A sort is a sequence of stable passes from the least to the most
+// significant key: integer columns use an LSD radix sort, text columns a
+// stable merge sort, and a final stable partition puts folders first. Large
+// inputs are split across threads. The same order is available as a
+// comparator (Less) for partial_sort and for merging newly scanned entries.
+//
+// EntrySorter also owns a worker thread so that re-sorting a large listing
+// never blocks a frame. The worker publishes the sorted top window first
+// (partial_sort) and the complete order afterwards.
+//
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "EntryStore.hpp"
+
+// -----------------------------------------------------------------------------
+// Sort specification
+// -----------------------------------------------------------------------------
+enum class SortColumn {
+    Name,       // Natural order, case-insensitive
+    Type,       // Extension (case-insensitive), folders have none
+    Size,       // File size in bytes (recursive size for folders once computed)
+    Date        // Last modification time
+};
+
+struct SortKey {
+    SortColumn column;
+    bool descending;
+};
+
+inline bool operator==(const SortKey& a, const SortKey& b) {
+    return a.column == b.column && a.descending == b.descending;
+}
+
+// Keys in priority order (folders always come first)
+using SortSpec = std::vector<SortKey>;
+
+// -----------------------------------------------------------------------------
+// SortKeys - precomputed collation keys, indexed by EntryStore storage index
+// -----------------------------------------------------------------------------
+class SortKeys {
+public:
+    using Char = EntryStore::Char;
+    using Index = EntryStore::Index;
+
+    // Number of entries with keys
+    std::size_t Size() const { return m_sizes.size(); }
+
+    // Remove all keys
+    void Clear();
+
+    // Compute keys for the entries appended to the store since the last call
+    // @param entries Store the keys belong to
+    void Append(const EntryStore& entries);
+
+    // Rebuild the keys for a new listing, copying the keys of unchanged entries
+    // @param reuse   New index -> index in the current keys (kNoIndex: compute)
+    // @param entries New listing
+    void Remap(const std::vector<Index>& reuse, const EntryStore& entries);
+
+    // Three-way comparisons of two entries (<0, 0, >0)
+    int CompareName(Index a, Index b) const;
+    int CompareType(Index a, Index b) const;
+
+    bool IsDirectory(Index i) const { return m_flags[i] != 0; }
+    std::uint64_t GetSize(Index i) const { return m_sizes[i]; }
+    std::int64_t GetTime(Index i) const { return m_times[i]; }
+
+    // Replace the size key of an entry (recursive folder sizes)
+    void SetSize(Index i, std::uint64_t size) { m_sizes[i] = size; }
+
+    // Build the natural-order collation key of a name
+    // Letters are case-folded; each run of digits becomes a marker, the
+    // number of significant digits and the digits, so numbers compare by
+    // value. Keys compare with plain lexicographic order.
+    // @param name Name to encode
+    // @param out  Receives the key (appended)
+    static void AppendNameKey(EntryStore::NameView name, std::vector<Char>& out);
+
+    // Approximate heap memory used
+    std::size_t GetMemoryBytes() const;
+
+private:
+    // A key stored in m_chars with a packed prefix for fast comparison
+    struct TextKey {
+        std::uint64_t prefix;       // First characters, big-endian, zero padded
+        std::uint32_t offset;       // Start in m_chars
+        std::uint16_t length;       // Characters
+    };
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    std::vector<Char> m_chars;                 // Key arena (names and extensions)
+    std::vector<TextKey> m_names;              // Name collation keys
+    std::vector<TextKey> m_types;              // Case-folded extensions
+    std::vector<std::uint64_t> m_sizes;        // Size column
+    std::vector<std::int64_t> m_times;         // Date column (system_clock ticks)
+    std::vector<std::uint8_t> m_flags;         // 1 for directories
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Grow all columns for the entries of a store (geometric)
+    void ReserveFor(const EntryStore& entries);
+
+    // Compute and append the keys of one entry
+    void AppendEntry(const EntryStore& entries, Index index);
+
+    // Append a copy of another key set's entry
+    void CopyEntry(const SortKeys& from, Index index);
+
+    // Store the characters appended to m_chars since start as one key
+    TextKey MakeKey(std::size_t start) const;
+
+    // Compare two stored keys
+    int CompareKeys(const TextKey& a, const TextKey& b) const;
+};
+
+// -----------------------------------------------------------------------------
+// EntrySorter class
+// -----------------------------------------------------------------------------
+class EntrySorter {
+public:
+    using Index = EntryStore::Index;
+
+    // Order produced by the worker
+    struct Result {
+        std::uint64_t generation = 0;      // Start() call this belongs to
+        std::vector<Index> order;          // Permutation of [0, count)
+        bool complete = false;             // False: only the first topCount rows are sorted
+    };
+
+    // Timing of the most recent background sort
+    struct Stats {
+        std::size_t entryCount = 0;
+        int threads = 0;
+        std::chrono::microseconds partialTime{0};   // Time to the sorted top window (0 if skipped)
+        std::chrono::microseconds totalTime{0};     // Time to the complete order
+        bool cancelled = false;
+    };
+
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    // Constructor - starts the worker thread
+    EntrySorter();
+
+    // Destructor - cancels the current job and joins the worker
+    ~EntrySorter();
+
+    EntrySorter(const EntrySorter&) = delete;
+    EntrySorter& operator=(const EntrySorter&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API (background)
+    // -------------------------------------------------------------------------
+
+    // Sort all entries that have keys on the worker thread
+    // @param keys     Keys to sort (not modified while the job holds them)
+    // @param spec     Sort specification
+    // @param topCount Rows to deliver early with partial_sort (0 = no partial result)
+    // @return Generation token of the job
+    std::uint64_t Start(std::shared_ptr<const SortKeys> keys, SortSpec spec, std::size_t topCount);
+
+    // Abandon the current job
+    void Cancel();
+
+    // Take the newest result of the current job, if any
+    // @param out Receives the result
+    // @return True if a result was taken
+    bool Poll(Result& out);
+
+    // Get timing of the most recent job
+    Stats GetLastStats() const;
+
+    // -------------------------------------------------------------------------
+    // Sorting algorithms (usable on any thread)
+    // -------------------------------------------------------------------------
+
+    // Full comparator equivalent to Sort()
+    static bool Less(const SortKeys& keys, const SortSpec& spec, Index a, Index b);
+
+    // Sort all entries that have keys
+    // @param keys    Keys
+    // @param spec    Sort specification
+    // @param order   Receives the permutation
+    // @param threads Worker threads to use for large inputs
+    // @param cancel  Optional flag checked between passes
+    // @return False if cancelled
+    static bool Sort(const SortKeys& keys, const SortSpec& spec, std::vector<Index>& order,
+                     int threads = 1, const std::atomic<bool>* cancel = nullptr);
+
+    // Sort the appended tail [firstNew, size) and merge it into the sorted prefix
+    static void MergeAppended(const SortKeys& keys, const SortSpec& spec,
+                              std::vector<Index>& order, std::size_t firstNew);
+
+    // Insert a few entries into a sorted order (binary search per entry)
+    // @param order Sorted order, receives the result
+    // @param items Indices to insert (not yet in order)
+    static void InsertSorted(const SortKeys& keys, const SortSpec& spec,
+                             std::vector<Index>& order, std::vector<Index> items);
+
+    // Threads used for large sorts on this machine
+    static int DefaultThreadCount();
+
+    // Split [0, count) into equal ranges and run fn(thread, begin, end) on
+    // each, the first range on the calling thread
+    // @param threads Ranges (and threads); 1 or less runs fn(0, 0, count) here
+    // @param count   Number of items
+    // @param fn      Called once per range with the thread number and range
+    template <typename Fn>
+    static void ParallelFor(int threads, std::size_t count, Fn fn) {
+        if (threads <= 1) {
+            fn(0, (std::size_t)0, count);
+            return;
+        }
+        std::vector<std::thread> pool;
+        std::size_t chunk = (count + threads - 1) / threads;
+        for (int t = 1; t < threads; ++t) {
+            std::size_t b = std::min(count, t * chunk), e = std::min(count, b + chunk);
+            pool.emplace_back([=, &fn] { fn(t, b, e); });
+        }
+        fn(0, (std::size_t)0, std::min(count, chunk));
+        for (auto& th : pool)
+            th.join();
+    }
+
+private:
+    // -------------------------------------------------------------------------
+    // Internal structures
+    // -------------------------------------------------------------------------
+
+    struct Job {
+        std::uint64_t generation = 0;
+        std::shared_ptr<const SortKeys> keys;
+        SortSpec spec;
+        std::size_t topCount = 0;
+    };
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    std::thread m_worker;                      // Background sort thread
+    mutable std::mutex m_mutex;                // Guards everything below
+    std::condition_variable m_wakeCv;          // Signals the worker
+    bool m_stop;                               // Shutdown flag
+    bool m_hasJob;                             // A job is waiting in m_job
+    Job m_job;                                 // Next job
+    std::uint64_t m_generation;                // Latest Start() token
+    std::atomic<bool> m_cancel;                // Set when the running job is superseded
+    bool m_hasResult;                          // m_result holds an untaken result
+    Result m_result;                           // Newest result
+    Stats m_stats;                             // Timing of the last job
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Worker thread main loop
+    void WorkerLoop();
+
+    // Publish a result unless the job was superseded
+    void Publish(std::uint64_t generation, std::vector<Index> order, bool complete);
+};
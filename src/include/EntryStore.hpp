@@ -0,0 +1,110 @@
+// EntryStore.hpp
+// Columnar storage for the entries of one directory
+//
+// Stores a directory listing as a struct of arrays: all names live in one
+// character arena (offset + length per entry), while size, modification time
+// and flags are packed into parallel arrays. There is no per-entry heap
+// allocation and nothing repeats the parent directory, so a listing with
+// millions of entries costs a few tens of bytes per entry plus its names.
+//
+// Entries are addressed by their storage index (the order they were added).
+// The display order is a separate permutation of indices, so sorting and
+// filtering move 4-byte indices instead of entries.
+//
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <string_view>
+#include <vector>
+#include "DirEnumerator.hpp"
+
+// -----------------------------------------------------------------------------
+// EntryStore class
+// -----------------------------------------------------------------------------
+class EntryStore {
+public:
+    using Char = std::filesystem::path::value_type;
+    using NameView = std::basic_string_view<Char>;
+    using Index = std::uint32_t;
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    // Placeholder for "no entry" in index mappings
+    static constexpr Index kNoIndex = std::numeric_limits<Index>::max();
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Number of entries
+    std::size_t Size() const { return m_sizes.size(); }
+
+    // Check whether the store is empty
+    bool Empty() const { return m_sizes.empty(); }
+
+    // Remove all entries (keeps capacity)
+    void Clear();
+
+    // Reserve room for entries and name characters
+    // @param entries   Expected number of entries
+    // @param nameChars Expected total length of all names
+    void Reserve(std::size_t entries, std::size_t nameChars);
+
+    // Release unused capacity
+    void ShrinkToFit();
+
+    // Append an entry (also appended to the display order)
+    // @param name          File name (no parent directory)
+    // @param isDirectory   True for directories
+    // @param size          File size in bytes
+    // @param lastWriteTime Last modification time
+    // @return Storage index of the new entry
+    Index Add(NameView name, bool isDirectory, std::uint64_t size, TimePoint lastWriteTime);
+
+    // Append a chunk delivered by a DirEnumerator
+    // @param chunk Entries to append
+    void Append(const std::vector<ScanEntry>& chunk);
+
+    // Column access by storage index
+    NameView GetName(Index i) const { return NameView(m_names.data() + m_nameOffsets[i], m_nameLengths[i]); }
+    bool IsDirectory(Index i) const { return (m_flags[i] & kFlagDirectory) != 0; }
+    std::uint64_t GetSize(Index i) const { return m_sizes[i]; }
+    TimePoint GetWriteTime(Index i) const { return m_writeTimes[i]; }
+
+    // Display order (permutation of storage indices)
+    const std::vector<Index>& GetOrder() const { return m_order; }
+
+    // Default listing order: directories first, then by name
+    bool Less(Index a, Index b) const;
+
+    // Sort the display order
+    void Sort();
+
+    // Sort the indices appended since firstNew and merge them into the
+    // already sorted prefix of the display order
+    // @param firstNew Number of entries that were already sorted
+    void MergeSorted(std::size_t firstNew);
+
+    // Total length of all names in characters
+    std::size_t GetNameChars() const { return m_names.size(); }
+
+    // Approximate heap memory used (allocated capacity of all columns)
+    std::size_t GetMemoryBytes() const;
+
+private:
+    static constexpr std::uint8_t kFlagDirectory = 1;
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    std::vector<Char> m_names;                 // Name arena (not null-terminated)
+    std::vector<std::uint32_t> m_nameOffsets;  // Start of each name in m_names
+    std::vector<std::uint16_t> m_nameLengths;  // Name length in characters
+    std::vector<std::uint64_t> m_sizes;        // File sizes in bytes
+    std::vector<TimePoint> m_writeTimes;       // Last modification times
+    std::vector<std::uint8_t> m_flags;         // kFlag* bits
+    std::vector<Index> m_order;                // Display order
+};
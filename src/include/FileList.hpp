@@ -1,18 +1,80 @@
 // FileList.hpp
 // Main file list component for FileMgr
 // 
-// Displays files and directories in a table view with columns for name, size,
+// Displays files and directories in a table view with columns for name, type, size,
 // and modification date. Supports navigation history (back/forward), directory
 // refreshing, and file opening via ShellExecute.
 // 
+// Directory contents are read by a background DirScanner and merged into the
+// table batch by batch, so large folders never block the UI thread. Recently
+// visited directories are kept in a SnapshotCache and repainted instantly on
+// revisit, then revalidated in the background. A DirPrefetcher warms that
+// cache with the parent directory and hovered folders. At startup, listings
+// missing from the cache are taken from the persistent ListingStore, so the
+// first frame is drawn without touching the directory.
+// 
+// Entries are kept in a columnar EntryStore (name arena plus packed size,
+// mtime and flag arrays); sorting and drawing work on its index order. Row
+// text (UTF-8 name, size, local date) is formatted once per entry into
+// DisplayStrings and icons are looked up once per row, so drawing does no
+// formatting and no heap allocation. Only the rows inside the visible part
+// of the table are submitted (ImGuiListClipper), so the cost of a frame
+// depends on the window height, not on the folder size.
+// 
+// The filter box above the table narrows the view as the user types
+// (substring, prefix, or glob when the text contains * or ?). Matching runs
+// on EntryFilter's lowercase name buffer and the filtered rows are a subset
+// of the sorted view, so sorting and refreshes keep working underneath.
+// 
+// Clicking a column header sorts by it (shift-click adds secondary keys).
+// Rows are drawn through a separate view order produced by EntrySorter from
+// precomputed keys; large listings are re-sorted on its worker thread while
+// the previous order stays on screen.
+// 
+// Refresh() and background revalidation do not rebuild the table: the fresh
+// listing is diffed against the shown one (ListingDiff), unchanged rows keep
+// their keys and text, changed rows are inserted into the sorted view and
+// briefly highlighted, and the scroll position and selection are kept.
+// 
+// With "Folder sizes" turned on, a DirSizer computes the recursive size of
+// every subfolder once the listing is complete. Sizes appear in the Size
+// column as they grow (dimmed until a folder is finished) and are written
+// into the sort keys, so sorting by size orders folders too. The column
+// shows either the logical size or the size on disk; hovering a folder's
+// size shows both along with its file and folder counts. EntryStore keeps
+// the sizes reported by the directory, so refreshes and snapshots are not
+// affected.
+// 
+// With "Checksums" turned on, a Checksum column shows the XXH64 or SHA-256
+// of each file. Only files whose rows are drawn, and selected files, are
+// hashed, on ChecksumCache's background workers; rows that scroll away
+// before their turn are dropped from the queue. Results are cached by file
+// identity, so refreshes and revisits do not read unchanged files again.
+// Right-clicking a .sha256 or .md5 file offers to verify the files it
+// lists (handled by the owner through SetOnVerifyManifest()).
+// 
+// ShowVirtualListing() replaces the table with entries that do not come from
+// one directory (e.g. name index results): their names are paths relative
+// to a root folder, and the listing stays until the next navigation.
+// 
 #pragma once
 
 #include <imgui.h>
 #include <filesystem>
+#include <string>
 #include <vector>
 #include <functional>
 #include <optional>
 #include "IconCache.hpp"
+#include "DirScanner.hpp"
+#include "SnapshotCache.hpp"
+#include "DirPrefetcher.hpp"
+#include "ListingStore.hpp"
+#include "DisplayStrings.hpp"
+#include "EntrySorter.hpp"
+#include "EntryFilter.hpp"
+#include "DirSizer.hpp"
+#include "ChecksumCache.hpp"
 
 // -----------------------------------------------------------------------------
 // FileList class
@@ -24,8 +86,11 @@ public:
     // -------------------------------------------------------------------------
     
     // Constructor
-    // @param iconCache Pointer to shared icon cache (must outlive this object)
-    explicit FileList(IconCache* iconCache);
+    // @param iconCache Pointer to shared icon cache (must outlive this object);
+    //                  null draws no icons (headless frame benchmark)
+    // @param store     Optional persistent listing cache; its last location is
+    //                  shown first (must outlive this object)
+    explicit FileList(IconCache* iconCache, const ListingStore* store = nullptr);
 
     // -------------------------------------------------------------------------
     // Public API
@@ -42,9 +107,28 @@ public:
     // @return Reference to current path
     const std::filesystem::path& GetCurrentPath() const { return m_currentPath; }
     
-    // Refresh current directory (re-scan files)
+    // Refresh current directory (re-scan files and merge the differences)
+    // While a scan is running the refresh is queued behind it, so a folder
+    // that changes continuously is re-read back to back, never restarted
     void Refresh();
     
+    // Check whether the current directory is still being scanned
+    // @return True while batches are still arriving from the scanner
+    bool IsScanning() const { return m_scanning; }
+    
+    // Number of entries currently shown
+    std::size_t GetEntryCount() const { return m_entries.Size(); }
+    
+    // Check whether a background sort of the listing is still running
+    bool IsSorting() const { return m_sorting; }
+    
+    // Select the directory enumeration backend (takes effect on next scan)
+    // @param backend Backend to use
+    void SetScanBackend(EnumBackend backend) { m_scanner.SetBackend(backend); }
+    
+    // Get the selected directory enumeration backend
+    EnumBackend GetScanBackend() const { return m_scanner.GetBackend(); }
+    
     // Navigate to new directory (adds to history)
     // @param newPath Directory to navigate to
     void NavigateTo(const std::filesystem::path& newPath);
@@ -69,43 +153,229 @@ public:
     // @param path Directory to navigate to (processed during next Draw())
     void RequestNavigation(const std::filesystem::path& path);
     
+    // Open a path from outside the list (e.g. the go-to-file window):
+    // folders are navigated to, files are opened with ShellExecute
+    // @param path Full path to open
+    void OpenPath(const std::filesystem::path& path);
+    
+    // Show entries collected elsewhere instead of a directory listing; the
+    // next navigation (including to the same root) leaves this mode
+    // @param root    Folder the entry names are relative to
+    // @param label   Text shown in place of the path (UTF-8)
+    // @param entries Entries whose names are paths relative to root
+    void ShowVirtualListing(const std::filesystem::path& root, const std::string& label, EntryStore entries);
+    
+    // Check whether a virtual listing is shown
+    bool IsVirtual() const { return !m_virtualLabel.empty(); }
+    
+    // Get the label of the virtual listing (empty if none is shown)
+    const std::string& GetVirtualLabel() const { return m_virtualLabel; }
+    
+    // Set the filter box text as if it had been typed (headless filter benchmark)
+    // @param text UTF-8 filter text (empty shows every entry)
+    // @param mode Substring or Prefix for text without wildcards
+    void SetFilter(const std::string& text, FilterMode mode);
+    
+    // Number of rows the table shows (after the filter)
+    std::size_t GetDisplayedCount() const { return DisplayedRows().size(); }
+    
+    // Time from the last filter change to the updated rows
+    std::chrono::microseconds GetFilterTime() const { return m_filterTime; }
+    
+    // Ask the prefetcher to warm a directory the user may open next
+    // (ignored while the current directory is still being scanned)
+    // @param dir Directory to prefetch
+    void RequestPrefetch(const std::filesystem::path& dir);
+    
+    // Draw scan and cache statistics (for the statistics window)
+    void DrawStats();
+    
+    // Access the directory snapshot cache
+    SnapshotCache& GetSnapshotCache() { return m_snapshots; }
+    
+    // Set callback for verifying a checksum manifest (.sha256 / .md5)
+    // @param callback Function called with the full path of the manifest
+    void SetOnVerifyManifest(std::function<void(const std::filesystem::path&)> callback) {
+        m_onVerifyManifest = callback;
+    }
+    
 private:
     // -------------------------------------------------------------------------
     // Internal structures
     // -------------------------------------------------------------------------
     
-    // File entry for display
-    struct FileEntry {
-        std::filesystem::path path;           // Full path
-        bool isDirectory;                      // True for directories
-        std::uintmax_t size;                   // File size in bytes (0 for directories)
-        std::filesystem::file_time_type lastWriteTime; // Last modification time
+    // Outcome of the most recent incremental refresh
+    struct DiffStats {
+        std::size_t added = 0;
+        std::size_t removed = 0;
+        std::size_t modified = 0;
+        std::chrono::microseconds time{0};     // Diff and merge on the UI thread
     };
-
+    
     // -------------------------------------------------------------------------
     // Member variables
     // -------------------------------------------------------------------------
     
     IconCache* m_iconCache;                    // Shared icon cache
     std::filesystem::path m_currentPath;       // Currently displayed directory
+    std::string m_virtualLabel;                // Label of a virtual listing (empty for a directory)
+    
+    EntryStore m_entries;                      // Files in current directory (full path is m_currentPath / name)
+    DisplayStrings m_display;                  // Preformatted row text for m_entries
+    
+    std::shared_ptr<SortKeys> m_sortKeys;      // Collation keys for m_entries (shared with m_sorter while it runs)
+    std::vector<EntryStore::Index> m_view;     // Display order of m_entries
+    std::uint64_t m_viewGeneration;            // Bumped whenever m_view changes
+    SortSpec m_sortSpec;                       // Current table sort specification
+    EntrySorter m_sorter;                      // Background sort for large listings
+    std::uint64_t m_sortGeneration;            // Generation of the sort feeding m_view
+    bool m_sorting;                            // Waiting for m_sorter's complete order
+    std::size_t m_visibleRows;                 // Rows that fit in the table (last frame)
+    bool m_scrolledToTop;                      // Table was scrolled to the top (last frame)
+    std::chrono::microseconds m_lastSortTime;  // Duration of the last synchronous sort
     
-    std::vector<FileEntry> m_entries;          // Files in current directory
+    std::vector<std::uint8_t> m_rowFlags;      // Selection / change / icon / prefetch bits per storage index
+    std::vector<ImTextureID> m_rowIcons;       // Icon per storage index (valid once flagged as loaded)
+    std::chrono::steady_clock::time_point m_changeTime; // When changed rows were last merged in
+    float m_rowHeight;                         // Measured table row height (last frame)
+    float m_scrollY;                           // Table scroll position (last frame)
+    std::size_t m_drawnRows;                   // Rows submitted by the clipper (last frame)
+    std::chrono::microseconds m_drawTime;      // Time spent submitting rows (last frame)
+    std::optional<float> m_pendingScrollY;     // Scroll position to apply on the next frame
+    DiffStats m_diffStats;                     // Last incremental refresh
+    
+    EntryFilter m_filter;                      // Name matching for the filter box
+    char m_filterText[256];                    // Filter box contents (UTF-8)
+    FilterMode m_filterMode;                   // Substring or Prefix for text without wildcards
+    std::vector<EntryStore::Index> m_filteredView; // Rows of m_view that match the filter
+    std::uint64_t m_filteredViewGeneration;    // m_viewGeneration m_filteredView was built from
+    std::uint64_t m_filteredMatchGeneration;   // Filter generation m_filteredView was built from
+    std::chrono::microseconds m_filterTime;    // Last keystroke to updated rows
     
     std::vector<std::filesystem::path> m_backStack;    // Back navigation history
     std::vector<std::filesystem::path> m_forwardStack; // Forward navigation history
     
     std::optional<std::filesystem::path> m_pendingNavigation; // Deferred navigation request
+    
+    DirScanner m_scanner;                      // Background directory scanner
+    std::uint64_t m_scanGeneration;            // Generation of the scan feeding m_entries
+    bool m_scanning;                           // True until the final batch arrives
+    bool m_revalidating;                       // Showing a cached snapshot while re-checking it
+    bool m_refreshQueued;                      // Refresh() requested while a scan was running
+    EntryStore m_pendingEntries;               // Fresh listing collected during revalidation
+    
+    SnapshotCache m_snapshots;                 // Recently visited directory listings
+    DirPrefetcher m_prefetcher;                // Warms m_snapshots speculatively
+    const ListingStore* m_store;               // Listings persisted by the previous session
+    
+    DirSizer m_sizer;                          // Recursive sizes of the subfolders
+    bool m_folderSizes;                        // Size column shows folder sizes (opt-in)
+    bool m_sizeOnDisk;                         // Show allocated instead of logical sizes
+    std::uint64_t m_entriesGeneration;         // Bumped whenever m_entries is replaced or merged
+    std::uint64_t m_sizedGeneration;           // m_entriesGeneration the sizer was started for
+    std::vector<EntryStore::Index> m_sizedRows;    // Sizer slot -> storage index (ascending)
+    std::vector<DirSizer::Slot> m_sizerSlots;      // Slot progress (last poll)
+    std::vector<std::uint64_t> m_shownSizes;       // Size written to the keys and text per slot
+    std::chrono::steady_clock::time_point m_sizesAppliedTime; // Last time sizes were written
+    bool m_sizesFinal;                         // The finished walk's sizes have been written
+    
+    ChecksumCache m_checksums;                 // Background hashing for the Checksum column
+    bool m_showChecksums;                      // Checksum column shown (opt-in)
+    std::vector<std::uint32_t> m_rowChecksums; // Checksum slot per storage index (0 = not requested)
+    std::uint64_t m_checksumGeneration;        // m_entriesGeneration m_rowChecksums belongs to
+    std::function<void(const std::filesystem::path&)> m_onVerifyManifest;
 
     // -------------------------------------------------------------------------
     // Private methods
     // -------------------------------------------------------------------------
     
+    // Get the full path of an entry in the current directory
+    // @param index Storage index of the entry in m_entries
+    std::filesystem::path EntryPath(EntryStore::Index index) const;
+    
     // Open a file entry (directory navigation or file execution)
-    // @param entry File/directory to open
-    void OpenEntry(const FileEntry& entry);
+    // @param index Storage index of the entry in m_entries
+    void OpenEntry(EntryStore::Index index);
+    
+    // Internal refresh implementation (starts an asynchronous scan)
+    // @param useCache Paint from the snapshot cache first if possible
+    void RefreshImpl(bool useCache = true);
+    
+    // Merge batches delivered by the scanner into m_entries (keeps sort order)
+    void PollScanResults();
+    
+    // Recompute sort keys and the view after m_entries was replaced
+    void RebuildView();
+    
+    // Sort the view with m_sortSpec (synchronously for small listings)
+    void ResortView();
+    
+    // Merge entries appended to m_entries since the view was built
+    void ExtendView();
+    
+    // Take orders delivered by the background sorter
+    void PollSortResults();
+    
+    // Replace m_entries with m_pendingEntries by merging only the differences
+    // (keeps the view order, selection and scroll anchor)
+    void ApplyDiff();
+    
+    // Apply the filter box contents to m_filter and the filtered rows
+    void ApplyFilter();
+    
+    // Rebuild m_filteredView if the view or the matches changed
+    void UpdateFilteredView();
+    
+    // Rows shown in the table (filtered or full view)
+    const std::vector<EntryStore::Index>& DisplayedRows() const {
+        return m_filter.IsActive() ? m_filteredView : m_view;
+    }
+    
+    // Handle a click on a row (Ctrl toggles, otherwise selects only this row)
+    // @param index Storage index of the clicked entry
+    void SelectEntry(EntryStore::Index index);
+    
+    // Look a directory up in the persistent store and move it into the cache
+    // @param dir Directory to look up
+    // @return Unvalidated snapshot or null
+    std::shared_ptr<const DirSnapshot> LoadStoredSnapshot(const std::filesystem::path& dir);
+    
+    // Store the current listing in the snapshot cache
+    // @param dirWriteTime Directory mtime recorded when the scan started
+    void StoreSnapshot(std::chrono::system_clock::time_point dirWriteTime);
+    
+    // Size the subfolders of the current listing
+    // @param useCache Reuse the sizes of folders whose time is unchanged
+    void StartFolderSizes(bool useCache);
+    
+    // Start, poll and apply folder sizes (throttled while the walk runs)
+    void PollFolderSizes();
+    
+    // Write the polled folder sizes into the sort keys and row text
+    // @return True if any size changed
+    bool ApplyFolderSizes();
+    
+    // Stop sizing and restore the sizes reported by the directory
+    void ClearFolderSizes();
+    
+    // Draw the size mode, progress and totals line above the table
+    void DrawFolderSizeBar();
+    
+    // Show both sizes and the counts of a folder in a tooltip
+    // @param index Storage index of a folder
+    void DrawFolderSizeTooltip(EntryStore::Index index);
+    
+    // Forget the checksum slots and request the selected files again
+    void ResetChecksums();
+    
+    // Hash a file even while its row is not visible
+    // @param index Storage index of the entry
+    void PinChecksum(EntryStore::Index index);
     
-    // Internal refresh implementation
-    void RefreshImpl();
+    // Draw the Checksum cell of a file row (requests it on first sight)
+    // @param index      Storage index of the entry
+    // @param rowHovered The row is hovered (shows the full checksum)
+    void DrawChecksumCell(EntryStore::Index index, bool rowHovered);
     
     // Set current path without modifying history
     // @param newPath Directory to set as current
@@ -0,0 +1,37 @@
+// FuzzyBenchmark.hpp
+// Fuzzy finder benchmark for FileMgr (--fuzzy-benchmark)
+//
+// Generates a million synthetic relative paths in memory (nested source,
+// asset and build folders with mixed-case file names), feeds them to a
+// FuzzyFinder headless and reports the ingest time and the memory of the
+// candidate buffer. Then types a fixed set of queries one character at a
+// time and reports the latency of every keystroke (query change to
+// published ranking), how many paths were scored and whether only the
+// previous matches were re-ranked. One known path is planted among the
+// candidates; the benchmark fails if its query does not rank it first.
+//
+#pragma once
+
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// FuzzyBenchmark class
+// -----------------------------------------------------------------------------
+class FuzzyBenchmark {
+public:
+    // Candidate parameters
+    struct Options {
+        int paths = 1000000;               // Synthetic candidate paths
+    };
+
+    // Run the benchmark and log the results
+    // @param options Candidate parameters
+    // @return Process exit code (0 on success)
+    static int Run(const Options& options);
+
+private:
+    // Build the synthetic paths (the same every run)
+    // @param count Number of paths
+    static std::vector<std::string> Generate(int count);
+};
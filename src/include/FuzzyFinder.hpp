@@ -0,0 +1,204 @@
+// FuzzyFinder.hpp
+// Fuzzy "go to file" search over a directory subtree for FileMgr
+//
+// A walker thread lists the subtree below a root folder breadth-first and
+// streams the relative paths of its files to a ranking thread. The ranking
+// thread owns the candidate paths (one buffer, '\0' separated) and scores
+// them against the query with an fzf-style function: the query characters
+// must appear in order; matches at word starts (after a separator, '_', '-',
+// '.', a space or a lower-to-upper case change) and runs of consecutive
+// characters score higher, gaps cost a little, and a match inside the file
+// name beats one spread over the folders. Scoring is split across threads.
+//
+// While the user only appends characters, the new matches are a subset of
+// the old ones and only those are scored again; paths streamed in after a
+// query was ranked are scored on their own and merged into the result. The
+// UI thread only ever sees the published top matches (copied strings), so
+// the candidate buffer needs no locking.
+//
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// FuzzyFinder class
+// -----------------------------------------------------------------------------
+class FuzzyFinder {
+public:
+    // One ranked path
+    struct Match {
+        std::string path;                  // UTF-8 path relative to the root
+        int score = 0;                     // Higher is better
+    };
+
+    // Ranking published to the UI
+    struct Result {
+        std::uint64_t generation = 0;      // Changes with every new result
+        std::string query;                 // Query the matches belong to
+        std::vector<Match> matches;        // Best matches, best first
+        std::size_t matchCount = 0;        // All candidates matching the query
+        std::size_t candidates = 0;        // Paths found so far
+        bool walking = false;              // The walk is still running
+    };
+
+    // Cost of the most recent ranking
+    struct Stats {
+        std::size_t candidates = 0;        // Paths found by the walk
+        std::size_t directories = 0;       // Folders listed by the walk
+        std::size_t scored = 0;            // Paths scored for the last query change
+        bool narrowed = false;             // Only the previous matches were scored
+        int threads = 0;                   // Threads used for scoring
+        std::chrono::microseconds queryTime{0};    // Time to rank the last query change
+        std::chrono::microseconds walkTime{0};     // Duration of the walk (so far)
+        std::size_t memoryBytes = 0;       // Candidate buffer and match lists
+    };
+
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    // Constructor - starts the walker and ranking threads
+    FuzzyFinder();
+
+    // Destructor - stops the walk and joins both threads
+    ~FuzzyFinder();
+
+    FuzzyFinder(const FuzzyFinder&) = delete;
+    FuzzyFinder& operator=(const FuzzyFinder&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Walk a new subtree (drops all candidates; the query is kept)
+    // @param root Folder to search below
+    void SetRoot(const std::filesystem::path& root);
+
+    // Get the folder being searched
+    const std::filesystem::path& GetRoot() const { return m_root; }
+
+    // Rank the candidates against a new query
+    // @param query UTF-8 query (case-insensitive for ASCII; empty matches nothing)
+    void SetQuery(const std::string& query);
+
+    // Take the newest ranking, if one was published since the last call
+    // @param out Receives the result
+    // @return True if a result was taken
+    bool Poll(Result& out);
+
+    // Get the cost of the most recent ranking
+    Stats GetLastStats() const;
+
+    // -------------------------------------------------------------------------
+    // Headless use (any thread)
+    // -------------------------------------------------------------------------
+
+    // Add candidate paths directly, as if the walk had found them
+    // @param paths UTF-8 relative paths
+    void AddCandidates(std::vector<std::string> paths);
+
+    // Block until every queued query and candidate has been ranked
+    void WaitIdle();
+
+    // Score one path against a lowercase query
+    // @param query Lowercase query
+    // @param path  Path to score
+    // @param size  Bytes in path
+    // @param nameStart Offset of the file name within path
+    // @return Score, or -1 if the path does not contain the query
+    static int Score(const std::string& query, const char* path, std::size_t size, std::size_t nameStart);
+
+    // Maximum number of matches published
+    static constexpr std::size_t kMaxResults = 100;
+
+private:
+    // A scored candidate
+    struct Hit {
+        std::uint32_t index;
+        int score;
+    };
+
+    // -------------------------------------------------------------------------
+    // Member variables (UI thread)
+    // -------------------------------------------------------------------------
+
+    std::filesystem::path m_root;
+
+    // -------------------------------------------------------------------------
+    // Member variables (shared, guarded by m_mutex)
+    // -------------------------------------------------------------------------
+
+    std::thread m_walker;
+    std::thread m_ranker;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_walkCv;          // Wakes the walker
+    std::condition_variable m_rankCv;          // Wakes the ranker
+    std::condition_variable m_idleCv;          // Signals WaitIdle()
+    bool m_stop;
+    bool m_hasRoot;                            // A new root waits for the walker
+    std::filesystem::path m_walkRoot;
+    std::atomic<std::uint64_t> m_walkGeneration;   // Bumped by SetRoot() to cancel the walk
+    std::uint64_t m_rankedWalk;                // Walk generation the candidates belong to
+    std::vector<std::string> m_incoming;       // Paths found but not yet ranked
+    std::string m_query;                       // Newest query
+    std::uint64_t m_queryGeneration;           // Bumped by SetQuery()
+    std::uint64_t m_rankedQuery;               // Query generation of the last ranking
+    std::atomic<bool> m_cancel;                // A newer query or root makes the ranking pointless
+    bool m_walking;
+    bool m_walkEnded;                          // The walk finished since the last ranking
+    bool m_busy;                               // The ranker is working
+    std::uint64_t m_resultGeneration;
+    Result m_result;
+    bool m_hasResult;
+    Stats m_stats;
+
+    // -------------------------------------------------------------------------
+    // Member variables (ranking thread only)
+    // -------------------------------------------------------------------------
+
+    std::vector<char> m_text;                  // Candidate paths, each followed by '\0'
+    std::vector<std::uint32_t> m_offsets;      // Start of each path in m_text, plus the end
+    std::vector<std::uint16_t> m_nameStarts;   // Offset of the file name in each path
+    std::vector<std::uint64_t> m_masks;        // Characters present in each path (one bit per class)
+    std::vector<Hit> m_hits;                   // Candidates matching m_ranked
+    std::string m_ranked;                      // Lowercase query m_hits belongs to
+    int m_threads;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Walker thread: list the subtree of each new root
+    void WalkLoop();
+
+    // Walk one subtree, streaming file paths to the ranker
+    void Walk(const std::filesystem::path& root, std::uint64_t generation);
+
+    // Ranking thread: merge new paths and re-rank on query changes
+    void RankLoop();
+
+    // Append paths to the candidate buffer
+    void AppendCandidates(const std::vector<std::string>& paths);
+
+    // Score candidates [first, Count()) in parallel and append the matches
+    // @return False if the work was cancelled
+    bool ScoreRange(std::size_t first, const std::string& query, std::vector<Hit>& out);
+
+    // Score the previous hits again in parallel (the query was extended)
+    // @return False if the work was cancelled
+    bool ScoreHits(const std::string& query, std::vector<Hit>& out);
+
+    // Copy the best hits into a result and publish it
+    void Publish(std::uint64_t walkGeneration, const std::string& query, bool walking);
+
+    // Number of candidates
+    std::size_t Count() const { return m_offsets.empty() ? 0 : m_offsets.size() - 1; }
+};
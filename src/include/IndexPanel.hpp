@@ -0,0 +1,98 @@
+// IndexPanel.hpp
+// "Name Index" window for FileMgr
+//
+// Builds (or loads) the whole-volume NameIndex and searches it as the user
+// types: every keystroke runs a query on the UI thread and shows the match
+// count, the query time and the first matching paths. Enter or "Show in
+// file list" turns the matches into a virtual listing of the file list, so
+// they can be sorted, filtered and opened like a folder. The index state
+// (size, bytes per entry, build time, live update backend) is shown above
+// the query box and in the statistics window.
+//
+#pragma once
+
+#include <imgui.h>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+#include "NameIndex.hpp"
+
+// -----------------------------------------------------------------------------
+// IndexPanel class
+// -----------------------------------------------------------------------------
+class IndexPanel {
+public:
+    // Receives the matches to show in the file list
+    using ShowCallback = std::function<void(const std::filesystem::path& root, const std::string& label,
+                                            EntryStore entries)>;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Load the index saved by a previous session (in the background)
+    void LoadSaved();
+
+    // Save the index if live updates changed it
+    void SaveIfChanged();
+
+    // Show the window
+    // @param current Folder the "index this folder / drive" buttons refer to
+    void Open(const std::filesystem::path& current);
+
+    // Draw the window (does nothing while it is closed)
+    void Draw();
+
+    // Draw index and query statistics (for the statistics window)
+    void DrawStats();
+
+    // Set callback for showing matches in the file list
+    void SetOnShow(ShowCallback callback) { m_onShow = callback; }
+
+    // Set callback for opening a match
+    // @param callback Function called with the full path of the entry
+    void SetOnOpen(std::function<void(const std::filesystem::path&)> callback) {
+        m_onOpen = callback;
+    }
+
+    // Maximum number of matches put into the file list
+    static constexpr std::size_t kMaxShown = 100000;
+
+    // Number of matching paths listed in the window
+    static constexpr std::size_t kMaxPreview = 200;
+
+private:
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    NameIndex m_index;
+    std::filesystem::path m_current;           // Folder the window was opened on
+    std::filesystem::path m_root;              // Root of the index
+    std::string m_rootLabel;                   // m_root as UTF-8 (for drawing)
+    std::string m_buildLabel;                  // Folder being indexed as UTF-8
+    char m_query[256] = "";
+    int m_mode = 0;                            // 0: contains, 1: starts with
+    std::vector<std::string> m_preview;        // First matches as relative UTF-8 paths
+    std::uint64_t m_seenGeneration = 0;        // Index generation m_root and the matches belong to
+    std::uint64_t m_seenUpdates = 0;           // Live updates reflected in the matches
+    int m_selected = -1;
+    bool m_open = false;
+    bool m_focusQuery = false;
+    ShowCallback m_onShow;
+    std::function<void(const std::filesystem::path&)> m_onOpen;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Run the query and refresh the preview
+    void RunQuery();
+
+    // Put the current matches into the file list
+    void ShowInList();
+
+    // Start building the index for a folder
+    void StartBuild(const std::filesystem::path& root);
+};
@@ -0,0 +1,64 @@
+// ListBenchmark.hpp
+// File list benchmarks for FileMgr (--memory-benchmark, --frame-benchmark,
+// --filter-benchmark)
+//
+// Work on a synthetic listing held in memory, so nothing is written to disk.
+//
+// RunMemory builds the same listing of a million entries three ways and
+// reports the heap bytes per entry of each: the FileEntry vector FileList
+// used to keep (a full path per entry), a vector of ScanEntry (the scanner's
+// transport format) and EntryStore (columns and one name arena). Bytes are
+// the ones requested from operator new on this thread (AllocCounter), with
+// the vectors reserved up front so growth does not count.
+//
+// RunFrames builds frames headless (an ImGui context without a window or
+// renderer) with a real FileList showing 10, 10k and 1M entries, and
+// reports the microseconds per frame and the heap allocations per frame
+// once the listing is formatted and sorted. With only the visible rows
+// submitted, the 1M-entry frames must cost about the same as the 10k ones;
+// the run fails if they cost more than twice as much.
+//
+// RunFilter types into the filter box of a headless FileList showing a
+// million entries, one character at a time and then back to empty, with
+// substring, prefix and glob patterns. Each keystroke is timed from the new
+// text to the updated rows (matching plus the filtered view) and must fit
+// in one frame at 60 Hz; the run fails if any does not.
+//
+#pragma once
+
+#include <cstddef>
+
+class EntryStore;
+
+// -----------------------------------------------------------------------------
+// ListBenchmark class
+// -----------------------------------------------------------------------------
+class ListBenchmark {
+public:
+    // Listing parameters
+    struct Options {
+        int entries = 1000000;             // Entries in the synthetic listing
+        int frames = 300;                  // Frames timed per listing (RunFrames)
+    };
+
+    // Compare the memory used per entry by the listing layouts
+    // @param options Listing parameters
+    // @return Process exit code (0 on success)
+    static int RunMemory(const Options& options);
+
+    // Time headless frames of a FileList with 10, 10k and options.entries entries
+    // @param options Listing parameters
+    // @return Process exit code (0 on success)
+    static int RunFrames(const Options& options);
+
+    // Time filter box keystrokes on a listing of options.entries entries
+    // @param options Listing parameters
+    // @return Process exit code (0 if every keystroke fits in one frame)
+    static int RunFilter(const Options& options);
+
+private:
+    // Fill a store with the synthetic listing (the same every run)
+    // @param store   Receives the entries (cleared first)
+    // @param entries Number of entries
+    static void Generate(EntryStore& store, int entries);
+};
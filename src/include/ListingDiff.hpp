@@ -0,0 +1,42 @@
+// ListingDiff.hpp
+// Differences between two listings of the same directory
+//
+// Matches the entries of an old and a new EntryStore by name with a single
+// merge over their default orders (both are kept sorted by EntryStore::Less),
+// so no hashing or sorting is needed. The result maps storage indices in both
+// directions and lists the entries that were added or modified; everything
+// derived from the old listing (sort keys, row text, selection, the sorted
+// view) can then be carried over instead of being rebuilt.
+//
+// An entry that turned from a file into a folder (or back) counts as removed
+// and added.
+//
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "EntryStore.hpp"
+
+// -----------------------------------------------------------------------------
+// ListingDiff
+// -----------------------------------------------------------------------------
+struct ListingDiff {
+    using Index = EntryStore::Index;
+
+    std::vector<Index> previous;   // New index -> old index with the same name (kNoIndex: added)
+    std::vector<Index> reuse;      // New index -> old index if unchanged (kNoIndex: added or modified)
+    std::vector<Index> current;    // Old index -> new index if unchanged (kNoIndex: removed or modified)
+    std::vector<Index> changed;    // New indices of added and modified entries
+    std::size_t added = 0;
+    std::size_t removed = 0;
+    std::size_t modified = 0;
+
+    // Check whether both listings are identical
+    bool Empty() const { return added == 0 && removed == 0 && modified == 0; }
+
+    // Compare two listings
+    // @param before Old listing (default order must be sorted)
+    // @param after  New listing (default order must be sorted)
+    // @return Differences from before to after
+    static ListingDiff Compute(const EntryStore& before, const EntryStore& after);
+};
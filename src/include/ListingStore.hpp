@@ -0,0 +1,109 @@
+// ListingStore.hpp
+// Persistent, memory-mapped listing cache for FileMgr
+//
+// Saves directory snapshots, the expanded sidebar nodes and the last visited
+// location into one compact binary file on exit, and memory-maps it on the
+// next launch. The first frame can then be drawn from the mapped file without
+// enumerating any directory; callers revalidate each snapshot lazily by
+// comparing the directory's modification time (see SnapshotCache).
+//
+// File layout (version 1, little-endian, all offsets from file start):
+//   Header
+//   DirRecord[dirCount]         sorted by normalized path
+//   EntryRecord[...]            entries of each directory, in display order
+//   PathRecord[expandedCount]   expanded sidebar nodes
+//   character pool              names and paths (path::value_type units)
+//
+// A file with a different magic, version or character width is ignored.
+//
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "SnapshotCache.hpp"
+
+// -----------------------------------------------------------------------------
+// ListingStore class
+// -----------------------------------------------------------------------------
+class ListingStore {
+public:
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    ListingStore();
+    ~ListingStore();
+
+    ListingStore(const ListingStore&) = delete;
+    ListingStore& operator=(const ListingStore&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Default cache file location (%LOCALAPPDATA%\FileMgr or ~/.cache/FileMgr)
+    static std::filesystem::path GetDefaultPath();
+
+    // Map a cache file read-only
+    // @param file Cache file path
+    // @return False if the file is missing, unreadable or has the wrong format
+    bool Open(const std::filesystem::path& file);
+
+    // Unmap the file
+    void Close();
+
+    // Check whether a valid file is mapped
+    bool IsOpen() const { return m_data != nullptr; }
+
+    // Number of directory snapshots in the mapped file
+    std::size_t GetDirCount() const;
+
+    // Build a snapshot for one directory from the mapped file
+    // @param dir Directory to look up
+    // @return Snapshot (unvalidated) or null if not stored
+    std::shared_ptr<DirSnapshot> Find(const std::filesystem::path& dir) const;
+
+    // Last location stored in the file
+    std::optional<std::filesystem::path> GetLastLocation() const;
+
+    // Expanded sidebar nodes stored in the file
+    std::vector<std::filesystem::path> GetExpandedPaths() const;
+
+    // Write a new cache file (atomically replaces file; unmaps the old one)
+    // Directories from the currently mapped file that are not in snapshots
+    // are carried over until the size limit is reached.
+    // @param file         Destination path
+    // @param snapshots    Snapshots to save, most important first
+    // @param expanded     Expanded sidebar nodes
+    // @param lastLocation Directory shown at exit
+    // @return True on success
+    bool Save(const std::filesystem::path& file,
+              const std::vector<std::shared_ptr<const DirSnapshot>>& snapshots,
+              const std::vector<std::filesystem::path>& expanded,
+              const std::filesystem::path& lastLocation);
+
+private:
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    const unsigned char* m_data;               // Mapped file contents (null if closed)
+    std::size_t m_size;                        // Mapped size in bytes
+    void* m_fileHandle;                        // Platform file handle
+    void* m_mapHandle;                         // Platform mapping handle (Windows)
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Read a string from the character pool (bounds-checked)
+    // @return False if the range lies outside the file
+    bool ReadString(std::uint64_t offset, std::uint32_t length,
+                    std::filesystem::path::string_type& out) const;
+
+    // Build a snapshot from the directory record at index
+    std::shared_ptr<DirSnapshot> LoadDir(std::size_t index) const;
+};
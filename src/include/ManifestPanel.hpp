@@ -0,0 +1,65 @@
+// ManifestPanel.hpp
+// "Verify Manifest" window for FileMgr
+//
+// Runs a ManifestVerifier on a .sha256 or .md5 file chosen in the file list
+// and shows the progress in bytes, the read throughput and the counts of
+// good, mismatched, missing and unreadable files while it runs. Files that
+// did not verify are listed as they are found, with the checksum they
+// actually have or the error; double-clicking one shows its folder in the
+// file list.
+//
+#pragma once
+
+#include <imgui.h>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+#include "ManifestVerifier.hpp"
+
+// -----------------------------------------------------------------------------
+// ManifestPanel class
+// -----------------------------------------------------------------------------
+class ManifestPanel {
+public:
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Show the window and start verifying a manifest
+    // @param manifest Path of the .sha256 / .md5 file
+    void Open(const std::filesystem::path& manifest);
+
+    // Draw the window (does nothing while it is closed)
+    void Draw();
+
+    // Set callback for showing a folder in the file list
+    // @param callback Function called with the full path of the folder
+    void SetOnNavigate(std::function<void(const std::filesystem::path&)> callback) {
+        m_onNavigate = callback;
+    }
+
+private:
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    ManifestVerifier m_verifier;
+    std::vector<ManifestVerifier::Problem> m_problems;     // In the order they were found
+    std::filesystem::path m_manifest;
+    std::string m_manifestLabel;               // m_manifest as UTF-8 (for drawing)
+    int m_threads = 2;                         // Files checked at the same time
+    int m_selected = -1;                       // Selected row
+    bool m_open = false;
+    std::function<void(const std::filesystem::path&)> m_onNavigate;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Start verifying m_manifest
+    void StartVerify();
+
+    // Draw the table of files that did not verify
+    void DrawProblems();
+};
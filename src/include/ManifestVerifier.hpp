@@ -0,0 +1,171 @@
+// ManifestVerifier.hpp
+// Checksum manifest verification for FileMgr
+//
+// Checks the files listed in a .sha256 or .md5 manifest against their
+// checksums, like "sha256sum -c". Both line formats are read: the GNU one
+// ("<hex>  name" or "<hex> *name", with the backslash escape for names that
+// contain newlines) and the BSD tagged one ("SHA256 (name) = <hex>"). The
+// algorithm comes from the file extension, or from the tag or the length of
+// the first checksum when the extension says nothing. Names are relative to
+// the manifest's folder.
+//
+// Verification is built for manifests of large files: each file is streamed
+// in 4 MB sequential reads, and the next block is already being read while
+// the current one is hashed (overlapped I/O on Windows, read-ahead hints on
+// Linux), so a file is checked at the speed of the slower of the disk and
+// the hash. A few files are checked at the same time; on a spinning disk
+// one at a time is fastest. The bytes read are counted as they go, so the
+// progress and throughput can be shown while a single large file is being
+// read.
+//
+// Mismatched, missing and unreadable files are reported through Poll() as
+// soon as they are found. Malformed lines are counted and skipped.
+//
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// ManifestVerifier class
+// -----------------------------------------------------------------------------
+class ManifestVerifier {
+public:
+    enum class Algorithm { Unknown, Md5, Sha256 };
+
+    // What was found for one listed file
+    enum class Result { Ok, Mismatch, Missing, Failed };
+
+    // Parameters
+    struct Options {
+        int threads = 2;                   // Files checked at the same time
+        std::size_t readSize = 4 << 20;    // Bytes per sequential read
+    };
+
+    // Progress of the current (or last) run
+    struct Stats {
+        Algorithm algorithm = Algorithm::Unknown;
+        std::size_t files = 0;             // Files listed
+        std::size_t checked = 0;
+        std::size_t ok = 0;
+        std::size_t mismatched = 0;
+        std::size_t missing = 0;
+        std::size_t failed = 0;            // Could not be read
+        std::size_t malformed = 0;         // Lines that are not a checksum entry
+        std::uint64_t totalBytes = 0;      // Size of the listed files that exist
+        std::uint64_t bytes = 0;           // Bytes read and hashed so far
+        int threads = 0;
+        bool loading = false;              // Reading the manifest and the file sizes
+        bool running = false;
+        bool cancelled = false;
+        std::chrono::microseconds time{0}; // Elapsed time (so far)
+    };
+
+    // A listed file that did not verify
+    struct Problem {
+        std::string file;                  // Name as written in the manifest (UTF-8)
+        Result result = Result::Failed;
+        std::string detail;                // Actual checksum or error
+    };
+
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    ManifestVerifier() = default;
+
+    // Destructor - stops the run and joins the workers
+    ~ManifestVerifier();
+
+    ManifestVerifier(const ManifestVerifier&) = delete;
+    ManifestVerifier& operator=(const ManifestVerifier&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Start verifying a manifest (stops the previous run)
+    // @param manifest Path of the .sha256 / .md5 file
+    // @param options  Parameters
+    void Start(const std::filesystem::path& manifest, const Options& options);
+
+    // Stop after the blocks being read
+    void Cancel();
+
+    // Take the problems reported since the last call
+    // @param out Receives the problems (appended)
+    // @return True if problems were added
+    bool Poll(std::vector<Problem>& out);
+
+    // Check whether the run is still going
+    bool IsRunning() const;
+
+    // Get the progress of the current or last run
+    Stats GetStats() const;
+
+    // Get the manifest of the current or last run
+    const std::filesystem::path& GetManifest() const { return m_manifest; }
+
+    // Check whether a file name has a manifest extension
+    // @param name File name (UTF-8)
+    static bool IsManifestName(const char* name);
+
+    // Name of an algorithm for display
+    static const char* AlgorithmName(Algorithm algorithm);
+
+    // Largest number of problems kept for Poll() per run
+    static constexpr std::size_t kMaxProblems = 10000;
+
+private:
+    // One line of the manifest
+    struct Item {
+        std::string name;                  // As written (UTF-8)
+        std::filesystem::path path;
+        std::uint64_t size = 0;
+        bool missing = false;
+        unsigned char expected[32];
+    };
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    std::filesystem::path m_manifest;
+    Options m_options;
+    std::vector<Item> m_items;                 // Written by the loader before the workers start
+    Algorithm m_algorithm = Algorithm::Unknown;    // Chosen by the loader
+    std::thread m_thread;                      // Loads the manifest, then runs a worker
+    std::atomic<bool> m_cancel{false};
+    std::atomic<std::size_t> m_nextItem{0};
+    std::atomic<std::uint64_t> m_bytes{0};     // Bytes hashed (updated per block)
+    std::chrono::steady_clock::time_point m_startTime;
+
+    mutable std::mutex m_mutex;                // Guards the fields below
+    std::vector<Problem> m_problems;           // Not yet taken by Poll()
+    std::size_t m_problemCount = 0;            // Reported this run
+    Stats m_stats;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Thread body: load the manifest, check the files, finish the run
+    void Run();
+
+    // Parse the manifest and look up the sizes of the listed files
+    // @return False if the manifest could not be read
+    bool Load();
+
+    // Worker thread: take files until none are left
+    void WorkerLoop();
+
+    // Hash one file and compare it with its expected checksum
+    // @param detail Receives the actual checksum or the error
+    Result Check(const Item& item, std::vector<char>& buffers, std::string& detail);
+};
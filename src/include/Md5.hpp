@@ -0,0 +1,43 @@
+// Md5.hpp
+// MD5 for FileMgr
+//
+// Only for checking md5sum manifests: MD5 is broken as a cryptographic hash
+// and a match says nothing about tampering, but old archives and mirrors
+// still publish it and it still detects a damaged copy.
+//
+// Data can be hashed in one call or streamed through Update() in pieces of
+// any size.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// -----------------------------------------------------------------------------
+// Md5 class
+// -----------------------------------------------------------------------------
+class Md5 {
+public:
+    static constexpr std::size_t kDigestSize = 16;
+
+    Md5() { Reset(); }
+
+    // Start a new hash
+    void Reset();
+
+    // Add data to the hash
+    void Update(const void* data, std::size_t size);
+
+    // Get the hash of the data added so far (more data can still be added)
+    // @param digest Receives kDigestSize bytes
+    void Digest(unsigned char* digest) const;
+
+private:
+    // Process one 64-byte block
+    void Transform(const unsigned char* block);
+
+    std::uint32_t m_state[4];
+    std::uint64_t m_total = 0;                 // Bytes added
+    unsigned char m_buffer[64];                // Bytes of an incomplete block
+    std::size_t m_buffered = 0;
+};
@@ -0,0 +1,46 @@
+// NameBenchmark.hpp
+// File name index benchmark for FileMgr (--name-index-benchmark)
+//
+// Generates a tree of empty files below a folder (100 project folders of
+// 100 subfolders each, 500 files per subfolder, names made of two words, a
+// number and an extension) and indexes it with NameIndex. Reports the build
+// time, the bytes per file in memory and in the index file, and the load
+// time of the saved index. Then runs a fixed set of substring, prefix and
+// glob queries (each the best of several runs, plus one query typed a
+// character at a time so it narrows) and reports their latency. A substring
+// and a prefix query are checked against the counts of the generated names;
+// the benchmark fails if they differ. The tree is kept and reused by later
+// runs.
+//
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+// -----------------------------------------------------------------------------
+// NameBenchmark class
+// -----------------------------------------------------------------------------
+class NameBenchmark {
+public:
+    // Tree parameters
+    struct Options {
+        int files = 5000000;               // Files in the tree
+        int threads = 0;                   // Walker threads (0 = EntrySorter::DefaultThreadCount())
+    };
+
+    // Run the benchmark and log the results
+    // @param dir     Folder for the tree and the index file (created if needed)
+    // @param options Tree parameters
+    // @return Process exit code (0 on success)
+    static int Run(const std::filesystem::path& dir, const Options& options);
+
+private:
+    // Write the tree unless a complete one with the same file count exists
+    // @return False if a file could not be written
+    static bool Generate(const std::filesystem::path& tree, const Options& options);
+
+    // Count the generated file names containing (or starting with) a text
+    // @param text   Lowercase text
+    // @param prefix Count names starting with text instead
+    static std::size_t CountNames(const Options& options, const char* text, bool prefix);
+};
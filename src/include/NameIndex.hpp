@@ -0,0 +1,268 @@
+// NameIndex.hpp
+// Whole-volume file name index for FileMgr
+//
+// Indexes every file and folder below a root (normally a volume root) so
+// that names can be searched instantly without touching the disk. Records
+// are columnar: one UTF-8 name buffer ('\0' separated, original case), a
+// parent id, size, mtime and flag per record. A path is rebuilt by following
+// the parent links, so each record stores only its own name. Children of a
+// folder are stored next to each other by the build, so a folder's children
+// are one range; a permutation of the records sorted by case-folded name
+// answers prefix queries with a binary search.
+//
+// The build is a parallel walk (worker threads share one folder stack, like
+// ContentSearch) that stays on the root's filesystem. The finished index is
+// swapped in and written to disk; later sessions load it instead of walking
+// again. Substring and glob queries scan the name buffer in parallel with
+// SSE2, prefix queries use the sorted permutation, and a query that only
+// extends the previous one re-checks the previous matches.
+//
+// After a build or load the index is kept current from change
+// notifications: fanotify with a filesystem mark on Linux (needs
+// CAP_SYS_ADMIN), a recursive ReadDirectoryChangesW on Windows. Created
+// folders are walked, deleted records are marked and skipped by queries.
+// When notifications are unavailable or events were lost the index reports
+// itself as stale until it is rebuilt.
+//
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "EntryFilter.hpp"
+#include "EntryStore.hpp"
+
+// -----------------------------------------------------------------------------
+// NameIndex class
+// -----------------------------------------------------------------------------
+class NameIndex {
+public:
+    using Id = std::uint32_t;
+    static constexpr Id kNoId = ~Id(0);
+
+    // State of the index
+    struct Stats {
+        std::uint64_t generation = 0;      // Bumped when a build or load replaces the index
+        std::size_t files = 0;             // Live file records
+        std::size_t folders = 0;           // Live folder records
+        std::size_t memoryBytes = 0;       // Record arrays, name buffer and sorted order
+        std::size_t walked = 0;            // Records found by the running build
+        int threads = 0;                   // Threads used by the last build
+        bool building = false;             // A build or load is running
+        bool ready = false;                // Queries can run
+        bool loaded = false;               // The index was read from disk, not built
+        bool stale = false;                // Changes may have been missed
+        const char* liveBackend = "none";  // Source of live updates
+        std::uint64_t updates = 0;         // Change events applied since the build or load
+        std::chrono::microseconds buildTime{0};    // Duration of the build or load (so far)
+    };
+
+    // Cost of the last query
+    struct QueryStats {
+        std::size_t matches = 0;           // Live records matching the query
+        std::size_t checked = 0;           // Records examined (0 for a full buffer scan)
+        bool narrowed = false;             // Only the previous matches were re-checked
+        int threads = 0;
+        std::chrono::microseconds time{0};
+    };
+
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    NameIndex();
+
+    // Destructor - stops the build and the live updates
+    ~NameIndex();
+
+    NameIndex(const NameIndex&) = delete;
+    NameIndex& operator=(const NameIndex&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Build a new index in the background (the current one stays usable
+    // until the new one is complete, then it is saved to the index file)
+    // @param root    Folder to index
+    // @param file    Where to save the index (empty: do not save)
+    // @param threads Walker threads (0 = EntrySorter::DefaultThreadCount())
+    void StartBuild(const std::filesystem::path& root, const std::filesystem::path& file, int threads = 0);
+
+    // Load a saved index in the background
+    // @param file Index file written by a previous build
+    void StartLoad(const std::filesystem::path& file);
+
+    // Write the index if it changed since it was built, loaded or saved
+    // @param file Index file to write
+    // @return False if writing failed
+    bool SaveIfChanged(const std::filesystem::path& file);
+
+    // Get the state of the index
+    Stats GetStats() const;
+
+    // Get the indexed folder (empty before the first build or load)
+    std::filesystem::path GetRoot() const;
+
+    // Find the records matching a pattern (call from one thread only)
+    // @param pattern UTF-8 pattern, case-insensitive for ASCII
+    // @param mode    How text without * or ? is matched (with them: glob)
+    // @return Matching record ids (valid until the next call)
+    const std::vector<Id>& Query(const std::string& pattern, FilterMode mode);
+
+    // Get the matches of the last query (query thread only)
+    const std::vector<Id>& GetMatches() const { return m_matches; }
+
+    // Get the cost of the last query
+    const QueryStats& GetLastQueryStats() const { return m_queryStats; }
+
+    // Get the path of a record relative to the root
+    // @param id Record id from Query()
+    // @return UTF-8 path, or an empty string for an unknown id
+    std::string GetRelativePath(Id id) const;
+
+    // Copy records into an entry store; names are native paths relative to
+    // the root, so root / name is the full path of an entry
+    // @param ids   Record ids from Query()
+    // @param limit Maximum number of entries copied
+    // @param out   Receives the entries (cleared first)
+    void FillEntries(const std::vector<Id>& ids, std::size_t limit, EntryStore& out) const;
+
+    // Block until the running build or load has finished
+    void WaitIdle();
+
+    // Default location of the index file (next to the listing cache)
+    static std::filesystem::path GetDefaultPath();
+
+private:
+    // Children of one folder written by the build
+    struct DirRange {
+        Id dir;
+        Id first;
+        Id count;
+    };
+
+    // The indexed records; replaced as a whole by a build or load
+    struct Data {
+        std::filesystem::path root;
+        std::vector<char> names;                   // UTF-8 names, each followed by '\0'
+        std::vector<std::uint32_t> offsets;        // Start of each name in names, plus the end
+        std::vector<Id> parents;                   // Parent record (kNoId for the root)
+        std::vector<std::uint64_t> sizes;
+        std::vector<std::int64_t> times;           // Modification time (ns since the epoch)
+        std::vector<std::uint8_t> flags;           // Folder / deleted bits
+        std::vector<DirRange> ranges;              // Children written by the build, by folder
+        std::unordered_multimap<Id, Id> extra;     // Children added by live updates, by folder
+        std::vector<Id> sorted;                    // Records [1, sorted.size()] by folded name
+        std::size_t folders = 0;
+        std::size_t deletedFiles = 0;
+        std::size_t deletedFolders = 0;
+
+        Id Count() const { return offsets.empty() ? 0 : Id(offsets.size() - 1); }
+        Id Add(Id parent, const char* name, std::size_t size, bool isDir, std::uint64_t bytes, std::int64_t time);
+        const char* Name(Id id) const { return names.data() + offsets[id]; }
+        std::size_t NameSize(Id id) const { return offsets[id + 1] - offsets[id] - 1; }
+        std::size_t MemoryBytes() const;
+    };
+
+    // Platform notification handles (defined in NameIndex.cpp)
+    struct Watch;
+
+    // Change reported by the live update thread
+    struct Change {
+        enum Kind { Created, Removed, Modified } kind;
+        std::filesystem::path relative;            // Path relative to the root
+    };
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    mutable std::shared_mutex m_dataMutex;     // Readers: queries; writers: swap and live updates
+    std::unique_ptr<Data> m_data;
+    std::uint64_t m_dataGeneration;            // Bumped whenever records change (guarded by m_dataMutex)
+
+    std::thread m_worker;                      // Build or load
+    std::thread m_watcher;                     // Live updates
+    std::atomic<bool> m_cancelBuild;
+    std::atomic<bool> m_stopWatch;
+#ifdef _WIN32
+    void* m_watchStopEvent;                    // Wakes the watcher (HANDLE)
+#else
+    int m_watchWakeFd;                         // eventfd that wakes the watcher
+#endif
+    std::atomic<bool> m_dirty;                 // Changed since the last save
+
+    mutable std::mutex m_statsMutex;
+    std::condition_variable m_idleCv;
+    Stats m_stats;
+    std::chrono::steady_clock::time_point m_buildStart;
+
+    // Query state (query thread only)
+    std::vector<Id> m_matches;
+    std::string m_lastPattern;                 // Lowercase pattern m_matches belongs to
+    FilterMode m_lastMode;
+    std::uint64_t m_lastGeneration;            // m_dataGeneration m_matches was computed from
+    QueryStats m_queryStats;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Join the worker and the watcher
+    void StopThreads();
+
+    // Stop live updates and join the watcher
+    void StopWatcher();
+
+    // Worker: walk a root with several threads into a new Data
+    std::unique_ptr<Data> Build(const std::filesystem::path& root, int threads);
+
+    // Sort the children ranges and the name order of a finished Data
+    static void Finish(Data& data, int threads);
+
+    // Replace the records and start live updates for the new root
+    // @param watch Notifications opened before the build (null: open now)
+    void Install(std::unique_ptr<Data> data, std::unique_ptr<Watch> watch, bool loaded,
+                 std::chrono::microseconds time);
+
+    // Write a Data to disk (temporary file, then rename)
+    static bool Write(const Data& data, const std::filesystem::path& file);
+
+    // Read a Data written by Write()
+    static std::unique_ptr<Data> Read(const std::filesystem::path& file);
+
+    // Start receiving change notifications for a root
+    static std::unique_ptr<Watch> OpenWatch(const std::filesystem::path& root);
+
+    // Watcher thread: turn notifications below the root into changes
+    void WatchLoop(std::unique_ptr<Watch> watch);
+
+    // Apply a batch of changes (stats the paths, walks created folders)
+    void ApplyChanges(const std::vector<Change>& changes);
+
+    // Append the path of a record relative to the root
+    static void AppendPath(const Data& data, Id id, std::string& out);
+
+    // Find a child of a folder by name
+    static Id FindChild(const Data& data, Id dir, const char* name, std::size_t size);
+
+    // Mark a record and everything below it as deleted
+    static void MarkDeleted(Data& data, Id id);
+
+    // Scan the name buffer for a lowercase literal in parallel
+    void ScanRecords(const Data& data, const std::string& literal, const std::string& glob, std::vector<Id>& out,
+                     int threads);
+
+    // Check one record against the current pattern
+    static bool MatchRecord(const Data& data, Id id, const std::string& pattern, FilterMode mode);
+};
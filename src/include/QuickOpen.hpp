@@ -0,0 +1,68 @@
+// QuickOpen.hpp
+// Ctrl+P "go to file" window for FileMgr
+//
+// Shows a query box and the best fuzzy matches among the files below the
+// folder it was opened on. The subtree walk and the ranking run on the
+// FuzzyFinder's threads; the window only draws the published matches, so
+// typing stays responsive while the walk is still streaming paths in.
+//
+// Up/Down move the selection, Enter (or a click) opens the selected file
+// through the open callback, Escape closes the window. Reopening the window
+// on the same folder keeps the paths already found.
+//
+#pragma once
+
+#include <imgui.h>
+#include <filesystem>
+#include <functional>
+#include "FuzzyFinder.hpp"
+
+// -----------------------------------------------------------------------------
+// QuickOpen class
+// -----------------------------------------------------------------------------
+class QuickOpen {
+public:
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Show the window and search below a folder
+    // @param root Folder whose subtree is searched
+    void Open(const std::filesystem::path& root);
+
+    // Check whether the window is shown
+    bool IsOpen() const { return m_open; }
+
+    // Draw the window (does nothing while it is closed)
+    void Draw();
+
+    // Draw walk and ranking statistics (for the statistics window)
+    void DrawStats();
+
+    // Set callback for opening a match
+    // @param callback Function called with the full path of the chosen file
+    void SetOnOpen(std::function<void(const std::filesystem::path&)> callback) {
+        m_onOpen = callback;
+    }
+
+private:
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    FuzzyFinder m_finder;
+    FuzzyFinder::Result m_result;              // Newest published ranking
+    char m_query[256] = "";
+    int m_selected = 0;                        // Selected row of m_result.matches
+    bool m_open = false;
+    bool m_focusQuery = false;                 // Focus the query box on the next frame
+    bool m_scrollToSelected = false;
+    std::function<void(const std::filesystem::path&)> m_onOpen;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Open the match in a row and close the window
+    void Choose(int row);
+};
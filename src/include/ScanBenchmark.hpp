@@ -0,0 +1,66 @@
+// ScanBenchmark.hpp
+// Directory scan benchmark for FileMgr (--scan-benchmark)
+//
+// Generates one folder with a large number of empty files (and a subfolder
+// every thousand entries) below a folder and scans it headless with
+// DirScanner the way FileList does: batches are collected with
+// WaitForBatch() and Poll() as they arrive. After a warm-up scan, each run
+// reports the time to the first row and the total scan time, and the
+// benchmark fails if either is over its limit or if the listing is not
+// exactly the generated folder. A last run restarts the scan as soon as its
+// first rows arrive and checks that no batch of the superseded scan is
+// delivered. Finally every enumeration backend available here scans the
+// same folder (std::filesystem with a metadata query per entry, the native
+// bulk API and, on Linux, io_uring batched statx) and its best rate in
+// entries/s is reported next to the std::filesystem one; the io_uring rate
+// is also compared with the synchronous statx path. The folder is kept and
+// reused by later runs.
+//
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+class DirScanner;
+
+// -----------------------------------------------------------------------------
+// ScanBenchmark class
+// -----------------------------------------------------------------------------
+class ScanBenchmark {
+public:
+    // Folder parameters and limits
+    struct Options {
+        int files = 1000000;               // Files in the folder
+        int runs = 3;                      // Timed scans after the warm-up scan
+        int maxFirstRowMs = 50;            // Limit for Start() -> first rows delivered
+        int maxTotalMs = 10000;            // Limit for Start() -> last rows delivered
+    };
+
+    // Run the benchmark and log the results
+    // @param dir     Folder for the generated folder (created if needed)
+    // @param options Folder parameters and limits
+    // @return Process exit code (0 on success)
+    static int Run(const std::filesystem::path& dir, const Options& options);
+
+private:
+    // What one scan delivered
+    struct Result {
+        std::size_t entries = 0;
+        std::size_t directories = 0;
+        std::uint64_t bytes = 0;           // Sum of the file sizes
+        bool finished = false;             // The final batch arrived
+        bool stale = false;                // A batch of another generation was delivered
+        std::chrono::microseconds firstRow{0};
+        std::chrono::microseconds total{0};
+    };
+
+    // Write the folder unless a complete one already exists
+    // @return False if a file could not be written
+    static bool Generate(const std::filesystem::path& folder, const Options& options);
+
+    // Scan the folder once and collect the batches as FileList would
+    // @param restart Start the scan again as soon as the first rows arrive
+    static Result Measure(DirScanner& scanner, const std::filesystem::path& folder, bool restart);
+};
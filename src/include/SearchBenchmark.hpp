@@ -0,0 +1,51 @@
+// SearchBenchmark.hpp
+// Content search benchmark for FileMgr (--search-benchmark)
+//
+// Generates a synthetic corpus of several GB below a folder: source-like
+// text files of 20-220 KB spread over 200 folders, a 64 MB file every 500
+// files (read through a memory mapping) and a binary file (NUL in the first
+// byte) every 97 files. A known number of lines carry a needle, some of them
+// in upper case. The corpus is searched with ContentSearch, once to warm the
+// page cache and then with 1, 2, 4 ... up to the default number of threads,
+// ignoring case and matching case; each pass reports its throughput and must
+// find exactly the planted lines and skip exactly the binary files. Finally
+// a search is cancelled shortly after it starts and the time Cancel() takes
+// is reported. The corpus is kept and reused by later runs.
+//
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+// -----------------------------------------------------------------------------
+// SearchBenchmark class
+// -----------------------------------------------------------------------------
+class SearchBenchmark {
+public:
+    // Corpus parameters
+    struct Options {
+        int megabytes = 4096;              // Corpus size
+        int threads = 0;                   // Most search threads (0 = EntrySorter::DefaultThreadCount())
+    };
+
+    // Run the benchmark and log the results
+    // @param dir     Folder for the corpus (created if needed)
+    // @param options Corpus parameters
+    // @return Process exit code (0 on success)
+    static int Run(const std::filesystem::path& dir, const Options& options);
+
+private:
+    // What the generated corpus contains
+    struct Corpus {
+        int files = 0;
+        int binary = 0;                    // Files starting with a NUL byte
+        std::uint64_t bytes = 0;
+        std::uint64_t planted = 0;         // Needle lines in text files (any case)
+        std::uint64_t exact = 0;           // Of those, lines with the needle as written
+    };
+
+    // Write the corpus unless a complete one of the same size already exists
+    // @param corpus Receives what the corpus contains
+    // @return False if a file could not be written
+    static bool Generate(const std::filesystem::path& folder, const Options& options, Corpus& corpus);
+};
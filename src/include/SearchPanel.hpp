@@ -0,0 +1,84 @@
+// SearchPanel.hpp
+// "Find in Files" window for FileMgr
+//
+// Searches the contents of the files below the current folder with
+// ContentSearch and lists the matching lines as they stream in. The result
+// table is drawn through ImGuiListClipper, so only the visible rows are
+// submitted however many matches arrive. Double-clicking a row opens its
+// file through the open callback.
+//
+// A folder can be given a TextIndex ("Index this folder"); the saved index
+// of the folder or of a parent is loaded and brought up to date when the
+// window is opened on it. With "Use index" the search text is a list of
+// words: the index finds the files containing all of them and only those
+// files are read, listing the lines with the rarest word.
+//
+#pragma once
+
+#include <imgui.h>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include "ContentSearch.hpp"
+#include "TextIndex.hpp"
+
+// -----------------------------------------------------------------------------
+// SearchPanel class
+// -----------------------------------------------------------------------------
+class SearchPanel {
+public:
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Show the window for a folder (a running search keeps its folder)
+    // @param root Folder whose subtree the next search covers
+    void Open(const std::filesystem::path& root);
+
+    // Draw the window (does nothing while it is closed)
+    void Draw();
+
+    // Set callback for opening a match
+    // @param callback Function called with the full path of the file
+    void SetOnOpen(std::function<void(const std::filesystem::path&)> callback) {
+        m_onOpen = callback;
+    }
+
+private:
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    ContentSearch m_search;
+    ContentSearch::Results m_results;          // Matches taken so far
+    std::filesystem::path m_root;              // Folder of the next search
+    std::string m_rootLabel;                   // m_root as UTF-8 (for drawing)
+    char m_text[256] = "";
+    bool m_matchCase = false;
+    TextIndex m_index;
+    std::string m_indexLabel;                  // Root of the index as UTF-8
+    std::string m_indexPrefix;                 // m_root relative to the index root ("" or ending in a separator)
+    std::uint64_t m_seenGeneration = ~0ULL;    // Index generation m_indexLabel and m_indexCovers belong to
+    bool m_indexCovers = false;                // The index contains m_root
+    bool m_useIndex = false;
+    bool m_indexed = false;                    // The last search used the index
+    std::size_t m_indexedFiles = 0;            // Files of the last indexed search
+    int m_threads = 0;                         // 0 until the window is first opened
+    int m_selected = -1;
+    bool m_open = false;
+    bool m_focusText = false;
+    std::function<void(const std::filesystem::path&)> m_onOpen;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Start a search for the current text
+    void StartSearch();
+
+    // Draw the text index state and its buttons
+    void DrawIndex();
+
+    // Check whether the index contains m_root (after it or m_root changed)
+    void UpdateIndexCoverage();
+};
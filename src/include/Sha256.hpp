@@ -0,0 +1,45 @@
+// Sha256.hpp
+// SHA-256 for FileMgr
+//
+// The FIPS 180-4 hash used by sha256sum manifests and most published
+// download checksums. Portable C++ (no CPU extensions): a few hundred
+// megabytes per second on one core, so verifying a large file is usually
+// bound by the hash rather than by a fast disk; callers that only compare
+// files among themselves use XxHash64 instead.
+//
+// Data can be hashed in one call or streamed through Update() in pieces of
+// any size.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// -----------------------------------------------------------------------------
+// Sha256 class
+// -----------------------------------------------------------------------------
+class Sha256 {
+public:
+    static constexpr std::size_t kDigestSize = 32;
+
+    Sha256() { Reset(); }
+
+    // Start a new hash
+    void Reset();
+
+    // Add data to the hash
+    void Update(const void* data, std::size_t size);
+
+    // Get the hash of the data added so far (more data can still be added)
+    // @param digest Receives kDigestSize bytes
+    void Digest(unsigned char* digest) const;
+
+private:
+    // Process one 64-byte block
+    void Transform(const unsigned char* block);
+
+    std::uint32_t m_state[8];
+    std::uint64_t m_total = 0;                 // Bytes added
+    unsigned char m_buffer[64];                // Bytes of an incomplete block
+    std::size_t m_buffered = 0;
+};
@@ -5,13 +5,29 @@
 // Uses caching to avoid repeated filesystem scans and provides folder selection
 // callbacks for integration with the main file list.
 // 
+// Folder listings are shared with the file list through the SnapshotCache.
+// At startup they are seeded from the persistent ListingStore together with
+// the nodes that were expanded in the previous session; seeded listings are
+// revalidated by directory mtime a few per frame after the first frame.
+// Listings of watched folders are dropped by Invalidate() when the DirWatcher
+// reports a change, and re-read the next time they are drawn.
+// 
+// Each cached folder keeps its UTF-8 label and icon next to its path, and
+// lookups use the native path string, so drawing an unchanged tree does no
+// heap allocation.
+// 
 #pragma once
 
 #include <imgui.h>
 #include <filesystem>
 #include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "IconCache.hpp"
+#include "SnapshotCache.hpp"
+#include "ListingStore.hpp"
 
 // -----------------------------------------------------------------------------
 // SidebarTree class
@@ -24,7 +40,9 @@ public:
     
     // Constructor
     // @param iconCache Pointer to shared icon cache (must outlive this object)
-    explicit SidebarTree(IconCache* iconCache);
+    // @param snapshots Shared listing cache (must outlive this object)
+    // @param store     Optional persistent listing cache (must outlive this object)
+    SidebarTree(IconCache* iconCache, SnapshotCache* snapshots, const ListingStore* store = nullptr);
     
     // -------------------------------------------------------------------------
     // Public API
@@ -39,38 +57,83 @@ public:
         m_onFolderSelected = callback;
     }
     
+    // Set callback for folder hover
+    // @param callback Function called when the mouse rests on a folder node
+    void SetOnFolderHovered(std::function<void(const std::filesystem::path&)> callback) {
+        m_onFolderHovered = callback;
+    }
+    
+    // Get the nodes that are currently expanded (saved in the listing store)
+    std::vector<std::filesystem::path> GetExpandedPaths() const;
+    
+    // Counter that changes whenever a node is expanded or collapsed
+    std::uint64_t GetExpandedGeneration() const { return m_expandedGeneration; }
+    
+    // Drop the cached listing of a directory that changed on disk
+    // @param path Directory to re-read on the next frame
+    void Invalidate(const std::filesystem::path& path);
+    
 private:
     // -------------------------------------------------------------------------
     // Member variables
     // -------------------------------------------------------------------------
     
     IconCache* m_iconCache;                            // Shared icon cache
+    SnapshotCache* m_snapshots;                        // Shared directory listings
+    const ListingStore* m_store;                       // Listings from the previous session
     std::function<void(const std::filesystem::path&)> m_onFolderSelected; // Selection callback
+    std::function<void(const std::filesystem::path&)> m_onFolderHovered;  // Hover callback (prefetch)
     
     // -------------------------------------------------------------------------
     // Internal structures
     // -------------------------------------------------------------------------
     
+    // A folder shown in the tree
+    struct Node {
+        std::filesystem::path path;                    // Directory path
+        std::string label;                             // UTF-8 display name
+        ImTextureID icon = 0;                          // Folder icon (valid once iconLoaded)
+        bool iconLoaded = false;
+        bool hovered = false;                          // Hover callback already sent for this hover
+    };
+    
     // Cached directory information
     struct DirCache {
-        std::vector<std::filesystem::path> subDirs;    // Immediate subdirectories
-        std::filesystem::file_time_type lastWriteTime; // For cache invalidation (not currently used)
+        std::vector<Node> subDirs;                     // Immediate subdirectories
+        std::chrono::system_clock::time_point lastWriteTime; // Directory mtime of the listing
     };
     
-    // Cache of directory contents (keyed by wide string path)
-    std::unordered_map<std::wstring, DirCache> m_dirCache;
+    using PathKey = std::filesystem::path::string_type;
+    
+    // Cache of directory contents (keyed by native path string)
+    std::unordered_map<PathKey, DirCache> m_dirCache;
+    Node m_drives[26];                                 // Drive roots (path empty until seen)
+    
+    std::unordered_set<PathKey> m_expanded;            // Expanded nodes (restored once at startup)
+    std::uint64_t m_expandedGeneration;                // Bumped when m_expanded changes
+    std::vector<std::filesystem::path> m_revalidateQueue; // Seeded listings not yet re-checked
+    bool m_firstFrameDrawn;                            // Revalidation starts after the first frame
     
     // -------------------------------------------------------------------------
     // Private methods
     // -------------------------------------------------------------------------
     
     // Recursively draw a directory node in the tree
-    // @param path        Directory path
-    // @param displayName Name to display in the tree node
-    void DrawTreeNode(const std::filesystem::path& path, const std::string& displayName);
+    // @param node Folder to draw (icon and hover state are updated in place)
+    void DrawTreeNode(Node& node);
     
     // Get subdirectories of a path (with caching)
+    // Looks in the shared snapshot cache, then the listing store, and only
+    // then reads the directory.
     // @param path Directory path
-    // @return Reference to vector of subdirectory paths
-    const std::vector<std::filesystem::path>& GetSubDirectories(const std::filesystem::path& path);
+    // @return Reference to the cached subdirectory nodes
+    std::vector<Node>& GetSubDirectories(const std::filesystem::path& path);
+    
+    // Create a node for a subdirectory (formats its label)
+    // @param path Directory path
+    static Node MakeNode(std::filesystem::path path);
+    
+    // Re-check a few seeded listings against the directory mtime
+    // @param maxChecks Maximum number of directories to stat
+    void RevalidateSeeded(std::size_t maxChecks);
 };
\ No newline at end of file
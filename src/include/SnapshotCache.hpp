@@ -0,0 +1,117 @@
+// SnapshotCache.hpp
+// LRU cache of directory listings for FileMgr
+//
+// Keeps recently viewed directory listings in memory, keyed by path, so that
+// back/forward navigation and other revisits can paint immediately. Each
+// snapshot records the directory's own modification time at scan time; the
+// caller re-checks it in the background and replaces the snapshot if the
+// directory has changed since.
+//
+// The cache is bounded by an approximate memory budget (the allocated size
+// of each snapshot's EntryStore). Least recently used snapshots are evicted first. All methods are
+// thread-safe.
+//
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "EntryStore.hpp"
+
+// -----------------------------------------------------------------------------
+// DirSnapshot - a complete listing of one directory
+// -----------------------------------------------------------------------------
+struct DirSnapshot {
+    std::filesystem::path dir;                          // Directory that was listed
+    EntryStore entries;                                 // Entries (sorted display order)
+    std::chrono::system_clock::time_point dirWriteTime; // Directory mtime at scan start
+    std::size_t bytes = 0;                              // Approximate memory footprint
+};
+
+// -----------------------------------------------------------------------------
+// SnapshotCache class
+// -----------------------------------------------------------------------------
+class SnapshotCache {
+public:
+    // Counters for tuning the budget
+    struct Stats {
+        std::uint64_t hits = 0;         // Get() found a snapshot
+        std::uint64_t misses = 0;       // Get() found nothing
+        std::uint64_t evictions = 0;    // Snapshots dropped to stay within budget
+        std::size_t count = 0;          // Snapshots currently cached
+        std::size_t bytes = 0;          // Approximate bytes currently cached
+        std::size_t budget = 0;         // Memory budget in bytes
+    };
+
+    // Constructor
+    // @param budgetBytes Approximate memory budget for all snapshots
+    explicit SnapshotCache(std::size_t budgetBytes = 64 * 1024 * 1024);
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Look up a directory and mark it most recently used (counts hit/miss)
+    // @param dir Directory path
+    // @return Snapshot or null
+    std::shared_ptr<const DirSnapshot> Get(const std::filesystem::path& dir);
+
+    // Look up a directory without touching LRU order or counters
+    // @param dir Directory path
+    // @return Snapshot or null
+    std::shared_ptr<const DirSnapshot> Peek(const std::filesystem::path& dir) const;
+
+    // Insert or replace a snapshot, evicting old ones to stay within budget
+    // Snapshots larger than the whole budget are not cached.
+    // @param snapshot Snapshot to store (bytes is computed here)
+    void Put(std::shared_ptr<DirSnapshot> snapshot);
+
+    // Remove a directory from the cache
+    // @param dir Directory path
+    void Erase(const std::filesystem::path& dir);
+
+    // Change the memory budget (evicts immediately if shrinking)
+    // @param budgetBytes New budget in bytes
+    void SetBudget(std::size_t budgetBytes);
+
+    // Get a copy of the counters
+    Stats GetStats() const;
+
+    // Get every cached snapshot, most recently used first
+    std::vector<std::shared_ptr<const DirSnapshot>> GetAll() const;
+
+    // Normalize a path into a cache key (also used by ListingStore)
+    // @param dir Directory path
+    // @return Key with a trailing separator removed
+    static std::filesystem::path::string_type MakeKey(const std::filesystem::path& dir);
+
+    // Estimate the memory used by a listing
+    // @param entries Entries to measure
+    // @return Approximate size in bytes
+    static std::size_t EstimateBytes(const EntryStore& entries);
+
+private:
+    using Key = std::filesystem::path::string_type;
+    using LruList = std::list<std::shared_ptr<const DirSnapshot>>;
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    mutable std::mutex m_mutex;                          // Guards everything below
+    LruList m_lru;                                       // Front = most recently used
+    std::unordered_map<Key, LruList::iterator> m_index;  // Path -> position in m_lru
+    Stats m_stats;                                       // Counters and sizes
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Drop least recently used snapshots until within budget (lock held)
+    void EvictToBudget();
+};
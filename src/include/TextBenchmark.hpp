@@ -0,0 +1,40 @@
+// TextBenchmark.hpp
+// Text index benchmark for FileMgr (--text-index-benchmark)
+//
+// Generates a synthetic corpus of log-like text files (Zipf-distributed
+// words, timestamps, occasional request ids) below a folder, indexes it
+// with TextIndex and reports build throughput, index size and load time.
+// Then runs a fixed set of one-, two- and three-word AND queries against
+// the index and, for comparison, a ContentSearch pass over the whole corpus
+// for the rarest word of each query (a lower bound for a brute-force AND
+// search). Finally 1% of the files are changed and the incremental update
+// is timed. The corpus is kept and reused by later runs.
+//
+#pragma once
+
+#include <filesystem>
+
+// -----------------------------------------------------------------------------
+// TextBenchmark class
+// -----------------------------------------------------------------------------
+class TextBenchmark {
+public:
+    // Corpus parameters
+    struct Options {
+        int files = 8000;                  // Files in the corpus
+        int linesPerFile = 300;            // Average lines per file
+        int vocabulary = 40000;            // Distinct dictionary words
+        int threads = 0;                   // Index threads (0 = EntrySorter::DefaultThreadCount())
+    };
+
+    // Run the benchmark and log the results
+    // @param dir     Folder for the corpus (created if needed)
+    // @param options Corpus parameters
+    // @return Process exit code (0 on success)
+    static int Run(const std::filesystem::path& dir, const Options& options);
+
+private:
+    // Write the corpus unless a complete one already exists
+    // @return False if a file could not be written
+    static bool Generate(const std::filesystem::path& corpus, const Options& options);
+};
@@ -0,0 +1,251 @@
+// TextIndex.hpp
+// Full-text inverted index of a folder tree for FileMgr
+//
+// Opt-in per root folder: once a tree has been indexed, the words of its
+// text files are looked up in the index instead of reading every file.
+// A word is a run of ASCII letters, digits and '_' (or UTF-8 bytes), at
+// least two bytes long, compared without ASCII case. Every word maps to the
+// sorted list of files (documents) containing it, delta-encoded as varints
+// with a skip entry every 128 documents, so a query for several words
+// intersects the rarest list with the others and skips over most of the
+// longer ones.
+//
+// The index is built by a parallel walk followed by parallel tokenizing;
+// each worker fills its own postings and the lists are merged at the end.
+// It is saved to one file per root in the cache folder. An update walks the
+// tree again and re-reads only the files whose size or modification time
+// changed: their old documents are marked deleted and new documents are
+// appended, so no other list is rewritten. When a quarter of the documents
+// are deleted, the index is compacted. Files with a NUL byte in their first
+// 8 KB are treated as binary and not indexed.
+//
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// TextIndex class
+// -----------------------------------------------------------------------------
+class TextIndex {
+public:
+    using DocId = std::uint32_t;
+
+    // Shortest and longest indexed word (longer runs are not indexed)
+    static constexpr std::size_t kMinWord = 2;
+    static constexpr std::size_t kMaxWord = 64;
+
+    // State of the index
+    struct Stats {
+        std::uint64_t generation = 0;      // Bumped when the documents or words change
+        std::size_t documents = 0;         // Live documents (indexed text files)
+        std::size_t deleted = 0;           // Deleted documents not yet compacted away
+        std::size_t words = 0;             // Distinct words
+        std::uint64_t postings = 0;        // (word, document) pairs
+        std::size_t postingBytes = 0;      // Compressed postings and skip entries
+        std::size_t memoryBytes = 0;       // Everything held in memory
+        std::size_t walked = 0;            // Files found by the running build or update
+        std::size_t read = 0;              // Files tokenized by the running or last pass
+        std::size_t reused = 0;            // Unchanged files kept by the last update
+        std::size_t removed = 0;           // Documents removed by the last update
+        std::size_t binary = 0;            // Files skipped as binary by the last pass
+        std::uint64_t bytes = 0;           // Bytes tokenized by the running or last pass
+        int threads = 0;
+        bool building = false;             // A build, load or update is running
+        bool ready = false;                // Queries can run
+        bool loaded = false;               // The index was read from disk
+        std::chrono::microseconds buildTime{0};    // Duration of the last pass (so far)
+    };
+
+    // Cost of the last query
+    struct QueryStats {
+        std::size_t matches = 0;           // Live documents containing every word
+        std::size_t words = 0;             // Distinct words of the query
+        std::size_t shortest = 0;          // Documents in the rarest word's list
+        std::uint64_t decoded = 0;         // Postings decoded by the intersection
+        std::string rarest;                // Word with the shortest list (lowercase)
+        std::chrono::microseconds time{0};
+    };
+
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    TextIndex() = default;
+
+    // Destructor - stops the running build, load or update
+    ~TextIndex();
+
+    TextIndex(const TextIndex&) = delete;
+    TextIndex& operator=(const TextIndex&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Index a folder tree in the background and save it to GetIndexPath(root)
+    // (the current index stays usable until the new one is complete)
+    // @param root    Folder to index
+    // @param threads Worker threads (0 = EntrySorter::DefaultThreadCount())
+    void StartBuild(const std::filesystem::path& root, int threads = 0);
+
+    // Re-read the changed files of the current root in the background and
+    // save the index if anything changed
+    // @param threads Worker threads (0 = EntrySorter::DefaultThreadCount())
+    void StartUpdate(int threads = 0);
+
+    // Load the saved index of a folder in the background
+    // @param root   Folder indexed by a previous build
+    // @param update Bring the index up to date after loading
+    void StartLoad(const std::filesystem::path& root, bool update);
+
+    // Get the state of the index
+    Stats GetStats() const;
+
+    // Get the indexed folder (empty before the first build or load)
+    std::filesystem::path GetRoot() const;
+
+    // Find the documents containing every word of a query (call from one
+    // thread only; words shorter than kMinWord or longer than kMaxWord are
+    // ignored)
+    // @param text UTF-8 words separated by anything that is not a word
+    // @return Matching documents in ascending order (valid until the next call)
+    const std::vector<DocId>& Query(const std::string& text);
+
+    // Get the cost of the last query
+    const QueryStats& GetLastQueryStats() const { return m_queryStats; }
+
+    // Get the path of a document relative to the root
+    // @param doc Document from Query()
+    // @return UTF-8 path, or an empty string for an unknown document
+    std::string GetPath(DocId doc) const;
+
+    // Block until the running build, load or update has finished
+    void WaitIdle();
+
+    // Location of the index file of a folder (in the cache folder)
+    static std::filesystem::path GetIndexPath(const std::filesystem::path& root);
+
+    // Find the nearest folder at or above a folder that has a saved index
+    // @return The indexed folder, or an empty path
+    static std::filesystem::path FindIndexedRoot(const std::filesystem::path& folder);
+
+private:
+    // Entry in a word's skip table: the document before a block of postings
+    // and the byte offset of the block
+    struct Skip {
+        DocId doc;
+        std::uint32_t offset;
+    };
+
+    // Postings of one word
+    struct Postings {
+        std::vector<std::uint8_t> bytes;           // Document deltas as varints
+        std::vector<Skip> skips;                   // One per block of kSkipInterval postings
+        std::uint32_t count = 0;
+        DocId last = 0;                            // Last document appended
+
+        void Append(DocId doc);
+        std::size_t MemoryBytes() const;
+    };
+
+    // Sequential reader of a postings list
+    class Cursor;
+
+    // File found by a walk
+    struct FileInfo {
+        std::filesystem::path path;
+        std::string relative;                      // UTF-8 path relative to the root
+        std::uint64_t size;
+        std::int64_t time;                         // Modification time (ns since the epoch)
+    };
+
+    // The indexed documents and words; replaced as a whole by a build or load
+    struct Data {
+        std::filesystem::path root;
+        std::vector<std::string> paths;            // UTF-8 paths relative to the root
+        std::vector<std::uint64_t> sizes;
+        std::vector<std::int64_t> times;
+        std::vector<std::uint8_t> deleted;         // 1 for a deleted document
+        std::unordered_map<std::string, Postings> words;
+        std::size_t deletedCount = 0;
+        std::uint64_t postingCount = 0;            // Including the postings of deleted documents
+        std::size_t postingBytes = 0;              // Set by Measure()
+        std::size_t memoryBytes = 0;               // Set by Measure()
+
+        DocId Count() const { return (DocId)paths.size(); }
+
+        // Recompute postingBytes and memoryBytes (walks every word)
+        void Measure();
+    };
+
+    // Postings of the files tokenized by one worker
+    struct Segment;
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    mutable std::shared_mutex m_dataMutex;     // Readers: queries; writers: swap and updates
+    std::unique_ptr<Data> m_data;
+    std::uint64_t m_dataGeneration = 0;        // Guarded by m_dataMutex
+
+    std::thread m_worker;                      // Build, load or update
+    std::atomic<bool> m_cancel{false};
+
+    mutable std::mutex m_statsMutex;
+    std::condition_variable m_idleCv;
+    Stats m_stats;
+    std::chrono::steady_clock::time_point m_passStart;
+
+    // Query state (query thread only)
+    std::vector<DocId> m_matches;
+    QueryStats m_queryStats;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Stop the running pass and mark a new one as started
+    void BeginPass(int threads);
+
+    // Mark the running pass as finished
+    void EndPass(std::chrono::microseconds time);
+
+    // Walk a folder tree with several threads
+    // @return False if the root cannot be listed or the walk was cancelled
+    bool Walk(const std::filesystem::path& root, int threads, std::vector<FileInfo>& out);
+
+    // Tokenize files in parallel; files[k] becomes document firstDoc + k
+    // @param words Receives the postings (appended; documents must be new)
+    // @return False if cancelled
+    bool Tokenize(const std::vector<FileInfo>& files, DocId firstDoc, int threads,
+                  std::unordered_map<std::string, Postings>& words, std::uint64_t& postings);
+
+    // Worker: bring a loaded or built index up to date (under the exclusive
+    // lock only while applying the changes)
+    // @return True if the index changed
+    bool Update(int threads);
+
+    // Drop deleted documents and renumber the rest
+    static void Compact(Data& data);
+
+    // Replace the index
+    void Install(std::unique_ptr<Data> data);
+
+    // Write a Data to disk (temporary file, then rename)
+    static bool Write(const Data& data, const std::filesystem::path& file);
+
+    // Read a Data written by Write()
+    static std::unique_ptr<Data> Read(const std::filesystem::path& file);
+};
@@ -0,0 +1,225 @@
+// Treemap.hpp
+// Disk usage treemap model and layout for FileMgr
+//
+// Scans a folder tree in the background and keeps every file and folder as
+// a node with its total size; folder sizes grow while the scan runs. A
+// layout thread turns the tree into nested rectangles whose areas are
+// proportional to the sizes, using the squarified algorithm (Bruls, Huizing
+// and van Wijk), so rectangles stay close to square and remain clickable.
+//
+// The layout is level-of-detail culled: a folder is only subdivided while
+// its rectangle is large enough to show its contents, and the children of
+// a folder that would be smaller than a few pixels are merged into one
+// "small items" rectangle. The number of rectangles is therefore bounded
+// by the viewport area, not by the number of nodes, and a tree with a
+// million nodes lays out in milliseconds. The layout is recomputed a few
+// times per second while the scan runs, and when the viewport or the
+// focused folder changes; the UI thread only draws the latest result.
+//
+// Sizes are the file sizes reported by the directory listing; hard links
+// are not de-duplicated. Symbolic links and junctions count as empty files
+// and are not followed.
+//
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Treemap class
+// -----------------------------------------------------------------------------
+class Treemap {
+public:
+    using NodeId = std::uint32_t;
+
+    static constexpr NodeId kRoot = 0;
+    static constexpr NodeId kNoNode = ~NodeId(0);
+
+    // Rect flags
+    static constexpr std::uint16_t kRectFolder = 1;    // Node is a folder
+    static constexpr std::uint16_t kRectSmall = 2;     // Merged small children of node
+
+    // One rectangle of a layout (parents come before their children)
+    struct Rect {
+        float x0, y0, x1, y1;              // Viewport coordinates
+        NodeId node;
+        std::uint32_t color;               // Packed 0xAABBGGRR (ImU32 byte order)
+        std::uint32_t label;               // Offset in Layout::labels, or ~0 for no label
+        std::uint16_t depth;               // Nesting level below the focused folder
+        std::uint16_t flags;
+    };
+
+    // A complete layout of the focused folder
+    struct Layout {
+        std::uint64_t generation = 0;      // Bumped for every layout
+        float width = 0.0f, height = 0.0f; // Viewport it was computed for
+        NodeId focus = kRoot;
+        std::vector<Rect> rects;
+        std::vector<char> labels;          // UTF-8 names, '\0'-terminated
+        std::size_t culled = 0;            // Nodes merged into small-item rectangles
+        std::chrono::microseconds time{0}; // Layout duration
+    };
+
+    // State of the scan and the layout
+    struct Stats {
+        std::size_t files = 0;
+        std::size_t folders = 0;
+        std::uint64_t bytes = 0;
+        std::size_t memoryBytes = 0;       // Nodes and names
+        int threads = 0;
+        bool scanning = false;
+        std::chrono::microseconds scanTime{0};
+        std::size_t layouts = 0;           // Layouts computed for this scan
+    };
+
+    // -------------------------------------------------------------------------
+    // Construction / Destruction
+    // -------------------------------------------------------------------------
+
+    // Constructor - starts the layout thread
+    Treemap();
+
+    // Destructor - stops the scan and the layout thread
+    ~Treemap();
+
+    Treemap(const Treemap&) = delete;
+    Treemap& operator=(const Treemap&) = delete;
+
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Scan a folder tree in the background, replacing the current tree
+    // @param root    Folder to scan (becomes kRoot and the focus)
+    // @param threads Scan threads (0 = EntrySorter::DefaultThreadCount())
+    void Start(const std::filesystem::path& root, int threads = 0);
+
+    // Stop the scan (the tree keeps what was found)
+    void Cancel();
+
+    // Set the size of the area to lay out (relayouts if it changed)
+    // @param width       Viewport width in pixels
+    // @param height      Viewport height in pixels
+    // @param labelHeight Height of a line of text (folders get a title band)
+    void SetViewport(float width, float height, float labelHeight);
+
+    // Lay out a folder instead of the root
+    // @param node Folder node (kRoot for the whole tree)
+    void SetFocus(NodeId node);
+
+    // Get the focused folder
+    NodeId GetFocus() const { return m_focus.load(); }
+
+    // Get the latest layout (never null; empty before the first layout)
+    std::shared_ptr<const Layout> GetLayout() const;
+
+    // Get the scanned folder
+    const std::filesystem::path& GetRoot() const { return m_root; }
+
+    // Get the full path of a node
+    std::filesystem::path GetPath(NodeId node) const;
+
+    // Get the parent folder of a node (kNoNode for the root)
+    NodeId GetParent(NodeId node) const;
+
+    // Get the total size of a node
+    std::uint64_t GetSize(NodeId node) const;
+
+    // Check whether a node is a folder
+    bool IsFolder(NodeId node) const;
+
+    // Get the state of the scan and the layout
+    Stats GetStats() const;
+
+    // Block until the scan has finished
+    void WaitScan();
+
+private:
+    // A file or folder; the children of a folder are contiguous
+    struct Node {
+        NodeId parent;
+        NodeId first;                      // First child (folders)
+        std::uint32_t count;               // Number of children
+        std::uint32_t name;                // Offset in m_names
+        std::uint64_t size;                // File size, or total of the subtree
+        std::uint32_t flags;
+    };
+
+    // A child waiting to be placed by Squarify()
+    struct Item {
+        NodeId node;
+        std::uint64_t size;
+    };
+
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    mutable std::shared_mutex m_treeMutex;     // Scan workers: exclusive; layout and queries: shared
+    std::vector<Node> m_nodes;
+    std::vector<char> m_names;                 // UTF-8 names, '\0'-terminated
+    std::filesystem::path m_root;
+    std::uint64_t m_treeGeneration = 0;        // Bumped when nodes are added (guarded by m_treeMutex)
+
+    std::thread m_scanThread;
+    std::atomic<bool> m_cancel{false};
+    std::atomic<bool> m_scanning{false};
+    std::chrono::steady_clock::time_point m_scanStart;
+    std::atomic<std::int64_t> m_scanTime{0};   // Microseconds, set when the scan ends
+    std::atomic<std::size_t> m_files{0};
+    std::atomic<std::size_t> m_folders{0};
+    int m_threads = 0;
+
+    std::thread m_layoutThread;
+    mutable std::mutex m_layoutMutex;          // Guards the request fields and m_layout
+    std::condition_variable m_layoutCv;
+    bool m_stopLayout = false;
+    bool m_layoutRequested = false;
+    float m_width = 0.0f, m_height = 0.0f, m_labelHeight = 0.0f;
+    std::atomic<NodeId> m_focus{kRoot};
+    std::shared_ptr<const Layout> m_layout;
+    std::size_t m_layoutCount = 0;
+    std::uint64_t m_layoutGeneration = 0;
+    std::uint64_t m_scanId = 0;                // Bumped by Start() after the new tree is in place
+
+    // Layout thread scratch (reused between layouts)
+    std::vector<Item> m_items;
+    std::vector<Rect> m_childRects;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Scan thread: walk the tree with several workers
+    void ScanLoop(std::filesystem::path root, int threads);
+
+    // Layout thread: recompute the layout when requested or while scanning
+    void LayoutLoop();
+
+    // Wake the layout thread
+    void RequestLayout();
+
+    // Compute a layout of the focused folder (takes the shared tree lock)
+    // @return Tree generation the layout reflects
+    std::uint64_t ComputeLayout(Layout& layout, float width, float height, float labelHeight);
+
+    // Add a node's rectangle and lay out its children inside it
+    void LayoutNode(Layout& layout, NodeId node, float x0, float y0, float x1, float y1, int depth,
+                    float labelHeight);
+
+    // Place items [first, last) of m_items (sorted by size, descending) in a
+    // rectangle; the results are appended to m_childRects
+    void Squarify(std::size_t first, std::size_t last, double total, float x0, float y0, float x1, float y1);
+
+    // Get the name of a node (tree lock held)
+    const char* NameOf(NodeId node) const { return m_names.data() + m_nodes[node].name; }
+};
@@ -0,0 +1,90 @@
+// TreemapPanel.hpp
+// "Disk Usage" treemap pane for FileMgr
+//
+// Shows the Treemap of a folder in a pane to the right of the file list.
+// The scan and the layout run on their own threads; every frame the pane
+// only tells the Treemap its size and draws the latest layout with the
+// window draw list, so it stays interactive while a large tree is scanned.
+// Rectangles smaller than a pixel are skipped, borders and labels are only
+// drawn where they fit, and a layout computed for a slightly different size
+// is stretched until the new one arrives.
+//
+// Clicking a rectangle opens its folder (or the folder of a file) in the
+// file list; right-clicking a folder zooms the treemap into it and "Up"
+// zooms back out. The hovered rectangle is outlined and its path and size
+// are shown in a tooltip.
+//
+#pragma once
+
+#include <imgui.h>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include "Treemap.hpp"
+
+// -----------------------------------------------------------------------------
+// TreemapPanel class
+// -----------------------------------------------------------------------------
+class TreemapPanel {
+public:
+    // -------------------------------------------------------------------------
+    // Public API
+    // -------------------------------------------------------------------------
+
+    // Show the pane, scanning a folder unless it is the one already shown
+    // @param current Folder of the file list
+    void Open(const std::filesystem::path& current);
+
+    // Hide the pane (the tree is kept)
+    void Close() { m_open = false; }
+
+    // Check whether the pane is shown
+    bool IsOpen() const { return m_open; }
+
+    // Draw the pane into the current window or child
+    // @param current Folder of the file list ("Scan this folder" refers to it)
+    void Draw(const std::filesystem::path& current);
+
+    // Draw scan and layout statistics (for the statistics window)
+    void DrawStats();
+
+    // Set callback for opening a folder in the file list
+    // @param callback Function called with the full path of the folder
+    void SetOnNavigate(std::function<void(const std::filesystem::path&)> callback) {
+        m_onNavigate = callback;
+    }
+
+private:
+    // -------------------------------------------------------------------------
+    // Member variables
+    // -------------------------------------------------------------------------
+
+    Treemap m_treemap;
+    bool m_open = false;
+    bool m_scanned = false;                    // A scan has been started
+    Treemap::NodeId m_shownFocus = Treemap::kNoNode;   // Focus m_focusLabel belongs to
+    std::string m_focusLabel;                  // Focused folder as UTF-8
+
+    // Hovered rectangle (path looked up when the rectangle changes)
+    Treemap::NodeId m_hoverNode = Treemap::kNoNode;
+    std::uint16_t m_hoverFlags = 0;
+    std::uint64_t m_hoverLayout = 0;           // Layout generation of the cached values
+    std::string m_hoverPath;
+    std::uint64_t m_hoverSize = 0;
+
+    std::function<void(const std::filesystem::path&)> m_onNavigate;
+
+    // -------------------------------------------------------------------------
+    // Private methods
+    // -------------------------------------------------------------------------
+
+    // Scan a folder and forget the cached labels
+    void StartScan(const std::filesystem::path& root);
+
+    // Draw the layout and handle hover and clicks
+    void DrawCanvas();
+
+    // Get the folder a rectangle stands for (a file stands for its folder)
+    Treemap::NodeId FolderOf(Treemap::NodeId node, std::uint16_t flags) const;
+};
@@ -0,0 +1,48 @@
+// WatchTest.hpp
+// Change notification consistency test for FileMgr (--watch-test)
+//
+// Drives DirWatcher, DirScanner and ListingDiff headless the way the main
+// loop and FileList do: a folder and one subfolder below it are watched,
+// every reported change of the folder re-reads it (queued behind a running
+// scan) and the new listing is merged into the shown one through a
+// ListingDiff, and every reported change of the subfolder re-reads the
+// subfolder like an expanded sidebar node. Meanwhile writer threads create,
+// rewrite and delete files in both at a high rate. When the writers stop
+// and the last changes have been reported, the shown listings must match
+// the disk exactly (names, types and sizes); the test exits nonzero if they
+// do not, or if a merge did not account for every entry.
+//
+#pragma once
+
+#include <filesystem>
+
+class EntryStore;
+
+// -----------------------------------------------------------------------------
+// WatchTest class
+// -----------------------------------------------------------------------------
+class WatchTest {
+public:
+    // Test parameters
+    struct Options {
+        int names = 2000;                  // Distinct file names the writers use
+        int writers = 2;                   // Writer threads
+        int seconds = 5;                   // How long the writers run
+        int settleMs = 3000;               // Quiet time that ends the test after the writers stop
+    };
+
+    // Run the test and log the results
+    // @param dir     Folder for the test files (emptied first)
+    // @param options Test parameters
+    // @return Process exit code (0 if the listings match the disk)
+    static int Run(const std::filesystem::path& dir, const Options& options);
+
+private:
+    // Read a folder synchronously into a sorted store
+    static EntryStore ReadFolder(const std::filesystem::path& folder);
+
+    // Compare two sorted listings by name, type and size
+    // @param label Name of the listing for the log
+    // @return True if they are equal
+    static bool SameListing(const char* label, const EntryStore& shown, const EntryStore& disk);
+};
@@ -0,0 +1,47 @@
+// XxHash64.hpp
+// 64-bit xxHash (XXH64) for FileMgr
+//
+// A fast non-cryptographic hash for comparing file contents. XXH64 reads
+// 32 bytes per round into four independent lanes, so it runs at several
+// gigabytes per second on one core (faster than the disk in practice) and
+// produces the same values as the reference implementation, so hashes can
+// be checked with the xxhsum tool. It is not collision resistant against
+// crafted input; callers that act on a match (deleting a duplicate) must
+// compare the bytes first.
+//
+// Data can be hashed in one call or streamed through Update() in pieces of
+// any size.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// -----------------------------------------------------------------------------
+// XxHash64 class
+// -----------------------------------------------------------------------------
+class XxHash64 {
+public:
+    // Start a hash
+    // @param seed Seed value (0 for the standard hash)
+    explicit XxHash64(std::uint64_t seed = 0) { Reset(seed); }
+
+    // Restart with a new seed
+    void Reset(std::uint64_t seed = 0);
+
+    // Add data to the hash
+    void Update(const void* data, std::size_t size);
+
+    // Get the hash of the data added so far (more data can still be added)
+    std::uint64_t Digest() const;
+
+    // Hash a block of memory in one call
+    static std::uint64_t Hash(const void* data, std::size_t size, std::uint64_t seed = 0);
+
+private:
+    std::uint64_t m_lanes[4];
+    std::uint64_t m_seed = 0;
+    std::uint64_t m_total = 0;                 // Bytes added
+    unsigned char m_buffer[32];                // Bytes of an incomplete round
+    std::size_t m_buffered = 0;
+};
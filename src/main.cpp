@@ -10,6 +10,49 @@
 // - Navigation history (back/forward)
 // - Windows shell integration for file opening
 // - Custom icon loading and caching
+// - Persistent listing cache for instant cold start
+// - Automatic refresh from filesystem change notifications (polling on network drives)
+// - Allocation-free steady-state frames (heap allocation counter in Statistics)
+// 
+// Command line:
+// --console            Write log output to the console
+// --cold-start         Ignore the listing cache (cold start comparison)
+// --startup-benchmark  Exit after the first populated frame
+// --text-index-benchmark <folder>
+//                      Benchmark the text index on a synthetic corpus in
+//                      <folder> (created on the first run) and exit
+// --search-benchmark <folder>
+//                      Benchmark content search on a synthetic corpus of
+//                      several GB in <folder> (created on the first run),
+//                      check the matches and exit
+// --name-index-benchmark <folder>
+//                      Benchmark the file name index on a generated tree
+//                      of 5M files in <folder> (created on the first run):
+//                      build time, bytes per file, query latency; then exit
+// --duplicate-benchmark <folder>
+//                      Benchmark the duplicate finder on a synthetic tree
+//                      with planted duplicates in <folder> and exit
+// --dedupe-benchmark <folder>
+//                      Deduplicate a fresh synthetic tree in <folder> with
+//                      clones, then hard links, check it and exit (use a
+//                      btrfs or XFS folder to test clones)
+// --scan-benchmark <folder>
+//                      Scan a generated folder of 1M files in <folder>
+//                      headless, check the time to the first row and the
+//                      total scan time, compare the enumeration
+//                      backends and exit
+// --memory-benchmark   Report the bytes per entry of a 1M-entry listing in
+//                      the old full-path layout and in EntryStore, and exit
+// --frame-benchmark    Time headless file list frames with 10, 10k and 1M
+//                      entries (us per frame) and exit
+// --filter-benchmark   Type into the filter box of a 1M-entry list; exit
+//                      nonzero if a keystroke takes longer than one frame
+// --fuzzy-benchmark    Type queries into the fuzzy finder over 1M synthetic
+//                      paths, report the latency per keystroke and exit
+// --watch-test <folder>
+//                      Create and delete files in <folder> at a high rate
+//                      while watching it; exit nonzero if the refreshed
+//                      listing does not match the disk
 // 
 // Build requirements:
 // - C++17 compiler
@@ -23,12 +66,31 @@
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <filesystem>
+#include <chrono>
 #include "include/log.hpp"
 #include <windows.h>
 bool g_ConsoleOutput = false;
 #include "include/SidebarTree.hpp"
 #include "include/FileList.hpp"
 #include "include/IconCache.hpp"
+#include "include/ListingStore.hpp"
+#include "include/DirWatcher.hpp"
+#include "include/AllocCounter.hpp"
+#include "include/QuickOpen.hpp"
+#include "include/SearchPanel.hpp"
+#include "include/IndexPanel.hpp"
+#include "include/TreemapPanel.hpp"
+#include "include/DuplicatePanel.hpp"
+#include "include/ChunkPanel.hpp"
+#include "include/ManifestPanel.hpp"
+#include "include/TextBenchmark.hpp"
+#include "include/SearchBenchmark.hpp"
+#include "include/NameBenchmark.hpp"
+#include "include/DuplicateBenchmark.hpp"
+#include "include/ScanBenchmark.hpp"
+#include "include/ListBenchmark.hpp"
+#include "include/WatchTest.hpp"
+#include "include/FuzzyBenchmark.hpp"
 
 // Global clear color for background
 static float g_ClearColor[3] = {0.94f, 0.94f, 0.94f};
@@ -216,12 +278,137 @@ void SetDarkTheme()
 
 int main(int argc, char **argv)
 {
+    // 启动计时：从进程入口到第一帧显示出文件列表
+    const auto launchTime = std::chrono::steady_clock::now();
+
+    bool coldStart = false;
+    bool startupBenchmark = false;
+    bool memoryBenchmark = false;
+    bool frameBenchmark = false;
+    bool filterBenchmark = false;
+    bool fuzzyBenchmark = false;
+    std::filesystem::path textBenchmarkDir;
+    std::filesystem::path searchBenchmarkDir;
+    std::filesystem::path nameBenchmarkDir;
+    std::filesystem::path duplicateBenchmarkDir;
+    std::filesystem::path dedupeBenchmarkDir;
+    std::filesystem::path scanBenchmarkDir;
+    std::filesystem::path watchTestDir;
     for (int i = 1; i < argc; ++i)
     {
         if (strcmp(argv[i], "--console") == 0)
         {
             g_ConsoleOutput = true;
         }
+        else if (strcmp(argv[i], "--cold-start") == 0)
+        {
+            coldStart = true;
+        }
+        else if (strcmp(argv[i], "--startup-benchmark") == 0)
+        {
+            startupBenchmark = true;
+        }
+        else if (strcmp(argv[i], "--text-index-benchmark") == 0 && i + 1 < argc)
+        {
+            textBenchmarkDir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--search-benchmark") == 0 && i + 1 < argc)
+        {
+            searchBenchmarkDir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--name-index-benchmark") == 0 && i + 1 < argc)
+        {
+            nameBenchmarkDir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--duplicate-benchmark") == 0 && i + 1 < argc)
+        {
+            duplicateBenchmarkDir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--dedupe-benchmark") == 0 && i + 1 < argc)
+        {
+            dedupeBenchmarkDir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--memory-benchmark") == 0)
+        {
+            memoryBenchmark = true;
+        }
+        else if (strcmp(argv[i], "--frame-benchmark") == 0)
+        {
+            frameBenchmark = true;
+        }
+        else if (strcmp(argv[i], "--filter-benchmark") == 0)
+        {
+            filterBenchmark = true;
+        }
+        else if (strcmp(argv[i], "--fuzzy-benchmark") == 0)
+        {
+            fuzzyBenchmark = true;
+        }
+        else if (strcmp(argv[i], "--scan-benchmark") == 0 && i + 1 < argc)
+        {
+            scanBenchmarkDir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--watch-test") == 0 && i + 1 < argc)
+        {
+            watchTestDir = argv[++i];
+        }
+    }
+
+    // 文本索引基准测试不需要窗口，结果输出到控制台
+    if (!textBenchmarkDir.empty())
+    {
+        g_ConsoleOutput = true;
+        return TextBenchmark::Run(textBenchmarkDir, TextBenchmark::Options());
+    }
+    if (!searchBenchmarkDir.empty())
+    {
+        g_ConsoleOutput = true;
+        return SearchBenchmark::Run(searchBenchmarkDir, SearchBenchmark::Options());
+    }
+    if (!nameBenchmarkDir.empty())
+    {
+        g_ConsoleOutput = true;
+        return NameBenchmark::Run(nameBenchmarkDir, NameBenchmark::Options());
+    }
+    if (!duplicateBenchmarkDir.empty())
+    {
+        g_ConsoleOutput = true;
+        return DuplicateBenchmark::Run(duplicateBenchmarkDir, DuplicateBenchmark::Options());
+    }
+    if (!dedupeBenchmarkDir.empty())
+    {
+        g_ConsoleOutput = true;
+        return DuplicateBenchmark::RunDedupe(dedupeBenchmarkDir, DuplicateBenchmark::Options());
+    }
+    if (!scanBenchmarkDir.empty())
+    {
+        g_ConsoleOutput = true;
+        return ScanBenchmark::Run(scanBenchmarkDir, ScanBenchmark::Options());
+    }
+    if (memoryBenchmark)
+    {
+        g_ConsoleOutput = true;
+        return ListBenchmark::RunMemory(ListBenchmark::Options());
+    }
+    if (frameBenchmark)
+    {
+        g_ConsoleOutput = true;
+        return ListBenchmark::RunFrames(ListBenchmark::Options());
+    }
+    if (filterBenchmark)
+    {
+        g_ConsoleOutput = true;
+        return ListBenchmark::RunFilter(ListBenchmark::Options());
+    }
+    if (fuzzyBenchmark)
+    {
+        g_ConsoleOutput = true;
+        return FuzzyBenchmark::Run(FuzzyBenchmark::Options());
+    }
+    if (!watchTestDir.empty())
+    {
+        g_ConsoleOutput = true;
+        return WatchTest::Run(watchTestDir, WatchTest::Options());
     }
 
     // Initialize GLFW
@@ -243,6 +430,8 @@ int main(int argc, char **argv)
 
     // Initialize ImGui
     IMGUI_CHECKVERSION();
+    // ImGui allocations go through the same counters as operator new
+    ImGui::SetAllocatorFunctions(AllocCounter::ImGuiAlloc, AllocCounter::ImGuiFree);
     ImGui::CreateContext();
     ImGuiIO &io = ImGui::GetIO();
     (void)io;
@@ -285,20 +474,93 @@ int main(int argc, char **argv)
         LOG_ERROR("Failed to load button icons: %s", e.what());
     }
 
-    // Create sidebar tree and file list, passing the icon cache
-    SidebarTree sidebar(&iconCache);
-    FileList fileList(&iconCache);
+    // Map the listing cache written by the previous session
+    const std::filesystem::path listingCachePath = ListingStore::GetDefaultPath();
+    ListingStore listingStore;
+    if (!coldStart)
+        listingStore.Open(listingCachePath);
+    const bool warmStart = listingStore.IsOpen();
+
+    // Create file list and sidebar tree; both paint from the listing cache first
+    // and share one snapshot cache
+    FileList fileList(&iconCache, &listingStore);
+    SidebarTree sidebar(&iconCache, &fileList.GetSnapshotCache(), &listingStore);
 
     // Set callback when a folder is selected in the sidebar
     sidebar.SetOnFolderSelected([&](const std::filesystem::path &folder)
                                 { fileList.RequestNavigation(folder); });
 
-    // Initially set file list to current working directory
-    fileList.NavigateTo(std::filesystem::current_path());
+    // Warm the listing of sidebar folders the mouse rests on
+    sidebar.SetOnFolderHovered([&](const std::filesystem::path &folder)
+                               { fileList.RequestPrefetch(folder); });
+
+    // Watch the current folder and the expanded sidebar nodes; bursts of
+    // changes are debounced into one incremental refresh per folder
+    DirWatcher dirWatcher;
+    std::filesystem::path watchedPath;
+    std::uint64_t watchedGeneration = ~0ULL;
+    std::vector<std::filesystem::path> changedDirs;
+
+    // Ctrl+P go-to-file window; chosen files open like a double-click
+    QuickOpen quickOpen;
+    quickOpen.SetOnOpen([&](const std::filesystem::path &path)
+                        { fileList.OpenPath(path); });
+
+    // Ctrl+Shift+F content search below the current folder
+    SearchPanel searchPanel;
+    searchPanel.SetOnOpen([&](const std::filesystem::path &path)
+                          { fileList.OpenPath(path); });
+
+    // Ctrl+E whole-volume name index; matches open like a double-click or
+    // replace the file list as a virtual listing
+    IndexPanel indexPanel;
+    indexPanel.SetOnOpen([&](const std::filesystem::path &path)
+                         { fileList.OpenPath(path); });
+    indexPanel.SetOnShow([&](const std::filesystem::path &root, const std::string &label, EntryStore entries)
+                         { fileList.ShowVirtualListing(root, label, std::move(entries)); });
+    if (!coldStart)
+        indexPanel.LoadSaved();
+
+    // Ctrl+U disk usage treemap next to the file list; clicking a rectangle
+    // opens its folder
+    TreemapPanel treemapPanel;
+    treemapPanel.SetOnNavigate([&](const std::filesystem::path &folder)
+                               { fileList.NavigateTo(folder); });
+
+    // Ctrl+Shift+D duplicate finder below the current folder
+    DuplicatePanel duplicatePanel;
+    duplicatePanel.SetOnOpen([&](const std::filesystem::path &path)
+                             { fileList.OpenPath(path); });
+    duplicatePanel.SetOnNavigate([&](const std::filesystem::path &folder)
+                                 { fileList.NavigateTo(folder); });
+    ChunkPanel chunkPanel;
+    chunkPanel.SetOnNavigate([&](const std::filesystem::path &folder)
+                             { fileList.NavigateTo(folder); });
+
+    // Right-clicking a .sha256 / .md5 file in the list verifies the files it names
+    ManifestPanel manifestPanel;
+    manifestPanel.SetOnNavigate([&](const std::filesystem::path &folder)
+                                { fileList.NavigateTo(folder); });
+    fileList.SetOnVerifyManifest([&](const std::filesystem::path &manifest)
+                                 { manifestPanel.Open(manifest); });
+
+    // Statistics window visibility (View menu)
+    bool showStats = false;
+
+    // Time to first populated frame (negative until measured)
+    double startupMs = -1.0;
+
+    // Heap allocations made by the UI thread during the previous frame
+    AllocCounter::Totals frameAllocs;
+
+    // Path shown in the address bar (re-encoded only when it changes)
+    std::filesystem::path addressPath;
+    bool addressVirtual = false;
 
     // Main loop
     while (!glfwWindowShouldClose(window))
     {
+        const AllocCounter::Totals frameStart = AllocCounter::GetThreadTotals();
         glfwPollEvents();
 
         ImGui_ImplOpenGL3_NewFrame();
@@ -316,6 +578,48 @@ int main(int argc, char **argv)
                     SetDarkTheme();
                 ImGui::EndMenu();
             }
+            if (ImGui::BeginMenu("View"))
+            {
+                if (ImGui::MenuItem("Go to File...", "Ctrl+P"))
+                    quickOpen.Open(fileList.GetCurrentPath());
+                if (ImGui::MenuItem("Find in Files...", "Ctrl+Shift+F"))
+                    searchPanel.Open(fileList.GetCurrentPath());
+                if (ImGui::MenuItem("Name Index...", "Ctrl+E"))
+                    indexPanel.Open(fileList.GetCurrentPath());
+                if (ImGui::MenuItem("Find Duplicates...", "Ctrl+Shift+D"))
+                    duplicatePanel.Open(fileList.GetCurrentPath());
+                if (ImGui::MenuItem("Estimate Block Dedupe...", "Ctrl+Shift+B"))
+                    chunkPanel.Open(fileList.GetCurrentPath());
+                if (ImGui::MenuItem("Disk Usage", "Ctrl+U", treemapPanel.IsOpen()))
+                {
+                    if (treemapPanel.IsOpen())
+                        treemapPanel.Close();
+                    else
+                        treemapPanel.Open(fileList.GetCurrentPath());
+                }
+                ImGui::MenuItem("Statistics", nullptr, &showStats);
+                // 切换目录枚举后端并立即重新扫描，便于在 --console 日志中对比耗时
+                if (ImGui::BeginMenu("Scan Backend"))
+                {
+                    static const struct { const char* label; EnumBackend backend; bool available; } backends[] = {
+                        { "Auto", EnumBackend::Auto, true },
+                        { "Native", EnumBackend::Native, DirEnumerator::IsAvailable(EnumBackend::Native) },
+                        { "io_uring (Linux)", EnumBackend::IoUring, DirEnumerator::IsAvailable(EnumBackend::IoUring) },
+                        { "Portable (std::filesystem)", EnumBackend::Portable, true },
+                    };
+                    EnumBackend current = fileList.GetScanBackend();
+                    for (const auto& item : backends)
+                    {
+                        if (ImGui::MenuItem(item.label, nullptr, current == item.backend, item.available))
+                        {
+                            fileList.SetScanBackend(item.backend);
+                            fileList.Refresh();
+                        }
+                    }
+                    ImGui::EndMenu();
+                }
+                ImGui::EndMenu();
+            }
             ImGui::EndMainMenuBar();
         }
 
@@ -388,8 +692,15 @@ int main(int argc, char **argv)
         ImGui::SameLine();
 
         static char pathBuf[512];
-        strncpy(pathBuf, fileList.GetCurrentPath().string().c_str(), sizeof(pathBuf) - 1);
-        pathBuf[sizeof(pathBuf) - 1] = '\0';
+        if (fileList.GetCurrentPath() != addressPath || fileList.IsVirtual() != addressVirtual)
+        {
+            addressPath = fileList.GetCurrentPath();
+            addressVirtual = fileList.IsVirtual();
+            // 虚拟列表（索引搜索结果）显示其标签而不是根目录
+            strncpy(pathBuf, addressVirtual ? fileList.GetVirtualLabel().c_str() : addressPath.string().c_str(),
+                    sizeof(pathBuf) - 1);
+            pathBuf[sizeof(pathBuf) - 1] = '\0';
+        }
         ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
         if (ImGui::InputText("##Address", pathBuf, sizeof(pathBuf), ImGuiInputTextFlags_EnterReturnsTrue))
         {
@@ -412,6 +723,9 @@ int main(int argc, char **argv)
                 LOG_ERROR("Error parsing path: %s", e.what());
             }
         }
+        // 放弃编辑时下一帧恢复为当前路径
+        if (ImGui::IsItemDeactivated())
+            addressPath.clear();
 
         ImGui::Separator();
 
@@ -428,14 +742,119 @@ int main(int argc, char **argv)
 
         ImGui::NextColumn();
 
-        // Right column: File list
-        ImGui::BeginChild("FileList", ImVec2(0, 0), true);
-        fileList.Draw();
-        ImGui::EndChild();
+        // Right column: File list, with the disk usage treemap to its right
+        // when shown (the divider can be dragged)
+        if (ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiKey_U, ImGuiInputFlags_RouteGlobal))
+        {
+            if (treemapPanel.IsOpen())
+                treemapPanel.Close();
+            else
+                treemapPanel.Open(fileList.GetCurrentPath());
+        }
+        if (treemapPanel.IsOpen())
+        {
+            ImGui::BeginChild("FileList", ImVec2(ImGui::GetContentRegionAvail().x * 0.55f, 0),
+                              ImGuiChildFlags_Borders | ImGuiChildFlags_ResizeX);
+            fileList.Draw();
+            ImGui::EndChild();
+            ImGui::SameLine();
+            ImGui::BeginChild("DiskUsage", ImVec2(0, 0), true);
+            treemapPanel.Draw(fileList.GetCurrentPath());
+            ImGui::EndChild();
+        }
+        else
+        {
+            ImGui::BeginChild("FileList", ImVec2(0, 0), true);
+            fileList.Draw();
+            ImGui::EndChild();
+        }
 
         ImGui::End(); // MainWindow
         ImGui::PopStyleVar(2);
 
+        // ----- Go to file (Ctrl+P) -----
+        if (ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiKey_P, ImGuiInputFlags_RouteGlobal))
+            quickOpen.Open(fileList.GetCurrentPath());
+        quickOpen.Draw();
+
+        // ----- Find in files (Ctrl+Shift+F) -----
+        if (ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiMod_Shift | ImGuiKey_F, ImGuiInputFlags_RouteGlobal))
+            searchPanel.Open(fileList.GetCurrentPath());
+        searchPanel.Draw();
+
+        // ----- Name index (Ctrl+E) -----
+        if (ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiKey_E, ImGuiInputFlags_RouteGlobal))
+            indexPanel.Open(fileList.GetCurrentPath());
+        indexPanel.Draw();
+
+        // ----- Find duplicates (Ctrl+Shift+D) -----
+        if (ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiMod_Shift | ImGuiKey_D, ImGuiInputFlags_RouteGlobal))
+            duplicatePanel.Open(fileList.GetCurrentPath());
+        duplicatePanel.Draw();
+
+        // ----- Block dedupe estimate (Ctrl+Shift+B) -----
+        if (ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiMod_Shift | ImGuiKey_B, ImGuiInputFlags_RouteGlobal))
+            chunkPanel.Open(fileList.GetCurrentPath());
+        chunkPanel.Draw();
+
+        // ----- Manifest verification (file list context menu) -----
+        manifestPanel.Draw();
+
+        // ----- Filesystem change notifications -----
+        // 监视集合只在当前目录或展开节点变化时更新
+        if (fileList.GetCurrentPath() != watchedPath || sidebar.GetExpandedGeneration() != watchedGeneration)
+        {
+            watchedPath = fileList.GetCurrentPath();
+            watchedGeneration = sidebar.GetExpandedGeneration();
+            std::vector<std::filesystem::path> dirs = sidebar.GetExpandedPaths();
+            dirs.push_back(watchedPath);
+            dirWatcher.SetWatchedDirs(dirs);
+        }
+        if (dirWatcher.Poll(changedDirs))
+        {
+            for (const auto& dir : changedDirs)
+            {
+                sidebar.Invalidate(dir);
+                if (dir == fileList.GetCurrentPath())
+                    fileList.Refresh(); // 增量合并，保留滚动位置和选中项
+            }
+        }
+
+        // ----- Statistics window -----
+        if (showStats)
+        {
+            ImGui::SetNextWindowSize(ImVec2(360, 420), ImGuiCond_FirstUseEver);
+            if (ImGui::Begin("Statistics", &showStats))
+            {
+                ImGui::SeparatorText("Startup");
+                if (startupMs >= 0.0)
+                    ImGui::Text("First populated frame: %.1f ms (%s cache)", startupMs, warmStart ? "warm" : "cold");
+                else
+                    ImGui::TextDisabled("First populated frame: pending");
+                ImGui::SeparatorText("Frame");
+                ImGui::Text("Heap allocations: %llu (%llu bytes)", (unsigned long long)frameAllocs.count,
+                            (unsigned long long)frameAllocs.bytes);
+                fileList.DrawStats();
+                quickOpen.DrawStats();
+                indexPanel.DrawStats();
+                treemapPanel.DrawStats();
+
+                DirWatcher::Stats watch = dirWatcher.GetStats();
+                ImGui::SeparatorText("Change notifications");
+                ImGui::Text("Backend: %s  Watched folders: %d", watch.backend, (int)watch.watched);
+                ImGui::Text("Events: %llu  Refreshes: %llu  Overflows: %llu", (unsigned long long)watch.events,
+                            (unsigned long long)watch.reported, (unsigned long long)watch.overflows);
+                if (watch.polled > 0) {
+                    ImGui::Text("Polled folders: %d  Interval: %.1f-%.1f s", (int)watch.polled, watch.minInterval,
+                                watch.maxInterval);
+                    ImGui::Text("Checks: %llu (%d/s of %d/s)  Changes: %llu  Overdue: %d",
+                                (unsigned long long)watch.polls, watch.pollsLastSecond, watch.statBudget,
+                                (unsigned long long)watch.pollChanges, (int)watch.overdue);
+                }
+            }
+            ImGui::End();
+        }
+
         // Rendering
         ImGui::Render();
         int display_w, display_h;
@@ -446,8 +865,27 @@ int main(int argc, char **argv)
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
         glfwSwapBuffers(window);
+
+        const AllocCounter::Totals frameEnd = AllocCounter::GetThreadTotals();
+        frameAllocs.count = frameEnd.count - frameStart.count;
+        frameAllocs.bytes = frameEnd.bytes - frameStart.bytes;
+
+        // 第一帧显示出目录内容（或确认目录为空）时记录启动耗时
+        if (startupMs < 0.0 && (fileList.GetEntryCount() > 0 || !fileList.IsScanning()))
+        {
+            startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - launchTime).count();
+            LOG_INFO("Startup: first populated frame after %.1f ms (%s cache, %d entries)",
+                     startupMs, warmStart ? "warm" : "cold", (int)fileList.GetEntryCount());
+            if (startupBenchmark)
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
     }
 
+    // Persist listings, expanded sidebar nodes and the current location
+    listingStore.Save(listingCachePath, fileList.GetSnapshotCache().GetAll(),
+                      sidebar.GetExpandedPaths(), fileList.GetCurrentPath());
+    indexPanel.SaveIfChanged();
+
     // Cleanup
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
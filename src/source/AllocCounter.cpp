@@ -0,0 +1,58 @@
+// AllocCounter.cpp
+// Heap allocation counting implementation for FileMgr
+//
+// Key features:
+// - Replacement global operator new/delete (plain and nothrow forms)
+// - Per-thread counters, no locking or atomics on the allocation path
+// - ImGui allocator hooks that share the same counters
+//
+
+#include "../include/AllocCounter.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace {
+    // 每个线程各自计数，界面线程只看自己的分配
+    thread_local AllocCounter::Totals t_totals;
+
+    void* CountedAlloc(std::size_t size) {
+        ++t_totals.count;
+        t_totals.bytes += size;
+        return std::malloc(size ? size : 1);
+    }
+}
+
+AllocCounter::Totals AllocCounter::GetThreadTotals() {
+    return t_totals;
+}
+
+void* AllocCounter::ImGuiAlloc(std::size_t size, void*) {
+    return CountedAlloc(size);
+}
+
+void AllocCounter::ImGuiFree(void* ptr, void*) {
+    std::free(ptr);
+}
+
+// 数组形式和对齐形式的默认实现会转调以下函数，或自成一对，无需替换
+void* operator new(std::size_t size) {
+    if (void* p = CountedAlloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return CountedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
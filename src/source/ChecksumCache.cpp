@@ -0,0 +1,228 @@
+// ChecksumCache.cpp
+// Background file checksum implementation for FileMgr
+//
+// Key features:
+// - Workers start with the first request; newest requests are hashed first
+// - Queued slots that scrolled out of view expire unless pinned
+// - Cache keyed by volume, file id, size and write time, read from the handle
+// - 1 MB sequential reads; a cleared slot stops its read early
+//
+
+#include "../include/ChecksumCache.hpp"
+#include "../include/Common.hpp"
+#include "../include/Sha256.hpp"
+#include "../include/XxHash64.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr std::size_t kChunkSize = 1 << 20;         // 按 1 MB 顺序读取
+    constexpr std::uint64_t kExpireFrames = 3;          // 排队的槽位超过这么多帧没被看到就撤下
+    constexpr std::size_t kMaxCached = 200000;          // 缓存条目上限，超过后清空重来
+}
+
+// -----------------------------------------------------------------------------
+// Construction / Destruction
+// -----------------------------------------------------------------------------
+
+ChecksumCache::ChecksumCache(int threads)
+    : m_threadCount(std::max(1, threads)) {
+    m_stats.threads = m_threadCount;
+}
+
+ChecksumCache::~ChecksumCache() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto& worker : m_workers)
+        worker.join();
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+void ChecksumCache::SetAlgorithm(Algorithm algorithm) {
+    if (algorithm == m_algorithm)
+        return;
+    ClearSlots();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_algorithm = algorithm;
+}
+
+std::uint32_t ChecksumCache::Request(const fs::path& path, bool pinned) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_slots.emplace_back();
+    Slot& slot = m_slots.back();
+    slot.path = path;
+    slot.pinned = pinned;
+    slot.wanted = m_frame;
+    std::uint32_t id = (std::uint32_t)m_slots.size();
+    Enqueue(id);
+    return id;
+}
+
+void ChecksumCache::Pin(std::uint32_t id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (id == 0 || id > m_slots.size())
+        return;
+    Slot& slot = m_slots[id - 1];
+    slot.pinned = true;
+    if (slot.state == State::Idle)
+        Enqueue(id);
+}
+
+ChecksumCache::State ChecksumCache::Get(std::uint32_t id, char* text, std::size_t size) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (id == 0 || id > m_slots.size())
+        return State::Idle;
+    Slot& slot = m_slots[id - 1];
+    slot.wanted = m_frame;
+    // 撤下过的槽位重新回到屏幕上：再排一次队
+    if (slot.state == State::Idle)
+        Enqueue(id);
+    if (slot.state == State::Done && size > 0) {
+        std::size_t length = std::min(std::strlen(slot.text.data()), size - 1);
+        std::memcpy(text, slot.text.data(), length);
+        text[length] = '\0';
+    }
+    return slot.state;
+}
+
+void ChecksumCache::ClearSlots() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_generation;
+    m_slots.clear();
+    m_queue.clear();
+}
+
+ChecksumCache::Stats ChecksumCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.queued = m_queue.size();
+    stats.slots = m_slots.size();
+    stats.cached = m_cache.size();
+    return stats;
+}
+
+// -----------------------------------------------------------------------------
+// Private methods
+// -----------------------------------------------------------------------------
+
+void ChecksumCache::Enqueue(std::uint32_t id) {
+    m_slots[id - 1].state = State::Queued;
+    m_queue.push_back(id);
+    if (m_workers.empty()) {
+        for (int i = 0; i < m_threadCount; ++i)
+            m_workers.emplace_back(&ChecksumCache::WorkerLoop, this);
+    }
+    m_cv.notify_one();
+}
+
+void ChecksumCache::WorkerLoop() {
+    std::vector<char> buffer(kChunkSize);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+        // 从最新的请求取起；太久没被看到又没固定的槽位撤下
+        std::uint32_t id = 0;
+        while (id == 0 && !m_queue.empty()) {
+            std::uint32_t candidate = m_queue.back();
+            m_queue.pop_back();
+            Slot& slot = m_slots[candidate - 1];
+            if (slot.state != State::Queued)
+                continue;
+            if (!slot.pinned && slot.wanted + kExpireFrames < m_frame) {
+                slot.state = State::Idle;
+                continue;
+            }
+            id = candidate;
+        }
+        if (id == 0) {
+            m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            continue;
+        }
+
+        m_slots[id - 1].state = State::Hashing;
+        fs::path path = m_slots[id - 1].path;
+        Algorithm algorithm = m_algorithm;
+        std::uint64_t generation = m_generation;
+        lock.unlock();
+
+        Text text{};
+        bool ok = Compute(path, algorithm, generation, buffer, text);
+
+        lock.lock();
+        // 槽位在计算期间被清掉了：结果只留在缓存里
+        if (generation != m_generation)
+            continue;
+        Slot& slot = m_slots[id - 1];
+        slot.state = ok ? State::Done : State::Failed;
+        slot.text = text;
+    }
+}
+
+bool ChecksumCache::Compute(const fs::path& path, Algorithm algorithm, std::uint64_t generation,
+                            std::vector<char>& buffer, Text& text) {
+    SequentialFile file(path);
+    if (!file.IsOpen()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.failed;
+        return false;
+    }
+
+    Key key{ file.Device(), file.Id(), file.Size(), file.WriteTime(), (int)algorithm };
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_cache.find(key);
+        if (it != m_cache.end()) {
+            text = it->second;
+            ++m_stats.cacheHits;
+            return true;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    XxHash64 xxh;
+    Sha256 sha;
+    std::uint64_t total = 0;
+    for (;;) {
+        // 列表已换掉：不再读完这个文件
+        if (m_stop || generation != m_generation)
+            return false;
+        std::int64_t read = file.Read(buffer.data(), buffer.size());
+        if (read < 0) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.failed;
+            return false;
+        }
+        if (read == 0)
+            break;
+        if (algorithm == Algorithm::Sha256)
+            sha.Update(buffer.data(), (std::size_t)read);
+        else
+            xxh.Update(buffer.data(), (std::size_t)read);
+        total += (std::uint64_t)read;
+    }
+
+    if (algorithm == Algorithm::Sha256) {
+        unsigned char digest[Sha256::kDigestSize];
+        sha.Digest(digest);
+        ToHex(digest, sizeof(digest), text.data());
+    } else {
+        std::snprintf(text.data(), text.size(), "%016llx", (unsigned long long)xxh.Digest());
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.hashed++;
+    m_stats.bytes += total;
+    m_stats.hashTime += ElapsedSince(start);
+    if (m_cache.size() >= kMaxCached)
+        m_cache.clear();
+    m_cache[key] = text;
+    return true;
+}
@@ -0,0 +1,353 @@
+// ChunkEstimator.cpp
+// Block-level deduplication estimate implementation for FileMgr
+//
+// Key features:
+// - FastCDC chunking (gear hash, normalized masks, 2 / 8 / 64 KB)
+// - XXH64 chunk fingerprints in a fixed-size open-addressing table
+// - Content-based sampling when the table is full (memory bounded)
+// - Walk and chunking on one worker pool sharing a stack of items
+// - Bytes and unique bytes per top-level folder while the job runs
+//
+
+#include "../include/ChunkEstimator.hpp"
+#include "../include/Common.hpp"
+#include "../include/EntrySorter.hpp"
+#include "../include/XxHash64.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <array>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr std::size_t kReadSize = 1 << 20;          // 每次读 1 MB
+    constexpr std::size_t kBatchChunks = 1024;          // 攒够这么多块再加锁写入指纹表
+    constexpr int kMaxDepth = 64;                       // 超过该深度的文件夹不再下探
+
+    // FastCDC 论文中平均 8 KB 的掩码：小于平均长度时 15 位，之后 11 位
+    constexpr std::uint64_t kMaskS = 0x0003590703530000ULL;
+    constexpr std::uint64_t kMaskL = 0x0000d90003530000ULL;
+
+    // gear 表：每个字节值一个随机 64 位数（splitmix64，固定种子，结果可复现）
+    const std::array<std::uint64_t, 256>& GearTable() {
+        static const std::array<std::uint64_t, 256> table = [] {
+            std::array<std::uint64_t, 256> gear{};
+            std::uint64_t state = 0x4643444347454152ULL;
+            for (std::uint64_t& value : gear) {
+                std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                value = z ^ (z >> 31);
+            }
+            return gear;
+        }();
+        return table;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Construction / Destruction
+// -----------------------------------------------------------------------------
+
+ChunkEstimator::~ChunkEstimator() {
+    Cancel();
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+void ChunkEstimator::Start(const fs::path& root, const Options& options) {
+    Cancel();
+    m_root = root;
+    m_options = options;
+    m_options.threads = options.threads > 0 ? std::min(options.threads, 64) : EntrySorter::DefaultThreadCount();
+    m_cancel = false;
+    m_sampleShift = 0;
+    m_startTime = std::chrono::steady_clock::now();
+
+    // 表的槽数取不超过内存上限的 2 的幂，装到 3/4 时提高采样
+    int bits = 10;
+    while (bits < 40 && (sizeof(Entry) << (bits + 1)) <= options.memory)
+        ++bits;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_items.assign(1, Item{ root, 0, 0 });
+        m_idle = 0;
+        m_tableBits = bits;
+        m_table.assign((std::size_t)1 << bits, Entry{ 0, 0, 0 });
+        m_table.shrink_to_fit();
+        m_entries = 0;
+        m_sampledBytes = 0;
+        m_folders.assign(1, Folder());
+        m_folderSampled.assign(1, 0);
+        m_stats = Stats();
+        m_stats.capacity = m_table.size() / 4 * 3;
+        m_stats.threads = m_options.threads;
+        m_stats.running = true;
+    }
+    for (int k = 0; k < m_options.threads; ++k)
+        m_workers.emplace_back(&ChunkEstimator::WorkerLoop, this);
+}
+
+void ChunkEstimator::Cancel() {
+    if (m_workers.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancel = true;
+        if (m_stats.running) {
+            m_stats.running = false;
+            m_stats.cancelled = true;
+            m_stats.time = ElapsedSince(m_startTime);
+        }
+    }
+    m_cv.notify_all();
+    for (std::thread& worker : m_workers)
+        worker.join();
+    m_workers.clear();
+}
+
+bool ChunkEstimator::IsRunning() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats.running;
+}
+
+ChunkEstimator::Stats ChunkEstimator::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.sampled = m_entries;
+    stats.sampleShift = m_sampleShift;
+    stats.uniqueBytes = m_sampledBytes << stats.sampleShift;
+    stats.uniqueChunks = (std::uint64_t)m_entries << stats.sampleShift;
+    if (stats.running)
+        stats.time = ElapsedSince(m_startTime);
+    return stats;
+}
+
+void ChunkEstimator::GetFolders(std::vector<Folder>& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out = m_folders;
+    for (std::size_t k = 0; k < out.size(); ++k)
+        out[k].uniqueBytes = m_folderSampled[k] << m_sampleShift;
+}
+
+// -----------------------------------------------------------------------------
+// Worker threads
+// -----------------------------------------------------------------------------
+
+void ChunkEstimator::WorkerLoop() {
+    std::unique_ptr<DirEnumerator> enumerator = DirEnumerator::Create(EnumBackend::Auto);
+    std::vector<char> buffer(kReadSize);
+    std::vector<Chunk> chunks;
+    chunks.reserve(kBatchChunks);
+
+    // 共享栈：文件后压入、先取出，列出的文件夹不会在栈里堆积太多文件
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_cancel) {
+        if (m_items.empty()) {
+            if (++m_idle == m_stats.threads) {
+                if (m_stats.running) {
+                    m_stats.running = false;
+                    m_stats.time = ElapsedSince(m_startTime);
+                    LOG_INFO("Chunk estimate %s: %d files, %.1f MB, %.1f MB unique in %llu chunks (1 in %d sampled, "
+                             "%.2f s)",
+                             m_root.u8string().c_str(), (int)m_stats.files, m_stats.bytes / 1e6,
+                             (m_sampledBytes << m_sampleShift) / 1e6, (unsigned long long)m_stats.chunks,
+                             1 << m_sampleShift, m_stats.time.count() / 1e6);
+                }
+                m_cv.notify_all();
+                break;
+            }
+            m_cv.wait(lock, [&] { return m_cancel || m_idle == m_stats.threads || !m_items.empty(); });
+            if (m_idle == m_stats.threads)
+                break;
+            --m_idle;
+            continue;
+        }
+        Item item = std::move(m_items.back());
+        m_items.pop_back();
+        lock.unlock();
+        if (item.depth < 0)
+            ChunkFile(item, buffer, chunks);
+        else
+            ListFolder(item, *enumerator);
+        lock.lock();
+    }
+}
+
+void ChunkEstimator::ListFolder(const Item& item, DirEnumerator& enumerator) {
+    std::vector<Item> folders, files;
+    std::vector<std::string> names;             // 根目录下的子文件夹各成一组
+    std::error_code ec;
+    enumerator.Enumerate(item.path, [&](std::vector<ScanEntry>& chunk) {
+        if (m_cancel.load(std::memory_order_relaxed))
+            return false;
+        for (auto& se : chunk) {
+            // 符号链接和联接不跟随，也不计入
+            if (se.isLink)
+                continue;
+            if (se.isDirectory) {
+                if (item.depth < kMaxDepth) {
+                    folders.push_back({ item.path / se.name, item.folder, item.depth + 1 });
+                    if (item.depth == 0)
+                        names.push_back(fs::path(se.name).u8string());
+                }
+            } else if (se.size > 0) {
+                files.push_back({ item.path / se.name, item.folder, -1 });
+            }
+        }
+        return true;
+    }, ec);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.folders;
+    for (std::size_t k = 0; k < folders.size(); ++k) {
+        if (item.depth == 0) {
+            folders[k].folder = (std::uint32_t)m_folders.size();
+            m_folders.emplace_back();
+            m_folders.back().name = std::move(names[k]);
+            m_folderSampled.push_back(0);
+        }
+        m_items.push_back(std::move(folders[k]));
+    }
+    for (Item& file : files)
+        m_items.push_back(std::move(file));
+    if (folders.size() + files.size() > 1)
+        m_cv.notify_all();
+    else if (!folders.empty() || !files.empty())
+        m_cv.notify_one();
+}
+
+void ChunkEstimator::ChunkFile(const Item& item, std::vector<char>& buffer, std::vector<Chunk>& chunks) {
+    SequentialFile file(item.path);
+    if (!file.IsOpen()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.failed;
+        return;
+    }
+
+    const std::array<std::uint64_t, 256>& gear = GearTable();
+    XxHash64 hasher;
+    std::uint64_t hash = 0;                     // gear 滚动哈希
+    std::size_t length = 0;                     // 当前块已读的长度
+    std::uint64_t bytes = 0, count = 0;         // 尚未计入统计的字节和块
+    std::uint64_t sampleMask = 0;
+    bool failed = false;
+
+    auto flush = [&] {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.bytes += bytes;
+        m_stats.chunks += count;
+        m_folders[item.folder].bytes += bytes;
+        AddChunks(chunks, item.folder);
+        chunks.clear();
+        bytes = count = 0;
+    };
+    auto cut = [&] {
+        // 指纹 0 表示空槽；低位为 0 的块才进入采样
+        std::uint64_t fingerprint = std::max<std::uint64_t>(hasher.Digest(), 1);
+        ++count;
+        if ((fingerprint & sampleMask) == 0)
+            chunks.push_back({ fingerprint, (std::uint32_t)length });
+        hasher.Reset();
+        hash = 0;
+        length = 0;
+    };
+
+    for (;;) {
+        std::int64_t got = file.Read(buffer.data(), buffer.size());
+        if (got <= 0) {
+            failed = got < 0;
+            break;
+        }
+        sampleMask = ((std::uint64_t)1 << m_sampleShift.load(std::memory_order_relaxed)) - 1;
+        const unsigned char* data = reinterpret_cast<const unsigned char*>(buffer.data());
+        std::size_t size = (std::size_t)got, start = 0, k = 0;
+        while (k < size) {
+            // 最小长度以内不可能切分，直接跳过
+            if (length < kMinChunk) {
+                std::size_t skip = std::min(kMinChunk - length, size - k);
+                k += skip;
+                length += skip;
+                continue;
+            }
+            hash = (hash << 1) + gear[data[k]];
+            ++k;
+            ++length;
+            if ((hash & (length < kAvgChunk ? kMaskS : kMaskL)) == 0 || length >= kMaxChunk) {
+                hasher.Update(data + start, k - start);
+                start = k;
+                cut();
+            }
+        }
+        hasher.Update(data + start, size - start);
+        bytes += size;
+        if (chunks.size() >= kBatchChunks)
+            flush();
+        if (m_cancel.load(std::memory_order_relaxed))
+            return;
+    }
+    if (length > 0)
+        cut();
+    flush();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.files;
+    ++m_folders[item.folder].files;
+    if (failed)
+        ++m_stats.failed;
+}
+
+// -----------------------------------------------------------------------------
+// Fingerprint table
+// -----------------------------------------------------------------------------
+
+void ChunkEstimator::AddChunks(const std::vector<Chunk>& chunks, std::uint32_t folder) {
+    const std::size_t mask = m_table.size() - 1;
+    for (const Chunk& chunk : chunks) {
+        // 采样位数可能在块排队期间提高过
+        if (chunk.fingerprint & (((std::uint64_t)1 << m_sampleShift) - 1))
+            continue;
+        // 低位用于采样，槽位取乘法散列的高位
+        std::size_t slot = (std::size_t)((chunk.fingerprint * 0x9E3779B97F4A7C15ULL) >> (64 - m_tableBits));
+        while (m_table[slot].fingerprint != 0 && m_table[slot].fingerprint != chunk.fingerprint)
+            slot = (slot + 1) & mask;
+        if (m_table[slot].fingerprint != 0)
+            continue;
+        m_table[slot] = { chunk.fingerprint, chunk.size, folder };
+        ++m_entries;
+        m_sampledBytes += chunk.size;
+        m_folderSampled[folder] += chunk.size;
+        while (m_entries > m_stats.capacity)
+            RaiseSampleShift();
+    }
+}
+
+void ChunkEstimator::RaiseSampleShift() {
+    // 只留下指纹多一个低位为 0 的块（约一半），其余移出并按新位置重新插入
+    int shift = m_sampleShift + 1;
+    std::uint64_t sampleMask = ((std::uint64_t)1 << shift) - 1;
+    std::vector<Entry> kept;
+    kept.reserve(m_entries / 2 + 1);
+    for (Entry& entry : m_table) {
+        if (entry.fingerprint == 0)
+            continue;
+        if (entry.fingerprint & sampleMask) {
+            m_sampledBytes -= entry.size;
+            m_folderSampled[entry.folder] -= entry.size;
+        } else {
+            kept.push_back(entry);
+        }
+        entry = Entry{ 0, 0, 0 };
+    }
+    const std::size_t mask = m_table.size() - 1;
+    for (const Entry& entry : kept) {
+        std::size_t slot = (std::size_t)((entry.fingerprint * 0x9E3779B97F4A7C15ULL) >> (64 - m_tableBits));
+        while (m_table[slot].fingerprint != 0)
+            slot = (slot + 1) & mask;
+        m_table[slot] = entry;
+    }
+    m_entries = kept.size();
+    m_sampleShift = shift;
+}
@@ -0,0 +1,168 @@
+// ChunkPanel.cpp
+// "Block Dedupe Estimate" window implementation for FileMgr
+//
+// Key features:
+// - Memory limit and thread controls with Start / Stop
+// - Bytes read, chunks, unique bytes and saving while the job runs
+// - Sampling noted when the fingerprint table overflowed
+// - Per-folder table (ImGuiListClipper), largest first
+//
+
+#include "../include/ChunkPanel.hpp"
+#include "../include/DisplayStrings.hpp"
+#include "../include/EntrySorter.hpp"
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr auto kFoldersInterval = std::chrono::milliseconds(250);    // 运行期间刷新文件夹表的间隔
+    constexpr std::size_t kMemoryLimits[] = { 16u << 20, 64u << 20, 256u << 20, 1024u << 20 };
+
+    // 去重节省的比例
+    double SavingPercent(std::uint64_t bytes, std::uint64_t unique) {
+        return bytes > unique ? 100.0 * (bytes - unique) / bytes : 0.0;
+    }
+}
+
+void ChunkPanel::Open(const fs::path& root) {
+    if (!m_estimator.IsRunning() && root != m_root) {
+        m_root = root;
+        m_rootLabel = root.u8string();
+    }
+    if (m_threads == 0)
+        m_threads = EntrySorter::DefaultThreadCount();
+    m_open = true;
+}
+
+void ChunkPanel::Draw() {
+    if (!m_open)
+        return;
+
+    ImGui::SetNextWindowSize(ImVec2(680, 420), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Block Dedupe Estimate", &m_open)) {
+        ImGui::End();
+        return;
+    }
+
+    // 文件夹表按间隔刷新，任务结束后再取一次最终结果
+    ChunkEstimator::Stats stats = m_estimator.GetStats();
+    bool refresh = stats.running ? std::chrono::steady_clock::now() - m_foldersTime >= kFoldersInterval
+                                 : !m_foldersFinal && !m_estimator.GetRoot().empty();
+    if (refresh) {
+        m_estimator.GetFolders(m_folders);
+        std::stable_sort(m_folders.begin(), m_folders.end(),
+                         [](const ChunkEstimator::Folder& a, const ChunkEstimator::Folder& b) {
+                             return a.bytes > b.bytes;
+                         });
+        m_foldersTime = std::chrono::steady_clock::now();
+        m_foldersFinal = !stats.running;
+    }
+
+    ImGui::SetNextItemWidth(150.0f);
+    ImGui::Combo("Memory", &m_memory, "16 MB table\0" "64 MB table\0" "256 MB table\0" "1 GB table\0");
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Fingerprints kept before the estimate switches to a sample of the chunks");
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(60.0f);
+    if (ImGui::InputInt("Threads", &m_threads, 0))
+        m_threads = std::max(1, std::min(m_threads, 64));
+    ImGui::SameLine();
+    if (stats.running) {
+        if (ImGui::Button("Stop"))
+            m_estimator.Cancel();
+    } else {
+        ImGui::BeginDisabled(m_root.empty());
+        if (ImGui::Button("Estimate"))
+            StartEstimate();
+        ImGui::EndDisabled();
+    }
+
+    ImGui::TextDisabled("In %s", m_rootLabel.c_str());
+    if (stats.running || stats.files > 0) {
+        char bytes[32], unique[32], saved[32];
+        DisplayStrings::FormatSize(stats.bytes, bytes, sizeof(bytes));
+        DisplayStrings::FormatSize(stats.uniqueBytes, unique, sizeof(unique));
+        DisplayStrings::FormatSize(stats.bytes > stats.uniqueBytes ? stats.bytes - stats.uniqueBytes : 0, saved,
+                                   sizeof(saved));
+        double seconds = stats.time.count() / 1e6;
+        ImGui::TextDisabled("%d files in %d folders, %s read (%.0f MB/s), %llu chunks of %.1f KB on average%s",
+                            (int)stats.files, (int)stats.folders, bytes,
+                            seconds > 0 ? stats.bytes / 1e6 / seconds : 0.0, (unsigned long long)stats.chunks,
+                            stats.chunks ? stats.bytes / 1024.0 / stats.chunks : 0.0,
+                            stats.running ? "  (chunking...)" : stats.cancelled ? "  (stopped)" : "");
+        ImGui::Text("%s unique of %s: block dedupe saves %s (%.1f%%)", unique, bytes, saved,
+                    SavingPercent(stats.bytes, stats.uniqueBytes));
+        if (stats.sampleShift > 0) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(estimated from 1 in %d chunks)", 1 << stats.sampleShift);
+        }
+        if (stats.failed > 0) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(%d files unreadable)", (int)stats.failed);
+        }
+    }
+
+    DrawFolders();
+    ImGui::End();
+}
+
+// -----------------------------------------------------------------------------
+// Private methods
+// -----------------------------------------------------------------------------
+
+void ChunkPanel::StartEstimate() {
+    m_folders.clear();
+    m_foldersFinal = false;
+    m_selected = -1;
+    ChunkEstimator::Options options;
+    options.threads = m_threads;
+    options.memory = kMemoryLimits[std::max(0, std::min(m_memory, 3))];
+    m_estimator.Start(m_root, options);
+}
+
+void ChunkPanel::DrawFolders() {
+    if (!ImGui::BeginTable("##folders", 5,
+                           ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_Resizable |
+                               ImGuiTableFlags_ScrollY))
+        return;
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Folder", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Files", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+    ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+    ImGui::TableSetupColumn("Unique", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+    ImGui::TableSetupColumn("Saving", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+    ImGui::TableHeadersRow();
+
+    // 唯一字节记在首次出现的文件夹上，各行之和等于总数
+    ImGuiListClipper clipper;
+    clipper.Begin((int)m_folders.size());
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            const ChunkEstimator::Folder& folder = m_folders[row];
+            char size[32];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::PushID(row);
+            const char* name = folder.name.empty() ? "(files in this folder)" : folder.name.c_str();
+            if (ImGui::Selectable(name, m_selected == row,
+                                  ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowDoubleClick)) {
+                m_selected = row;
+                if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left) && m_onNavigate)
+                    m_onNavigate(m_estimator.GetRoot() / fs::u8path(folder.name));
+            }
+            ImGui::PopID();
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)folder.files);
+            ImGui::TableNextColumn();
+            DisplayStrings::FormatSize(folder.bytes, size, sizeof(size));
+            ImGui::TextUnformatted(size);
+            ImGui::TableNextColumn();
+            DisplayStrings::FormatSize(folder.uniqueBytes, size, sizeof(size));
+            ImGui::TextUnformatted(size);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f%%", SavingPercent(folder.bytes, folder.uniqueBytes));
+        }
+    }
+    ImGui::EndTable();
+}
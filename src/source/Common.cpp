@@ -0,0 +1,110 @@
+// Common.cpp
+// Shared helper implementation for FileMgr
+//
+// Key features:
+// - OS error messages through std::system_category
+// - Lowercase hex digests, with and without allocation
+// - Sequential read-only files with their identity read from the handle
+//
+
+#include "../include/Common.hpp"
+#include <cerrno>
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char kHexDigits[] = "0123456789abcdef";
+}
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+std::string ErrorText(int code) {
+    return std::system_category().message(code);
+}
+
+void ToHex(const unsigned char* digest, std::size_t size, char* text) {
+    for (std::size_t k = 0; k < size; ++k) {
+        text[2 * k] = kHexDigits[digest[k] >> 4];
+        text[2 * k + 1] = kHexDigits[digest[k] & 15];
+    }
+    text[2 * size] = '\0';
+}
+
+std::string ToHex(const unsigned char* digest, std::size_t size) {
+    std::string text(2 * size, '0');
+    for (std::size_t k = 0; k < size; ++k) {
+        text[2 * k] = kHexDigits[digest[k] >> 4];
+        text[2 * k + 1] = kHexDigits[digest[k] & 15];
+    }
+    return text;
+}
+
+// -----------------------------------------------------------------------------
+// SequentialFile
+// -----------------------------------------------------------------------------
+
+SequentialFile::SequentialFile(const fs::path& path) {
+#ifdef _WIN32
+    m_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                           nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    BY_HANDLE_FILE_INFORMATION info;
+    if (m_handle != INVALID_HANDLE_VALUE && GetFileInformationByHandle(m_handle, &info) &&
+        !(info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+        m_device = info.dwVolumeSerialNumber;
+        m_id = ((std::uint64_t)info.nFileIndexHigh << 32) | info.nFileIndexLow;
+        m_size = ((std::uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+        m_writeTime = (std::int64_t)(((std::uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) |
+                                     info.ftLastWriteTime.dwLowDateTime);
+        m_ok = true;
+    }
+#else
+    m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (m_fd >= 0 && ::fstat(m_fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        m_device = (std::uint64_t)st.st_dev;
+        m_id = (std::uint64_t)st.st_ino;
+        m_size = (std::uint64_t)st.st_size;
+        m_writeTime = (std::int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+        m_ok = true;
+#ifdef POSIX_FADV_SEQUENTIAL
+        ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    }
+#endif
+}
+
+SequentialFile::~SequentialFile() {
+#ifdef _WIN32
+    if (m_handle != INVALID_HANDLE_VALUE)
+        CloseHandle(m_handle);
+#else
+    if (m_fd >= 0)
+        ::close(m_fd);
+#endif
+}
+
+std::int64_t SequentialFile::Read(char* data, std::size_t size) {
+#ifdef _WIN32
+    DWORD read = 0;
+    if (!ReadFile(m_handle, data, (DWORD)size, &read, nullptr))
+        return -1;
+    return read;
+#else
+    ssize_t read;
+    do {
+        read = ::read(m_fd, data, size);
+    } while (read < 0 && errno == EINTR);
+    return read;
+#endif
+}
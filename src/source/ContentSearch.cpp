@@ -0,0 +1,481 @@
+// ContentSearch.cpp
+// Multithreaded recursive content search implementation for FileMgr
+//
+// Key features:
+// - Worker pool sharing one folder stack and one file queue
+// - Memory-mapped large files, buffered reads for small ones
+// - SSE2 first/last byte literal scan, case-insensitive for ASCII
+// - Binary files skipped by a NUL byte in the first 8 KB
+// - Matches streamed in batches; cancellation between 4 MB segments
+// - Optional explicit file list (index candidates) instead of a walk
+//
+
+#include "../include/ContentSearch.hpp"
+#include "../include/Common.hpp"
+#include "../include/EntrySorter.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CONTENTSEARCH_SSE2 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr std::size_t kMapThreshold = 1 << 20;      // 大于该大小的文件用内存映射
+    constexpr std::size_t kBinaryProbe = 8192;          // 检查前 8 KB 是否有 NUL
+    constexpr std::size_t kSegment = 4 << 20;           // 每搜索 4 MB 检查一次取消
+    constexpr std::size_t kContextBefore = 80;          // 匹配前保留的字节
+    constexpr std::size_t kContextAfter = 160;          // 匹配后保留的字节
+    constexpr int kMaxDepth = 64;                       // 防止符号链接环无限下探
+
+    // 只折叠 ASCII；UTF-8 多字节字符原样比较
+    inline char FoldCase(char c) {
+        return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+    }
+
+    inline char OtherCase(char c) {
+        if (c >= 'a' && c <= 'z')
+            return char(c - 'a' + 'A');
+        if (c >= 'A' && c <= 'Z')
+            return char(c - 'A' + 'a');
+        return c;
+    }
+
+#ifdef CONTENTSEARCH_SSE2
+    inline int LowestBit(unsigned mask) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (int)index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+#endif
+
+    // 在 text[pos, stop) 中查找字面量；fold 为 true 时 needle 已是小写
+    // @return 第一次出现的位置，没有则返回 stop
+    std::size_t FindLiteral(const char* text, std::size_t pos, std::size_t stop, const std::string& needle, bool fold) {
+        std::size_t n = needle.size();
+        if (stop - pos < n)
+            return stop;
+        auto verify = [&](std::size_t at) {
+            if (!fold)
+                return std::memcmp(text + at + 1, needle.data() + 1, n - 1) == 0;
+            for (std::size_t k = 1; k < n; ++k) {
+                if (FoldCase(text[at + k]) != needle[k])
+                    return false;
+            }
+            return true;
+        };
+
+#ifdef CONTENTSEARCH_SSE2
+        // 16 个位置同时比较首字节和末字节（不区分大小写时两种写法都比较）
+        const char f = needle[0], l = needle[n - 1];
+        const char f2 = fold ? OtherCase(f) : f, l2 = fold ? OtherCase(l) : l;
+        const __m128i first = _mm_set1_epi8(f), first2 = _mm_set1_epi8(f2);
+        const __m128i last = _mm_set1_epi8(l), last2 = _mm_set1_epi8(l2);
+        for (; pos + n - 1 + 16 <= stop; pos += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + pos));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + pos + n - 1));
+            __m128i ma = _mm_or_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(a, first2));
+            __m128i mb = _mm_or_si128(_mm_cmpeq_epi8(b, last), _mm_cmpeq_epi8(b, last2));
+            unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(ma, mb));
+            while (mask) {
+                std::size_t at = pos + LowestBit(mask);
+                if (verify(at))
+                    return at;
+                mask &= mask - 1;
+            }
+        }
+#endif
+        // 剩余部分（或无 SSE2 时）逐个定位首字节
+        for (; pos + n <= stop; ++pos) {
+            if ((fold ? FoldCase(text[pos]) : text[pos]) == needle[0] && verify(pos))
+                return pos;
+        }
+        return stop;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Construction / Destruction
+// -----------------------------------------------------------------------------
+
+ContentSearch::~ContentSearch() {
+    Cancel();
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+void ContentSearch::Start(const fs::path& root, const std::string& literal, const Options& options) {
+    Cancel();
+    if (literal.empty())
+        return;
+
+    m_root = root;
+    m_options = options;
+    m_literal = literal;
+    if (!options.matchCase) {
+        for (char& c : m_literal)
+            c = FoldCase(c);
+    }
+    m_cancel = false;
+    m_full = false;
+    m_matchCount = 0;
+    m_startTime = std::chrono::steady_clock::now();
+
+    int threads = options.threads > 0 ? std::min(options.threads, 64) : EntrySorter::DefaultThreadCount();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_folders.clear();
+        m_files.clear();
+        if (options.files.empty()) {
+            m_folders.push_back({root, std::string(), 0});
+        } else {
+            // 指定了文件列表时不遍历目录
+            for (const std::string& file : options.files)
+                m_files.push_back({root / fs::u8path(file), file, 0});
+        }
+        m_idle = 0;
+        m_done = false;
+        m_pending.Clear();
+        m_stats = Stats();
+        m_stats.threads = threads;
+        m_stats.running = true;
+    }
+    for (int t = 0; t < threads; ++t)
+        m_workers.emplace_back(&ContentSearch::WorkerLoop, this);
+}
+
+void ContentSearch::Cancel() {
+    if (m_workers.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancel = true;
+        if (m_stats.running) {
+            m_stats.running = false;
+            m_stats.cancelled = true;
+            m_stats.time = ElapsedSince(m_startTime);
+        }
+    }
+    m_workCv.notify_all();
+    for (auto& worker : m_workers)
+        worker.join();
+    m_workers.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_folders.clear();
+    m_files.clear();
+}
+
+bool ContentSearch::Poll(Results& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pending.matches.empty())
+        return false;
+    if (out.matches.empty() && out.files.empty()) {
+        out = std::move(m_pending);
+    } else {
+        std::uint32_t base = (std::uint32_t)out.files.size();
+        for (auto& file : m_pending.files)
+            out.files.push_back(std::move(file));
+        for (auto& match : m_pending.matches) {
+            match.file += base;
+            out.matches.push_back(std::move(match));
+        }
+    }
+    m_pending.Clear();
+    return true;
+}
+
+bool ContentSearch::IsRunning() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats.running;
+}
+
+ContentSearch::Stats ContentSearch::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    if (stats.running)
+        stats.time = ElapsedSince(m_startTime);
+    return stats;
+}
+
+// -----------------------------------------------------------------------------
+// Worker threads
+// -----------------------------------------------------------------------------
+
+void ContentSearch::WorkerLoop() {
+    std::unique_ptr<DirEnumerator> enumerator = DirEnumerator::Create(EnumBackend::Auto);
+    std::vector<char> buffer;
+    Results local;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_cancel && !m_full) {
+        // 优先搜索文件，目录按后进先出展开（深度优先，队列不会膨胀）
+        Work work;
+        bool isFile;
+        if (!m_files.empty()) {
+            work = std::move(m_files.front());
+            m_files.pop_front();
+            isFile = true;
+        } else if (!m_folders.empty()) {
+            work = std::move(m_folders.back());
+            m_folders.pop_back();
+            isFile = false;
+        } else {
+            // 所有线程都空闲且队列为空：搜索结束
+            if (++m_idle == m_stats.threads) {
+                m_done = true;
+                m_workCv.notify_all();
+                break;
+            }
+            m_workCv.wait(lock, [this] { return m_done || m_cancel || !m_files.empty() || !m_folders.empty(); });
+            if (m_done)
+                break;
+            --m_idle;
+            continue;
+        }
+        lock.unlock();
+
+        if (isFile)
+            SearchFile(work, buffer, local);
+        else
+            ListFolder(work, *enumerator);
+
+        lock.lock();
+        if (!local.matches.empty())
+            Flush(local);
+    }
+
+    if (m_done && m_stats.running) {
+        m_stats.running = false;
+        m_stats.truncated = m_full;
+        m_stats.time = ElapsedSince(m_startTime);
+        double seconds = m_stats.time.count() / 1e6;
+        LOG_INFO("Content search in %s: %llu files, %.1f MB, %llu matches, %.2f s (%.0f MB/s, %d threads)",
+                 m_root.string().c_str(), (unsigned long long)m_stats.files, m_stats.bytes / 1e6,
+                 (unsigned long long)m_stats.matches, seconds, seconds > 0 ? m_stats.bytes / 1e6 / seconds : 0.0,
+                 m_stats.threads);
+    }
+    // 达到匹配上限时其余线程可能在等待，唤醒它们退出
+    if (m_full && !m_done) {
+        m_done = true;
+        m_stats.running = false;
+        m_stats.truncated = true;
+        m_stats.time = ElapsedSince(m_startTime);
+        m_workCv.notify_all();
+    }
+}
+
+void ContentSearch::ListFolder(const Work& folder, DirEnumerator& enumerator) {
+    const char separator = (char)fs::path::preferred_separator;
+    std::vector<Work> folders, files;
+    std::error_code ec;
+    enumerator.Enumerate(folder.path, [&](std::vector<ScanEntry>& chunk) {
+        if (m_cancel.load(std::memory_order_relaxed))
+            return false;
+        for (auto& se : chunk) {
+            std::string relative = folder.relative;
+            if (!relative.empty())
+                relative += separator;
+            relative += fs::path(se.name).u8string();
+            if (se.isDirectory) {
+                if (folder.depth < kMaxDepth)
+                    folders.push_back({folder.path / se.name, std::move(relative), folder.depth + 1});
+            } else {
+                files.push_back({folder.path / se.name, std::move(relative), folder.depth});
+            }
+        }
+        return true;
+    }, ec);
+    // 无权限等错误只跳过该目录，不记日志（大目录树里会很多）
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.folders;
+        for (auto& w : folders)
+            m_folders.push_back(std::move(w));
+        for (auto& w : files)
+            m_files.push_back(std::move(w));
+    }
+    if (!folders.empty() || !files.empty())
+        m_workCv.notify_all();
+}
+
+void ContentSearch::SearchFile(const Work& file, std::vector<char>& buffer, Results& out) {
+    const char* text = nullptr;
+    std::size_t size = 0;
+    bool opened = false;
+
+#ifdef _WIN32
+    HANDLE h = CreateFileW(file.path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                           nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    HANDLE mapping = nullptr;
+    void* view = nullptr;
+    LARGE_INTEGER fileSize;
+    if (h != INVALID_HANDLE_VALUE && GetFileSizeEx(h, &fileSize)) {
+        size = (std::size_t)fileSize.QuadPart;
+        if (size >= kMapThreshold) {
+            mapping = CreateFileMappingW(h, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            text = static_cast<const char*>(view);
+            opened = view != nullptr;
+        } else {
+            buffer.resize(size);
+            DWORD read = 0;
+            opened = size == 0 || ReadFile(h, buffer.data(), (DWORD)size, &read, nullptr);
+            size = read;
+            text = buffer.data();
+        }
+    }
+#else
+    int fd = ::open(file.path.c_str(), O_RDONLY | O_CLOEXEC);
+    void* view = MAP_FAILED;
+    struct stat st;
+    if (fd >= 0 && ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        size = (std::size_t)st.st_size;
+        if (size >= kMapThreshold) {
+            view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED) {
+                ::madvise(view, size, MADV_SEQUENTIAL);
+                text = static_cast<const char*>(view);
+                opened = true;
+            }
+        } else {
+            buffer.resize(size);
+            std::size_t got = 0;
+            while (got < size) {
+                ssize_t r = ::read(fd, buffer.data() + got, size - got);
+                if (r <= 0)
+                    break;
+                got += (std::size_t)r;
+            }
+            size = got;
+            text = buffer.data();
+            opened = true;
+        }
+    }
+#endif
+
+    bool binary = false;
+    std::size_t matches = 0;
+    if (opened) {
+        // 前 8 KB 出现 NUL 视为二进制文件
+        binary = std::memchr(text, 0, std::min(size, kBinaryProbe)) != nullptr;
+        if (!binary && size > 0) {
+            std::uint32_t index = (std::uint32_t)out.files.size();
+            matches = SearchText(text, size, index, out);
+            if (matches > 0)
+                out.files.push_back(file.relative);
+        }
+    }
+
+#ifdef _WIN32
+    if (view)
+        UnmapViewOfFile(view);
+    if (mapping)
+        CloseHandle(mapping);
+    if (h != INVALID_HANDLE_VALUE)
+        CloseHandle(h);
+#else
+    if (view != MAP_FAILED)
+        ::munmap(view, size);
+    if (fd >= 0)
+        ::close(fd);
+#endif
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!opened)
+        ++m_stats.failed;
+    else if (binary)
+        ++m_stats.binary;
+    else {
+        ++m_stats.files;
+        m_stats.bytes += size;
+    }
+}
+
+std::size_t ContentSearch::SearchText(const char* text, std::size_t size, std::uint32_t file, Results& out) {
+    const std::size_t n = m_literal.size();
+    const bool fold = !m_options.matchCase;
+    std::size_t added = 0;
+    std::size_t pos = 0;
+    std::size_t counted = 0;        // 已统计换行的位置
+    std::uint32_t line = 1;
+
+    while (pos < size) {
+        // 分段搜索，段间检查取消
+        std::size_t segmentEnd = std::min(size, pos + kSegment);
+        std::size_t hit = FindLiteral(text, pos, std::min(size, segmentEnd + n - 1), m_literal, fold);
+        if (hit >= segmentEnd) {
+            pos = segmentEnd;
+            if (m_cancel.load(std::memory_order_relaxed))
+                break;
+            continue;
+        }
+
+        // 行首：从命中处向前找换行；行号只统计新扫过的部分
+        std::size_t lineBegin = hit;
+        while (lineBegin > counted && text[lineBegin - 1] != '\n')
+            --lineBegin;
+        line += (std::uint32_t)std::count(text + counted, text + lineBegin, '\n');
+        const char* eol = static_cast<const char*>(std::memchr(text + hit, '\n', size - hit));
+        std::size_t lineEnd = eol ? (std::size_t)(eol - text) : size;
+
+        // 超长行只保留匹配附近的一段
+        std::size_t from = std::max(lineBegin, hit > kContextBefore ? hit - kContextBefore : 0);
+        std::size_t to = std::min(lineEnd, hit + n + kContextAfter);
+        if (to > from && text[to - 1] == '\r')
+            --to;
+        Match match{file, line, (std::uint32_t)(hit - lineBegin + 1), std::string(text + from, to - from)};
+        std::replace(match.text.begin(), match.text.end(), '\t', ' ');
+        out.matches.push_back(std::move(match));
+
+        ++added;
+        if (m_matchCount.fetch_add(1, std::memory_order_relaxed) + 1 >= m_options.maxMatches) {
+            m_full = true;
+            break;
+        }
+        if (added >= m_options.maxPerFile)
+            break;
+
+        // 每行只报告一次
+        pos = lineEnd + 1;
+        counted = std::min(pos, size);
+        ++line;
+    }
+    return added;
+}
+
+void ContentSearch::Flush(Results& local) {
+    // 调用方持有 m_mutex
+    std::uint32_t base = (std::uint32_t)m_pending.files.size();
+    for (auto& file : local.files)
+        m_pending.files.push_back(std::move(file));
+    for (auto& match : local.matches) {
+        match.file += base;
+        m_pending.matches.push_back(std::move(match));
+    }
+    m_stats.matches += local.matches.size();
+    local.Clear();
+}
@@ -0,0 +1,618 @@
+// Deduplicator.cpp
+// Duplicate space reclamation implementation for FileMgr
+//
+// Key features:
+// - Clone: FIDEDUPERANGE (Linux) or FSCTL_DUPLICATE_EXTENTS_TO_FILE (Windows),
+//   compared and shared while the files cannot change
+// - Hard link (opt-in): compare, check unchanged, link to a temporary name,
+//   rename over the file (POSIX rename on Windows, MoveFileExW as fallback)
+// - Changed, cross-volume and unsupported files skipped and reported
+// - Groups spread over a few worker threads; bytes reclaimed counted
+//
+
+#include "../include/Deduplicator.hpp"
+#include "../include/Common.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <winioctl.h>
+#else
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr std::size_t kCompareChunk = 1 << 20;          // 逐字节比较时每次读 1 MB
+#ifdef _WIN32
+    constexpr std::uint64_t kCloneChunk = 1ULL << 30;       // 每次复制扩展的长度（须小于 4 GB）
+#else
+    constexpr std::uint64_t kCloneChunk = 16 << 20;         // 每次去重的长度（btrfs 单次最多 16 MB）
+#endif
+
+    std::atomic<std::uint32_t> g_tempCounter{0};            // 临时链接名的序号
+
+    // 同一文件夹中的临时名字，改名覆盖时不跨卷
+    fs::path TempName(const fs::path& file) {
+        char suffix[32];
+        std::snprintf(suffix, sizeof(suffix), ".dedupe-%08x", (unsigned)g_tempCounter++);
+        return file.parent_path() / fs::u8path(file.filename().u8string() + suffix);
+    }
+
+#ifdef _WIN32
+    // 自动关闭的句柄
+    struct Handle {
+        HANDLE h = INVALID_HANDLE_VALUE;
+        explicit Handle(HANDLE handle) : h(handle) {}
+        ~Handle() { Close(); }
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+        bool IsOpen() const { return h != INVALID_HANDLE_VALUE; }
+        void Close() {
+            if (h != INVALID_HANDLE_VALUE)
+                CloseHandle(h);
+            h = INVALID_HANDLE_VALUE;
+        }
+    };
+
+    std::uint64_t FileSize(const BY_HANDLE_FILE_INFORMATION& info) {
+        return ((std::uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    }
+
+    bool SameFile(const BY_HANDLE_FILE_INFORMATION& a, const BY_HANDLE_FILE_INFORMATION& b) {
+        return a.dwVolumeSerialNumber == b.dwVolumeSerialNumber && a.nFileIndexHigh == b.nFileIndexHigh &&
+               a.nFileIndexLow == b.nFileIndexLow;
+    }
+
+    // 文件系统不支持克隆或硬链接时的错误
+    bool IsUnsupported(DWORD error) {
+        return error == ERROR_INVALID_FUNCTION || error == ERROR_NOT_SUPPORTED || error == ERROR_NOT_SAME_DEVICE ||
+               error == ERROR_TOO_MANY_LINKS || error == ERROR_BLOCK_TOO_MANY_REFERENCES;
+    }
+
+    // 系统或文件系统不支持 FileRenameInfoEx（Windows 10 1607 之前、FAT 等）
+    bool IsRenameExUnsupported(DWORD error) {
+        return error == ERROR_INVALID_PARAMETER || error == ERROR_NOT_SUPPORTED || error == ERROR_INVALID_FUNCTION;
+    }
+
+    // 以 POSIX 语义改名覆盖 target：被覆盖的文件可以仍被打开（须允许删除共享）
+    bool RenameReplacing(HANDLE file, const fs::path& target) {
+        const std::wstring& name = target.native();
+        std::vector<char> buffer(sizeof(FILE_RENAME_INFO) + name.size() * sizeof(wchar_t));
+        FILE_RENAME_INFO* info = reinterpret_cast<FILE_RENAME_INFO*>(buffer.data());
+        info->Flags = FILE_RENAME_FLAG_REPLACE_IF_EXISTS | FILE_RENAME_FLAG_POSIX_SEMANTICS;
+        info->RootDirectory = nullptr;
+        info->FileNameLength = (DWORD)(name.size() * sizeof(wchar_t));
+        std::memcpy(info->FileName, name.c_str(), name.size() * sizeof(wchar_t));
+        return SetFileInformationByHandle(file, FileRenameInfoEx, info, (DWORD)buffer.size()) != 0;
+    }
+
+    // 从 offset 读满 size 字节
+    bool ReadAt(HANDLE file, std::uint64_t offset, char* data, std::size_t size) {
+        std::size_t got = 0;
+        while (got < size) {
+            OVERLAPPED overlapped = {};
+            overlapped.Offset = (DWORD)(offset + got);
+            overlapped.OffsetHigh = (DWORD)((offset + got) >> 32);
+            DWORD read = 0;
+            if (!ReadFile(file, data + got, (DWORD)(size - got), &read, &overlapped) || read == 0)
+                return false;
+            got += read;
+        }
+        return true;
+    }
+
+    // 逐块比较两个已打开文件的内容
+    bool ContentsEqual(HANDLE a, HANDLE b, std::uint64_t size, std::uint64_t& compared) {
+        std::size_t chunk = (std::size_t)std::min<std::uint64_t>(kCompareChunk, size);
+        std::vector<char> bufferA(chunk), bufferB(chunk);
+        for (std::uint64_t offset = 0; offset < size; offset += kCompareChunk) {
+            std::size_t length = (std::size_t)std::min<std::uint64_t>(kCompareChunk, size - offset);
+            if (!ReadAt(a, offset, bufferA.data(), length) || !ReadAt(b, offset, bufferB.data(), length))
+                return false;
+            compared += 2 * length;
+            if (std::memcmp(bufferA.data(), bufferB.data(), length) != 0)
+                return false;
+        }
+        return true;
+    }
+#else
+    // 自动关闭的文件描述符
+    struct Fd {
+        int fd = -1;
+        explicit Fd(int descriptor) : fd(descriptor) {}
+        ~Fd() {
+            if (fd >= 0)
+                ::close(fd);
+        }
+        Fd(const Fd&) = delete;
+        Fd& operator=(const Fd&) = delete;
+        bool IsOpen() const { return fd >= 0; }
+    };
+
+    bool SameFile(const struct stat& a, const struct stat& b) {
+        return a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+    }
+
+    // 比较之后文件没有被改动：大小、修改时间和状态时间都相同
+    bool Unchanged(const struct stat& a, const struct stat& b) {
+        return SameFile(a, b) && a.st_size == b.st_size && a.st_mtim.tv_sec == b.st_mtim.tv_sec &&
+               a.st_mtim.tv_nsec == b.st_mtim.tv_nsec && a.st_ctim.tv_sec == b.st_ctim.tv_sec &&
+               a.st_ctim.tv_nsec == b.st_ctim.tv_nsec;
+    }
+
+    // 文件系统不支持块共享或硬链接时的错误
+    bool IsUnsupported(int error) {
+        return error == EOPNOTSUPP || error == ENOTTY || error == EINVAL || error == EXDEV || error == ENOSYS;
+    }
+
+    // 从 offset 读满 size 字节
+    bool ReadAt(int fd, std::uint64_t offset, char* data, std::size_t size) {
+        std::size_t got = 0;
+        while (got < size) {
+            ssize_t read = ::pread(fd, data + got, size - got, (off_t)(offset + got));
+            if (read <= 0)
+                return false;
+            got += (std::size_t)read;
+        }
+        return true;
+    }
+
+    // 逐块比较两个已打开文件的内容
+    bool ContentsEqual(int a, int b, std::uint64_t size, std::uint64_t& compared) {
+        std::size_t chunk = (std::size_t)std::min<std::uint64_t>(kCompareChunk, size);
+        std::vector<char> bufferA(chunk), bufferB(chunk);
+        for (std::uint64_t offset = 0; offset < size; offset += kCompareChunk) {
+            std::size_t length = (std::size_t)std::min<std::uint64_t>(kCompareChunk, size - offset);
+            if (!ReadAt(a, offset, bufferA.data(), length) || !ReadAt(b, offset, bufferB.data(), length))
+                return false;
+            compared += 2 * length;
+            if (std::memcmp(bufferA.data(), bufferB.data(), length) != 0)
+                return false;
+        }
+        return true;
+    }
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Construction / Destruction
+// -----------------------------------------------------------------------------
+
+Deduplicator::~Deduplicator() {
+    Cancel();
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+void Deduplicator::Start(const fs::path& root, std::vector<DuplicateFinder::Group> groups, const Options& options) {
+    Cancel();
+    m_root = root;
+    m_groups = std::move(groups);
+    m_options = options;
+    m_options.threads = std::max(1, std::min(options.threads, 16));
+    m_cancel = false;
+    m_nextGroup = 0;
+    m_startTime = std::chrono::steady_clock::now();
+    int threads = (int)std::min<std::size_t>((std::size_t)m_options.threads, std::max<std::size_t>(1, m_groups.size()));
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_problems.clear();
+        m_problemCount = 0;
+        m_stats = Stats();
+        for (const DuplicateFinder::Group& group : m_groups)
+            m_stats.files += group.files.empty() ? 0 : group.files.size() - 1;
+        m_stats.threads = threads;
+        m_stats.running = true;
+    }
+    m_live = threads;
+    for (int k = 0; k < threads; ++k)
+        m_workers.emplace_back(&Deduplicator::WorkerLoop, this);
+}
+
+void Deduplicator::Cancel() {
+    if (m_workers.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancel = true;
+        if (m_stats.running) {
+            m_stats.running = false;
+            m_stats.cancelled = true;
+            m_stats.time = ElapsedSince(m_startTime);
+        }
+    }
+    for (std::thread& worker : m_workers)
+        worker.join();
+    m_workers.clear();
+}
+
+bool Deduplicator::Poll(std::vector<Problem>& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_problems.empty())
+        return false;
+    for (Problem& problem : m_problems)
+        out.push_back(std::move(problem));
+    m_problems.clear();
+    return true;
+}
+
+bool Deduplicator::IsRunning() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats.running;
+}
+
+Deduplicator::Stats Deduplicator::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    if (stats.running)
+        stats.time = ElapsedSince(m_startTime);
+    return stats;
+}
+
+// -----------------------------------------------------------------------------
+// Worker threads
+// -----------------------------------------------------------------------------
+
+void Deduplicator::WorkerLoop() {
+    while (!m_cancel) {
+        std::size_t index = m_nextGroup++;
+        if (index >= m_groups.size())
+            break;
+        const DuplicateFinder::Group& group = m_groups[index];
+        if (group.files.size() < 2)
+            continue;
+
+        // 每组保留第一个文件，其余文件与它共享存储
+        fs::path keep = m_root / fs::u8path(group.files[0]);
+        for (std::size_t k = 1; k < group.files.size() && !m_cancel; ++k) {
+            Result result = Replace(keep, m_root / fs::u8path(group.files[k]), group.size);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.processed;
+            m_stats.bytesReclaimed += result.reclaimed;
+            m_stats.bytesCompared += result.compared;
+            switch (result.outcome) {
+                case Outcome::Replaced:    ++m_stats.replaced; break;
+                case Outcome::Linked:      ++m_stats.linked; break;
+                case Outcome::Changed:     ++m_stats.changed; break;
+                case Outcome::Unsupported: ++m_stats.unsupported; break;
+                case Outcome::Failed:      ++m_stats.failed; break;
+            }
+            if (!result.reason.empty() && m_problemCount < kMaxProblems) {
+                m_problems.push_back({ group.files[k], std::move(result.reason) });
+                ++m_problemCount;
+            }
+        }
+    }
+
+    // 最后一个退出的线程结束本次运行
+    if (--m_live == 0) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stats.running) {
+            m_stats.running = false;
+            m_stats.time = ElapsedSince(m_startTime);
+            LOG_INFO("Deduplicate %s: %d of %d files replaced, %.1f MB reclaimed, %d changed, %d unsupported, "
+                     "%d failed (%.2f s)",
+                     m_root.u8string().c_str(), (int)m_stats.replaced, (int)m_stats.files,
+                     m_stats.bytesReclaimed / 1e6, (int)m_stats.changed, (int)m_stats.unsupported,
+                     (int)m_stats.failed, m_stats.time.count() / 1e6);
+        }
+    }
+}
+
+Deduplicator::Result Deduplicator::Replace(const fs::path& keep, const fs::path& file, std::uint64_t size) {
+    return m_options.method == Method::HardLink ? HardLink(keep, file, size) : Clone(keep, file, size);
+}
+
+// -----------------------------------------------------------------------------
+// Clone
+// -----------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+Deduplicator::Result Deduplicator::Clone(const fs::path& keep, const fs::path& file, std::uint64_t size) {
+    Result result;
+    // 两个文件都不允许其他人写入，比较和克隆之间内容不会变
+    Handle source(CreateFileW(keep.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+    Handle target(CreateFileW(file.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+    BY_HANDLE_FILE_INFORMATION sourceInfo, targetInfo;
+    if (!source.IsOpen() || !target.IsOpen() || !GetFileInformationByHandle(source.h, &sourceInfo) ||
+        !GetFileInformationByHandle(target.h, &targetInfo)) {
+        result.reason = ErrorText((int)GetLastError());
+        return result;
+    }
+    if (SameFile(sourceInfo, targetInfo)) {
+        result.outcome = Outcome::Linked;
+        return result;
+    }
+    if (sourceInfo.dwVolumeSerialNumber != targetInfo.dwVolumeSerialNumber) {
+        result.outcome = Outcome::Unsupported;
+        result.reason = "On another volume";
+        return result;
+    }
+    if (FileSize(sourceInfo) != size || FileSize(targetInfo) != size ||
+        !ContentsEqual(source.h, target.h, size, result.compared)) {
+        result.outcome = Outcome::Changed;
+        result.reason = "Contents changed since the search";
+        return result;
+    }
+
+    // 克隆的范围须按簇对齐；最后一段向上取整到簇（超出文件末尾的部分不复制）
+    wchar_t volume[MAX_PATH];
+    DWORD sectorsPerCluster = 0, bytesPerSector = 0, freeClusters = 0, totalClusters = 0;
+    if (!GetVolumePathNameW(file.c_str(), volume, MAX_PATH) ||
+        !GetDiskFreeSpaceW(volume, &sectorsPerCluster, &bytesPerSector, &freeClusters, &totalClusters)) {
+        result.reason = ErrorText((int)GetLastError());
+        return result;
+    }
+    std::uint64_t cluster = std::max<std::uint64_t>(1, (std::uint64_t)sectorsPerCluster * bytesPerSector);
+    if (sourceInfo.dwFileAttributes & FILE_ATTRIBUTE_SPARSE_FILE) {
+        DWORD returned = 0;
+        DeviceIoControl(target.h, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &returned, nullptr);
+    }
+    for (std::uint64_t offset = 0; offset < size; offset += kCloneChunk) {
+        std::uint64_t length = std::min(kCloneChunk, size - offset);
+        DUPLICATE_EXTENTS_DATA extents = {};
+        extents.FileHandle = source.h;
+        extents.SourceFileOffset.QuadPart = (LONGLONG)offset;
+        extents.TargetFileOffset.QuadPart = (LONGLONG)offset;
+        extents.ByteCount.QuadPart = (LONGLONG)((length + cluster - 1) / cluster * cluster);
+        DWORD returned = 0;
+        if (!DeviceIoControl(target.h, FSCTL_DUPLICATE_EXTENTS_TO_FILE, &extents, sizeof(extents), nullptr, 0,
+                             &returned, nullptr)) {
+            DWORD error = GetLastError();
+            result.outcome = IsUnsupported(error) ? Outcome::Unsupported : Outcome::Failed;
+            result.reason = ErrorText((int)error);
+            return result;
+        }
+        result.reclaimed += length;
+    }
+    result.outcome = Outcome::Replaced;
+    return result;
+}
+
+#else
+
+Deduplicator::Result Deduplicator::Clone(const fs::path& keep, const fs::path& file, std::uint64_t size) {
+    Result result;
+    // 目标以写方式打开；没有写权限时，文件属主仍可只读打开后去重
+    Fd source(::open(keep.c_str(), O_RDONLY | O_CLOEXEC));
+    Fd target(::open(file.c_str(), O_RDWR | O_CLOEXEC));
+    if (!target.IsOpen() && (errno == EACCES || errno == EROFS || errno == ETXTBSY))
+        target.fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat sourceStat, targetStat;
+    if (!source.IsOpen() || !target.IsOpen() || ::fstat(source.fd, &sourceStat) != 0 ||
+        ::fstat(target.fd, &targetStat) != 0) {
+        result.reason = ErrorText(errno);
+        return result;
+    }
+    // 卷号不同不一定跨文件系统（btrfs 子卷），交给内核判断
+    if (SameFile(sourceStat, targetStat)) {
+        result.outcome = Outcome::Linked;
+        return result;
+    }
+    if ((std::uint64_t)sourceStat.st_size != size || (std::uint64_t)targetStat.st_size != size) {
+        result.outcome = Outcome::Changed;
+        result.reason = "Size changed since the search";
+        return result;
+    }
+
+    // 内核锁住两个文件、逐字节比较，相同才共享块；每次最多 kCloneChunk
+    std::vector<char> buffer(sizeof(file_dedupe_range) + sizeof(file_dedupe_range_info));
+    auto* range = reinterpret_cast<file_dedupe_range*>(buffer.data());
+    for (std::uint64_t offset = 0; offset < size && !m_cancel;) {
+        std::memset(buffer.data(), 0, buffer.size());
+        range->src_offset = offset;
+        range->src_length = std::min(kCloneChunk, size - offset);
+        range->dest_count = 1;
+        range->info[0].dest_fd = target.fd;
+        range->info[0].dest_offset = offset;
+        int error = ::ioctl(source.fd, FIDEDUPERANGE, range) == 0 ? 0 : errno;
+        if (error == 0 && range->info[0].status < 0)
+            error = -range->info[0].status;
+        if (error != 0) {
+            result.outcome = IsUnsupported(error) ? Outcome::Unsupported : Outcome::Failed;
+            result.reason = result.outcome == Outcome::Unsupported
+                                ? "File system cannot share blocks (" + ErrorText(error) + ")"
+                                : ErrorText(error);
+            return result;
+        }
+        if (range->info[0].status == FILE_DEDUPE_RANGE_DIFFERS) {
+            // 已共享的前段保留（内容相同），其余不动
+            result.outcome = Outcome::Changed;
+            result.reason = "Contents changed since the search";
+            return result;
+        }
+        if (range->info[0].bytes_deduped == 0) {
+            result.reason = "No progress sharing blocks";
+            return result;
+        }
+        offset += range->info[0].bytes_deduped;
+        result.reclaimed += range->info[0].bytes_deduped;
+    }
+    result.outcome = m_cancel && result.reclaimed < size ? Outcome::Failed : Outcome::Replaced;
+    if (result.outcome == Outcome::Failed)
+        result.reason = "Stopped";
+    return result;
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// Hard link
+// -----------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+Deduplicator::Result Deduplicator::HardLink(const fs::path& keep, const fs::path& file, std::uint64_t size) {
+    Result result;
+    // 不允许写入但允许删除：POSIX 语义的改名覆盖时句柄仍然打开，比较之后无人能改
+    Handle source(CreateFileW(keep.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+    Handle target(CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+    BY_HANDLE_FILE_INFORMATION sourceInfo, targetInfo;
+    if (!source.IsOpen() || !target.IsOpen() || !GetFileInformationByHandle(source.h, &sourceInfo) ||
+        !GetFileInformationByHandle(target.h, &targetInfo)) {
+        result.reason = ErrorText((int)GetLastError());
+        return result;
+    }
+    if (SameFile(sourceInfo, targetInfo)) {
+        result.outcome = Outcome::Linked;
+        return result;
+    }
+    if (sourceInfo.dwVolumeSerialNumber != targetInfo.dwVolumeSerialNumber) {
+        result.outcome = Outcome::Unsupported;
+        result.reason = "On another volume";
+        return result;
+    }
+    if (FileSize(sourceInfo) != size || FileSize(targetInfo) != size ||
+        !ContentsEqual(source.h, target.h, size, result.compared)) {
+        result.outcome = Outcome::Changed;
+        result.reason = "Contents changed since the search";
+        return result;
+    }
+
+    // 链接到临时名字，确认它指向比较过的保留文件
+    fs::path temp = TempName(file);
+    if (!CreateHardLinkW(temp.c_str(), keep.c_str(), nullptr)) {
+        DWORD error = GetLastError();
+        result.outcome = IsUnsupported(error) ? Outcome::Unsupported : Outcome::Failed;
+        result.reason = ErrorText((int)error);
+        return result;
+    }
+    Handle link(CreateFileW(temp.c_str(), DELETE | FILE_READ_ATTRIBUTES,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, 0, nullptr));
+    BY_HANDLE_FILE_INFORMATION linkInfo;
+    if (!link.IsOpen() || !GetFileInformationByHandle(link.h, &linkInfo)) {
+        DWORD error = GetLastError();
+        link.Close();
+        DeleteFileW(temp.c_str());
+        result.reason = ErrorText((int)error);
+        return result;
+    }
+    if (!SameFile(linkInfo, sourceInfo)) {
+        link.Close();
+        DeleteFileW(temp.c_str());
+        result.outcome = Outcome::Changed;
+        result.reason = "Replaced while being compared";
+        return result;
+    }
+
+    // 首选：target 仍然打开时用 POSIX 语义改名覆盖
+    if (!RenameReplacing(link.h, file)) {
+        DWORD error = GetLastError();
+        link.Close();
+        if (!IsRenameExUnsupported(error)) {
+            DeleteFileW(temp.c_str());
+            result.reason = ErrorText((int)error);
+            return result;
+        }
+
+        // 退而用 MoveFileExW：它不能覆盖仍被打开的文件，先关闭 target，
+        // 再确认名字仍指向比较过的文件，大小和修改时间都没变
+        target.Close();
+        Handle current(CreateFileW(file.c_str(), FILE_READ_ATTRIBUTES,
+                                   FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, 0,
+                                   nullptr));
+        BY_HANDLE_FILE_INFORMATION currentInfo;
+        bool unchanged = current.IsOpen() && GetFileInformationByHandle(current.h, &currentInfo) &&
+                         SameFile(currentInfo, targetInfo) && FileSize(currentInfo) == size &&
+                         CompareFileTime(&currentInfo.ftLastWriteTime, &targetInfo.ftLastWriteTime) == 0;
+        current.Close();
+        if (!unchanged) {
+            DeleteFileW(temp.c_str());
+            result.outcome = Outcome::Changed;
+            result.reason = "Modified while being compared";
+            return result;
+        }
+        if (!MoveFileExW(temp.c_str(), file.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+            error = GetLastError();
+            DeleteFileW(temp.c_str());
+            result.reason = ErrorText((int)error);
+            return result;
+        }
+    }
+    result.outcome = Outcome::Replaced;
+    result.reclaimed = targetInfo.nNumberOfLinks == 1 ? size : 0;
+    return result;
+}
+
+#else
+
+Deduplicator::Result Deduplicator::HardLink(const fs::path& keep, const fs::path& file, std::uint64_t size) {
+    Result result;
+    Fd source(::open(keep.c_str(), O_RDONLY | O_CLOEXEC));
+    Fd target(::open(file.c_str(), O_RDONLY | O_CLOEXEC));
+    struct stat sourceStat, targetStat;
+    if (!source.IsOpen() || !target.IsOpen() || ::fstat(source.fd, &sourceStat) != 0 ||
+        ::fstat(target.fd, &targetStat) != 0) {
+        result.reason = ErrorText(errno);
+        return result;
+    }
+    if (SameFile(sourceStat, targetStat)) {
+        result.outcome = Outcome::Linked;
+        return result;
+    }
+    if (sourceStat.st_dev != targetStat.st_dev) {
+        result.outcome = Outcome::Unsupported;
+        result.reason = "On another volume";
+        return result;
+    }
+    if ((std::uint64_t)sourceStat.st_size != size || (std::uint64_t)targetStat.st_size != size ||
+        !ContentsEqual(source.fd, target.fd, size, result.compared)) {
+        result.outcome = Outcome::Changed;
+        result.reason = "Contents changed since the search";
+        return result;
+    }
+
+    // 比较期间两个文件都没有被写过（修改时间和状态时间不变）
+    struct stat sourceAfter, targetAfter;
+    if (::fstat(source.fd, &sourceAfter) != 0 || ::fstat(target.fd, &targetAfter) != 0 ||
+        !Unchanged(sourceStat, sourceAfter) || !Unchanged(targetStat, targetAfter)) {
+        result.outcome = Outcome::Changed;
+        result.reason = "Modified while being compared";
+        return result;
+    }
+
+    // 链接到临时名字，确认两个名字仍指向比较过的文件，再原子地改名覆盖
+    fs::path temp = TempName(file);
+    if (::link(keep.c_str(), temp.c_str()) != 0) {
+        int error = errno;
+        bool unsupported = IsUnsupported(error) || error == EPERM || error == EMLINK;
+        result.outcome = unsupported ? Outcome::Unsupported : Outcome::Failed;
+        result.reason = ErrorText(error);
+        return result;
+    }
+    struct stat linked, current;
+    if (::lstat(temp.c_str(), &linked) != 0 || !SameFile(linked, sourceStat) ||
+        ::lstat(file.c_str(), &current) != 0 || !Unchanged(current, targetStat)) {
+        ::unlink(temp.c_str());
+        result.outcome = Outcome::Changed;
+        result.reason = "Replaced while being compared";
+        return result;
+    }
+    if (::rename(temp.c_str(), file.c_str()) != 0) {
+        int error = errno;
+        ::unlink(temp.c_str());
+        result.reason = ErrorText(error);
+        return result;
+    }
+    result.outcome = Outcome::Replaced;
+    result.reclaimed = targetStat.st_nlink == 1 ? (std::uint64_t)targetStat.st_blocks * 512 : 0;
+    return result;
+}
+
+#endif
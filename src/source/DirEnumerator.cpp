@@ -0,0 +1,307 @@
+// DirEnumerator.cpp
+// Directory enumeration backends for FileMgr
+//
+// Each backend turns one directory into chunks of ScanEntry records. The
+// native backends fetch all metadata in as few calls as the platform allows;
+// the portable backend relies on whatever std::filesystem caches.
+//
+// Key features:
+// - Win32 FindFirstFileExW large-fetch backend (no per-entry stat)
+// - Linux getdents64 + statx backend (d_type used when statx fails)
+// - std::filesystem fallback
+//
+
+#include "../include/DirEnumerator.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr std::size_t kChunkSize = 1024;
+
+    // 把 std::filesystem 的时间转换为 system_clock（C++17 没有 clock_cast）
+    class FileTimeConverter {
+    public:
+        FileTimeConverter()
+            : m_fileNow(fs::file_time_type::clock::now()),
+              m_sysNow(std::chrono::system_clock::now()) {}
+
+        std::chrono::system_clock::time_point operator()(fs::file_time_type t) const {
+            return m_sysNow + std::chrono::duration_cast<std::chrono::system_clock::duration>(t - m_fileNow);
+        }
+
+    private:
+        fs::file_time_type m_fileNow;
+        std::chrono::system_clock::time_point m_sysNow;
+    };
+
+    // -------------------------------------------------------------------------
+    // Portable backend: std::filesystem
+    // -------------------------------------------------------------------------
+    class PortableEnumerator : public DirEnumerator {
+    public:
+        const char* GetName() const override { return "portable"; }
+
+        bool Enumerate(const fs::path& dir, const Sink& sink, std::error_code& ec) override {
+            FileTimeConverter toSys;
+            std::vector<ScanEntry> chunk;
+            chunk.reserve(kChunkSize);
+
+            fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+            for (; !ec && it != fs::directory_iterator(); it.increment(ec)) {
+                const fs::directory_entry& entry = *it;
+                std::error_code entryEc;
+                ScanEntry se;
+                se.name = entry.path().filename().native();
+                se.isDirectory = entry.is_directory(entryEc);
+                se.isLink = entry.is_symlink(entryEc);
+                se.size = 0;
+                if (!se.isDirectory && entry.is_regular_file(entryEc)) {
+                    se.size = entry.file_size(entryEc);
+                    if (entryEc) se.size = 0;
+                }
+                auto ftime = entry.last_write_time(entryEc);
+                se.lastWriteTime = entryEc ? std::chrono::system_clock::time_point() : toSys(ftime);
+                chunk.push_back(std::move(se));
+
+                if (chunk.size() >= kChunkSize) {
+                    if (!sink(chunk))
+                        return false;
+                    chunk.clear();
+                }
+            }
+            if (!chunk.empty() && !sink(chunk))
+                return false;
+            return !ec;
+        }
+    };
+
+#ifdef _WIN32
+    // FILETIME：自 1601-01-01 起的 100ns 计数
+    std::chrono::system_clock::time_point FileTimeToSys(const FILETIME& ft) {
+        constexpr std::int64_t kUnixEpochTicks = 116444736000000000LL;
+        std::int64_t ticks = ((std::int64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+        std::chrono::duration<std::int64_t, std::ratio<1, 10000000>> d(ticks - kUnixEpochTicks);
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(d));
+    }
+
+    // -------------------------------------------------------------------------
+    // Win32 backend: FindFirstFileExW (large fetch, basic info)
+    // -------------------------------------------------------------------------
+    class Win32Enumerator : public DirEnumerator {
+    public:
+        const char* GetName() const override { return "win32"; }
+
+        bool Enumerate(const fs::path& dir, const Sink& sink, std::error_code& ec) override {
+            std::wstring pattern = (dir / L"*").wstring();
+            WIN32_FIND_DATAW fd;
+            // FindExInfoBasic 不查询短文件名；LARGE_FETCH 让每次往返返回更多条目
+            HANDLE h = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &fd,
+                                        FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+            if (h == INVALID_HANDLE_VALUE) {
+                DWORD err = GetLastError();
+                if (err == ERROR_FILE_NOT_FOUND)
+                    return true; // 空目录（连 . 和 .. 都没有，如驱动器根目录）
+                ec.assign((int)err, std::system_category());
+                return false;
+            }
+
+            std::vector<ScanEntry> chunk;
+            chunk.reserve(kChunkSize);
+            bool keepGoing = true;
+            do {
+                const wchar_t* name = fd.cFileName;
+                if (name[0] == L'.' && (name[1] == L'\0' || (name[1] == L'.' && name[2] == L'\0')))
+                    continue;
+
+                ScanEntry se;
+                se.name = name;
+                se.isDirectory = (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+                // 其它重解析点（云文件占位符、去重文件等）仍是普通文件
+                se.isLink = (fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) &&
+                            (fd.dwReserved0 == IO_REPARSE_TAG_SYMLINK || fd.dwReserved0 == IO_REPARSE_TAG_MOUNT_POINT);
+                se.size = se.isDirectory ? 0
+                    : ((std::uintmax_t)fd.nFileSizeHigh << 32) | fd.nFileSizeLow;
+                se.lastWriteTime = FileTimeToSys(fd.ftLastWriteTime);
+                chunk.push_back(std::move(se));
+
+                if (chunk.size() >= kChunkSize) {
+                    if (!sink(chunk)) { keepGoing = false; break; }
+                    chunk.clear();
+                }
+            } while (FindNextFileW(h, &fd));
+
+            DWORD err = keepGoing ? GetLastError() : ERROR_NO_MORE_FILES;
+            FindClose(h);
+            if (keepGoing && !chunk.empty() && !sink(chunk))
+                keepGoing = false;
+            if (err != ERROR_NO_MORE_FILES) {
+                ec.assign((int)err, std::system_category());
+                return false;
+            }
+            return keepGoing;
+        }
+
+    };
+#endif
+
+#ifdef __linux__
+    std::chrono::system_clock::time_point StatxTimeToSys(const struct statx_timestamp& t) {
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec)));
+    }
+
+    // -------------------------------------------------------------------------
+    // Linux backend: getdents64 + statx
+    // -------------------------------------------------------------------------
+    struct LinuxDirent64 {
+        std::uint64_t d_ino;
+        std::int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+
+    class LinuxEnumerator : public DirEnumerator {
+    public:
+        const char* GetName() const override { return "getdents64"; }
+
+        bool Enumerate(const fs::path& dir, const Sink& sink, std::error_code& ec) override {
+            int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (fd < 0) {
+                ec.assign(errno, std::generic_category());
+                return false;
+            }
+
+            std::vector<char> buffer(64 * 1024);
+            std::vector<ScanEntry> chunk;
+            chunk.reserve(kChunkSize);
+            bool keepGoing = true;
+
+            while (keepGoing) {
+                long n = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+                if (n < 0) {
+                    ec.assign(errno, std::generic_category());
+                    keepGoing = false;
+                    break;
+                }
+                if (n == 0)
+                    break;
+
+                for (long off = 0; off < n;) {
+                    auto* d = reinterpret_cast<LinuxDirent64*>(buffer.data() + off);
+                    off += d->d_reclen;
+                    const char* name = d->d_name;
+                    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+                        continue;
+
+                    ScanEntry se;
+                    se.name = name;
+                    FillMetadata(fd, name, d->d_type, se);
+                    chunk.push_back(std::move(se));
+                }
+
+                if (chunk.size() >= kChunkSize) {
+                    if (!sink(chunk)) { keepGoing = false; break; }
+                    chunk.clear();
+                }
+            }
+            ::close(fd);
+
+            if (keepGoing && !chunk.empty() && !sink(chunk))
+                keepGoing = false;
+            return keepGoing && !ec;
+        }
+
+    private:
+        // 与 directory_entry 一致：跟随符号链接；AT_STATX_DONT_SYNC 避免网络文件系统强制同步
+        static void FillMetadata(int dirFd, const char* name, unsigned char dtype, ScanEntry& se) {
+            se.isLink = dtype == DT_LNK;
+            struct statx stx;
+            if (::statx(dirFd, name, AT_STATX_DONT_SYNC, STATX_TYPE | STATX_SIZE | STATX_MTIME, &stx) == 0) {
+                se.isDirectory = S_ISDIR(stx.stx_mode);
+                se.size = S_ISREG(stx.stx_mode) ? stx.stx_size : 0;
+                se.lastWriteTime = StatxTimeToSys(stx.stx_mtime);
+            } else {
+                // 悬空链接等情况：只保留 d_type 提供的类型信息
+                se.isDirectory = dtype == DT_DIR;
+                se.size = 0;
+                se.lastWriteTime = std::chrono::system_clock::time_point();
+            }
+        }
+    };
+#endif
+}
+
+std::unique_ptr<DirEnumerator> DirEnumerator::Create(EnumBackend backend) {
+    if (backend == EnumBackend::Portable)
+        return std::make_unique<PortableEnumerator>();
+#ifdef __linux__
+    if (backend == EnumBackend::IoUring) {
+        if (auto uring = CreateUringEnumerator())
+            return uring;
+        // io_uring 不可用（旧内核或被 sysctl 禁用）：退回同步 statx 后端
+    }
+#endif
+#ifdef _WIN32
+    return std::make_unique<Win32Enumerator>();
+#elif defined(__linux__)
+    return std::make_unique<LinuxEnumerator>();
+#else
+    return std::make_unique<PortableEnumerator>();
+#endif
+}
+
+bool DirEnumerator::IsAvailable(EnumBackend backend) {
+    switch (backend) {
+    case EnumBackend::IoUring:
+#ifdef __linux__
+        return CreateUringEnumerator() != nullptr;
+#else
+        return false;
+#endif
+    case EnumBackend::Native:
+#if defined(_WIN32) || defined(__linux__)
+        return true;
+#else
+        return false;
+#endif
+    default:
+        return true;
+    }
+}
+
+bool QueryWriteTime(const fs::path& path, std::chrono::system_clock::time_point& out) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data))
+        return false;
+    out = FileTimeToSys(data.ftLastWriteTime);
+    return true;
+#elif defined(__linux__)
+    struct statx stx;
+    if (::statx(AT_FDCWD, path.c_str(), AT_STATX_DONT_SYNC, STATX_MTIME, &stx) != 0)
+        return false;
+    out = StatxTimeToSys(stx.stx_mtime);
+    return true;
+#else
+    std::error_code ec;
+    auto ftime = fs::last_write_time(path, ec);
+    if (ec)
+        return false;
+    out = FileTimeConverter()(ftime);
+    return true;
+#endif
+}
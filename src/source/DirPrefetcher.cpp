@@ -0,0 +1,186 @@
+// DirPrefetcher.cpp
+// Speculative directory prefetcher implementation for FileMgr
+//
+// Workers take the newest request from the queue, list the directory with
+// the native enumeration backend and store the sorted result in the shared
+// SnapshotCache. Every chunk checks the generation counter so CancelAll()
+// takes effect within one enumerator chunk.
+//
+// Key features:
+// - Bounded concurrency, queue length and per-directory size
+// - Never evicts: a prefetch only fills free cache budget
+// - Usage tracking for a prefetch hit-rate statistic
+//
+
+#include "../include/DirPrefetcher.hpp"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr std::size_t kMaxQueue = 8;            // 等待中的请求上限
+    constexpr std::size_t kMaxEntries = 50000;      // 超过该条目数的目录放弃预取
+    constexpr std::size_t kMaxTracked = 256;        // 记录“预取但尚未访问”的目录数上限
+    constexpr std::size_t kBudgetShare = 8;         // 单个快照最多占缓存预算的 1/8
+
+    // 预取线程使用最低优先级，不与界面线程和前台扫描争抢 CPU
+    void LowerThreadPriority() {
+#ifdef _WIN32
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+        setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 19);
+#endif
+    }
+
+    fs::path::string_type MakeKey(const fs::path& dir) {
+        return dir.lexically_normal().native();
+    }
+}
+
+DirPrefetcher::DirPrefetcher(SnapshotCache* cache, int threadCount)
+    : m_cache(cache), m_stop(false), m_generation(0) {
+    threadCount = std::clamp(threadCount, 1, 2);
+    for (int i = 0; i < threadCount; ++i)
+        m_workers.emplace_back(&DirPrefetcher::WorkerLoop, this);
+}
+
+DirPrefetcher::~DirPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_queue.clear();
+        ++m_generation;
+    }
+    m_wakeCv.notify_all();
+    for (auto& t : m_workers)
+        t.join();
+}
+
+void DirPrefetcher::Request(const fs::path& dir) {
+    if (dir.empty() || m_cache->Peek(dir))
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Key key = MakeKey(dir);
+        if (m_inFlight.count(key))
+            return;
+        for (const auto& queued : m_queue) {
+            if (MakeKey(queued) == key)
+                return;
+        }
+        // 队列满时丢弃最旧的请求：用户的注意力已经移开了
+        if (m_queue.size() >= kMaxQueue)
+            m_queue.pop_front();
+        m_queue.push_back(dir);
+        ++m_stats.requested;
+    }
+    m_wakeCv.notify_one();
+}
+
+void DirPrefetcher::CancelAll() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.cancelled += m_queue.size();
+    m_queue.clear();
+    ++m_generation;
+}
+
+void DirPrefetcher::NoteNavigation(const fs::path& dir, bool cacheHit) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::find(m_prefetched.begin(), m_prefetched.end(), MakeKey(dir));
+    if (it == m_prefetched.end())
+        return;
+    if (cacheHit)
+        ++m_stats.used;
+    m_prefetched.erase(it);
+}
+
+DirPrefetcher::Stats DirPrefetcher::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void DirPrefetcher::WorkerLoop() {
+    LowerThreadPriority();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wakeCv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+        if (m_stop)
+            return;
+
+        // 后进先出：最近悬停的目录最可能被打开
+        fs::path dir = std::move(m_queue.back());
+        m_queue.pop_back();
+        Key key = MakeKey(dir);
+        m_inFlight.insert(key);
+        std::uint64_t gen = m_generation.load();
+
+        lock.unlock();
+        Prefetch(dir, gen);
+        lock.lock();
+        m_inFlight.erase(key);
+    }
+}
+
+void DirPrefetcher::Prefetch(const fs::path& dir, std::uint64_t generation) {
+    if (m_cache->Peek(dir))
+        return;
+
+    auto snapshot = std::make_shared<DirSnapshot>();
+    snapshot->dir = dir;
+    bool haveWriteTime = QueryWriteTime(dir, snapshot->dirWriteTime);
+
+    bool cancelled = false;
+    bool tooLarge = false;
+    std::error_code ec;
+    auto enumerator = DirEnumerator::Create(EnumBackend::Auto);
+    enumerator->Enumerate(dir, [&](std::vector<ScanEntry>& chunk) {
+        if (m_generation.load(std::memory_order_relaxed) != generation) {
+            cancelled = true;
+            return false;
+        }
+        if (snapshot->entries.Size() + chunk.size() > kMaxEntries) {
+            tooLarge = true;
+            return false;
+        }
+        snapshot->entries.Append(chunk);
+        return true;
+    }, ec);
+
+    if (!cancelled && !tooLarge && !ec && haveWriteTime)
+        snapshot->entries.Sort();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (cancelled || m_generation.load() != generation) {
+        ++m_stats.cancelled;
+        return;
+    }
+    if (tooLarge || ec || !haveWriteTime) {
+        ++m_stats.skipped;
+        return;
+    }
+
+    // 只使用缓存的空闲预算，绝不为了预取把用户真正访问过的目录挤出去
+    SnapshotCache::Stats cacheStats = m_cache->GetStats();
+    snapshot->entries.ShrinkToFit();
+    std::size_t bytes = SnapshotCache::EstimateBytes(snapshot->entries);
+    if (bytes > cacheStats.budget / kBudgetShare || cacheStats.bytes + bytes > cacheStats.budget) {
+        ++m_stats.skipped;
+        return;
+    }
+
+    m_cache->Put(std::move(snapshot));
+    ++m_stats.completed;
+    if (m_prefetched.size() >= kMaxTracked)
+        m_prefetched.pop_front();
+    m_prefetched.push_back(MakeKey(dir));
+}
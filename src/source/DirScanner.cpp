@@ -0,0 +1,247 @@
+// DirScanner.cpp
+// Background directory scanner implementation for FileMgr
+//
+// A single worker thread waits for scan requests. Each scan reads the
+// directory through the selected DirEnumerator backend and flushes what it has read so far either
+// when the batch is full or when a frame's worth of time has passed, so the
+// UI always has something new to show on the next frame.
+//
+// Key features:
+// - Generation-token cancellation (checked per enumerator chunk)
+// - Small first batch for low time-to-first-row, larger batches afterwards
+// - Per-scan timing statistics (time to first batch, total time)
+// - Cheap revalidation of cached listings by directory mtime
+//
+
+#include "../include/DirScanner.hpp"
+#include "../include/Common.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // 第一批尽量小，让首行尽快出现；之后用大批次减少加锁次数
+    constexpr std::size_t kFirstBatchSize = 256;
+    constexpr std::size_t kMaxBatchSize = 8192;
+    // 即使批次未满，超过该时间也要提交一次（约半帧）
+    constexpr auto kFlushInterval = std::chrono::milliseconds(8);
+}
+
+DirScanner::DirScanner()
+    : m_generation(0), m_stop(false), m_hasRequest(false), m_backend(EnumBackend::Auto) {
+    m_worker = std::thread(&DirScanner::WorkerLoop, this);
+}
+
+DirScanner::~DirScanner() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        ++m_generation; // 让正在进行的扫描尽快退出
+    }
+    m_wakeCv.notify_all();
+    if (m_worker.joinable())
+        m_worker.join();
+}
+
+std::uint64_t DirScanner::Start(const fs::path& dir) {
+    Request request;
+    request.dir = dir;
+    return Submit(std::move(request));
+}
+
+std::uint64_t DirScanner::StartRevalidate(const fs::path& dir,
+                                          std::chrono::system_clock::time_point knownWriteTime) {
+    Request request;
+    request.dir = dir;
+    request.revalidate = true;
+    request.knownWriteTime = knownWriteTime;
+    return Submit(std::move(request));
+}
+
+std::uint64_t DirScanner::Submit(Request request) {
+    std::uint64_t gen;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        gen = ++m_generation;
+        m_ready.clear();
+        request.generation = gen;
+        request.startTime = std::chrono::steady_clock::now();
+        request.backend = m_backend;
+        m_request = std::move(request);
+        m_hasRequest = true;
+    }
+    m_wakeCv.notify_one();
+    return gen;
+}
+
+void DirScanner::Cancel() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_generation;
+    m_ready.clear();
+    m_hasRequest = false;
+}
+
+bool DirScanner::Poll(std::vector<Batch>& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_ready.empty())
+        return false;
+    std::uint64_t gen = m_generation.load();
+    bool delivered = false;
+    for (auto& batch : m_ready) {
+        if (batch.generation != gen)
+            continue; // 过期批次直接丢弃
+        out.push_back(std::move(batch));
+        delivered = true;
+    }
+    m_ready.clear();
+    return delivered;
+}
+
+bool DirScanner::WaitForBatch(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    // 与 Poll() 一致：只有当前扫描的批次才算
+    return m_readyCv.wait_for(lock, timeout, [this] {
+        std::uint64_t gen = m_generation.load();
+        return std::any_of(m_ready.begin(), m_ready.end(),
+                           [gen](const Batch& batch) { return batch.generation == gen; });
+    });
+}
+
+void DirScanner::SetBackend(EnumBackend backend) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_backend = backend;
+}
+
+EnumBackend DirScanner::GetBackend() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_backend;
+}
+
+DirScanner::Stats DirScanner::GetLastStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastStats;
+}
+
+void DirScanner::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wakeCv.wait(lock, [this] { return m_stop || m_hasRequest; });
+        if (m_stop)
+            return;
+
+        Request request = std::move(m_request);
+        m_hasRequest = false;
+
+        lock.unlock();
+        ScanDirectory(request);
+        lock.lock();
+    }
+}
+
+bool DirScanner::PushBatch(Batch&& batch) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (batch.generation != m_generation.load())
+            return false;
+        m_ready.push_back(std::move(batch));
+    }
+    m_readyCv.notify_all();
+    return true;
+}
+
+void DirScanner::ScanDirectory(const Request& request) {
+    const fs::path& dir = request.dir;
+    const std::uint64_t generation = request.generation;
+    const auto startTime = request.startTime;
+
+    // 先记录目录自身的修改时间：扫描期间若有变化，下次校验时能发现
+    std::chrono::system_clock::time_point dirWriteTime{};
+    bool haveWriteTime = QueryWriteTime(dir, dirWriteTime);
+    if (request.revalidate && haveWriteTime && dirWriteTime == request.knownWriteTime) {
+        Batch batch{generation, {}, true};
+        batch.unchanged = true;
+        batch.dirWriteTime = dirWriteTime;
+        PushBatch(std::move(batch));
+        return;
+    }
+
+    std::unique_ptr<DirEnumerator> enumerator = DirEnumerator::Create(request.backend);
+    Stats stats;
+    stats.generation = generation;
+    stats.backend = enumerator->GetName();
+
+    Batch batch{generation, {}, false};
+    std::size_t batchLimit = kFirstBatchSize;
+    batch.entries.reserve(batchLimit);
+    auto lastFlush = std::chrono::steady_clock::now();
+    bool superseded = false;
+    bool firstFlushed = false;
+
+    // 提交当前批次；返回 false 表示扫描已被新的导航取代
+    auto flush = [&](bool finished) {
+        if (batch.entries.empty() && !finished)
+            return true;
+        if (!firstFlushed) {
+            stats.timeToFirstBatch = ElapsedSince(startTime);
+            firstFlushed = true;
+        }
+        batch.finished = finished;
+        if (finished)
+            batch.dirWriteTime = dirWriteTime;
+        bool ok = PushBatch(std::move(batch));
+        batch = Batch{generation, {}, false};
+        batchLimit = kMaxBatchSize;
+        batch.entries.reserve(batchLimit);
+        lastFlush = std::chrono::steady_clock::now();
+        return ok;
+    };
+
+    try {
+        std::error_code ec;
+        enumerator->Enumerate(dir, [&](std::vector<ScanEntry>& chunk) {
+            if (m_generation.load(std::memory_order_relaxed) != generation) {
+                superseded = true;
+                return false;
+            }
+            for (auto& se : chunk)
+                batch.entries.push_back(std::move(se));
+            stats.entryCount += chunk.size();
+
+            if (batch.entries.size() >= batchLimit ||
+                std::chrono::steady_clock::now() - lastFlush >= kFlushInterval) {
+                if (!flush(false)) {
+                    superseded = true;
+                    return false;
+                }
+            }
+            return true;
+        }, ec);
+        if (ec) {
+            LOG_ERROR("Filesystem error in scan for %s: %s", dir.string().c_str(), ec.message().c_str());
+        }
+    } catch (const fs::filesystem_error& e) {
+        LOG_ERROR("Filesystem error in scan for %s: %s", dir.string().c_str(), e.what());
+    } catch (const std::exception& e) {
+        LOG_ERROR("Standard exception in scan: %s", e.what());
+    } catch (...) {
+        LOG_ERROR("Unknown exception in scan for %s", dir.string().c_str());
+    }
+
+    // 无论成功与否都要发出结束批次，UI 才能关闭“扫描中”提示
+    if (!superseded && !flush(true))
+        superseded = true;
+
+    stats.totalTime = ElapsedSince(startTime);
+    stats.cancelled = superseded;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_lastStats = stats;
+    }
+    double seconds = stats.totalTime.count() / 1e6;
+    LOG_INFO("Scanned %s [%s]: %llu entries, first batch %lld us, total %lld us (%.0f entries/s)%s",
+             dir.string().c_str(), stats.backend, (unsigned long long)stats.entryCount,
+             (long long)stats.timeToFirstBatch.count(), (long long)stats.totalTime.count(),
+             seconds > 0 ? stats.entryCount / seconds : 0.0, superseded ? " (cancelled)" : "");
+}
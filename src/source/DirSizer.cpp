@@ -0,0 +1,448 @@
+// DirSizer.cpp
+// Parallel recursive folder size implementation for FileMgr
+//
+// Key features:
+// - Work-stealing worker pool (own deque from the back, steal from the front)
+// - Per-subfolder running totals, polled by the UI while the walk runs
+// - Logical and allocated sizes; multi-link files counted once by file id
+// - Per-folder cache validated by the folder's modification time
+// - Win32 GetFileInformationByHandleEx / POSIX fstatat enumeration
+//
+
+#include "../include/DirSizer.hpp"
+#include "../include/Common.hpp"
+#include "../include/EntrySorter.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr std::uint32_t kMaxDepth = 512;               // 绑定挂载等造成的环只下探到这个深度
+    constexpr std::size_t kMaxCacheEntries = 1 << 20;      // 缓存目录数上限，超出时清空所在分片
+    constexpr int kSpinsBeforeSleep = 64;                  // 空闲线程先让出几次再短暂休眠
+
+#ifdef _WIN32
+    constexpr DWORD kBufferSize = 64 * 1024;               // 每次取一批目录项
+
+    // FILETIME（1601 年起的 100 ns）转成 Unix 纳秒
+    std::int64_t FileTimeToNanos(std::int64_t ticks) {
+        return (ticks - 116444736000000000LL) * 100;
+    }
+
+    HANDLE OpenFolder(const fs::path& path) {
+        return CreateFileW(path.c_str(), FILE_LIST_DIRECTORY | FILE_READ_ATTRIBUTES,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                           FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    }
+
+    // 目录所在卷的序列号
+    bool FolderDevice(const fs::path& path, std::uint64_t& device) {
+        HANDLE h = OpenFolder(path);
+        if (h == INVALID_HANDLE_VALUE)
+            return false;
+        BY_HANDLE_FILE_INFORMATION info;
+        bool ok = GetFileInformationByHandle(h, &info) != FALSE;
+        CloseHandle(h);
+        device = ok ? info.dwVolumeSerialNumber : 0;
+        return ok;
+    }
+#else
+    bool FolderDevice(const fs::path& path, std::uint64_t& device) {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0)
+            return false;
+        device = (std::uint64_t)st.st_dev;
+        return true;
+    }
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Construction / Destruction
+// -----------------------------------------------------------------------------
+
+DirSizer::~DirSizer() {
+    Stop();
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+std::uint64_t DirSizer::Start(const fs::path& root, const std::vector<fs::path::string_type>& children,
+                              bool useCache, int threads) {
+    Stop();
+    m_cancel = false;
+    ++m_generation;
+
+    threads = threads > 0 ? std::min(threads, 64) : EntrySorter::DefaultThreadCount();
+    m_root = root;
+    m_useCache = useCache;
+    if (!FolderDevice(root, m_rootDevice))
+        LOG_ERROR("Folder sizes: cannot open %s", root.string().c_str());
+
+    // 第 k 个子目录对应槽 k；最后一个槽记录根目录自身和它直接包含的文件
+    m_childSlots.clear();
+    for (std::size_t k = 0; k < children.size(); ++k)
+        m_childSlots.emplace(children[k], (std::uint32_t)k);
+    m_slotCount = children.size() + 1;
+    m_slots.reset(new SlotState[m_slotCount]);
+    for (LinkShard& shard : m_links)
+        shard.keys.clear();
+    m_visited = 0;
+    m_cached = 0;
+    m_linked = 0;
+    m_steals = 0;
+    m_errors = 0;
+    m_elapsed = 0;
+    m_outstanding = 0;
+
+    m_queues.clear();
+    for (int k = 0; k < threads; ++k)
+        m_queues.push_back(std::make_unique<Queue>());
+    Push(0, Work{ root, (std::uint32_t)children.size(), 0 });
+    for (std::size_t k = 0; k < children.size(); ++k)
+        Push(k % threads, Work{ root / children[k], (std::uint32_t)k, 1 });
+
+    m_start = std::chrono::steady_clock::now();
+    m_running = true;
+    m_live = threads;
+    for (int k = 0; k < threads; ++k)
+        m_workers.emplace_back(&DirSizer::WorkerLoop, this, (std::size_t)k);
+    return m_generation;
+}
+
+void DirSizer::Cancel() {
+    Stop();
+}
+
+void DirSizer::GetSlots(std::vector<Slot>& out) const {
+    std::size_t count = m_slotCount ? m_slotCount - 1 : 0;
+    out.resize(count);
+    for (std::size_t k = 0; k < count; ++k) {
+        const SlotState& state = m_slots[k];
+        Slot& slot = out[k];
+        // pending 先读：为 0 时其余计数已是最终值
+        slot.done = state.pending.load(std::memory_order_acquire) == 0;
+        slot.totals.logical = state.logical.load(std::memory_order_relaxed);
+        slot.totals.allocated = state.allocated.load(std::memory_order_relaxed);
+        slot.totals.files = state.files.load(std::memory_order_relaxed);
+        slot.totals.folders = state.folders.load(std::memory_order_relaxed);
+    }
+}
+
+DirSizer::Stats DirSizer::GetStats() const {
+    Stats stats;
+    stats.generation = m_generation;
+    for (std::size_t k = 0; k < m_slotCount; ++k) {
+        const SlotState& state = m_slots[k];
+        stats.total.logical += state.logical.load(std::memory_order_relaxed);
+        stats.total.allocated += state.allocated.load(std::memory_order_relaxed);
+        stats.total.files += state.files.load(std::memory_order_relaxed);
+        stats.total.folders += state.folders.load(std::memory_order_relaxed);
+    }
+    stats.visited = m_visited;
+    stats.cached = m_cached;
+    stats.linked = m_linked;
+    stats.steals = m_steals;
+    stats.errors = m_errors;
+    stats.threads = (int)m_queues.size();
+    stats.running = IsRunning();
+    stats.time = stats.running ? ElapsedSince(m_start) : std::chrono::microseconds(m_elapsed.load());
+    for (const CacheShard& shard : m_cache) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.cacheEntries += shard.entries.size();
+    }
+    return stats;
+}
+
+void DirSizer::Wait() {
+    for (std::thread& worker : m_workers) {
+        if (worker.joinable())
+            worker.join();
+    }
+    m_workers.clear();
+}
+
+void DirSizer::ClearCache() {
+    for (CacheShard& shard : m_cache) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.clear();
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Workers
+// -----------------------------------------------------------------------------
+
+void DirSizer::WorkerLoop(std::size_t self) {
+    Work work;
+    int idle = 0;
+    while (!m_cancel.load(std::memory_order_relaxed)) {
+        if (Take(self, work)) {
+            Visit(self, work);
+            idle = 0;
+            continue;
+        }
+        // 所有目录都已读完；否则别的线程正在读的目录还可能产生新工作
+        if (m_outstanding.load(std::memory_order_acquire) == 0)
+            break;
+        if (++idle < kSpinsBeforeSleep)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    // 最后一个退出的线程收尾
+    if (m_live.fetch_sub(1) == 1) {
+        m_elapsed = ElapsedSince(m_start).count();
+        m_running.store(false, std::memory_order_release);
+        if (!m_cancel) {
+            Stats stats = GetStats();
+            LOG_INFO("Folder sizes for %s: %llu files, %llu folders, %.1f MB (%.1f MB on disk) in %.2f s "
+                     "(%d folders from cache, %d hard links skipped, %d steals, %d threads)",
+                     m_root.string().c_str(), (unsigned long long)stats.total.files,
+                     (unsigned long long)stats.total.folders, stats.total.logical / 1e6,
+                     stats.total.allocated / 1e6, stats.time.count() / 1e6, (int)stats.cached, (int)stats.linked,
+                     (int)stats.steals, stats.threads);
+        }
+    }
+}
+
+bool DirSizer::Take(std::size_t self, Work& work) {
+    {
+        // 自己的队列从尾部取：最近压入的子目录，缓存里还热
+        Queue& own = *m_queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.items.empty()) {
+            work = std::move(own.items.back());
+            own.items.pop_back();
+            return true;
+        }
+    }
+    // 从别的线程队列头部偷：最早压入的目录，通常是较大的子树
+    std::size_t count = m_queues.size();
+    for (std::size_t k = 1; k < count; ++k) {
+        Queue& victim = *m_queues[(self + k) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.items.empty()) {
+            work = std::move(victim.items.front());
+            victim.items.pop_front();
+            m_steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void DirSizer::Push(std::size_t self, Work work) {
+    // 计数先于入队增加，这样计数归零时队列一定为空
+    m_slots[work.slot].pending.fetch_add(1, std::memory_order_relaxed);
+    m_outstanding.fetch_add(1, std::memory_order_relaxed);
+    Queue& queue = *m_queues[self];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.items.push_back(std::move(work));
+}
+
+void DirSizer::Visit(std::size_t self, const Work& work) {
+    if (!m_cancel.load(std::memory_order_relaxed)) {
+        CacheEntry entry;
+        switch (ReadFolder(self, work, entry)) {
+        case ReadResult::Read: {
+            Account(self, work, entry);
+            CacheShard& shard = m_cache[std::hash<fs::path::string_type>()(work.path.native()) % kShards];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (shard.entries.size() >= kMaxCacheEntries / kShards)
+                shard.entries.clear();
+            shard.entries[work.path.native()] = std::move(entry);
+            break;
+        }
+        case ReadResult::Failed:
+            m_errors.fetch_add(1, std::memory_order_relaxed);
+            break;
+        default:
+            break;
+        }
+    }
+    // 子目录都已入队之后才减计数
+    m_slots[work.slot].pending.fetch_sub(1, std::memory_order_release);
+    m_outstanding.fetch_sub(1, std::memory_order_release);
+}
+
+void DirSizer::Account(std::size_t self, const Work& work, const CacheEntry& entry) {
+    Totals add = entry.own;
+    for (const LinkedFile& file : entry.linked) {
+        if (ClaimLink(file.key)) {
+            add.logical += file.logical;
+            add.allocated += file.allocated;
+            ++add.files;
+        } else {
+            m_linked.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    SlotState& slot = m_slots[work.slot];
+    slot.logical.fetch_add(add.logical, std::memory_order_relaxed);
+    slot.allocated.fetch_add(add.allocated, std::memory_order_relaxed);
+    slot.files.fetch_add(add.files, std::memory_order_relaxed);
+    slot.folders.fetch_add(add.folders, std::memory_order_relaxed);
+    m_visited.fetch_add(1, std::memory_order_relaxed);
+
+    if (work.depth >= kMaxDepth)
+        return;
+    for (const fs::path::string_type& name : entry.subfolders) {
+        // 列表里的子目录在 Start() 时已单独入队
+        if (work.depth == 0 && m_childSlots.count(name))
+            continue;
+        Push(self, Work{ work.path / name, work.slot, work.depth + 1 });
+    }
+}
+
+bool DirSizer::ClaimLink(const FileKey& key) {
+    LinkShard& shard = m_links[FileKeyHash()(key) % kShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.keys.insert(key).second;
+}
+
+void DirSizer::Stop() {
+    m_cancel = true;
+    Wait();
+    m_running = false;
+}
+
+// -----------------------------------------------------------------------------
+// Reading folders
+// -----------------------------------------------------------------------------
+
+DirSizer::ReadResult DirSizer::ReadFolder(std::size_t self, const Work& work, CacheEntry& entry) {
+    std::int64_t time = 0;
+    auto fromCache = [&]() -> bool {
+        if (!m_useCache)
+            return false;
+        CacheShard& shard = m_cache[std::hash<fs::path::string_type>()(work.path.native()) % kShards];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(work.path.native());
+        if (it == shard.entries.end() || it->second.time != time)
+            return false;
+        // Account() 只取链接集合和队列的锁，不会反过来等缓存锁
+        Account(self, work, it->second);
+        m_cached.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    };
+
+#ifdef _WIN32
+    HANDLE h = OpenFolder(work.path);
+    if (h == INVALID_HANDLE_VALUE)
+        return ReadResult::Failed;
+    FILE_BASIC_INFO basic;
+    if (!GetFileInformationByHandleEx(h, FileBasicInfo, &basic, sizeof(basic))) {
+        CloseHandle(h);
+        return ReadResult::Failed;
+    }
+    time = FileTimeToNanos(basic.LastWriteTime.QuadPart);
+    if (fromCache()) {
+        CloseHandle(h);
+        return ReadResult::Cached;
+    }
+
+    // 目录项自带大小、占用空间和文件 ID，不需要逐个打开文件；
+    // 但没有链接数，所以每个文件都按 ID 去重
+    alignas(8) thread_local std::uint8_t buffer[kBufferSize];
+    entry.time = time;
+    FILE_INFO_BY_HANDLE_CLASS infoClass = FileIdBothDirectoryRestartInfo;
+    for (;;) {
+        if (!GetFileInformationByHandleEx(h, infoClass, buffer, kBufferSize)) {
+            DWORD error = GetLastError();
+            CloseHandle(h);
+            return error == ERROR_NO_MORE_FILES ? ReadResult::Read : ReadResult::Failed;
+        }
+        infoClass = FileIdBothDirectoryInfo;
+        const std::uint8_t* p = buffer;
+        for (;;) {
+            const auto* info = reinterpret_cast<const FILE_ID_BOTH_DIR_INFO*>(p);
+            std::size_t length = info->FileNameLength / sizeof(WCHAR);
+            const WCHAR* name = info->FileName;
+            bool dot = (length == 1 && name[0] == L'.') || (length == 2 && name[0] == L'.' && name[1] == L'.');
+            if (!dot) {
+                if (info->FileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                    // 目录联接和符号链接不跟随
+                    if (!(info->FileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)) {
+                        entry.subfolders.emplace_back(name, length);
+                        ++entry.own.folders;
+                    }
+                } else {
+                    entry.linked.push_back({ { m_rootDevice, (std::uint64_t)info->FileId.QuadPart },
+                                             (std::uint64_t)info->EndOfFile.QuadPart,
+                                             (std::uint64_t)info->AllocationSize.QuadPart });
+                }
+            }
+            if (info->NextEntryOffset == 0)
+                break;
+            p += info->NextEntryOffset;
+        }
+    }
+#else
+    int fd = open(work.path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd < 0)
+        return ReadResult::Failed;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return ReadResult::Failed;
+    }
+    // 不跨越挂载点
+    if ((std::uint64_t)st.st_dev != m_rootDevice) {
+        close(fd);
+        return ReadResult::Skipped;
+    }
+    time = (std::int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    if (fromCache()) {
+        close(fd);
+        return ReadResult::Cached;
+    }
+
+    DIR* dir = fdopendir(fd);
+    if (!dir) {
+        close(fd);
+        return ReadResult::Failed;
+    }
+    entry.time = time;
+    entry.own.allocated = (std::uint64_t)st.st_blocks * 512;
+    while (dirent* de = readdir(dir)) {
+        const char* name = de->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+            continue;
+        if (de->d_type == DT_DIR) {
+            entry.subfolders.emplace_back(name);
+            ++entry.own.folders;
+            continue;
+        }
+        // 符号链接本身按文件计（不跟随）
+        struct stat file;
+        if (fstatat(fd, name, &file, AT_SYMLINK_NOFOLLOW) != 0)
+            continue;
+        if (S_ISDIR(file.st_mode)) {
+            entry.subfolders.emplace_back(name);
+            ++entry.own.folders;
+        } else if (file.st_nlink > 1) {
+            entry.linked.push_back({ { (std::uint64_t)file.st_dev, (std::uint64_t)file.st_ino },
+                                     (std::uint64_t)file.st_size, (std::uint64_t)file.st_blocks * 512 });
+        } else {
+            entry.own.logical += (std::uint64_t)file.st_size;
+            entry.own.allocated += (std::uint64_t)file.st_blocks * 512;
+            ++entry.own.files;
+        }
+    }
+    closedir(dir);
+    return ReadResult::Read;
+#endif
+}
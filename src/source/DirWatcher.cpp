@@ -0,0 +1,618 @@
+// DirWatcher.cpp
+// Filesystem change notification implementation for FileMgr
+//
+// Key features:
+// - Windows: ReadDirectoryChangesW per directory, all on one completion port
+// - Linux: one inotify descriptor plus an eventfd for wake-ups
+// - Per-directory debounce (quiet period with an upper bound)
+// - Lost events are reported as a change of the affected directories
+// - mtime polling for network/FUSE filesystems with adaptive intervals
+//   and a global stat budget
+//
+
+#include "../include/DirWatcher.hpp"
+#include "../include/DirEnumerator.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <unordered_set>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+#include <cstdint>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    using std::chrono::milliseconds;
+
+    constexpr milliseconds kMinPollInterval(1000);     // 刚发现变化后的轮询间隔
+    constexpr milliseconds kMaxPollInterval(30000);    // 长期无变化时的上限
+    constexpr int kStatBudget = 20;                    // 全局每秒最多 stat 次数
+
+    // 读取目录修改时间；网络文件系统上绕过客户端属性缓存
+    bool StatWriteTime(const fs::path& dir, std::chrono::system_clock::time_point& out) {
+#if defined(__linux__)
+        struct statx stx;
+        if (::statx(AT_FDCWD, dir.c_str(), AT_STATX_FORCE_SYNC, STATX_MTIME, &stx) != 0)
+            return false;
+        out = std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::seconds(stx.stx_mtime.tv_sec) + std::chrono::nanoseconds(stx.stx_mtime.tv_nsec)));
+        return true;
+#else
+        return QueryWriteTime(dir, out);
+#endif
+    }
+
+#ifdef _WIN32
+    constexpr DWORD kNotifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME |
+                                    FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE |
+                                    FILE_NOTIFY_CHANGE_ATTRIBUTES;
+    constexpr std::size_t kBufferBytes = 64 * 1024;    // 网络共享上限也是 64 KB
+
+    // 一个被监视的目录：重叠 I/O 进行期间 OVERLAPPED 和缓冲区必须保持有效
+    struct Watch {
+        fs::path dir;
+        HANDLE handle = INVALID_HANDLE_VALUE;
+        OVERLAPPED overlapped{};
+        std::vector<DWORD> buffer = std::vector<DWORD>(kBufferBytes / sizeof(DWORD));
+        bool closing = false;                          // 已取消，等待完成包后释放
+    };
+
+    bool IssueRead(Watch& w) {
+        w.overlapped = OVERLAPPED{};
+        return ReadDirectoryChangesW(w.handle, w.buffer.data(), (DWORD)kBufferBytes, FALSE, kNotifyFilter,
+                                     nullptr, &w.overlapped, nullptr) != 0;
+    }
+#elif defined(__linux__)
+    constexpr std::uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE |
+                                         IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |
+                                         IN_ONLYDIR;
+
+    int ToFd(void* handle) { return (int)reinterpret_cast<intptr_t>(handle); }
+#endif
+}
+
+DirWatcher::DirWatcher(std::chrono::milliseconds quietTime, std::chrono::milliseconds maxDelay)
+    : m_quietTime(quietTime), m_maxDelay(maxDelay), m_available(false), m_handle(nullptr),
+      m_wakeHandle(nullptr), m_stop(false), m_dirsChanged(false), m_statTokens(kStatBudget),
+      m_tokenTime(std::chrono::steady_clock::now()), m_rateStart(m_tokenTime), m_rateCount(0) {
+    m_stats.statBudget = kStatBudget;
+#ifdef _WIN32
+    HANDLE port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+    if (port) {
+        m_handle = port;
+        m_available = true;
+        m_stats.backend = "ReadDirectoryChangesW";
+    }
+#elif defined(__linux__)
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    int wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd >= 0 && wakeFd >= 0) {
+        m_handle = reinterpret_cast<void*>((intptr_t)fd);
+        m_wakeHandle = reinterpret_cast<void*>((intptr_t)wakeFd);
+        m_available = true;
+        m_stats.backend = "inotify";
+    } else {
+        if (fd >= 0)
+            ::close(fd);
+        if (wakeFd >= 0)
+            ::close(wakeFd);
+    }
+#endif
+    if (!m_available) {
+        LOG_ERROR("DirWatcher: change notifications unavailable, folders refresh manually only");
+        return;
+    }
+    m_worker = std::thread(&DirWatcher::WorkerLoop, this);
+}
+
+DirWatcher::~DirWatcher() {
+    if (!m_available)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    Wake();
+    m_worker.join();
+#ifdef _WIN32
+    CloseHandle(static_cast<HANDLE>(m_handle));
+#elif defined(__linux__)
+    ::close(ToFd(m_handle));
+    ::close(ToFd(m_wakeHandle));
+#endif
+}
+
+void DirWatcher::Wake() {
+#ifdef _WIN32
+    PostQueuedCompletionStatus(static_cast<HANDLE>(m_handle), 0, 0, nullptr);
+#elif defined(__linux__)
+    std::uint64_t one = 1;
+    if (::write(ToFd(m_wakeHandle), &one, sizeof(one)) < 0) {
+        // 计数器已满时写入失败，但线程本来就会被唤醒
+    }
+#endif
+}
+
+void DirWatcher::SetWatchedDirs(const std::vector<fs::path>& dirs) {
+    if (!m_available)
+        return;
+    std::vector<fs::path> unique;
+    std::unordered_set<fs::path::string_type> seen;
+    for (const auto& dir : dirs) {
+        if (!dir.empty() && seen.insert(dir.native()).second)
+            unique.push_back(dir);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (unique == m_dirs)
+            return;
+        m_dirs = std::move(unique);
+        m_dirsChanged = true;
+    }
+    Wake();
+}
+
+void DirWatcher::MarkChanged(const fs::path& dir, std::chrono::steady_clock::time_point now) {
+    auto result = m_pending.try_emplace(dir.native());
+    Pending& pending = result.first->second;
+    if (result.second) {
+        pending.dir = dir;
+        pending.first = now;
+    }
+    pending.last = now;
+}
+
+bool DirWatcher::Poll(std::vector<fs::path>& changed) {
+    changed.clear();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pending.empty())
+        return false;
+    // 安静一段时间后再报告；持续变化的目录也至少每 maxDelay 报告一次
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (now - it->second.last >= m_quietTime || now - it->second.first >= m_maxDelay) {
+            changed.push_back(std::move(it->second.dir));
+            it = m_pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_stats.reported += changed.size();
+    return !changed.empty();
+}
+
+DirWatcher::Stats DirWatcher::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+bool DirWatcher::NeedsPolling(const fs::path& dir) {
+#ifdef _WIN32
+    // 网络驱动器（含映射的共享和 UNC 路径）
+    wchar_t volume[MAX_PATH];
+    if (!GetVolumePathNameW(dir.c_str(), volume, MAX_PATH))
+        return false;
+    return GetDriveTypeW(volume) == DRIVE_REMOTE;
+#elif defined(__linux__)
+    // 这些文件系统上 inotify 只能看到本机发起的修改
+    struct statfs sfs;
+    if (::statfs(dir.c_str(), &sfs) != 0)
+        return false;
+    switch ((unsigned long)sfs.f_type) {
+    case 0x6969:        // NFS
+    case 0x517B:        // SMB
+    case 0xFF534D42:    // CIFS
+    case 0xFE534D42:    // SMB2
+    case 0x65735546:    // FUSE (sshfs, rclone, ...)
+    case 0x01021997:    // 9P
+    case 0x5346414F:    // AFS
+    case 0x73757245:    // Coda
+    case 0x00C36400:    // Ceph
+        return true;
+    default:
+        return false;
+    }
+#else
+    (void)dir;
+    return true;
+#endif
+}
+
+void DirWatcher::SetPolled(const std::vector<fs::path>& dirs) {
+    std::vector<Polled> polled;
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& dir : dirs) {
+        auto it = std::find_if(m_polled.begin(), m_polled.end(), [&](const Polled& p) { return p.dir == dir; });
+        if (it != m_polled.end()) {
+            polled.push_back(std::move(*it));
+            continue;
+        }
+        // 新目录立即检查一次，记下基准修改时间
+        polled.push_back(Polled{ dir, {}, false, kMinPollInterval, now });
+    }
+    m_polled.swap(polled);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.polled = m_polled.size();
+}
+
+bool DirWatcher::IsPolled(const fs::path& dir) const {
+    return std::any_of(m_polled.begin(), m_polled.end(), [&](const Polled& p) { return p.dir == dir; });
+}
+
+int DirWatcher::RunPolls() {
+    if (m_polled.empty())
+        return -1;
+
+    // 令牌桶：按预算匀速补充，最多攒一秒的量
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - m_tokenTime).count();
+    m_statTokens = std::min<double>(kStatBudget, m_statTokens + elapsed * kStatBudget);
+    m_tokenTime = now;
+
+    // 最早到期的先查
+    std::vector<Polled*> due;
+    for (auto& p : m_polled) {
+        if (p.due <= now)
+            due.push_back(&p);
+    }
+    std::sort(due.begin(), due.end(), [](const Polled* a, const Polled* b) { return a->due < b->due; });
+
+    std::vector<fs::path> changed;
+    int checks = 0;
+    std::size_t deferred = 0;
+    for (Polled* p : due) {
+        if (m_statTokens < 1.0) {
+            ++deferred;
+            continue;
+        }
+        m_statTokens -= 1.0;
+        ++checks;
+        std::chrono::system_clock::time_point writeTime;
+        bool ok = StatWriteTime(p->dir, writeTime);
+        // 目录消失也算变化（之前能读到时间的话）
+        bool isChanged = p->known && (!ok || writeTime != p->writeTime);
+        p->known = ok;
+        p->writeTime = writeTime;
+        // 有变化：回到最短间隔；无变化：逐步放宽
+        if (isChanged) {
+            changed.push_back(p->dir);
+            p->interval = kMinPollInterval;
+        } else {
+            p->interval = std::min(kMaxPollInterval, milliseconds(p->interval.count() * 3 / 2));
+        }
+        p->due = now + p->interval;
+    }
+
+    // 每满一秒公布一次上一秒的检查次数
+    int lastSecond = -1;
+    if (now - m_rateStart >= std::chrono::seconds(1)) {
+        lastSecond = m_rateCount;
+        m_rateStart = now;
+        m_rateCount = 0;
+    }
+    m_rateCount += checks;
+
+    auto next = std::chrono::steady_clock::time_point::max();
+    milliseconds shortest = kMaxPollInterval, longest(0);
+    for (const auto& p : m_polled) {
+        next = std::min(next, p.due);
+        shortest = std::min(shortest, p.interval);
+        longest = std::max(longest, p.interval);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.polls += checks;
+        m_stats.pollChanges += changed.size();
+        m_stats.overdue = deferred;
+        if (lastSecond >= 0)
+            m_stats.pollsLastSecond = lastSecond;
+        m_stats.minInterval = shortest.count() / 1000.0;
+        m_stats.maxInterval = longest.count() / 1000.0;
+        for (const auto& dir : changed)
+            MarkChanged(dir, now);
+    }
+
+    // 预算用完时等下一个令牌
+    if (deferred > 0)
+        return 1000 / kStatBudget + 1;
+    auto wait = std::chrono::duration_cast<milliseconds>(next - now).count();
+    return (int)std::max<long long>(wait, 0) + 1;
+}
+
+#ifdef _WIN32
+
+void DirWatcher::WorkerLoop() {
+    HANDLE port = static_cast<HANDLE>(m_handle);
+    std::unordered_map<fs::path::string_type, std::unique_ptr<Watch>> active;
+    std::vector<std::unique_ptr<Watch>> closing;
+
+    // 取消的读请求仍会投递完成包，收到后才能释放 Watch
+    auto cancel = [&](std::unique_ptr<Watch> w) {
+        w->closing = true;
+        CancelIoEx(w->handle, &w->overlapped);
+        closing.push_back(std::move(w));
+    };
+    auto release = [&](Watch* w) {
+        CloseHandle(w->handle);
+        closing.erase(std::remove_if(closing.begin(), closing.end(),
+                                     [w](const std::unique_ptr<Watch>& p) { return p.get() == w; }),
+                      closing.end());
+    };
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_stop)
+                break;
+            if (m_dirsChanged) {
+                std::vector<fs::path> dirs = m_dirs;
+                m_dirsChanged = false;
+                lock.unlock();
+
+                std::unordered_set<fs::path::string_type> wanted;
+                for (const auto& dir : dirs)
+                    wanted.insert(dir.native());
+                for (auto it = active.begin(); it != active.end();) {
+                    if (!wanted.count(it->first)) {
+                        cancel(std::move(it->second));
+                        it = active.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+                // 无法监视或位于网络驱动器的目录改为轮询（网络驱动器上的通知仍然保留）
+                std::vector<fs::path> pollDirs;
+                for (const auto& dir : dirs) {
+                    if (active.count(dir.native())) {
+                        if (IsPolled(dir))
+                            pollDirs.push_back(dir);
+                        continue;
+                    }
+                    auto w = std::make_unique<Watch>();
+                    w->dir = dir;
+                    w->handle = CreateFileW(dir.c_str(), FILE_LIST_DIRECTORY,
+                                            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                            OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+                    if (w->handle == INVALID_HANDLE_VALUE) {
+                        DWORD error = GetLastError();
+                        if (error != ERROR_FILE_NOT_FOUND && error != ERROR_PATH_NOT_FOUND)
+                            pollDirs.push_back(dir);
+                        continue;
+                    }
+                    if (!CreateIoCompletionPort(w->handle, port, reinterpret_cast<ULONG_PTR>(w.get()), 0) ||
+                        !IssueRead(*w)) {
+                        CloseHandle(w->handle);
+                        pollDirs.push_back(dir);
+                        continue;
+                    }
+                    if (NeedsPolling(dir))
+                        pollDirs.push_back(dir);
+                    active.emplace(dir.native(), std::move(w));
+                }
+                SetPolled(pollDirs);
+
+                lock.lock();
+                m_stats.watched = active.size();
+            }
+        }
+
+        // 有轮询目录时最多等到下一次检查
+        int timeout = RunPolls();
+        DWORD bytes = 0;
+        ULONG_PTR key = 0;
+        OVERLAPPED* overlapped = nullptr;
+        BOOL ok = GetQueuedCompletionStatus(port, &bytes, &key, &overlapped, timeout < 0 ? INFINITE : (DWORD)timeout);
+        if (!overlapped)
+            continue; // Wake() 投递的空包或超时
+
+        Watch* w = reinterpret_cast<Watch*>(key);
+        if (w->closing) {
+            release(w);
+            continue;
+        }
+
+        // 统计本次收到的事件条数；bytes 为 0 表示缓冲区溢出，事件已丢失
+        std::uint64_t events = 0;
+        if (ok && bytes > 0) {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(w->buffer.data());
+            while (true) {
+                const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(p);
+                ++events;
+                if (info->NextEntryOffset == 0)
+                    break;
+                p += info->NextEntryOffset;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.events += events;
+            if (ok && bytes == 0)
+                ++m_stats.overflows;
+            MarkChanged(w->dir, std::chrono::steady_clock::now());
+        }
+
+        // 目录被删除或句柄失效时不再监视（变化已经报告）
+        if (!ok || !IssueRead(*w)) {
+            auto it = active.find(w->dir.native());
+            CloseHandle(w->handle);
+            if (it != active.end())
+                active.erase(it);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.watched = active.size();
+        }
+    }
+
+    // 退出：取消所有读请求并等它们的完成包回来，之后才能释放缓冲区
+    for (auto& entry : active)
+        cancel(std::move(entry.second));
+    active.clear();
+    while (!closing.empty()) {
+        DWORD bytes = 0;
+        ULONG_PTR key = 0;
+        OVERLAPPED* overlapped = nullptr;
+        BOOL ok = GetQueuedCompletionStatus(port, &bytes, &key, &overlapped, 1000);
+        if (!ok && !overlapped)
+            break; // 超时
+        if (overlapped)
+            release(reinterpret_cast<Watch*>(key));
+    }
+    for (auto& w : closing)
+        CloseHandle(w->handle);
+    closing.clear();
+}
+
+#elif defined(__linux__)
+
+void DirWatcher::WorkerLoop() {
+    int fd = ToFd(m_handle);
+    int wakeFd = ToFd(m_wakeHandle);
+    // 同一目录的不同路径（符号链接）会得到同一个 wd
+    std::unordered_map<int, std::vector<fs::path>> byWd;
+    std::unordered_map<fs::path::string_type, int> byPath;
+    alignas(struct inotify_event) char buffer[64 * 1024];
+
+    auto unwatch = [&](const fs::path::string_type& key, int wd) {
+        auto& paths = byWd[wd];
+        paths.erase(std::remove_if(paths.begin(), paths.end(), [&](const fs::path& p) { return p.native() == key; }),
+                    paths.end());
+        if (paths.empty()) {
+            inotify_rm_watch(fd, wd);
+            byWd.erase(wd);
+        }
+    };
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_stop)
+                break;
+            if (m_dirsChanged) {
+                std::vector<fs::path> dirs = m_dirs;
+                m_dirsChanged = false;
+                lock.unlock();
+
+                std::unordered_set<fs::path::string_type> wanted;
+                for (const auto& dir : dirs)
+                    wanted.insert(dir.native());
+                for (auto it = byPath.begin(); it != byPath.end();) {
+                    if (!wanted.count(it->first)) {
+                        unwatch(it->first, it->second);
+                        it = byPath.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+                // 无法监视（如 inotify 数量上限）或位于网络/FUSE 文件系统的目录改为轮询
+                std::vector<fs::path> pollDirs;
+                for (const auto& dir : dirs) {
+                    if (byPath.count(dir.native())) {
+                        if (IsPolled(dir))
+                            pollDirs.push_back(dir);
+                        continue;
+                    }
+                    int wd = inotify_add_watch(fd, dir.c_str(), kWatchMask);
+                    if (wd < 0) {
+                        if (errno != ENOENT)
+                            pollDirs.push_back(dir);
+                        continue;
+                    }
+                    if (NeedsPolling(dir))
+                        pollDirs.push_back(dir);
+                    byPath[dir.native()] = wd;
+                    byWd[wd].push_back(dir);
+                }
+                SetPolled(pollDirs);
+
+                lock.lock();
+                m_stats.watched = byPath.size();
+            }
+        }
+
+        // 有轮询目录时最多等到下一次检查
+        int timeout = RunPolls();
+        pollfd fds[2] = { { fd, POLLIN, 0 }, { wakeFd, POLLIN, 0 } };
+        if (::poll(fds, 2, timeout) < 0)
+            continue; // EINTR
+        if (fds[1].revents & POLLIN) {
+            std::uint64_t count;
+            if (::read(wakeFd, &count, sizeof(count)) < 0) {
+                // 非阻塞读取，计数已被取走
+            }
+        }
+        if (!(fds[0].revents & POLLIN))
+            continue;
+
+        // 读空队列；同一目录的大量事件只需要记一次
+        std::unordered_set<int> changedWds;
+        std::uint64_t events = 0;
+        bool overflow = false;
+        while (true) {
+            ssize_t len = ::read(fd, buffer, sizeof(buffer));
+            if (len <= 0)
+                break;
+            for (char* p = buffer; p < buffer + len;) {
+                const inotify_event* ev = reinterpret_cast<const inotify_event*>(p);
+                ++events;
+                if (ev->mask & IN_Q_OVERFLOW)
+                    overflow = true;
+                else if (ev->wd >= 0)
+                    changedWds.insert(ev->wd);
+                // 目录被删除：内核已移除该监视
+                if ((ev->mask & IN_IGNORED) && byWd.count(ev->wd)) {
+                    for (const auto& path : byWd[ev->wd])
+                        byPath.erase(path.native());
+                }
+                p += sizeof(inotify_event) + ev->len;
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.events += events;
+        if (overflow) {
+            // 事件已丢失：所有监视的目录都当作已变化
+            ++m_stats.overflows;
+            for (const auto& entry : byWd) {
+                for (const auto& path : entry.second)
+                    MarkChanged(path, now);
+            }
+        }
+        for (int wd : changedWds) {
+            auto it = byWd.find(wd);
+            if (it == byWd.end())
+                continue;
+            for (const auto& path : it->second)
+                MarkChanged(path, now);
+        }
+        for (auto it = byWd.begin(); it != byWd.end();) {
+            bool alive = false;
+            for (const auto& path : it->second)
+                alive |= byPath.count(path.native()) != 0;
+            it = alive ? std::next(it) : byWd.erase(it);
+        }
+        m_stats.watched = byPath.size();
+    }
+
+    for (const auto& entry : byWd)
+        inotify_rm_watch(fd, entry.first);
+}
+
+#else
+
+void DirWatcher::WorkerLoop() {}
+
+#endif
@@ -0,0 +1,267 @@
+// DisplayStrings.cpp
+// Preformatted file list row text implementation for FileMgr
+//
+// Key features:
+// - One character buffer per directory (name, size and date per row)
+// - UTF-8 names for ImGui (converted once)
+// - Local date formatting with per-day cached UTC offsets
+//
+
+#include "../include/DisplayStrings.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <ctime>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace {
+    constexpr std::int64_t kSecondsPerDay = 86400;
+    constexpr std::int32_t kMixedDay = INT32_MIN;   // 当天发生了夏令时切换
+    constexpr std::size_t kMaxCachedDays = 16384;   // 约 45 年
+    constexpr std::size_t kFolderSizeSlot = 15;     // 文件夹行为大小预留的字节数（"99999.9 GB" 也放得下）
+
+    std::int64_t FloorDiv(std::int64_t a, std::int64_t b) {
+        return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+    }
+
+    // 公历日期 -> 1970-01-01 起的天数（H. Hinnant 算法）
+    std::int64_t DaysFromCivil(std::int64_t y, unsigned m, unsigned d) {
+        y -= m <= 2;
+        const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+        const unsigned yoe = (unsigned)(y - era * 400);
+        const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + (std::int64_t)doe - 719468;
+    }
+
+    // 1970-01-01 起的天数 -> 公历日期
+    void CivilFromDays(std::int64_t z, std::int64_t& y, unsigned& m, unsigned& d) {
+        z += 719468;
+        const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        const unsigned doe = (unsigned)(z - era * 146097);
+        const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const unsigned mp = (5 * doy + 2) / 153;
+        d = doy - (153 * mp + 2) / 5 + 1;
+        m = mp < 10 ? mp + 3 : mp - 9;
+        y = (std::int64_t)yoe + era * 400 + (m <= 2);
+    }
+
+    // 文件名转为 UTF-8 追加到 out（Linux 上文件名本身就是字节串）
+    std::size_t AppendUtf8(EntryStore::NameView name, std::vector<char>& out) {
+#ifdef _WIN32
+        if (name.empty())
+            return 0;
+        int bytes = WideCharToMultiByte(CP_UTF8, 0, name.data(), (int)name.size(), nullptr, 0, nullptr, nullptr);
+        std::size_t start = out.size();
+        out.resize(start + bytes);
+        WideCharToMultiByte(CP_UTF8, 0, name.data(), (int)name.size(), out.data() + start, bytes, nullptr, nullptr);
+        return (std::size_t)bytes;
+#else
+        out.insert(out.end(), name.begin(), name.end());
+        return name.size();
+#endif
+    }
+}
+
+// -----------------------------------------------------------------------------
+// LocalTimeFormatter
+// -----------------------------------------------------------------------------
+
+bool LocalTimeFormatter::QueryOffset(std::int64_t utcSeconds, std::int32_t& offset) {
+    std::time_t tt = (std::time_t)utcSeconds;
+    std::tm tm{};
+#ifdef _WIN32
+    if (localtime_s(&tm, &tt) != 0)
+        return false;
+#else
+    if (!localtime_r(&tt, &tm))
+        return false;
+#endif
+    std::int64_t local = DaysFromCivil(tm.tm_year + 1900, (unsigned)tm.tm_mon + 1, (unsigned)tm.tm_mday) * kSecondsPerDay +
+                         tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec;
+    offset = (std::int32_t)(local - utcSeconds);
+    return true;
+}
+
+bool LocalTimeFormatter::GetUtcOffset(std::int64_t utcSeconds, std::int32_t& offset) {
+    // 按 UTC 日缓存偏移：一天的首尾偏移相同，则整天都相同（一天内最多一次切换）
+    std::int64_t day = FloorDiv(utcSeconds, kSecondsPerDay);
+    auto it = m_dayOffsets.find(day);
+    if (it == m_dayOffsets.end()) {
+        std::int32_t first, last;
+        if (!QueryOffset(day * kSecondsPerDay, first) || !QueryOffset(day * kSecondsPerDay + kSecondsPerDay - 1, last))
+            return QueryOffset(utcSeconds, offset);
+        if (m_dayOffsets.size() >= kMaxCachedDays)
+            m_dayOffsets.clear();
+        it = m_dayOffsets.emplace(day, first == last ? first : kMixedDay).first;
+    }
+    if (it->second == kMixedDay)
+        return QueryOffset(utcSeconds, offset);
+    offset = it->second;
+    return true;
+}
+
+std::size_t LocalTimeFormatter::Format(std::chrono::system_clock::time_point t, char* buf, std::size_t size) {
+    std::int64_t utc = std::chrono::floor<std::chrono::seconds>(t.time_since_epoch()).count();
+    std::int32_t offset;
+    if (!GetUtcOffset(utc, offset))
+        return 0;
+    std::int64_t local = utc + offset;
+    std::int64_t days = FloorDiv(local, kSecondsPerDay);
+    std::int64_t secs = local - days * kSecondsPerDay;
+    std::int64_t year;
+    unsigned month, day;
+    CivilFromDays(days, year, month, day);
+    if (year < 0 || year > 9999 || size < 17)
+        return 0;
+
+    // 定长格式 "YYYY-MM-DD HH:MM"，手写数字比 snprintf 快得多
+    auto put2 = [](char* p, unsigned v) { p[0] = char('0' + v / 10); p[1] = char('0' + v % 10); };
+    put2(buf, (unsigned)year / 100);
+    put2(buf + 2, (unsigned)year % 100);
+    buf[4] = '-';
+    put2(buf + 5, month);
+    buf[7] = '-';
+    put2(buf + 8, day);
+    buf[10] = ' ';
+    put2(buf + 11, (unsigned)(secs / 3600));
+    buf[13] = ':';
+    put2(buf + 14, (unsigned)(secs % 3600 / 60));
+    buf[16] = '\0';
+    return 16;
+}
+
+// -----------------------------------------------------------------------------
+// DisplayStrings
+// -----------------------------------------------------------------------------
+
+void DisplayStrings::Clear() {
+    m_text.clear();
+    m_rows.clear();
+}
+
+std::size_t DisplayStrings::FormatSize(std::uint64_t size, char* buf, std::size_t n) {
+    int len = 0;
+    if (size == 0)
+        return 0;
+    if (size < 1024)
+        len = std::snprintf(buf, n, "%llu B", (unsigned long long)size);
+    else if (size < 1024 * 1024)
+        len = std::snprintf(buf, n, "%.1f KB", size / 1024.0);
+    else if (size < 1024 * 1024 * 1024)
+        len = std::snprintf(buf, n, "%.1f MB", size / (1024.0 * 1024.0));
+    else
+        len = std::snprintf(buf, n, "%.1f GB", size / (1024.0 * 1024.0 * 1024.0));
+    return len > 0 ? std::min((std::size_t)len, n - 1) : 0;
+}
+
+void DisplayStrings::Reserve(const EntryStore& entries, std::size_t first) {
+    // 按批次追加时保持几何增长，避免每批精确 reserve 导致反复整体拷贝
+    // 文本预估：平均名字长度 + 大小和日期约 32 字节
+    std::size_t count = entries.Size();
+    std::size_t textNeeded = m_text.size() + (entries.GetNameChars() / count + 32) * (count - first);
+    if (m_text.capacity() < textNeeded)
+        m_text.reserve(std::max(textNeeded, m_text.capacity() * 2));
+    if (m_rows.capacity() < count)
+        m_rows.reserve(std::max(count, m_rows.capacity() * 2));
+}
+
+void DisplayStrings::FormatRow(const EntryStore& entries, EntryStore::Index index) {
+    char buf[32];
+    Row row{};
+    row.offset = (std::uint32_t)m_text.size();
+    row.nameLength = (std::uint16_t)AppendUtf8(entries.GetName(index), m_text);
+    m_text.push_back('\0');
+
+    // 扩展名直接指向名字内部：最后一个 '.' 之后，开头的点不算；文件夹没有扩展名
+    row.typeOffset = row.nameLength;
+    if (!entries.IsDirectory(index)) {
+        const char* name = m_text.data() + row.offset;
+        for (std::size_t k = row.nameLength; k > 1; --k) {
+            if (name[k - 1] == '.') {
+                row.typeOffset = (std::uint16_t)k;
+                break;
+            }
+        }
+    }
+
+    // 文件夹先不显示大小，但预留位置，递归大小算出后原地写入
+    std::size_t len = entries.IsDirectory(index) ? 0 : FormatSize(entries.GetSize(index), buf, sizeof(buf));
+    row.sizeLength = (std::uint8_t)len;
+    row.sizeSlot = (std::uint8_t)(entries.IsDirectory(index) ? kFolderSizeSlot : len);
+    m_text.insert(m_text.end(), buf, buf + len);
+    m_text.insert(m_text.end(), row.sizeSlot - len + 1, '\0');
+
+    len = m_time.Format(entries.GetWriteTime(index), buf, sizeof(buf));
+    row.dateLength = (std::uint8_t)len;
+    m_text.insert(m_text.end(), buf, buf + len);
+    m_text.push_back('\0');
+
+    m_rows.push_back(row);
+}
+
+void DisplayStrings::Update(const EntryStore& entries) {
+    std::size_t first = m_rows.size();
+    if (first >= entries.Size())
+        return;
+    Reserve(entries, first);
+    for (std::size_t i = first; i < entries.Size(); ++i)
+        FormatRow(entries, (EntryStore::Index)i);
+}
+
+void DisplayStrings::Remap(const std::vector<EntryStore::Index>& reuse, const EntryStore& entries) {
+    std::vector<char> oldText;
+    std::vector<Row> oldRows;
+    oldText.swap(m_text);
+    oldRows.swap(m_rows);
+    if (entries.Empty())
+        return;
+    Reserve(entries, 0);
+
+    for (std::size_t i = 0; i < entries.Size(); ++i) {
+        EntryStore::Index from = reuse[i];
+        if (from == EntryStore::kNoIndex || from >= oldRows.size()) {
+            FormatRow(entries, (EntryStore::Index)i);
+            continue;
+        }
+        // 未变化的行：name\0size\0date\0 整段复制
+        Row row = oldRows[from];
+        std::size_t bytes = row.nameLength + row.sizeSlot + row.dateLength + 3;
+        const char* text = oldText.data() + row.offset;
+        row.offset = (std::uint32_t)m_text.size();
+        m_text.insert(m_text.end(), text, text + bytes);
+        m_rows.push_back(row);
+    }
+}
+
+void DisplayStrings::SetSize(EntryStore::Index i, std::uint64_t size) {
+    // 文件的大小文本不会有 kFolderSizeSlot 那么长，据此只改文件夹行
+    Row& row = m_rows[i];
+    if (row.sizeSlot != kFolderSizeSlot)
+        return;
+    // 空文件夹显示 "0 B"，与尚未计算（空串）区分开
+    char buf[32];
+    std::size_t len = size == 0 ? (std::size_t)std::snprintf(buf, sizeof(buf), "0 B")
+                                : FormatSize(size, buf, sizeof(buf));
+    len = std::min<std::size_t>(len, row.sizeSlot);
+    char* text = m_text.data() + row.offset + row.nameLength + 1;
+    std::copy(buf, buf + len, text);
+    text[len] = '\0';
+    row.sizeLength = (std::uint8_t)len;
+}
+
+void DisplayStrings::ClearSize(EntryStore::Index i) {
+    Row& row = m_rows[i];
+    if (row.sizeSlot != kFolderSizeSlot)
+        return;
+    m_text[row.offset + row.nameLength + 1] = '\0';
+    row.sizeLength = 0;
+}
+
+std::size_t DisplayStrings::GetMemoryBytes() const {
+    return m_text.capacity() + m_rows.capacity() * sizeof(Row);
+}
@@ -0,0 +1,311 @@
+// DuplicateBenchmark.cpp
+// Duplicate finder benchmark implementation for FileMgr
+//
+// Key features:
+// - Deterministic tree: random sizes, common sizes, planted sets,
+//   near-duplicates and hard links
+// - Finder run with and without the partial-hash stage
+// - Found groups checked against the planted sets
+// - Dedupe run (clones, then hard links) on a fresh tree with a file
+//   changed after the search; contents checked after each pass
+//
+
+#include "../include/DuplicateBenchmark.hpp"
+#include "../include/Common.hpp"
+#include "../include/Deduplicator.hpp"
+#include "../include/DuplicateFinder.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // 很多文件共用的大小（同样大小的记录、图标、块文件等），只靠大小分不开
+    const std::uint64_t kCommonSizes[] = { 4096, 65536, 131072, 200000 };
+    constexpr int kCommonPercent = 30;                  // 这么多比例的文件取常见大小
+    constexpr std::uint64_t kMinSize = 512;
+
+    // 由种子生成文件内容（splitmix64）
+    void FillContents(std::uint64_t seed, std::vector<char>& data) {
+        std::uint64_t state = seed;
+        for (std::size_t k = 0; k < data.size(); k += 8) {
+            std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            z ^= z >> 31;
+            for (std::size_t b = 0; b < 8 && k + b < data.size(); ++b)
+                data[k + b] = (char)(z >> (8 * b));
+        }
+    }
+
+    // 运行一次查找，等待结束并取回所有组
+    DuplicateFinder::Stats Find(const fs::path& tree, const DuplicateFinder::Options& options,
+                                std::vector<DuplicateFinder::Group>& groups) {
+        DuplicateFinder finder;
+        finder.Start(tree, options);
+        while (finder.IsRunning()) {
+            finder.Poll(groups);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        finder.Poll(groups);
+        return finder.GetStats();
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+int DuplicateBenchmark::Run(const fs::path& dir, const Options& options) {
+    fs::path tree = dir / "tree";
+    std::vector<FileSpec> files = Plan(options);
+    auto start = std::chrono::steady_clock::now();
+    if (!Generate(tree, files))
+        return 1;
+    std::uint64_t bytes = 0;
+    for (const FileSpec& file : files) {
+        if (file.linkTo < 0)
+            bytes += file.size;
+    }
+    LOG_INFO("Duplicate benchmark: tree %s ready, %d names, %.1f MB (%.2f s)", tree.string().c_str(),
+             (int)files.size(), bytes / 1e6, ElapsedSince(start).count() / 1e6);
+
+    // 期望结果：每个植入的组（不含近似副本和硬链接）
+    std::vector<std::vector<std::string>> expected(options.sets);
+    for (const FileSpec& file : files) {
+        if (file.set >= 0 && file.linkTo < 0 && file.change == ~0ULL)
+            expected[file.set].push_back(file.relative);
+    }
+    for (auto& set : expected)
+        std::sort(set.begin(), set.end());
+    std::sort(expected.begin(), expected.end());
+
+    bool ok = true;
+    for (bool partial : { false, true }) {
+        DuplicateFinder::Options finderOptions;
+        finderOptions.threads = options.threads;
+        finderOptions.partialHash = partial;
+        std::vector<DuplicateFinder::Group> groups;
+        DuplicateFinder::Stats stats = Find(tree, finderOptions, groups);
+
+        std::vector<std::vector<std::string>> found;
+        for (DuplicateFinder::Group& group : groups)
+            found.push_back(std::move(group.files));
+        std::sort(found.begin(), found.end());
+        bool match = found == expected;
+        ok = ok && match;
+        double seconds = stats.time.count() / 1e6;
+        LOG_INFO("%s: %.2f s (walk %.2f s), %d groups, %d duplicates, %.1f MB reclaimable, %d hard links%s",
+                 partial ? "Size, partial hash, full hash" : "Size, full hash",
+                 seconds, stats.walkTime.count() / 1e6, (int)stats.groups, (int)stats.duplicates,
+                 stats.reclaimable / 1e6, (int)stats.hardLinks, match ? "" : " (MISMATCH)");
+        LOG_INFO("  %d files, %d share a size (%.1f MB); %d partial and %d full hashes; %.1f MB read "
+                 "(%.1f%% of the candidates, %.0f MB/s, %d threads)",
+                 (int)stats.files, (int)stats.candidates, stats.candidateBytes / 1e6, (int)stats.partialHashed,
+                 (int)stats.fullHashed, stats.bytesRead / 1e6,
+                 stats.candidateBytes ? 100.0 * stats.bytesRead / stats.candidateBytes : 0.0,
+                 seconds > 0 ? stats.bytesRead / 1e6 / seconds : 0.0, stats.threads);
+        if (!match)
+            LOG_ERROR("Expected %d groups, found %d", (int)expected.size(), (int)found.size());
+    }
+    return ok ? 0 : 1;
+}
+
+int DuplicateBenchmark::RunDedupe(const fs::path& dir, const Options& options) {
+    // 去重会改动树，每次重新生成
+    fs::path tree = dir / "dedupe";
+    std::error_code ec;
+    fs::remove_all(tree, ec);
+    std::vector<FileSpec> files = Plan(options);
+    if (!Generate(tree, files))
+        return 1;
+
+    DuplicateFinder::Options finderOptions;
+    finderOptions.threads = options.threads;
+    std::vector<DuplicateFinder::Group> groups;
+    DuplicateFinder::Stats found = Find(tree, finderOptions, groups);
+    LOG_INFO("Dedupe benchmark: %d groups, %d duplicates, %.1f MB reclaimable in %s", (int)found.groups,
+             (int)found.duplicates, found.reclaimable / 1e6, tree.string().c_str());
+    if (groups.empty()) {
+        LOG_ERROR("Dedupe benchmark: no duplicates found");
+        return 1;
+    }
+
+    // 搜索之后改动一个副本（大小不变），去重时必须跳过它
+    int changed = -1;
+    for (std::size_t k = 0; k < files.size(); ++k) {
+        if (files[k].relative == groups[0].files.back())
+            changed = (int)k;
+    }
+    {
+        std::fstream file(tree / fs::u8path(groups[0].files.back()), std::ios::in | std::ios::out | std::ios::binary);
+        char first = 0;
+        file.read(&first, 1);
+        file.seekp(0);
+        file.put((char)(first ^ 0x5A));
+    }
+
+    bool ok = true;
+    for (Deduplicator::Method method : { Deduplicator::Method::Clone, Deduplicator::Method::HardLink }) {
+        bool clone = method == Deduplicator::Method::Clone;
+        Deduplicator::Options dedupeOptions;
+        dedupeOptions.method = method;
+        Deduplicator deduplicator;
+        deduplicator.Start(tree, groups, dedupeOptions);
+        while (deduplicator.IsRunning())
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        Deduplicator::Stats stats = deduplicator.GetStats();
+        std::vector<Deduplicator::Problem> problems;
+        deduplicator.Poll(problems);
+
+        // 内容都不能变；克隆在不支持的卷上全部报告为不支持
+        int damaged = Verify(tree, files, changed);
+        bool unsupported = clone && stats.unsupported == stats.files;
+        bool complete = stats.changed == 1 && stats.failed == 0 && stats.unsupported == 0 &&
+                        stats.replaced + stats.linked + 1 == stats.files;
+        bool match = damaged == 0 && (unsupported || complete);
+        if (!clone && match) {
+            // 硬链接之后，每组（改动的文件除外）都是同一个文件
+            for (const DuplicateFinder::Group& group : groups) {
+                for (const std::string& file : group.files) {
+                    if (&group == &groups[0] && file == group.files.back())
+                        continue;
+                    match = match && fs::equivalent(tree / fs::u8path(group.files[0]), tree / fs::u8path(file), ec);
+                }
+            }
+        }
+        ok = ok && match;
+        LOG_INFO("%s: %d of %d files replaced, %d changed, %d unsupported, %d failed; %.1f MB reclaimed, "
+                 "%.1f MB compared (%.2f s)%s",
+                 clone ? "Clones" : "Hard links", (int)stats.replaced, (int)stats.files, (int)stats.changed,
+                 (int)stats.unsupported, (int)stats.failed, stats.bytesReclaimed / 1e6, stats.bytesCompared / 1e6,
+                 stats.time.count() / 1e6, match ? "" : " (MISMATCH)");
+        if (unsupported && !problems.empty())
+            LOG_INFO("  This volume cannot clone: %s", problems[0].reason.c_str());
+        if (damaged > 0)
+            LOG_ERROR("  %d files have the wrong contents", damaged);
+        for (std::size_t k = 0; k < problems.size() && k < 5 && !unsupported; ++k)
+            LOG_INFO("  %s: %s", problems[k].file.c_str(), problems[k].reason.c_str());
+    }
+    return ok ? 0 : 1;
+}
+
+// -----------------------------------------------------------------------------
+// Tree
+// -----------------------------------------------------------------------------
+
+std::vector<DuplicateBenchmark::FileSpec> DuplicateBenchmark::Plan(const Options& options) {
+    std::mt19937_64 rng(2024);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const char separator = (char)fs::path::preferred_separator;
+    auto randomSize = [&](std::uint64_t maxSize) {
+        // 常见大小之外，大小按对数均匀分布
+        if ((int)(rng() % 100) < kCommonPercent)
+            return kCommonSizes[rng() % (sizeof(kCommonSizes) / sizeof(kCommonSizes[0]))];
+        return (std::uint64_t)(kMinSize * std::pow((double)maxSize / kMinSize, uniform(rng)));
+    };
+    auto path = [&](const char* format, int k) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "d%03d", (int)(rng() % options.folders));
+        std::string relative = name;
+        relative += separator;
+        std::snprintf(name, sizeof(name), format, k);
+        return relative + name;
+    };
+
+    std::vector<FileSpec> files;
+    for (int k = 0; k < options.files; ++k)
+        files.push_back({ path("f%05d.bin", k), randomSize(options.maxSize), rng(), ~0ULL, -1, -1 });
+
+    // 植入的组：2 到 5 份；一半大小更大，一半常见大小
+    std::vector<int> originals;
+    for (int s = 0; s < options.sets; ++s) {
+        std::uint64_t size = s % 2 ? randomSize(options.maxSize) : randomSize(options.maxSize * 16);
+        std::uint64_t seed = rng();
+        int copies = 2 + (int)(rng() % 4);
+        originals.push_back((int)files.size());
+        for (int c = 0; c < copies; ++c)
+            files.push_back({ path("s%04d_", s) + std::to_string(c) + ".bin", size, seed, ~0ULL, -1, s });
+    }
+
+    // 近似副本：只改中间一个字节，首尾块与原件相同
+    std::vector<int> large;
+    for (int original : originals) {
+        if (files[original].size > 4 * DuplicateFinder::kBlockSize)
+            large.push_back(original);
+    }
+    for (int n = 0; n < options.nearDuplicates && !large.empty(); ++n) {
+        const FileSpec& original = files[large[n % large.size()]];
+        std::uint64_t change = original.size / 2 + (std::uint64_t)(n / large.size());
+        FileSpec near = { path("n%04d.bin", n), original.size, original.seed, change, -1, original.set };
+        files.push_back(near);
+    }
+
+    // 硬链接：同一个文件的其它名字，不算副本
+    for (int n = 0; n < options.hardLinks && options.files > 0; ++n) {
+        int target = (int)(rng() % options.files);
+        files.push_back({ path("h%04d.bin", n), files[target].size, files[target].seed, ~0ULL, target, -1 });
+    }
+    return files;
+}
+
+bool DuplicateBenchmark::Generate(const fs::path& tree, const std::vector<FileSpec>& files) {
+    // 树是确定的；完成标记存在时直接复用
+    std::error_code ec;
+    fs::path complete = tree / ".complete";
+    if (fs::exists(complete, ec))
+        return true;
+    LOG_INFO("Duplicate benchmark: writing %d files to %s", (int)files.size(), tree.string().c_str());
+
+    std::vector<char> data;
+    for (const FileSpec& file : files) {
+        fs::path path = tree / fs::u8path(file.relative);
+        fs::create_directories(path.parent_path(), ec);
+        if (file.linkTo >= 0) {
+            fs::remove(path, ec);
+            fs::create_hard_link(tree / fs::u8path(files[file.linkTo].relative), path, ec);
+            if (ec) {
+                LOG_ERROR("Duplicate benchmark: cannot link %s", path.string().c_str());
+                return false;
+            }
+            continue;
+        }
+        data.resize((std::size_t)file.size);
+        FillContents(file.seed, data);
+        if (file.change != ~0ULL)
+            data[(std::size_t)file.change] ^= 0x5A;
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), data.size());
+        if (!out) {
+            LOG_ERROR("Duplicate benchmark: cannot write %s", path.string().c_str());
+            return false;
+        }
+    }
+    std::ofstream(complete) << "complete\n";
+    return true;
+}
+
+int DuplicateBenchmark::Verify(const fs::path& tree, const std::vector<FileSpec>& files, int changed) {
+    int damaged = 0;
+    std::vector<char> expected, actual;
+    for (std::size_t k = 0; k < files.size(); ++k) {
+        const FileSpec& file = files[k];
+        expected.resize((std::size_t)file.size);
+        FillContents(file.seed, expected);
+        if (file.change != ~0ULL)
+            expected[(std::size_t)file.change] ^= 0x5A;
+        if ((int)k == changed && !expected.empty())
+            expected[0] ^= 0x5A;
+        actual.assign(expected.size() + 1, 0);
+        std::ifstream in(tree / fs::u8path(file.relative), std::ios::binary);
+        in.read(actual.data(), actual.size());
+        if ((std::size_t)in.gcount() != expected.size() || !std::equal(expected.begin(), expected.end(), actual.begin()))
+            ++damaged;
+    }
+    return damaged;
+}
@@ -0,0 +1,536 @@
+// DuplicateFinder.cpp
+// Duplicate file finder implementation for FileMgr
+//
+// Key features:
+// - Parallel walk; files grouped by size, unique sizes dropped
+// - Partial XXH64 of the first and last 16 KB, full XXH64 only on a match
+// - Largest files first; full hashes before new partial hashes
+// - Bounded number of reads in flight; hashing overlaps the reads
+// - Hard links detected by file identity and counted once
+// - Groups streamed as soon as they are complete
+//
+
+#include "../include/DuplicateFinder.hpp"
+#include "../include/Common.hpp"
+#include "../include/DirEnumerator.hpp"
+#include "../include/EntrySorter.hpp"
+#include "../include/XxHash64.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr std::size_t kChunkSize = 1 << 20;         // 整个文件按 1 MB 分块读取并哈希
+    constexpr int kMaxDepth = 64;                       // 超过该深度的文件夹不再下探
+
+    // 只读打开的文件：大小、标识（卷 + 文件号）和按偏移读取
+    class ReadOnlyFile {
+    public:
+        explicit ReadOnlyFile(const fs::path& path) {
+#ifdef _WIN32
+            m_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                   nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            BY_HANDLE_FILE_INFORMATION info;
+            if (m_handle != INVALID_HANDLE_VALUE && GetFileInformationByHandle(m_handle, &info)) {
+                m_size = ((std::uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+                m_device = info.dwVolumeSerialNumber;
+                m_id = ((std::uint64_t)info.nFileIndexHigh << 32) | info.nFileIndexLow;
+                m_ok = true;
+            }
+#else
+            m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat st;
+            if (m_fd >= 0 && ::fstat(m_fd, &st) == 0 && S_ISREG(st.st_mode)) {
+                m_size = (std::uint64_t)st.st_size;
+                m_device = (std::uint64_t)st.st_dev;
+                m_id = (std::uint64_t)st.st_ino;
+                m_ok = true;
+            }
+#endif
+        }
+
+        ~ReadOnlyFile() {
+#ifdef _WIN32
+            if (m_handle != INVALID_HANDLE_VALUE)
+                CloseHandle(m_handle);
+#else
+            if (m_fd >= 0)
+                ::close(m_fd);
+#endif
+        }
+
+        ReadOnlyFile(const ReadOnlyFile&) = delete;
+        ReadOnlyFile& operator=(const ReadOnlyFile&) = delete;
+
+        bool IsOpen() const { return m_ok; }
+        std::uint64_t Size() const { return m_size; }
+        std::uint64_t Device() const { return m_device; }
+        std::uint64_t Id() const { return m_id; }
+
+        // 从 offset 读满 size 字节（文件变短时读到的更少）
+        // @return 读到的字节数
+        std::size_t ReadAt(std::uint64_t offset, char* data, std::size_t size) {
+            std::size_t got = 0;
+            while (got < size) {
+#ifdef _WIN32
+                OVERLAPPED overlapped = {};
+                overlapped.Offset = (DWORD)(offset + got);
+                overlapped.OffsetHigh = (DWORD)((offset + got) >> 32);
+                DWORD read = 0;
+                if (!ReadFile(m_handle, data + got, (DWORD)(size - got), &read, &overlapped) || read == 0)
+                    break;
+#else
+                ssize_t read = ::pread(m_fd, data + got, size - got, (off_t)(offset + got));
+                if (read <= 0)
+                    break;
+#endif
+                got += (std::size_t)read;
+            }
+            return got;
+        }
+
+    private:
+#ifdef _WIN32
+        HANDLE m_handle = INVALID_HANDLE_VALUE;
+#else
+        int m_fd = -1;
+#endif
+        bool m_ok = false;
+        std::uint64_t m_size = 0;
+        std::uint64_t m_device = 0;
+        std::uint64_t m_id = 0;
+    };
+}
+
+// -----------------------------------------------------------------------------
+// Construction / Destruction
+// -----------------------------------------------------------------------------
+
+DuplicateFinder::~DuplicateFinder() {
+    Cancel();
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+void DuplicateFinder::Start(const fs::path& root, const Options& options) {
+    Cancel();
+    m_root = root;
+    m_options = options;
+    m_options.threads = options.threads > 0 ? std::min(options.threads, 64) : EntrySorter::DefaultThreadCount();
+    m_options.reads = options.reads > 0 ? std::min(options.reads, m_options.threads) : m_options.threads;
+    m_cancel = false;
+    m_startTime = std::chrono::steady_clock::now();
+    m_freeReads = m_options.reads;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_candidates.clear();
+        m_sets.clear();
+        m_partialTasks.clear();
+        m_nextPartial = 0;
+        m_fullTasks.clear();
+        m_active = 0;
+        m_pending.clear();
+        m_stats = Stats();
+        m_stats.phase = Phase::Walking;
+        m_stats.threads = m_options.threads;
+        m_stats.reads = m_options.reads;
+        m_stats.running = true;
+    }
+    m_thread = std::thread(&DuplicateFinder::Run, this);
+}
+
+void DuplicateFinder::Cancel() {
+    if (!m_thread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancel = true;
+        if (m_stats.running) {
+            m_stats.running = false;
+            m_stats.cancelled = true;
+            m_stats.time = ElapsedSince(m_startTime);
+        }
+    }
+    m_workCv.notify_all();
+    m_readCv.notify_all();
+    m_thread.join();
+}
+
+bool DuplicateFinder::Poll(std::vector<Group>& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pending.empty())
+        return false;
+    for (Group& group : m_pending)
+        out.push_back(std::move(group));
+    m_pending.clear();
+    return true;
+}
+
+bool DuplicateFinder::IsRunning() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats.running;
+}
+
+DuplicateFinder::Stats DuplicateFinder::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    if (stats.running)
+        stats.time = ElapsedSince(m_startTime);
+    return stats;
+}
+
+// -----------------------------------------------------------------------------
+// Search thread
+// -----------------------------------------------------------------------------
+
+void DuplicateFinder::Run() {
+    Walk();
+    if (m_cancel)
+        return;
+
+    // 大小相同的文件组成一组，每个成员先做部分哈希；大文件排在前面
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::size_t k = 0; k < m_candidates.size();) {
+            std::size_t end = k + 1;
+            while (end < m_candidates.size() && m_candidates[end].size == m_candidates[k].size)
+                ++end;
+            Set set;
+            set.pending = end - k;
+            for (std::size_t c = k; c < end; ++c) {
+                set.members.push_back((std::uint32_t)c);
+                m_partialTasks.push_back({ (std::uint32_t)c, (std::uint32_t)m_sets.size(), false });
+            }
+            m_sets.push_back(std::move(set));
+            k = end;
+        }
+        m_stats.phase = Phase::Hashing;
+    }
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < m_options.threads; ++t)
+        pool.emplace_back(&DuplicateFinder::WorkerLoop, this);
+    WorkerLoop();
+    for (auto& worker : pool)
+        worker.join();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_cancel)
+        return;
+    m_stats.phase = Phase::Done;
+    m_stats.running = false;
+    m_stats.time = ElapsedSince(m_startTime);
+    LOG_INFO("Duplicates in %s: %d groups, %d duplicate files, %.1f MB reclaimable | %d files, %d candidates "
+             "(%.1f MB), %d partial and %d full hashes, %.1f MB read, %.2f s (%d threads, %d reads)",
+             m_root.string().c_str(), (int)m_stats.groups, (int)m_stats.duplicates, m_stats.reclaimable / 1e6,
+             (int)m_stats.files, (int)m_stats.candidates, m_stats.candidateBytes / 1e6, (int)m_stats.partialHashed,
+             (int)m_stats.fullHashed, m_stats.bytesRead / 1e6, m_stats.time.count() / 1e6, m_stats.threads,
+             m_stats.reads);
+    // 结果已交给 UI，释放中间数据
+    m_candidates = std::vector<Candidate>();
+    m_sets.clear();
+    m_partialTasks = std::vector<Task>();
+}
+
+void DuplicateFinder::Walk() {
+    struct Folder {
+        fs::path path;
+        std::string relative;
+        int depth;
+    };
+    struct File {
+        std::string relative;
+        std::uint64_t size;
+    };
+    const char separator = (char)fs::path::preferred_separator;
+    const int threads = m_options.threads;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Folder> folders{ { m_root, std::string(), 0 } };
+    std::vector<File> files;
+    int idle = 0;
+    bool done = false;
+
+    // 与 Treemap 相同的共享栈遍历；每个线程先收集到本地，读完一个文件夹再合并
+    auto worker = [&] {
+        std::unique_ptr<DirEnumerator> enumerator = DirEnumerator::Create(EnumBackend::Auto);
+        std::vector<Folder> foundFolders;
+        std::vector<File> foundFiles;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!m_cancel) {
+            if (folders.empty()) {
+                if (++idle == threads) {
+                    done = true;
+                    cv.notify_all();
+                    break;
+                }
+                cv.wait(lock, [&] { return done || m_cancel || !folders.empty(); });
+                if (done)
+                    break;
+                --idle;
+                continue;
+            }
+            Folder folder = std::move(folders.back());
+            folders.pop_back();
+            lock.unlock();
+
+            foundFolders.clear();
+            foundFiles.clear();
+            std::error_code ec;
+            enumerator->Enumerate(folder.path, [&](std::vector<ScanEntry>& chunk) {
+                if (m_cancel.load(std::memory_order_relaxed))
+                    return false;
+                for (auto& se : chunk) {
+                    // 符号链接和联接不是可回收的副本
+                    if (se.isLink)
+                        continue;
+                    if (!se.isDirectory && (std::uint64_t)se.size < m_options.minSize)
+                        continue;
+                    std::string relative = folder.relative;
+                    if (!relative.empty())
+                        relative += separator;
+                    relative += fs::path(se.name).u8string();
+                    if (se.isDirectory) {
+                        if (folder.depth < kMaxDepth)
+                            foundFolders.push_back({ folder.path / se.name, std::move(relative), folder.depth + 1 });
+                    } else {
+                        foundFiles.push_back({ std::move(relative), (std::uint64_t)se.size });
+                    }
+                }
+                return true;
+            }, ec);
+
+            lock.lock();
+            for (Folder& found : foundFolders)
+                folders.push_back(std::move(found));
+            for (File& found : foundFiles)
+                files.push_back(std::move(found));
+            if (folders.size() > 1)
+                cv.notify_all();
+            std::lock_guard<std::mutex> statsLock(m_mutex);
+            ++m_stats.folders;
+            m_stats.files = files.size();
+        }
+        if (m_cancel) {
+            done = true;
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool)
+        th.join();
+    if (m_cancel)
+        return;
+
+    // 按大小降序排序，只留下大小与其它文件相同的
+    std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.size > b.size; });
+    std::vector<Candidate> candidates;
+    std::uint64_t candidateBytes = 0;
+    for (std::size_t k = 0; k < files.size();) {
+        std::size_t end = k + 1;
+        while (end < files.size() && files[end].size == files[k].size)
+            ++end;
+        if (end - k > 1) {
+            for (std::size_t c = k; c < end; ++c) {
+                Candidate candidate;
+                candidate.relative = std::move(files[c].relative);
+                candidate.size = files[c].size;
+                candidates.push_back(std::move(candidate));
+                candidateBytes += files[c].size;
+            }
+        }
+        k = end;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_candidates = std::move(candidates);
+    m_stats.files = files.size();
+    m_stats.candidates = m_candidates.size();
+    m_stats.candidateBytes = candidateBytes;
+    m_stats.walkTime = ElapsedSince(m_startTime);
+}
+
+// -----------------------------------------------------------------------------
+// Hash workers
+// -----------------------------------------------------------------------------
+
+void DuplicateFinder::WorkerLoop() {
+    std::vector<char> buffer(kChunkSize);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_cancel) {
+        // 完整哈希优先：尽早完成已经开始的组，结果也就尽早显示
+        Task task;
+        if (!m_fullTasks.empty()) {
+            task = m_fullTasks.front();
+            m_fullTasks.pop_front();
+        } else if (m_nextPartial < m_partialTasks.size()) {
+            task = m_partialTasks[m_nextPartial++];
+        } else if (m_active == 0) {
+            // 没有任务也没有正在哈希的文件（不会再产生新任务）：结束
+            m_workCv.notify_all();
+            break;
+        } else {
+            m_workCv.wait(lock, [this] {
+                return m_cancel || !m_fullTasks.empty() || m_nextPartial < m_partialTasks.size() || m_active == 0;
+            });
+            continue;
+        }
+        ++m_active;
+        Candidate& candidate = m_candidates[task.candidate];
+        lock.unlock();
+
+        std::uint64_t bytes = HashFile(candidate, task.full, buffer);
+
+        lock.lock();
+        --m_active;
+        m_stats.bytesRead += bytes;
+        if (task.full)
+            ++m_stats.fullHashed;
+        else
+            ++m_stats.partialHashed;
+        if (candidate.failed)
+            ++m_stats.failed;
+        if (--m_sets[task.set].pending == 0)
+            Resolve(task.set);
+        if (m_active == 0 || !m_fullTasks.empty())
+            m_workCv.notify_all();
+    }
+}
+
+std::uint64_t DuplicateFinder::HashFile(Candidate& candidate, bool full, std::vector<char>& buffer) {
+    ReadOnlyFile file(m_root / fs::u8path(candidate.relative));
+    // 打不开或大小已变（遍历之后被改过）的文件不参与比较
+    if (!file.IsOpen() || file.Size() != candidate.size) {
+        candidate.failed = true;
+        return 0;
+    }
+    candidate.device = file.Device();
+    candidate.id = file.Id();
+
+    // 部分哈希：首尾各一块；文件不超过两块时直接读完，得到的就是完整哈希
+    std::uint64_t size = candidate.size;
+    if (!full && m_options.partialHash && size > 2 * kBlockSize) {
+        char* first = buffer.data();
+        char* last = buffer.data() + kBlockSize;
+        AcquireRead();
+        std::size_t got = file.ReadAt(0, first, kBlockSize);
+        got += file.ReadAt(size - kBlockSize, last, kBlockSize);
+        ReleaseRead();
+        if (got != 2 * kBlockSize) {
+            candidate.failed = true;
+            return got;
+        }
+        candidate.partial = XxHash64::Hash(buffer.data(), 2 * kBlockSize);
+        return got;
+    }
+
+    // 完整哈希：每块读完即释放读取名额，哈希与其它线程的读取重叠
+    XxHash64 hash;
+    std::uint64_t offset = 0;
+    while (offset < size) {
+        if (m_cancel.load(std::memory_order_relaxed))
+            return offset;
+        std::size_t want = (std::size_t)std::min<std::uint64_t>(kChunkSize, size - offset);
+        AcquireRead();
+        std::size_t got = file.ReadAt(offset, buffer.data(), want);
+        ReleaseRead();
+        hash.Update(buffer.data(), got);
+        offset += got;
+        if (got != want) {
+            candidate.failed = true;
+            return offset;
+        }
+    }
+    candidate.full = hash.Digest();
+    candidate.partial = candidate.full;
+    candidate.complete = true;
+    return offset;
+}
+
+void DuplicateFinder::Resolve(std::uint32_t set) {
+    std::vector<std::uint32_t> members = std::move(m_sets[set].members);
+    m_sets[set].members = std::vector<std::uint32_t>();
+
+    // 去掉读取失败的文件；同一文件的其它硬链接名只留一个
+    members.erase(std::remove_if(members.begin(), members.end(),
+                                 [this](std::uint32_t c) { return m_candidates[c].failed; }),
+                  members.end());
+    std::sort(members.begin(), members.end(), [this](std::uint32_t a, std::uint32_t b) {
+        const Candidate& ca = m_candidates[a];
+        const Candidate& cb = m_candidates[b];
+        return ca.device != cb.device ? ca.device < cb.device : ca.id != cb.id ? ca.id < cb.id : a < b;
+    });
+    auto sameFile = [this](std::uint32_t a, std::uint32_t b) {
+        return m_candidates[a].device == m_candidates[b].device && m_candidates[a].id == m_candidates[b].id;
+    };
+    std::size_t before = members.size();
+    members.erase(std::unique(members.begin(), members.end(), sameFile), members.end());
+    m_stats.hardLinks += before - members.size();
+
+    // 按哈希分段；同一大小组里的成员要么都已完整哈希，要么都只有部分哈希
+    std::sort(members.begin(), members.end(), [this](std::uint32_t a, std::uint32_t b) {
+        return m_candidates[a].partial < m_candidates[b].partial;
+    });
+    for (std::size_t k = 0; k < members.size();) {
+        std::size_t end = k + 1;
+        while (end < members.size() && m_candidates[members[end]].partial == m_candidates[members[k]].partial)
+            ++end;
+        if (end - k > 1) {
+            std::vector<std::uint32_t> run(members.begin() + k, members.begin() + end);
+            if (m_candidates[run[0]].complete) {
+                Emit(run);
+            } else {
+                // 首尾相同：整个文件哈希后再比较
+                Set next;
+                next.pending = run.size();
+                for (std::uint32_t c : run)
+                    m_fullTasks.push_back({ c, (std::uint32_t)m_sets.size(), true });
+                next.members = std::move(run);
+                m_sets.push_back(std::move(next));
+            }
+        }
+        k = end;
+    }
+}
+
+void DuplicateFinder::Emit(std::vector<std::uint32_t>& members) {
+    Group group;
+    group.size = m_candidates[members[0]].size;
+    group.hash = m_candidates[members[0]].full;
+    for (std::uint32_t c : members)
+        group.files.push_back(m_candidates[c].relative);
+    std::sort(group.files.begin(), group.files.end());
+    ++m_stats.groups;
+    m_stats.duplicates += members.size() - 1;
+    m_stats.reclaimable += group.Reclaimable();
+    m_pending.push_back(std::move(group));
+}
+
+void DuplicateFinder::AcquireRead() {
+    std::unique_lock<std::mutex> lock(m_readMutex);
+    m_readCv.wait(lock, [this] { return m_freeReads > 0 || m_cancel; });
+    --m_freeReads;
+}
+
+void DuplicateFinder::ReleaseRead() {
+    {
+        std::lock_guard<std::mutex> lock(m_readMutex);
+        ++m_freeReads;
+    }
+    m_readCv.notify_one();
+}
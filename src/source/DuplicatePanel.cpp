@@ -0,0 +1,286 @@
+// DuplicatePanel.cpp
+// "Find Duplicates" window implementation for FileMgr
+//
+// Key features:
+// - Minimum size, thread and parallel read controls with Find / Stop
+// - Stage counters (size, partial, full hash) and bytes read
+// - Groups streamed in, sorted by reclaimable space, collapsible
+// - Virtualized list (ImGuiListClipper); double-click opens a file
+// - Deduplicate with clones or confirmed hard links, in the background
+//
+
+#include "../include/DuplicatePanel.hpp"
+#include "../include/DisplayStrings.hpp"
+#include "../include/EntrySorter.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr auto kRowsInterval = std::chrono::milliseconds(250);   // 搜索期间重排列表的间隔
+    constexpr std::uint64_t kMinSizes[] = { 1, 4096, 1 << 20, 100 << 20 };
+    constexpr std::size_t kTooltipProblems = 20;                     // 提示中列出的跳过文件数
+}
+
+void DuplicatePanel::Open(const fs::path& root) {
+    if (!m_finder.IsRunning() && root != m_root) {
+        m_root = root;
+        m_rootLabel = root.u8string();
+    }
+    if (m_threads == 0) {
+        m_threads = EntrySorter::DefaultThreadCount();
+        m_reads = m_threads;
+    }
+    m_open = true;
+}
+
+void DuplicatePanel::Draw() {
+    if (!m_open)
+        return;
+
+    ImGui::SetNextWindowSize(ImVec2(760, 480), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Find Duplicates", &m_open)) {
+        ImGui::End();
+        return;
+    }
+
+    // 新找到的组每帧取回；列表按间隔重排，搜索结束时再排一次
+    if (m_finder.Poll(m_groups)) {
+        m_collapsed.resize(m_groups.size(), 0);
+        m_rowsDirty = true;
+    }
+    DuplicateFinder::Stats stats = m_finder.GetStats();
+    if (m_rowsDirty && (!stats.running || std::chrono::steady_clock::now() - m_rowsTime >= kRowsInterval))
+        RebuildRows();
+
+    ImGui::SetNextItemWidth(130.0f);
+    ImGui::Combo("##minSize", &m_minSize, "Any size\0At least 4 KB\0At least 1 MB\0At least 100 MB\0");
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(60.0f);
+    if (ImGui::InputInt("Threads", &m_threads, 0))
+        m_threads = std::max(1, std::min(m_threads, 64));
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(60.0f);
+    if (ImGui::InputInt("Parallel reads", &m_reads, 0))
+        m_reads = std::max(1, std::min(m_reads, 64));
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Files read at the same time; 1 or 2 is fastest on a spinning disk");
+    ImGui::SameLine();
+    if (stats.running) {
+        if (ImGui::Button("Stop"))
+            m_finder.Cancel();
+    } else {
+        ImGui::BeginDisabled(m_root.empty() || m_deduplicator.IsRunning());
+        if (ImGui::Button("Find"))
+            StartSearch();
+        ImGui::EndDisabled();
+    }
+
+    ImGui::TextDisabled("In %s", m_rootLabel.c_str());
+    if (stats.phase == DuplicateFinder::Phase::Walking) {
+        ImGui::TextDisabled("Listing... %d files in %d folders", (int)stats.files, (int)stats.folders);
+    } else if (stats.phase != DuplicateFinder::Phase::Idle) {
+        char reclaimable[32];
+        DisplayStrings::FormatSize(stats.reclaimable, reclaimable, sizeof(reclaimable));
+        double seconds = stats.time.count() / 1e6;
+        ImGui::TextDisabled("%d files, %d share a size (%.1f MB)  |  %d partial, %d full hashes, %.1f MB read "
+                            "(%.0f MB/s)%s",
+                            (int)stats.files, (int)stats.candidates, stats.candidateBytes / 1e6,
+                            (int)stats.partialHashed, (int)stats.fullHashed, stats.bytesRead / 1e6,
+                            seconds > 0 ? stats.bytesRead / 1e6 / seconds : 0.0,
+                            stats.running ? "  (hashing...)" : stats.cancelled ? "  (stopped)" : "");
+        ImGui::Text("%d groups, %d duplicate files, %s reclaimable", (int)stats.groups, (int)stats.duplicates,
+                    reclaimable);
+        if (stats.hardLinks > 0 || stats.failed > 0) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(%d hard links counted once, %d files unreadable)", (int)stats.hardLinks,
+                                (int)stats.failed);
+        }
+    }
+
+    DrawDedupe(stats);
+    DrawGroups();
+    ImGui::End();
+}
+
+// -----------------------------------------------------------------------------
+// Private methods
+// -----------------------------------------------------------------------------
+
+void DuplicatePanel::StartSearch() {
+    m_groups.clear();
+    m_collapsed.clear();
+    m_rows.clear();
+    m_rowsDirty = false;
+    m_selected = { ~0u, -1 };
+    m_searchRoot = m_root;
+    DuplicateFinder::Options options;
+    options.threads = m_threads;
+    options.reads = m_reads;
+    options.minSize = kMinSizes[std::max(0, std::min(m_minSize, 3))];
+    m_finder.Start(m_root, options);
+}
+
+void DuplicatePanel::StartDedupe() {
+    m_problems.clear();
+    Deduplicator::Options options;
+    options.method = m_dedupeMethod == 1 ? Deduplicator::Method::HardLink : Deduplicator::Method::Clone;
+    m_deduplicator.Start(m_searchRoot, m_groups, options);
+}
+
+void DuplicatePanel::DrawDedupe(const DuplicateFinder::Stats& stats) {
+    m_deduplicator.Poll(m_problems);
+    Deduplicator::Stats dedupe = m_deduplicator.GetStats();
+    char reclaimed[32];
+    DisplayStrings::FormatSize(dedupe.bytesReclaimed, reclaimed, sizeof(reclaimed));
+
+    if (dedupe.running) {
+        ImGui::Text("Deduplicating... %d of %d files, %s reclaimed", (int)dedupe.processed, (int)dedupe.files,
+                    reclaimed);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Stop##dedupe"))
+            m_deduplicator.Cancel();
+    } else {
+        ImGui::BeginDisabled(stats.running || m_groups.empty());
+        if (ImGui::Button("Deduplicate...")) {
+            m_hardLinkConsent = false;
+            ImGui::OpenPopup("Deduplicate");
+        }
+        ImGui::EndDisabled();
+        if (dedupe.files > 0) {
+            ImGui::SameLine();
+            ImGui::Text("%d files replaced, %s reclaimed%s", (int)dedupe.replaced, reclaimed,
+                        dedupe.cancelled ? " (stopped)" : "");
+        }
+    }
+    if (dedupe.changed + dedupe.unsupported + dedupe.failed > 0) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(%d changed since the search, %d unsupported, %d failed)", (int)dedupe.changed,
+                            (int)dedupe.unsupported, (int)dedupe.failed);
+        if (ImGui::IsItemHovered() && !m_problems.empty()) {
+            ImGui::BeginTooltip();
+            for (std::size_t k = 0; k < m_problems.size() && k < kTooltipProblems; ++k)
+                ImGui::Text("%s: %s", m_problems[k].file.c_str(), m_problems[k].reason.c_str());
+            if (m_problems.size() > kTooltipProblems)
+                ImGui::TextDisabled("and %d more", (int)(m_problems.size() - kTooltipProblems));
+            ImGui::EndTooltip();
+        }
+    }
+
+    // 确认对话框：硬链接须另外勾选同意
+    if (ImGui::BeginPopupModal("Deduplicate", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::Text("Keep the first file of each group and make the other %d files share its storage.",
+                    (int)stats.duplicates);
+        ImGui::TextDisabled("Every file is compared again just before it is replaced; changed files are skipped.");
+        ImGui::Spacing();
+        ImGui::RadioButton("Reflink clones (btrfs, XFS, ReFS)", &m_dedupeMethod, 0);
+        ImGui::Indent();
+        ImGui::TextDisabled("The copies stay separate files. Volumes without cloning are left unchanged.");
+        ImGui::Unindent();
+        ImGui::RadioButton("Hard links", &m_dedupeMethod, 1);
+        ImGui::Indent();
+        ImGui::TextDisabled("Each copy becomes another name of the first file.");
+        if (m_dedupeMethod == 1)
+            ImGui::Checkbox("Editing any copy changes all of them, and they share one set of attributes",
+                            &m_hardLinkConsent);
+        ImGui::Unindent();
+        ImGui::Spacing();
+        ImGui::BeginDisabled(m_dedupeMethod == 1 && !m_hardLinkConsent);
+        if (ImGui::Button("Deduplicate")) {
+            StartDedupe();
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        if (ImGui::Button("Cancel"))
+            ImGui::CloseCurrentPopup();
+        ImGui::EndPopup();
+    }
+}
+
+void DuplicatePanel::RebuildRows() {
+    std::vector<std::uint32_t> order(m_groups.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) {
+        std::uint64_t ra = m_groups[a].Reclaimable(), rb = m_groups[b].Reclaimable();
+        return ra != rb ? ra > rb : a < b;
+    });
+    m_rows.clear();
+    for (std::uint32_t group : order) {
+        m_rows.push_back({ group, -1 });
+        if (!m_collapsed[group]) {
+            for (std::size_t file = 0; file < m_groups[group].files.size(); ++file)
+                m_rows.push_back({ group, (std::int32_t)file });
+        }
+    }
+    m_rowsDirty = false;
+    m_rowsTime = std::chrono::steady_clock::now();
+}
+
+void DuplicatePanel::DrawGroups() {
+    if (!ImGui::BeginTable("##groups", 2,
+                           ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_Resizable |
+                               ImGuiTableFlags_ScrollY))
+        return;
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("File", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_WidthFixed, 150.0f);
+    ImGui::TableHeadersRow();
+
+    // 只提交可见行；文字用格式化输出，不拼接字符串
+    bool toggled = false;
+    ImGuiListClipper clipper;
+    clipper.Begin((int)m_rows.size());
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            const Row& r = m_rows[row];
+            const DuplicateFinder::Group& group = m_groups[r.group];
+            char size[32];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::PushID(row);
+            if (r.file < 0) {
+                DisplayStrings::FormatSize(group.size, size, sizeof(size));
+                ImGui::SetNextItemOpen(!m_collapsed[r.group]);
+                bool open = ImGui::TreeNodeEx("##group", ImGuiTreeNodeFlags_NoTreePushOnOpen |
+                                                             ImGuiTreeNodeFlags_SpanAllColumns,
+                                              "%d copies of %s  (XXH64 %016llx)", (int)group.files.size(), size,
+                                              (unsigned long long)group.hash);
+                if (open == (m_collapsed[r.group] != 0)) {
+                    m_collapsed[r.group] = !open;
+                    toggled = true;
+                }
+                ImGui::TableNextColumn();
+                DisplayStrings::FormatSize(group.Reclaimable(), size, sizeof(size));
+                ImGui::TextDisabled("%s reclaimable", size);
+            } else {
+                const std::string& file = group.files[r.file];
+                ImGui::Indent();
+                bool selected = m_selected.group == r.group && m_selected.file == r.file;
+                if (ImGui::Selectable(file.c_str(), selected,
+                                      ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowDoubleClick)) {
+                    m_selected = r;
+                    if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left) && m_onOpen)
+                        m_onOpen(m_searchRoot / fs::u8path(file));
+                }
+                if (ImGui::BeginPopupContextItem("##file")) {
+                    if (ImGui::MenuItem("Open") && m_onOpen)
+                        m_onOpen(m_searchRoot / fs::u8path(file));
+                    if (ImGui::MenuItem("Open containing folder") && m_onNavigate)
+                        m_onNavigate((m_searchRoot / fs::u8path(file)).parent_path());
+                    ImGui::EndPopup();
+                }
+                ImGui::Unindent();
+                ImGui::TableNextColumn();
+                DisplayStrings::FormatSize(group.size, size, sizeof(size));
+                ImGui::TextUnformatted(size);
+            }
+            ImGui::PopID();
+        }
+    }
+    ImGui::EndTable();
+    // 展开或折叠改变行数，下一帧之前重建
+    if (toggled)
+        RebuildRows();
+}
@@ -0,0 +1,296 @@
+// EntryFilter.cpp
+// Type-ahead name filter implementation for FileMgr
+//
+// Key features:
+// - One lowercase name buffer per listing, built lazily and extended incrementally
+// - SSE2 substring search over the whole buffer (scalar fallback elsewhere)
+// - Glob matching pre-filtered by the pattern's longest literal run
+// - Narrowing: typing more characters only re-checks the previous matches
+//
+
+#include "../include/EntryFilter.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENTRYFILTER_SSE2 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+    // 只折叠 ASCII；UTF-8 多字节字符原样比较
+    inline char FoldCase(char c) {
+        return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+    }
+
+    std::string Lowercase(const std::string& text) {
+        std::string result(text);
+        for (char& c : result)
+            c = FoldCase(c);
+        return result;
+    }
+
+#ifdef ENTRYFILTER_SSE2
+    inline int LowestBit(unsigned mask) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (int)index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+#endif
+}
+
+void EntryFilter::Clear() {
+    m_text.clear();
+    m_offsets.clear();
+    m_match.clear();
+    if (!m_matches.empty())
+        ++m_generation;
+    m_matches.clear();
+}
+
+bool EntryFilter::Update(const DisplayStrings& display) {
+    if (!IsActive() || Size() >= display.Size())
+        return false;
+    Index first = (Index)Size();
+    AppendNames(display);
+    std::size_t added = MatchRange(first);
+    if (added > 0)
+        ++m_generation;
+    m_stats.matches = m_matches.size();
+    return added > 0;
+}
+
+void EntryFilter::Prepare(const DisplayStrings& display) {
+    if (Size() < display.Size())
+        AppendNames(display);
+}
+
+void EntryFilter::SetPattern(const std::string& pattern, FilterMode mode, const DisplayStrings& display) {
+    auto start = std::chrono::steady_clock::now();
+    std::string lowered = Lowercase(pattern);
+    if (lowered == m_pattern && mode == m_mode)
+        return;
+
+    // 只是在原模式后追加字符：结果是上次结果的子集，只需复查上次的匹配项
+    // 上次结果很多时整块扫描反而更快
+    bool narrow = IsActive() && !lowered.empty() && mode == m_mode && m_matches.size() < Size() / 4 &&
+                  ((mode == FilterMode::Substring && lowered.find(m_pattern) != std::string::npos) ||
+                   (mode == FilterMode::Prefix && lowered.compare(0, m_pattern.size(), m_pattern) == 0));
+    m_pattern = std::move(lowered);
+    m_mode = mode;
+    m_stats = Stats();
+    ++m_generation;
+
+    if (!IsActive()) {
+        // 清空过滤：保留名字缓冲区，同一目录再次输入时不必重建
+        std::fill(m_match.begin(), m_match.end(), 0);
+        m_matches.clear();
+        m_stats.time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        return;
+    }
+
+    // 通配符模式：取最长的连续字面量作预筛
+    m_literal.clear();
+    if (m_mode == FilterMode::Glob) {
+        std::size_t runStart = 0;
+        for (std::size_t i = 0; i <= m_pattern.size(); ++i) {
+            if (i == m_pattern.size() || m_pattern[i] == '*' || m_pattern[i] == '?') {
+                if (i - runStart > m_literal.size())
+                    m_literal = m_pattern.substr(runStart, i - runStart);
+                runStart = i + 1;
+            }
+        }
+    }
+
+    if (Size() < display.Size())
+        AppendNames(display);
+
+    if (narrow) {
+        std::size_t kept = 0;
+        for (Index i : m_matches) {
+            if (MatchRow(i))
+                m_matches[kept++] = i;
+            else
+                m_match[i] = 0;
+        }
+        m_stats.checked = m_matches.size();
+        m_stats.narrowed = true;
+        m_matches.resize(kept);
+    } else {
+        std::fill(m_match.begin(), m_match.end(), 0);
+        m_matches.clear();
+        MatchRange(0);
+    }
+    m_stats.matches = m_matches.size();
+    m_stats.time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+}
+
+std::size_t EntryFilter::GetMemoryBytes() const {
+    return m_text.capacity() + m_offsets.capacity() * sizeof(std::uint32_t) + m_match.capacity() +
+           m_matches.capacity() * sizeof(Index);
+}
+
+FilterMode EntryFilter::DetectMode(const std::string& pattern, FilterMode typed) {
+    return pattern.find_first_of("*?") != std::string::npos ? FilterMode::Glob : typed;
+}
+
+bool EntryFilter::GlobMatch(const std::string& glob, const char* name, std::size_t size) {
+    // 经典的单回溯点匹配：* 失配时只需回到最近一个 * 重试
+    std::size_t g = 0, n = 0;
+    std::size_t starG = std::string::npos, starN = 0;
+    while (n < size) {
+        if (g < glob.size() && glob[g] == '?') {
+            // ? 匹配一个完整的 UTF-8 字符
+            ++g;
+            ++n;
+            while (n < size && (static_cast<unsigned char>(name[n]) & 0xC0) == 0x80)
+                ++n;
+        } else if (g < glob.size() && glob[g] == '*') {
+            starG = g++;
+            starN = n;
+        } else if (g < glob.size() && glob[g] == name[n]) {
+            ++g;
+            ++n;
+        } else if (starG != std::string::npos) {
+            g = starG + 1;
+            n = ++starN;
+        } else {
+            return false;
+        }
+    }
+    while (g < glob.size() && glob[g] == '*')
+        ++g;
+    return g == glob.size();
+}
+
+void EntryFilter::AppendNames(const DisplayStrings& display) {
+    std::size_t first = Size();
+    std::size_t count = display.Size();
+    if (m_offsets.empty())
+        m_offsets.push_back(0);
+
+    // 名字后面紧跟大小文本，两者之差就是名字长度（含结尾 '\0'）
+    std::size_t bytes = 0;
+    for (std::size_t i = first; i < count; ++i)
+        bytes += display.GetSize((Index)i) - display.GetName((Index)i);
+    std::size_t end = m_text.size();
+    m_text.resize(end + bytes);
+    m_offsets.reserve(count + 1);
+    m_match.resize(count, 0);
+
+    char* out = m_text.data() + end;
+    for (std::size_t i = first; i < count; ++i) {
+        const char* name = display.GetName((Index)i);
+        std::size_t size = display.GetSize((Index)i) - name;
+        for (std::size_t k = 0; k < size; ++k)
+            out[k] = FoldCase(name[k]);
+        out += size;
+        m_offsets.push_back((std::uint32_t)(out - m_text.data()));
+    }
+}
+
+std::size_t EntryFilter::MatchRange(Index first) {
+    std::size_t before = m_matches.size();
+    std::size_t count = Size();
+    if (first >= count)
+        return 0;
+
+    auto add = [&](Index i) {
+        m_match[i] = 1;
+        m_matches.push_back(i);
+    };
+
+    // 前缀：每个名字比较一次开头
+    if (m_mode == FilterMode::Prefix) {
+        for (std::size_t i = first; i < count; ++i) {
+            if (MatchRow((Index)i))
+                add((Index)i);
+        }
+        return m_matches.size() - before;
+    }
+
+    // 子串（或通配符的字面量预筛）：整块缓冲区一次扫描，命中后跳到下一个名字
+    const std::string& needle = m_mode == FilterMode::Glob ? m_literal : m_pattern;
+    if (needle.empty()) {
+        for (std::size_t i = first; i < count; ++i) {
+            if (MatchRow((Index)i))
+                add((Index)i);
+        }
+        return m_matches.size() - before;
+    }
+
+    std::size_t stop = m_offsets[count];
+    std::size_t pos = m_offsets[first];
+    std::size_t row = first;
+    while (true) {
+        std::size_t hit = Find(needle, pos, stop);
+        if (hit >= stop)
+            break;
+        // 匹配结果按位置递增，行号只需向前推进
+        while (m_offsets[row + 1] <= hit)
+            ++row;
+        if (m_mode == FilterMode::Substring || MatchRow((Index)row))
+            add((Index)row);
+        pos = m_offsets[row + 1];
+    }
+    return m_matches.size() - before;
+}
+
+bool EntryFilter::MatchRow(Index i) const {
+    std::size_t begin = m_offsets[i];
+    std::size_t size = m_offsets[i + 1] - 1 - begin;
+    switch (m_mode) {
+    case FilterMode::Prefix:
+        return size >= m_pattern.size() && std::memcmp(m_text.data() + begin, m_pattern.data(), m_pattern.size()) == 0;
+    case FilterMode::Glob:
+        return GlobMatch(m_pattern, m_text.data() + begin, size);
+    default:
+        return Find(m_pattern, begin, begin + size) < begin + size;
+    }
+}
+
+std::size_t EntryFilter::Find(const std::string& needle, std::size_t pos, std::size_t stop) const {
+    const char* text = m_text.data();
+    std::size_t n = needle.size();
+    if (n == 0)
+        return pos;
+    if (stop - pos < n)
+        return stop;
+
+#ifdef ENTRYFILTER_SSE2
+    // 16 个位置同时比较针的首字节和末字节，两者都相等的位置再逐字节确认
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[n - 1]);
+    for (; pos + n - 1 + 16 <= stop; pos += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + pos));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + pos + n - 1));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+        while (mask) {
+            std::size_t at = pos + LowestBit(mask);
+            std::size_t k = 1;
+            while (k + 1 < n && text[at + k] == needle[k])
+                ++k;
+            if (k + 1 >= n)
+                return at;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    // 剩余部分（或无 SSE2 时）逐个定位首字节
+    for (; pos + n <= stop; ++pos) {
+        const char* p = static_cast<const char*>(std::memchr(text + pos, needle[0], stop - n + 1 - pos));
+        if (!p)
+            return stop;
+        pos = p - text;
+        if (std::memcmp(p + 1, needle.data() + 1, n - 1) == 0)
+            return pos;
+    }
+    return stop;
+}
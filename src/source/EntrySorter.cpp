@@ -0,0 +1,523 @@
+// EntrySorter.cpp
+// Multi-column sort engine implementation for FileMgr
+//
+// Key features:
+// - Natural-order, case-insensitive name keys with 64-bit prefixes
+// - Stable multi-pass sort: LSD radix for integer columns, merge sort for text
+// - Parallel histogram/scatter and parallel chunk sort + merge tree
+// - Background worker: sorted top window first, complete order second
+//
+
+#include "../include/EntrySorter.hpp"
+#include "../include/Common.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <numeric>
+#include <string_view>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace {
+    using Index = EntryStore::Index;
+    using Char = EntryStore::Char;
+    using UChar = std::make_unsigned_t<Char>;
+
+    constexpr std::size_t kParallelThreshold = 65536;  // 小于该规模时单线程更快
+    constexpr std::size_t kMaxDigits = 200;             // 数字串长度上限（编码在一个字符里）
+    constexpr int kPrefixUnits = (int)(8 / sizeof(Char));
+    constexpr int kPrefixBits = (int)(8 * sizeof(Char));
+
+    bool IsDigit(Char c) { return c >= Char('0') && c <= Char('9'); }
+
+    // ASCII 大小写折叠；Windows 上随后再用 CharLowerBuffW 处理其余字符
+    Char FoldAscii(Char c) { return (c >= Char('A') && c <= Char('Z')) ? Char(c + ('a' - 'A')) : c; }
+
+    void FoldRange(std::vector<Char>& chars, std::size_t start) {
+#ifdef _WIN32
+        if (chars.size() > start)
+            CharLowerBuffW(chars.data() + start, (DWORD)(chars.size() - start));
+#else
+        (void)chars;
+        (void)start;
+#endif
+    }
+
+    // 稳定 LSD 基数排序（8 位一趟，跳过所有元素该字节相同的趟）
+    // 并行版本：每线程统计本段直方图，按 (桶, 线程) 顺序分配输出位置，保持稳定性
+    template <typename KeyFn>
+    void RadixSort(std::vector<Index>& order, KeyFn keyOf, bool descending, int threads) {
+        std::size_t n = order.size();
+        if (n < 2)
+            return;
+        if (n < kParallelThreshold)
+            threads = 1;
+
+        std::uint64_t flip = descending ? ~0ULL : 0;
+        std::vector<std::uint64_t> keys(n), keysTmp(n);
+        std::vector<Index> idxTmp(n);
+        EntrySorter::ParallelFor(threads, n, [&](int, std::size_t b, std::size_t e) {
+            for (std::size_t i = b; i < e; ++i)
+                keys[i] = keyOf(order[i]) ^ flip;
+        });
+
+        std::vector<std::size_t> hist((std::size_t)threads * 256);
+        for (int shift = 0; shift < 64; shift += 8) {
+            std::fill(hist.begin(), hist.end(), 0);
+            EntrySorter::ParallelFor(threads, n, [&](int t, std::size_t b, std::size_t e) {
+                std::size_t* h = &hist[(std::size_t)t * 256];
+                for (std::size_t i = b; i < e; ++i)
+                    ++h[(keys[i] >> shift) & 0xFF];
+            });
+
+            // 所有元素在该字节上相同：这一趟什么也不会改变
+            bool trivial = false;
+            for (int d = 0; d < 256 && !trivial; ++d) {
+                std::size_t total = 0;
+                for (int t = 0; t < threads; ++t)
+                    total += hist[(std::size_t)t * 256 + d];
+                trivial = total == n;
+            }
+            if (trivial)
+                continue;
+
+            std::size_t running = 0;
+            for (int d = 0; d < 256; ++d) {
+                for (int t = 0; t < threads; ++t) {
+                    std::size_t c = hist[(std::size_t)t * 256 + d];
+                    hist[(std::size_t)t * 256 + d] = running;
+                    running += c;
+                }
+            }
+            EntrySorter::ParallelFor(threads, n, [&](int t, std::size_t b, std::size_t e) {
+                std::size_t* pos = &hist[(std::size_t)t * 256];
+                for (std::size_t i = b; i < e; ++i) {
+                    std::size_t p = pos[(keys[i] >> shift) & 0xFF]++;
+                    keysTmp[p] = keys[i];
+                    idxTmp[p] = order[i];
+                }
+            });
+            keys.swap(keysTmp);
+            order.swap(idxTmp);
+        }
+    }
+
+    // 稳定排序：大数据时分段并行 stable_sort，再两两归并（std::merge 在相等时先取左段，保持稳定）
+    template <typename Cmp>
+    void StableSort(std::vector<Index>& order, Cmp cmp, int threads) {
+        std::size_t n = order.size();
+        if (threads <= 1 || n < kParallelThreshold) {
+            std::stable_sort(order.begin(), order.end(), cmp);
+            return;
+        }
+
+        std::vector<std::size_t> bounds;
+        std::size_t chunk = (n + threads - 1) / threads;
+        for (std::size_t b = 0; b < n; b += chunk)
+            bounds.push_back(b);
+        bounds.push_back(n);
+        EntrySorter::ParallelFor((int)bounds.size() - 1, bounds.size() - 1, [&](int, std::size_t b, std::size_t e) {
+            for (std::size_t c = b; c < e; ++c)
+                std::stable_sort(order.begin() + bounds[c], order.begin() + bounds[c + 1], cmp);
+        });
+
+        std::vector<Index> buffer(n);
+        std::vector<Index>* src = &order;
+        std::vector<Index>* dst = &buffer;
+        while (bounds.size() > 2) {
+            std::size_t runs = bounds.size() - 1;
+            std::size_t pairs = (runs + 1) / 2;
+            EntrySorter::ParallelFor((int)pairs, pairs, [&](int, std::size_t b, std::size_t e) {
+                for (std::size_t p = b; p < e; ++p) {
+                    std::size_t lo = bounds[2 * p], mid = bounds[std::min(2 * p + 1, runs)], hi = bounds[std::min(2 * p + 2, runs)];
+                    std::merge(src->begin() + lo, src->begin() + mid, src->begin() + mid, src->begin() + hi,
+                               dst->begin() + lo, cmp);
+                }
+            });
+            std::vector<std::size_t> next;
+            for (std::size_t i = 0; i < bounds.size(); i += 2)
+                next.push_back(bounds[i]);
+            if (next.back() != n)
+                next.push_back(n);
+            bounds.swap(next);
+            std::swap(src, dst);
+        }
+        if (src != &order)
+            order.swap(*src);
+    }
+
+    int CompareColumn(const SortKeys& keys, SortColumn column, Index a, Index b) {
+        switch (column) {
+        case SortColumn::Name:
+            return keys.CompareName(a, b);
+        case SortColumn::Type:
+            return keys.CompareType(a, b);
+        case SortColumn::Size:
+            return keys.GetSize(a) < keys.GetSize(b) ? -1 : keys.GetSize(a) > keys.GetSize(b) ? 1 : 0;
+        case SortColumn::Date:
+            return keys.GetTime(a) < keys.GetTime(b) ? -1 : keys.GetTime(a) > keys.GetTime(b) ? 1 : 0;
+        }
+        return 0;
+    }
+
+    // 实际执行的键序列：用户指定的键 + 名称升序（若未指定）作为最终决胜
+    SortSpec EffectiveSpec(const SortSpec& spec) {
+        SortSpec effective = spec;
+        bool hasName = std::any_of(spec.begin(), spec.end(), [](const SortKey& k) { return k.column == SortColumn::Name; });
+        if (!hasName)
+            effective.push_back({ SortColumn::Name, false });
+        return effective;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// SortKeys
+// -----------------------------------------------------------------------------
+
+void SortKeys::Clear() {
+    m_chars.clear();
+    m_names.clear();
+    m_types.clear();
+    m_sizes.clear();
+    m_times.clear();
+    m_flags.clear();
+}
+
+void SortKeys::AppendNameKey(EntryStore::NameView name, std::vector<Char>& out) {
+    std::size_t start = out.size();
+    for (std::size_t i = 0; i < name.size();) {
+        if (!IsDigit(name[i])) {
+            out.push_back(FoldAscii(name[i++]));
+            continue;
+        }
+        // 数字串：去掉前导零后按“位数 + 数字”编码，位数少的数值小
+        std::size_t end = i;
+        while (end < name.size() && IsDigit(name[end]))
+            ++end;
+        std::size_t first = i;
+        while (first < end && name[first] == Char('0'))
+            ++first;
+        std::size_t digits = std::min(end - first, kMaxDigits);
+        out.push_back(Char('0'));
+        out.push_back(Char(1 + digits));
+        out.insert(out.end(), name.begin() + first, name.begin() + first + digits);
+        i = end;
+    }
+    FoldRange(out, start);
+}
+
+SortKeys::TextKey SortKeys::MakeKey(std::size_t start) const {
+    TextKey key{};
+    key.offset = (std::uint32_t)start;
+    key.length = (std::uint16_t)std::min<std::size_t>(m_chars.size() - start, UINT16_MAX);
+    for (int k = 0; k < kPrefixUnits; ++k) {
+        key.prefix <<= kPrefixBits;
+        if (k < key.length)
+            key.prefix |= (UChar)m_chars[start + k];
+    }
+    return key;
+}
+
+int SortKeys::CompareKeys(const TextKey& a, const TextKey& b) const {
+    // 前缀不同即可定序；前缀相同且两者都不超过前缀长度时完全相等（键中没有 0 字符）
+    if (a.prefix != b.prefix)
+        return a.prefix < b.prefix ? -1 : 1;
+    if (a.length <= kPrefixUnits && b.length <= kPrefixUnits)
+        return 0;
+    std::basic_string_view<Char> ka(m_chars.data() + a.offset, a.length);
+    std::basic_string_view<Char> kb(m_chars.data() + b.offset, b.length);
+    return ka.compare(kb);
+}
+
+int SortKeys::CompareName(Index a, Index b) const {
+    return CompareKeys(m_names[a], m_names[b]);
+}
+
+int SortKeys::CompareType(Index a, Index b) const {
+    return CompareKeys(m_types[a], m_types[b]);
+}
+
+void SortKeys::ReserveFor(const EntryStore& entries) {
+    // 几何增长预留：键约为名字长度再加上数字标记和扩展名
+    std::size_t count = entries.Size();
+    std::size_t charsNeeded = entries.GetNameChars() + entries.GetNameChars() / 2;
+    if (m_chars.capacity() < charsNeeded)
+        m_chars.reserve(std::max(charsNeeded, m_chars.capacity() * 2));
+    if (m_sizes.capacity() < count) {
+        std::size_t capacity = std::max(count, m_sizes.capacity() * 2);
+        m_names.reserve(capacity);
+        m_types.reserve(capacity);
+        m_sizes.reserve(capacity);
+        m_times.reserve(capacity);
+        m_flags.reserve(capacity);
+    }
+}
+
+void SortKeys::AppendEntry(const EntryStore& entries, Index index) {
+    EntryStore::NameView name = entries.GetName(index);
+    bool isDirectory = entries.IsDirectory(index);
+
+    std::size_t start = m_chars.size();
+    AppendNameKey(name, m_chars);
+    m_names.push_back(MakeKey(start));
+
+    // 扩展名：最后一个 '.' 之后（开头的点不算，如 ".gitignore"）
+    start = m_chars.size();
+    std::size_t dot = name.rfind(Char('.'));
+    if (!isDirectory && dot != EntryStore::NameView::npos && dot > 0) {
+        for (std::size_t k = dot + 1; k < name.size(); ++k)
+            m_chars.push_back(FoldAscii(name[k]));
+        FoldRange(m_chars, start);
+    }
+    m_types.push_back(MakeKey(start));
+
+    m_sizes.push_back(entries.GetSize(index));
+    m_times.push_back(entries.GetWriteTime(index).time_since_epoch().count());
+    m_flags.push_back(isDirectory ? 1 : 0);
+}
+
+void SortKeys::CopyEntry(const SortKeys& from, Index index) {
+    // 文本键整段复制，只需改写在字符池中的偏移
+    auto copyKey = [this, &from](const TextKey& key) {
+        TextKey copy = key;
+        copy.offset = (std::uint32_t)m_chars.size();
+        m_chars.insert(m_chars.end(), from.m_chars.begin() + key.offset, from.m_chars.begin() + key.offset + key.length);
+        return copy;
+    };
+    m_names.push_back(copyKey(from.m_names[index]));
+    m_types.push_back(copyKey(from.m_types[index]));
+    m_sizes.push_back(from.m_sizes[index]);
+    m_times.push_back(from.m_times[index]);
+    m_flags.push_back(from.m_flags[index]);
+}
+
+void SortKeys::Append(const EntryStore& entries) {
+    if (Size() >= entries.Size())
+        return;
+    ReserveFor(entries);
+    for (std::size_t i = Size(); i < entries.Size(); ++i)
+        AppendEntry(entries, (Index)i);
+}
+
+void SortKeys::Remap(const std::vector<Index>& reuse, const EntryStore& entries) {
+    SortKeys previous;
+    std::swap(previous, *this);
+    ReserveFor(entries);
+    for (std::size_t i = 0; i < entries.Size(); ++i) {
+        if (reuse[i] != EntryStore::kNoIndex && reuse[i] < previous.Size())
+            CopyEntry(previous, reuse[i]);
+        else
+            AppendEntry(entries, (Index)i);
+    }
+}
+
+std::size_t SortKeys::GetMemoryBytes() const {
+    return m_chars.capacity() * sizeof(Char) + (m_names.capacity() + m_types.capacity()) * sizeof(TextKey) +
+           m_sizes.capacity() * sizeof(std::uint64_t) + m_times.capacity() * sizeof(std::int64_t) + m_flags.capacity();
+}
+
+// -----------------------------------------------------------------------------
+// EntrySorter - algorithms
+// -----------------------------------------------------------------------------
+
+int EntrySorter::DefaultThreadCount() {
+    return (int)std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+}
+
+bool EntrySorter::Less(const SortKeys& keys, const SortSpec& spec, Index a, Index b) {
+    bool dirA = keys.IsDirectory(a), dirB = keys.IsDirectory(b);
+    if (dirA != dirB)
+        return dirA;
+    bool hasName = false;
+    for (const auto& key : spec) {
+        hasName |= key.column == SortColumn::Name;
+        int c = CompareColumn(keys, key.column, a, b);
+        if (c != 0)
+            return key.descending ? c > 0 : c < 0;
+    }
+    if (!hasName) {
+        int c = keys.CompareName(a, b);
+        if (c != 0)
+            return c < 0;
+    }
+    return a < b; // 与多趟稳定排序从存储顺序出发的结果一致
+}
+
+bool EntrySorter::Sort(const SortKeys& keys, const SortSpec& spec, std::vector<Index>& order,
+                       int threads, const std::atomic<bool>* cancel) {
+    order.resize(keys.Size());
+    std::iota(order.begin(), order.end(), (Index)0);
+
+    // 从最次要的键到最主要的键依次做稳定排序
+    SortSpec effective = EffectiveSpec(spec);
+    for (auto it = effective.rbegin(); it != effective.rend(); ++it) {
+        if (cancel && cancel->load(std::memory_order_relaxed))
+            return false;
+        const SortKey key = *it;
+        switch (key.column) {
+        case SortColumn::Name:
+        case SortColumn::Type:
+            StableSort(order, [&keys, key](Index a, Index b) {
+                int c = CompareColumn(keys, key.column, a, b);
+                return key.descending ? c > 0 : c < 0;
+            }, threads);
+            break;
+        case SortColumn::Size:
+            RadixSort(order, [&keys](Index i) { return keys.GetSize(i); }, key.descending, threads);
+            break;
+        case SortColumn::Date:
+            // 有符号时间翻转符号位后按无符号比较
+            RadixSort(order, [&keys](Index i) { return (std::uint64_t)keys.GetTime(i) ^ (1ULL << 63); },
+                      key.descending, threads);
+            break;
+        }
+    }
+
+    // 文件夹始终在前
+    std::stable_partition(order.begin(), order.end(), [&keys](Index i) { return keys.IsDirectory(i); });
+    return true;
+}
+
+void EntrySorter::MergeAppended(const SortKeys& keys, const SortSpec& spec,
+                                std::vector<Index>& order, std::size_t firstNew) {
+    auto less = [&keys, &spec](Index a, Index b) { return Less(keys, spec, a, b); };
+    auto mid = order.begin() + std::min(firstNew, order.size());
+    std::sort(mid, order.end(), less);
+    std::inplace_merge(order.begin(), mid, order.end(), less);
+}
+
+void EntrySorter::InsertSorted(const SortKeys& keys, const SortSpec& spec,
+                               std::vector<Index>& order, std::vector<Index> items) {
+    if (items.empty())
+        return;
+    auto less = [&keys, &spec](Index a, Index b) { return Less(keys, spec, a, b); };
+    std::sort(items.begin(), items.end(), less);
+
+    // 逐个二分定位插入点（k·log n 次比较），区间整段搬移
+    std::vector<Index> merged;
+    merged.reserve(order.size() + items.size());
+    auto pos = order.begin();
+    for (Index item : items) {
+        auto next = std::upper_bound(pos, order.end(), item, less);
+        merged.insert(merged.end(), pos, next);
+        merged.push_back(item);
+        pos = next;
+    }
+    merged.insert(merged.end(), pos, order.end());
+    order.swap(merged);
+}
+
+// -----------------------------------------------------------------------------
+// EntrySorter - background worker
+// -----------------------------------------------------------------------------
+
+EntrySorter::EntrySorter()
+    : m_stop(false), m_hasJob(false), m_generation(0), m_cancel(false), m_hasResult(false) {
+    m_worker = std::thread(&EntrySorter::WorkerLoop, this);
+}
+
+EntrySorter::~EntrySorter() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_cancel = true;
+    }
+    m_wakeCv.notify_all();
+    m_worker.join();
+}
+
+std::uint64_t EntrySorter::Start(std::shared_ptr<const SortKeys> keys, SortSpec spec, std::size_t topCount) {
+    std::uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        generation = ++m_generation;
+        m_job.generation = generation;
+        m_job.keys = std::move(keys);
+        m_job.spec = std::move(spec);
+        m_job.topCount = topCount;
+        m_hasJob = true;
+        m_hasResult = false;
+        m_cancel = true; // 正在进行的旧任务尽快放弃
+    }
+    m_wakeCv.notify_one();
+    return generation;
+}
+
+void EntrySorter::Cancel() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_generation;
+    m_hasJob = false;
+    m_job.keys.reset();
+    m_hasResult = false;
+    m_cancel = true;
+}
+
+bool EntrySorter::Poll(Result& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_hasResult)
+        return false;
+    out = std::move(m_result);
+    m_hasResult = false;
+    return true;
+}
+
+EntrySorter::Stats EntrySorter::GetLastStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void EntrySorter::Publish(std::uint64_t generation, std::vector<Index> order, bool complete) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (generation != m_generation)
+        return;
+    m_result.generation = generation;
+    m_result.order = std::move(order);
+    m_result.complete = complete;
+    m_hasResult = true;
+}
+
+void EntrySorter::WorkerLoop() {
+    const int threads = DefaultThreadCount();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wakeCv.wait(lock, [this] { return m_stop || m_hasJob; });
+        if (m_stop)
+            return;
+        Job job = std::move(m_job);
+        m_job.keys.reset();
+        m_hasJob = false;
+        m_cancel = false;
+        lock.unlock();
+
+        const SortKeys& keys = *job.keys;
+        const auto start = std::chrono::steady_clock::now();
+        Stats stats;
+        stats.entryCount = keys.Size();
+        stats.threads = keys.Size() >= kParallelThreshold ? threads : 1;
+
+        // 只有顶部一屏可见时，先用 partial_sort 交付这一屏
+        if (job.topCount > 0 && job.topCount < keys.Size()) {
+            std::vector<Index> top(keys.Size());
+            std::iota(top.begin(), top.end(), (Index)0);
+            std::partial_sort(top.begin(), top.begin() + job.topCount, top.end(),
+                              [&](Index a, Index b) { return Less(keys, job.spec, a, b); });
+            stats.partialTime = ElapsedSince(start);
+            Publish(job.generation, std::move(top), false);
+        }
+
+        std::vector<Index> order;
+        bool done = Sort(keys, job.spec, order, stats.threads, &m_cancel);
+        stats.totalTime = ElapsedSince(start);
+        stats.cancelled = !done;
+        if (done)
+            Publish(job.generation, std::move(order), true);
+        job.keys.reset(); // 尽早释放，界面线程追加新条目时无需复制键
+
+        LOG_INFO("Sorted %d entries in %.2f ms (top window %.2f ms, %d threads)%s", (int)stats.entryCount,
+                 stats.totalTime.count() / 1000.0, stats.partialTime.count() / 1000.0, stats.threads,
+                 done ? "" : " (cancelled)");
+        lock.lock();
+        m_stats = stats;
+    }
+}
@@ -0,0 +1,96 @@
+// EntryStore.cpp
+// Columnar directory entry storage implementation for FileMgr
+//
+// Key features:
+// - One name arena per directory (offset + length per entry)
+// - Packed size / mtime / flag columns
+// - Sorting and merging on an index permutation
+//
+
+#include "../include/EntryStore.hpp"
+#include <algorithm>
+#include <limits>
+
+void EntryStore::Clear() {
+    m_names.clear();
+    m_nameOffsets.clear();
+    m_nameLengths.clear();
+    m_sizes.clear();
+    m_writeTimes.clear();
+    m_flags.clear();
+    m_order.clear();
+}
+
+void EntryStore::Reserve(std::size_t entries, std::size_t nameChars) {
+    m_names.reserve(nameChars);
+    m_nameOffsets.reserve(entries);
+    m_nameLengths.reserve(entries);
+    m_sizes.reserve(entries);
+    m_writeTimes.reserve(entries);
+    m_flags.reserve(entries);
+    m_order.reserve(entries);
+}
+
+void EntryStore::ShrinkToFit() {
+    m_names.shrink_to_fit();
+    m_nameOffsets.shrink_to_fit();
+    m_nameLengths.shrink_to_fit();
+    m_sizes.shrink_to_fit();
+    m_writeTimes.shrink_to_fit();
+    m_flags.shrink_to_fit();
+    m_order.shrink_to_fit();
+}
+
+EntryStore::Index EntryStore::Add(NameView name, bool isDirectory, std::uint64_t size, TimePoint lastWriteTime) {
+    // 文件名长度受系统限制（NTFS 255 个 UTF-16 单元，Linux NAME_MAX 255 字节），16 位足够
+    std::size_t length = std::min<std::size_t>(name.size(), std::numeric_limits<std::uint16_t>::max());
+    Index index = (Index)m_sizes.size();
+    m_nameOffsets.push_back((std::uint32_t)m_names.size());
+    m_nameLengths.push_back((std::uint16_t)length);
+    m_names.insert(m_names.end(), name.data(), name.data() + length);
+    m_sizes.push_back(size);
+    m_writeTimes.push_back(lastWriteTime);
+    m_flags.push_back(isDirectory ? kFlagDirectory : 0);
+    m_order.push_back(index);
+    return index;
+}
+
+void EntryStore::Append(const std::vector<ScanEntry>& chunk) {
+    std::size_t chars = 0;
+    for (const auto& se : chunk)
+        chars += se.name.size();
+    // 按块预留，避免逐条扩容
+    if (m_names.capacity() - m_names.size() < chars)
+        m_names.reserve(std::max(m_names.size() + chars, m_names.capacity() * 2));
+    for (const auto& se : chunk)
+        Add(se.name, se.isDirectory, se.size, se.lastWriteTime);
+}
+
+bool EntryStore::Less(Index a, Index b) const {
+    bool dirA = IsDirectory(a), dirB = IsDirectory(b);
+    if (dirA != dirB)
+        return dirA;
+    return GetName(a) < GetName(b);
+}
+
+void EntryStore::Sort() {
+    std::sort(m_order.begin(), m_order.end(), [this](Index a, Index b) { return Less(a, b); });
+}
+
+void EntryStore::MergeSorted(std::size_t firstNew) {
+    auto less = [this](Index a, Index b) { return Less(a, b); };
+    auto mid = m_order.begin() + std::min(firstNew, m_order.size());
+    std::sort(mid, m_order.end(), less);
+    std::inplace_merge(m_order.begin(), mid, m_order.end(), less);
+}
+
+std::size_t EntryStore::GetMemoryBytes() const {
+    return sizeof(*this) +
+           m_names.capacity() * sizeof(Char) +
+           m_nameOffsets.capacity() * sizeof(std::uint32_t) +
+           m_nameLengths.capacity() * sizeof(std::uint16_t) +
+           m_sizes.capacity() * sizeof(std::uint64_t) +
+           m_writeTimes.capacity() * sizeof(TimePoint) +
+           m_flags.capacity() * sizeof(std::uint8_t) +
+           m_order.capacity() * sizeof(Index);
+}
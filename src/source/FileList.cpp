@@ -5,37 +5,101 @@
 // file listing, sorting, and integration with Windows shell for file opening.
 // 
 // Key features:
-// - Directory scanning and caching
+// - Asynchronous directory scanning with incremental, sorted merging
+// - Columnar entry storage (name arena, packed size/mtime/flags)
+// - Multi-column sorting by name, type, size and date (background for large folders)
+// - Incremental refresh: only changed rows are merged, scroll and selection kept
+// - LRU snapshot cache for instant back/forward with background revalidation
+// - Speculative prefetch of the parent and hovered directories
+// - Cold start from the persistent listing store (no directory I/O)
 // - Back/forward navigation stack
-// - File size formatting (B/KB/MB/GB)
-// - Date/time formatting
+// - File size and date formatting done once per entry (DisplayStrings)
+// - Virtualized rows: only the visible part of the table is submitted
+// - Type-ahead filter box (substring, prefix, glob) over the sorted view
+// - Optional recursive folder sizes (logical or on disk), filled in progressively
+// - Optional Checksum column (XXH64 / SHA-256) for drawn and selected files
+// - "Verify against manifest" on .sha256 / .md5 files
+// - Virtual listings (e.g. name index results) with names relative to a root
 // - Double-click to open files/directories
 // - Integration with IconCache for visual icons
 // 
 
 #include "../include/FileList.hpp"
+#include "../include/ListingDiff.hpp"
+#include "../include/ManifestVerifier.hpp"
 #include "../include/log.hpp"
 #include <shellapi.h>
 #include <algorithm>
 #include <chrono>
-#include <ctime>
+#include <cstdio>
 #include <optional>
 
 namespace fs = std::filesystem;
 
-// 构造函数（无需改动，仅初始化 m_iconCache）
-FileList::FileList(IconCache* iconCache) : m_iconCache(iconCache), m_pendingNavigation() {
-    // 初始时可将当前工作目录设为当前路径
-    m_currentPath = fs::current_path();
+namespace {
+    // 小于该规模时在界面线程直接排序（约几毫秒），否则交给后台线程
+    constexpr std::size_t kSyncSortLimit = 16384;
+
+    // m_rowFlags 位
+    constexpr std::uint8_t kRowSelected = 1;
+    constexpr std::uint8_t kRowChanged = 2;     // 最近一次增量刷新中新增或修改
+    constexpr std::uint8_t kRowIconLoaded = 4;  // m_rowIcons 中的图标已取得
+    constexpr std::uint8_t kRowHovered = 8;     // 本次悬停已请求过预取
+    constexpr std::uint8_t kRowSizing = 16;     // 文件夹大小仍在计算中
+
+    constexpr float kHighlightSeconds = 1.5f;   // 变化行高亮淡出时间
+    constexpr auto kFolderSizeInterval = std::chrono::milliseconds(250);   // 计算期间写入文件夹大小的间隔
+
+    bool SortsBySize(const SortSpec& spec) {
+        for (const SortKey& key : spec) {
+            if (key.column == SortColumn::Size)
+                return true;
+        }
+        return false;
+    }
+
+    // 补齐尚未计算的排序键；后台排序仍持有旧键时先复制一份（写时复制）
+    void AppendSortKeys(std::shared_ptr<SortKeys>& keys, const EntryStore& entries) {
+        if (keys->Size() >= entries.Size())
+            return;
+        if (keys.use_count() > 1)
+            keys = std::make_shared<SortKeys>(*keys);
+        keys->Append(entries);
+    }
+}
+
+// 构造函数：优先恢复上次退出时的目录，否则使用当前工作目录
+FileList::FileList(IconCache* iconCache, const ListingStore* store)
+    : m_iconCache(iconCache), m_sortKeys(std::make_shared<SortKeys>()), m_viewGeneration(0),
+      m_sortSpec{ { SortColumn::Name, false } },
+      m_sortGeneration(0), m_sorting(false), m_visibleRows(0), m_scrolledToTop(true), m_lastSortTime(0),
+      m_rowHeight(0.0f), m_scrollY(0.0f), m_drawnRows(0), m_drawTime(0), m_filterText{},
+      m_filterMode(FilterMode::Substring), m_filteredViewGeneration(0), m_filteredMatchGeneration(0), m_filterTime(0),
+      m_pendingNavigation(), m_scanGeneration(0), m_scanning(false),
+      m_revalidating(false), m_refreshQueued(false), m_prefetcher(&m_snapshots), m_store(store),
+      m_folderSizes(false), m_sizeOnDisk(false), m_entriesGeneration(0), m_sizedGeneration(0),
+      m_sizesFinal(false), m_showChecksums(false), m_checksumGeneration(0) {
+    // 这里不检查目录是否存在：首帧不做任何目录 I/O，失效的目录由后台校验发现
+    std::optional<fs::path> lastLocation;
+    if (m_store)
+        lastLocation = m_store->GetLastLocation();
+    m_currentPath = lastLocation ? *lastLocation : fs::current_path();
     RefreshImpl();
 }
 
 // 私有：直接设置路径并刷新，不修改历史
 void FileList::SetCurrentPath(const fs::path& newPath) {
-    if (newPath == m_currentPath) return;
+    // 虚拟列表的根目录与当前路径相同，此时导航到它仍要重新列出目录
+    if (newPath == m_currentPath && !IsVirtual()) return;
     if (fs::exists(newPath) && fs::is_directory(newPath)) {
+        // 真正的导航开始了，投机预取立即让路
+        m_prefetcher.CancelAll();
         m_currentPath = newPath;
+        m_virtualLabel.clear();
+        // 过滤条件只对当前目录有效
+        m_filterText[0] = '\0';
         RefreshImpl();
+        ApplyFilter();
     } else {
         LOG_ERROR("SetCurrentPath: invalid directory: %s", newPath.string().c_str());
     }
@@ -43,7 +107,7 @@ void FileList::SetCurrentPath(const fs::path& newPath) {
 
 // 公共导航：压栈 + 清前进 + 设置新路径
 void FileList::NavigateTo(const fs::path& newPath) {
-    if (newPath == m_currentPath) return;
+    if (newPath == m_currentPath && !IsVirtual()) return;
     if (!fs::exists(newPath) || !fs::is_directory(newPath)) {
         LOG_ERROR("NavigateTo: invalid directory: %s", newPath.string().c_str());
         return;
@@ -115,64 +179,409 @@ bool FileList::CanGoForward() const {
     return false;
 }
 
-// 刷新：重新扫描当前目录（不改变历史）
+// 刷新：重新扫描当前目录（不改变历史，也不使用缓存）
+// 新列表收集到 m_pendingEntries，完成后与当前列表做差异合并，而不是清空重建
 void FileList::Refresh() {
-    RefreshImpl();
+    // 虚拟列表不对应任何目录，没有可重新扫描的内容
+    if (IsVirtual())
+        return;
+    if (m_currentPath.empty()) {
+        RefreshImpl(false);
+        return;
+    }
+    // 扫描进行中：等它结束再扫一遍（目录持续变化时不会反复从头开始）
+    if (m_scanning) {
+        m_refreshQueued = true;
+        return;
+    }
+    m_pendingEntries.Clear();
+    m_scanGeneration = m_scanner.Start(m_currentPath);
+    m_scanning = true;
+    m_revalidating = true;
 }
 
-// 内部刷新实现（添加异常保护）
-void FileList::RefreshImpl() {
-    m_entries.clear();
-    if (m_currentPath.empty())
+// 内部刷新实现：清空列表并启动后台扫描（旧扫描自动作废）
+void FileList::RefreshImpl(bool useCache) {
+    m_entries.Clear();
+    m_display.Clear();
+    m_filter.Clear();
+    m_pendingEntries.Clear();
+    m_scanning = false;
+    m_revalidating = false;
+    m_refreshQueued = false;
+    RebuildView();
+    if (m_currentPath.empty()) {
+        m_scanner.Cancel();
         return;
+    }
 
-    try {
-        for (auto& entry : fs::directory_iterator(m_currentPath)) {
-            FileEntry fe;
-            fe.path = entry.path();
-            fe.isDirectory = entry.is_directory();
-            if (!fe.isDirectory && entry.is_regular_file()) {
-                fe.size = entry.file_size();
-            } else {
-                fe.size = 0;
-            }
-            fe.lastWriteTime = entry.last_write_time();
-            m_entries.push_back(fe);
+    // 命中缓存：立即显示快照，再在后台按目录修改时间校验
+    if (useCache) {
+        auto snapshot = m_snapshots.Get(m_currentPath);
+        m_prefetcher.NoteNavigation(m_currentPath, snapshot != nullptr);
+        if (!snapshot)
+            snapshot = LoadStoredSnapshot(m_currentPath);
+        if (snapshot) {
+            m_entries = snapshot->entries;
+            RebuildView();
+            m_scanGeneration = m_scanner.StartRevalidate(m_currentPath, snapshot->dirWriteTime);
+            m_scanning = true;
+            m_revalidating = true;
+            return;
+        }
+    }
+
+    m_scanGeneration = m_scanner.Start(m_currentPath);
+    m_scanning = true;
+}
+
+// 取回扫描线程送来的批次，排序后与已有条目归并
+// 校验期间新列表先收集到 m_pendingEntries，完成后整体替换，避免界面闪烁
+void FileList::PollScanResults() {
+    if (!m_scanning)
+        return;
+
+    std::vector<DirScanner::Batch> batches;
+    if (!m_scanner.Poll(batches))
+        return;
+
+    EntryStore& target = m_revalidating ? m_pendingEntries : m_entries;
+    std::size_t oldCount = target.Size();
+    bool finished = false;
+    bool unchanged = false;
+    std::chrono::system_clock::time_point dirWriteTime{};
+    for (auto& batch : batches) {
+        if (batch.generation != m_scanGeneration)
+            continue;
+        target.Append(batch.entries);
+        if (batch.finished) {
+            finished = true;
+            unchanged = batch.unchanged;
+            dirWriteTime = batch.dirWriteTime;
+        }
+    }
+
+    target.MergeSorted(oldCount);
+    if (!m_revalidating)
+        ExtendView();
+
+    if (!finished)
+        return;
+    m_scanning = false;
+    if (unchanged) {
+        m_revalidating = false; // 缓存仍然有效
+    } else {
+        if (m_revalidating) {
+            ApplyDiff();
+            m_revalidating = false;
+        }
+        StoreSnapshot(dirWriteTime);
+    }
+    // 扫描期间又收到了刷新请求（例如监视到新的变化）：紧接着再扫一遍
+    if (m_refreshQueued) {
+        m_refreshQueued = false;
+        Refresh();
+        return;
+    }
+
+    // 当前目录就绪后，预取上一级目录（“向上”是最常见的下一步）
+    fs::path parent = m_currentPath.parent_path();
+    if (parent != m_currentPath)
+        RequestPrefetch(parent);
+}
+
+// 条目整体替换：键必须重算（旧键可能仍被后台排序持有，所以换新对象）
+void FileList::RebuildView() {
+    m_sortKeys = std::make_shared<SortKeys>();
+    m_sortKeys->Append(m_entries);
+    m_view.clear();
+    ++m_viewGeneration;
+    ++m_entriesGeneration;
+    m_rowFlags.assign(m_entries.Size(), 0);
+    m_rowIcons.assign(m_entries.Size(), 0);
+    m_pendingScrollY.reset();
+    ResortView();
+}
+
+void FileList::ResortView() {
+    m_sorter.Cancel();
+    m_sorting = false;
+    AppendSortKeys(m_sortKeys, m_entries);
+
+    if (m_sortKeys->Size() < kSyncSortLimit) {
+        auto start = std::chrono::steady_clock::now();
+        EntrySorter::Sort(*m_sortKeys, m_sortSpec, m_view);
+        ++m_viewGeneration;
+        m_lastSortTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        return;
+    }
+
+    // 大目录：后台排序，期间继续显示当前顺序（刚替换的列表先用存储自带的默认顺序）
+    // 只有顶部可见时才值得先交付第一屏
+    if (m_view.size() != m_entries.Size()) {
+        m_view = m_entries.GetOrder();
+        ++m_viewGeneration;
+    }
+    m_sortGeneration = m_sorter.Start(m_sortKeys, m_sortSpec, m_scrolledToTop ? m_visibleRows : 0);
+    m_sorting = true;
+}
+
+// 新到达的条目：归并进已排序的视图；后台排序进行中则先追加在末尾，等结果到达后统一归并
+void FileList::ExtendView() {
+    std::size_t oldCount = m_view.size();
+    for (std::size_t i = oldCount; i < m_entries.Size(); ++i)
+        m_view.push_back((EntryStore::Index)i);
+    ++m_viewGeneration;
+    m_rowFlags.resize(m_entries.Size(), 0);
+    m_rowIcons.resize(m_entries.Size(), 0);
+    if (m_sorting || m_view.size() == oldCount)
+        return;
+    AppendSortKeys(m_sortKeys, m_entries);
+    EntrySorter::MergeAppended(*m_sortKeys, m_sortSpec, m_view, oldCount);
+}
+
+void FileList::PollSortResults() {
+    if (!m_sorting)
+        return;
+    EntrySorter::Result result;
+    if (!m_sorter.Poll(result) || result.generation != m_sortGeneration)
+        return;
+
+    // 结果只覆盖排序开始时的条目，之后扫描到的条目补在末尾
+    std::size_t sortedCount = result.order.size();
+    m_view = std::move(result.order);
+    for (std::size_t i = sortedCount; i < m_entries.Size(); ++i)
+        m_view.push_back((EntryStore::Index)i);
+    ++m_viewGeneration;
+    if (!result.complete)
+        return;
+    m_sorting = false;
+    if (m_view.size() > sortedCount) {
+        AppendSortKeys(m_sortKeys, m_entries);
+        EntrySorter::MergeAppended(*m_sortKeys, m_sortSpec, m_view, sortedCount);
+    }
+}
+
+void FileList::ApplyDiff() {
+    auto start = std::chrono::steady_clock::now();
+    ListingDiff diff = ListingDiff::Compute(m_entries, m_pendingEntries);
+    m_diffStats.added = diff.added;
+    m_diffStats.removed = diff.removed;
+    m_diffStats.modified = diff.modified;
+    if (diff.Empty()) {
+        // 目录修改时间变了但内容相同（例如临时文件已经删除）
+        m_pendingEntries.Clear();
+        m_diffStats.time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        return;
+    }
+
+    // 滚动锚点：视口顶部那一行（被删除或修改则顺延到下一未变行）
+    std::optional<EntryStore::Index> anchor;
+    float anchorOffset = 0.0f;
+    if (m_scrollY > 0.0f && m_rowHeight > 0.0f) {
+        const std::vector<EntryStore::Index>& rows = DisplayedRows();
+        std::size_t row = (std::size_t)(m_scrollY / m_rowHeight);
+        anchorOffset = m_scrollY - row * m_rowHeight;
+        for (; row < rows.size() && !anchor; ++row) {
+            if (diff.current[rows[row]] != EntryStore::kNoIndex)
+                anchor = diff.current[rows[row]];
+        }
+    }
+
+    // 选中状态和图标按名字带到新列表；新增和修改的行短暂高亮
+    std::vector<std::uint8_t> flags(m_pendingEntries.Size(), 0);
+    std::vector<ImTextureID> icons(m_pendingEntries.Size(), 0);
+    for (std::size_t i = 0; i < flags.size(); ++i) {
+        EntryStore::Index previous = diff.previous[i];
+        if (previous != EntryStore::kNoIndex && previous < m_rowFlags.size()) {
+            flags[i] = m_rowFlags[previous] & (kRowSelected | kRowIconLoaded);
+            icons[i] = m_rowIcons[previous];
         }
-    } catch (const fs::filesystem_error& e) {
-        LOG_ERROR("Filesystem error in Refresh for %s: %s", m_currentPath.string().c_str(), e.what());
-    } catch (const std::exception& e) {
-        LOG_ERROR("Standard exception in Refresh: %s", e.what());
-    } catch (...) {
-        LOG_ERROR("Unknown exception in Refresh for %s", m_currentPath.string().c_str());
     }
+    for (EntryStore::Index index : diff.changed)
+        flags[index] |= kRowChanged;
+
+    // 视图中保留未变的条目（换成新索引），其相对顺序不变
+    std::vector<EntryStore::Index> view;
+    view.reserve(m_pendingEntries.Size());
+    for (EntryStore::Index index : m_view) {
+        if (diff.current[index] != EntryStore::kNoIndex)
+            view.push_back(diff.current[index]);
+    }
+
+    std::swap(m_entries, m_pendingEntries);
+    m_pendingEntries.Clear();
+    ++m_entriesGeneration;
+    m_display.Remap(diff.reuse, m_entries);
+    m_filter.Clear();
+    m_filter.Update(m_display);
+    m_rowFlags.swap(flags);
+    m_rowIcons.swap(icons);
+    m_changeTime = std::chrono::steady_clock::now();
+
+    // 后台排序可能仍持有旧键：放弃它并复制一份再改写
+    bool wasSorting = m_sorting;
+    m_sorter.Cancel();
+    m_sorting = false;
+    if (m_sortKeys.use_count() > 1)
+        m_sortKeys = std::make_shared<SortKeys>(*m_sortKeys);
+    m_sortKeys->Remap(diff.reuse, m_entries);
+
+    m_view.swap(view);
+    ++m_viewGeneration;
+    if (wasSorting) {
+        // 旧视图本来就没排好，变化的条目补在末尾后整体重排
+        m_view.insert(m_view.end(), diff.changed.begin(), diff.changed.end());
+        ResortView();
+    } else {
+        EntrySorter::InsertSorted(*m_sortKeys, m_sortSpec, m_view, std::move(diff.changed));
+    }
+
+    if (anchor) {
+        UpdateFilteredView();
+        const std::vector<EntryStore::Index>& rows = DisplayedRows();
+        auto it = std::find(rows.begin(), rows.end(), *anchor);
+        m_pendingScrollY = (it - rows.begin()) * m_rowHeight + anchorOffset;
+    }
+
+    m_diffStats.time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    LOG_INFO("Refresh merged %d added, %d removed, %d modified entries in %.2f ms", (int)m_diffStats.added,
+             (int)m_diffStats.removed, (int)m_diffStats.modified, m_diffStats.time.count() / 1000.0);
+}
+
+void FileList::ApplyFilter() {
+    auto start = std::chrono::steady_clock::now();
+    std::string text(m_filterText);
+    m_filter.SetPattern(text, EntryFilter::DetectMode(text, m_filterMode), m_display);
+    UpdateFilteredView();
+    m_filterTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+}
+
+// 过滤结果是排好序的视图的子序列，视图或匹配集变化时重新抽取
+void FileList::UpdateFilteredView() {
+    if (!m_filter.IsActive()) {
+        m_filteredView.clear();
+        return;
+    }
+    if (m_filteredViewGeneration == m_viewGeneration && m_filteredMatchGeneration == m_filter.GetGeneration())
+        return;
+    m_filteredView.clear();
+    for (EntryStore::Index index : m_view) {
+        if (m_filter.Matches(index))
+            m_filteredView.push_back(index);
+    }
+    m_filteredViewGeneration = m_viewGeneration;
+    m_filteredMatchGeneration = m_filter.GetGeneration();
+}
+
+void FileList::SelectEntry(EntryStore::Index index) {
+    if (ImGui::GetIO().KeyCtrl) {
+        m_rowFlags[index] ^= kRowSelected;
+        if (m_rowFlags[index] & kRowSelected)
+            PinChecksum(index);
+        return;
+    }
+    for (std::uint8_t& flags : m_rowFlags)
+        flags &= (std::uint8_t)~kRowSelected;
+    m_rowFlags[index] |= kRowSelected;
+    PinChecksum(index);
+}
+
+void FileList::RequestPrefetch(const fs::path& dir) {
+    if (m_scanning && !m_revalidating)
+        return; // 不与前台扫描争抢磁盘
+    m_prefetcher.Request(dir);
+}
 
-    // 排序：目录在前，文件在后，按文件名排序
-    std::sort(m_entries.begin(), m_entries.end(),
-        [](const FileEntry& a, const FileEntry& b) {
-            if (a.isDirectory != b.isDirectory)
-                return a.isDirectory;
-            return a.path.filename() < b.path.filename();
-        });
+std::shared_ptr<const DirSnapshot> FileList::LoadStoredSnapshot(const fs::path& dir) {
+    if (!m_store || !m_store->IsOpen())
+        return nullptr;
+    std::shared_ptr<DirSnapshot> snapshot = m_store->Find(dir);
+    if (!snapshot)
+        return nullptr;
+    m_snapshots.Put(snapshot);
+    return snapshot;
+}
+
+void FileList::StoreSnapshot(std::chrono::system_clock::time_point dirWriteTime) {
+    auto snapshot = std::make_shared<DirSnapshot>();
+    snapshot->dir = m_currentPath;
+    snapshot->entries = m_entries;
+    snapshot->dirWriteTime = dirWriteTime;
+    m_snapshots.Put(std::move(snapshot));
+}
+
+fs::path FileList::EntryPath(EntryStore::Index index) const {
+    return m_currentPath / fs::path(m_entries.GetName(index));
 }
 
 // 双击打开条目（文件夹延迟导航，文件用 ShellExecute）
-void FileList::OpenEntry(const FileEntry& entry) {
-    if (entry.isDirectory) {
-        m_pendingNavigation = entry.path;
+void FileList::OpenEntry(EntryStore::Index index) {
+    fs::path fullPath = EntryPath(index);
+    if (m_entries.IsDirectory(index)) {
+        m_pendingNavigation = fullPath;
     } else {
-        ShellExecuteW(nullptr, L"open", entry.path.c_str(), nullptr, nullptr, SW_SHOW);
+        ShellExecuteW(nullptr, L"open", fullPath.c_str(), nullptr, nullptr, SW_SHOW);
+    }
+}
+
+void FileList::OpenPath(const std::filesystem::path& path) {
+    std::error_code ec;
+    if (fs::is_directory(path, ec))
+        RequestNavigation(path);
+    else
+        ShellExecuteW(nullptr, L"open", path.c_str(), nullptr, nullptr, SW_SHOW);
+}
+
+void FileList::ShowVirtualListing(const fs::path& root, const std::string& label, EntryStore entries) {
+    m_scanner.Cancel();
+    m_prefetcher.CancelAll();
+    m_pendingNavigation.reset();
+    // 从普通目录进入时记入历史，“后退”回到原目录
+    if (!IsVirtual() && !m_currentPath.empty()) {
+        m_backStack.push_back(m_currentPath);
+        m_forwardStack.clear();
     }
+    m_currentPath = root;
+    m_virtualLabel = label.empty() ? root.u8string() : label;
+    m_filterText[0] = '\0';
+
+    m_entries = std::move(entries);
+    m_display.Clear();
+    m_filter.Clear();
+    m_pendingEntries.Clear();
+    m_scanning = false;
+    m_revalidating = false;
+    m_refreshQueued = false;
+    RebuildView();
+    ApplyFilter();
+}
+
+void FileList::SetFilter(const std::string& text, FilterMode mode) {
+    std::snprintf(m_filterText, sizeof(m_filterText), "%s", text.c_str());
+    m_filterMode = mode;
+    // 与过滤框获得焦点时相同：先建好名字缓冲区
+    m_filter.Prepare(m_display);
+    ApplyFilter();
 }
 
 void FileList::RequestNavigation(const std::filesystem::path& path) {
     m_pendingNavigation = path;
+    // 导航延迟到本帧结束才执行，但旧目录的扫描和预取现在就可以停止
+    if (path != m_currentPath) {
+        m_scanner.Cancel();
+        m_prefetcher.CancelAll();
+    }
 }
 
 void FileList::ProcessPendingNavigation() {
     if (m_pendingNavigation) {
-        NavigateTo(*m_pendingNavigation);
+        fs::path target = *m_pendingNavigation;
         m_pendingNavigation.reset();
+        NavigateTo(target);
+        // 导航失败时当前目录不变，需要重新开始被提前取消的扫描
+        if (m_scanning && m_scanner.GetGeneration() != m_scanGeneration)
+            RefreshImpl();
     }
 }
 
@@ -188,64 +597,470 @@ void FileList::Draw() {
         return;
     }
 
-    // 使用表格布局
-    if (ImGui::BeginTable("FileListTable", 3,
-        ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY))
+    PollScanResults();
+    PollSortResults();
+    // 只为新到达的条目生成显示文本（过滤器随之匹配新条目）
+    m_display.Update(m_entries);
+    m_filter.Update(m_display);
+    PollFolderSizes();
+    // 条目整体替换或合并后校验和槽位作废（结果仍在缓存里）
+    if (m_showChecksums) {
+        if (m_checksumGeneration != m_entriesGeneration)
+            ResetChecksums();
+        else if (m_rowChecksums.size() < m_entries.Size())
+            m_rowChecksums.resize(m_entries.Size(), 0);
+    }
+    if (m_scanning && !m_revalidating) {
+        ImGui::TextDisabled("Scanning... %d items", (int)m_entries.Size());
+    } else if (m_sorting) {
+        ImGui::TextDisabled("Sorting... %d items", (int)m_entries.Size());
+    }
+
+    // 过滤框：逐键过滤；含 * 或 ? 时按通配符匹配整个名字
+    ImGui::SetNextItemWidth(m_showChecksums ? -430.0f : -330.0f);
+    bool filterEdited = ImGui::InputTextWithHint("##filter", "Filter (* and ? for wildcards)", m_filterText,
+                                                 sizeof(m_filterText), ImGuiInputTextFlags_EscapeClearsAll);
+    // 获得焦点时先建好小写名字缓冲区，第一次按键只需扫描
+    if (ImGui::IsItemActivated())
+        m_filter.Prepare(m_display);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(104.0f);
+    int filterMode = m_filterMode == FilterMode::Prefix ? 1 : 0;
+    if (ImGui::Combo("##filterMode", &filterMode, "Contains\0Starts with\0")) {
+        m_filterMode = filterMode == 1 ? FilterMode::Prefix : FilterMode::Substring;
+        filterEdited = true;
+    }
+    if (filterEdited)
+        ApplyFilter();
+    ImGui::SameLine();
+    if (ImGui::Checkbox("Checksums", &m_showChecksums)) {
+        if (m_showChecksums) {
+            ResetChecksums();
+        } else {
+            m_checksums.ClearSlots();
+            m_rowChecksums.clear();
+        }
+    }
+    if (m_showChecksums) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(90.0f);
+        int algorithm = m_checksums.GetAlgorithm() == ChecksumCache::Algorithm::Sha256 ? 1 : 0;
+        if (ImGui::Combo("##checksumAlgorithm", &algorithm, "XXH64\0SHA-256\0")) {
+            m_checksums.SetAlgorithm(algorithm == 1 ? ChecksumCache::Algorithm::Sha256
+                                                    : ChecksumCache::Algorithm::XxHash64);
+            ResetChecksums();
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Checkbox("Folder sizes", &m_folderSizes) && !m_folderSizes)
+        ClearFolderSizes();
+    if (m_folderSizes)
+        DrawFolderSizeBar();
+    UpdateFilteredView();
+    const std::vector<EntryStore::Index>& rows = DisplayedRows();
+
+    // 增量刷新后恢复滚动锚点（作用于表格的滚动子窗口）
+    if (m_pendingScrollY) {
+        ImGui::SetNextWindowScroll(ImVec2(-1.0f, *m_pendingScrollY));
+        m_pendingScrollY.reset();
+    }
+
+    // 使用表格布局（点击表头排序，Shift+点击追加次要排序键）
+    if (ImGui::BeginTable("FileListTable", 5,
+        ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY |
+        ImGuiTableFlags_Sortable | ImGuiTableFlags_SortMulti))
     {
-        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
-        ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_WidthFixed, 80.0f);
-        ImGui::TableSetupColumn("Date modified", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch | ImGuiTableColumnFlags_DefaultSort,
+                                0.0f, (ImGuiID)SortColumn::Name);
+        ImGui::TableSetupColumn("Type", ImGuiTableColumnFlags_WidthFixed, 60.0f, (ImGuiID)SortColumn::Type);
+        ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_WidthFixed, 80.0f, (ImGuiID)SortColumn::Size);
+        ImGui::TableSetupColumn("Date modified", ImGuiTableColumnFlags_WidthFixed, 120.0f, (ImGuiID)SortColumn::Date);
+        ImGui::TableSetupColumn("Checksum", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoSort |
+                                (m_showChecksums ? 0 : ImGuiTableColumnFlags_Disabled), 140.0f);
+        ImGui::TableSetupScrollFreeze(0, 1);
         ImGui::TableHeadersRow();
 
-        for (auto& entry : m_entries) {
-            // 为每一行分配唯一 ID
-            ImGui::PushID(entry.path.string().c_str());
+        // 记录可见行数，后台排序据此先交付第一屏
+        m_scrollY = ImGui::GetScrollY();
+        m_scrolledToTop = m_scrollY <= 0.0f;
+        float rowHeight = m_rowHeight > 0.0f ? m_rowHeight : ImGui::GetTextLineHeight();
+        m_visibleRows = (std::size_t)(ImGui::GetWindowHeight() / rowHeight) + 1;
 
-            ImGui::TableNextRow();
+        if (ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs()) {
+            if (specs->SpecsDirty) {
+                SortSpec spec;
+                for (int i = 0; i < specs->SpecsCount; ++i) {
+                    const ImGuiTableColumnSortSpecs& column = specs->Specs[i];
+                    spec.push_back({ (SortColumn)column.ColumnUserID,
+                                     column.SortDirection == ImGuiSortDirection_Descending });
+                }
+                if (spec != m_sortSpec) {
+                    m_sortSpec = std::move(spec);
+                    ResortView();
+                }
+                specs->SpecsDirty = false;
+            }
+        }
 
-            // 第0列：图标和文件名
-            ImGui::TableSetColumnIndex(0);
-            ImTextureID tex = m_iconCache->GetTexture(entry.path, entry.isDirectory);
-            ImGui::Image(tex, ImVec2(16, 16));
-            ImGui::SameLine();
+        // 变化行的高亮随时间淡出
+        float highlight = 1.0f - std::chrono::duration<float>(std::chrono::steady_clock::now() - m_changeTime).count() / kHighlightSeconds;
+        auto drawStart = std::chrono::steady_clock::now();
+        std::size_t drawn = 0;
 
-            std::string displayName = entry.path.filename().string();
-            ImGui::Selectable(displayName.c_str(), false, ImGuiSelectableFlags_SpanAllColumns);
+        // 只提交可见行：每帧开销取决于窗口高度而不是条目数
+        ImGuiListClipper clipper;
+        clipper.Begin((int)rows.size());
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                EntryStore::Index index = rows[row];
+                bool isDirectory = m_entries.IsDirectory(index);
+                std::uint8_t flags = m_rowFlags[index];
 
-            if (ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(0)) {
-                OpenEntry(entry);
-            }
+                // 行 ID 用存储索引，不再由名字生成
+                ImGui::PushID((int)index);
+
+                ImGui::TableNextRow();
+
+                // 第0列：图标和文件名
+                // 图标首次可见时取一次并记在行上，之后绘制不再构造路径
+                ImGui::TableSetColumnIndex(0);
+                if ((flags & kRowChanged) && highlight > 0.0f)
+                    ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg1, ImGui::GetColorU32(ImGuiCol_PlotHistogram, 0.4f * highlight));
+                if (!(flags & kRowIconLoaded)) {
+                    // 没有图标缓存（无界面的帧基准测试）时不取图标
+                    if (m_iconCache)
+                        m_rowIcons[index] = m_iconCache->GetTexture(EntryPath(index), isDirectory);
+                    m_rowFlags[index] |= kRowIconLoaded;
+                }
+                ImGui::Image(m_rowIcons[index], ImVec2(16, 16));
+                ImGui::SameLine();
 
-            // 第1列：大小
-            ImGui::TableSetColumnIndex(1);
-            if (!entry.isDirectory && entry.size > 0) {
-                if (entry.size < 1024)
-                    ImGui::Text("%llu B", entry.size);
-                else if (entry.size < 1024 * 1024)
-                    ImGui::Text("%.1f KB", entry.size / 1024.0);
-                else if (entry.size < 1024 * 1024 * 1024)
-                    ImGui::Text("%.1f MB", entry.size / (1024.0 * 1024.0));
+                if (ImGui::Selectable(m_display.GetName(index), (flags & kRowSelected) != 0, ImGuiSelectableFlags_SpanAllColumns))
+                    SelectEntry(index);
+
+                bool rowHovered = ImGui::IsItemHovered();
+                if (rowHovered && ImGui::IsMouseDoubleClicked(0)) {
+                    OpenEntry(index);
+                }
+                // 校验和清单的右键菜单（只在右键时检查扩展名）
+                if (!isDirectory && m_onVerifyManifest && ImGui::IsItemClicked(ImGuiMouseButton_Right) &&
+                    ManifestVerifier::IsManifestName(m_display.GetName(index)))
+                    ImGui::OpenPopup("##manifest");
+                if (ImGui::BeginPopup("##manifest")) {
+                    if (ImGui::MenuItem("Verify against manifest"))
+                        m_onVerifyManifest(EntryPath(index));
+                    ImGui::EndPopup();
+                }
+                // 鼠标在文件夹上停留片刻：很可能马上要打开它（每次悬停只请求一次）
+                bool hovered = isDirectory &&
+                    ImGui::IsItemHovered(ImGuiHoveredFlags_DelayShort | ImGuiHoveredFlags_NoSharedDelay);
+                if (hovered && !(flags & kRowHovered))
+                    RequestPrefetch(EntryPath(index));
+                m_rowFlags[index] = hovered ? (m_rowFlags[index] | kRowHovered)
+                                            : (m_rowFlags[index] & (std::uint8_t)~kRowHovered);
+
+                // 第1列：扩展名
+                ImGui::TableSetColumnIndex(1);
+                ImGui::TextUnformatted(m_display.GetType(index));
+
+                // 第2列：大小（空文件和未计算的文件夹为空串；仍在计算的文件夹变暗）
+                ImGui::TableSetColumnIndex(2);
+                if (flags & kRowSizing)
+                    ImGui::TextDisabled("%s", m_display.GetSize(index));
                 else
-                    ImGui::Text("%.1f GB", entry.size / (1024.0 * 1024.0 * 1024.0));
-            } else {
-                ImGui::Text("");
-            }
+                    ImGui::TextUnformatted(m_display.GetSize(index));
+                if (isDirectory && rowHovered && m_folderSizes &&
+                    ImGui::IsMouseHoveringRect(ImGui::GetItemRectMin(), ImGui::GetItemRectMax()))
+                    DrawFolderSizeTooltip(index);
 
-            // 第2列：修改时间
-            ImGui::TableSetColumnIndex(2);
-            auto ftime = entry.lastWriteTime;
-            auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-                ftime - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
-            std::time_t cftime = std::chrono::system_clock::to_time_t(sctp);
-            std::tm* tm = std::localtime(&cftime);
-            if (tm) {
-                char buffer[64];
-                strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M", tm);
-                ImGui::Text("%s", buffer);
-            }
+                // 第3列：修改时间
+                ImGui::TableSetColumnIndex(3);
+                ImGui::TextUnformatted(m_display.GetDate(index));
+
+                // 第4列：校验和（只为画出来的文件请求）
+                if (m_showChecksums && !isDirectory) {
+                    ImGui::TableSetColumnIndex(4);
+                    DrawChecksumCell(index, rowHovered);
+                }
 
-            ImGui::PopID();
+                ImGui::PopID();
+                ++drawn;
+            }
         }
+        // 裁剪器按第一行测得的行高（用于滚动锚点换算）
+        if (clipper.ItemsHeight > 0.0f)
+            m_rowHeight = clipper.ItemsHeight;
+        m_drawnRows = drawn;
+        m_checksums.NextFrame();
+        m_drawTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - drawStart);
         ImGui::EndTable();
     }
 }
+
+
+void FileList::DrawStats() {
+    DirScanner::Stats scan = m_scanner.GetLastStats();
+    ImGui::SeparatorText("Directory scan");
+    ImGui::Text("Backend: %s", scan.backend);
+    ImGui::Text("Entries: %llu", (unsigned long long)scan.entryCount);
+    ImGui::Text("First batch: %.2f ms", scan.timeToFirstBatch.count() / 1000.0);
+    ImGui::Text("Total: %.2f ms%s", scan.totalTime.count() / 1000.0, scan.cancelled ? " (cancelled)" : "");
+
+    // 列式存储的实际占用：名字池 + 各列数组，按已分配容量计算
+    ImGui::SeparatorText("Entry store");
+    std::size_t storeBytes = m_entries.GetMemoryBytes();
+    ImGui::Text("Entries: %d  Memory: %.1f KB", (int)m_entries.Size(), storeBytes / 1024.0);
+    ImGui::Text("Bytes per entry: %.1f (names %.1f)",
+                m_entries.Empty() ? 0.0 : (double)storeBytes / m_entries.Size(),
+                m_entries.Empty() ? 0.0 : (double)m_entries.GetNameChars() * sizeof(EntryStore::Char) / m_entries.Size());
+    ImGui::Text("Display text: %.1f KB", m_display.GetMemoryBytes() / 1024.0);
+
+    EntryFilter::Stats filter = m_filter.GetLastStats();
+    ImGui::SeparatorText("Filter");
+    ImGui::Text("Matches: %d of %d  Memory: %.1f KB", (int)m_filter.GetMatchCount(), (int)m_view.size(),
+                m_filter.GetMemoryBytes() / 1024.0);
+    ImGui::Text("Last keystroke: %.2f ms (match %.2f ms, %s)", m_filterTime.count() / 1000.0,
+                filter.time.count() / 1000.0, filter.narrowed ? "narrowed" : "full scan");
+
+    ImGui::SeparatorText("Table");
+    ImGui::Text("Rows drawn: %d of %d  Time: %.1f us", (int)m_drawnRows, (int)DisplayedRows().size(),
+                (double)m_drawTime.count());
+
+    // 小目录在界面线程内排序，大目录的耗时来自后台排序线程
+    EntrySorter::Stats sort = m_sorter.GetLastStats();
+    ImGui::SeparatorText("Sort");
+    ImGui::Text("Keys: %.1f KB  In-frame sort: %.2f ms", m_sortKeys->GetMemoryBytes() / 1024.0,
+                m_lastSortTime.count() / 1000.0);
+    ImGui::Text("Background: %d entries, %d threads", (int)sort.entryCount, sort.threads);
+    ImGui::Text("Top window: %.2f ms  Complete: %.2f ms%s", sort.partialTime.count() / 1000.0,
+                sort.totalTime.count() / 1000.0, sort.cancelled ? " (cancelled)" : "");
+
+    DirSizer::Stats sizes = m_sizer.GetStats();
+    ImGui::SeparatorText("Folder sizes");
+    ImGui::Text("Folders: %d read, %d from cache  Errors: %d", (int)sizes.visited, (int)sizes.cached,
+                (int)sizes.errors);
+    ImGui::Text("Hard links skipped: %d  Steals: %d  Threads: %d", (int)sizes.linked, (int)sizes.steals,
+                sizes.threads);
+    ImGui::Text("Time: %.2f ms%s  Cached folders: %d", sizes.time.count() / 1000.0,
+                sizes.running ? " (running)" : "", (int)sizes.cacheEntries);
+
+    // 吞吐量按各工作线程的哈希时间计算（单线程的速度）
+    ChecksumCache::Stats checksums = m_checksums.GetStats();
+    ImGui::SeparatorText("Checksums");
+    ImGui::Text("Hashed: %llu files, %.1f MB (%.0f MB/s per worker)", (unsigned long long)checksums.hashed,
+                checksums.bytes / 1e6,
+                checksums.hashTime.count() > 0 ? (double)checksums.bytes / checksums.hashTime.count() : 0.0);
+    ImGui::Text("From cache: %llu  Unreadable: %llu  Cached: %d", (unsigned long long)checksums.cacheHits,
+                (unsigned long long)checksums.failed, (int)checksums.cached);
+    ImGui::Text("Queued: %d of %d requested  Threads: %d", (int)checksums.queued, (int)checksums.slots,
+                checksums.threads);
+
+    ImGui::SeparatorText("Refresh");
+    ImGui::Text("Last diff: +%d  -%d  ~%d  in %.2f ms", (int)m_diffStats.added, (int)m_diffStats.removed,
+                (int)m_diffStats.modified, m_diffStats.time.count() / 1000.0);
+
+    SnapshotCache::Stats cache = m_snapshots.GetStats();
+    std::uint64_t lookups = cache.hits + cache.misses;
+    ImGui::SeparatorText("Snapshot cache");
+    ImGui::Text("Hits: %llu  Misses: %llu  (%.1f%%)", (unsigned long long)cache.hits,
+                (unsigned long long)cache.misses, lookups ? 100.0 * cache.hits / lookups : 0.0);
+    ImGui::Text("Evictions: %llu", (unsigned long long)cache.evictions);
+    ImGui::Text("Snapshots: %d  Memory: %.1f / %.1f MB", (int)cache.count,
+                cache.bytes / (1024.0 * 1024.0), cache.budget / (1024.0 * 1024.0));
+
+    int budgetMB = (int)(cache.budget / (1024 * 1024));
+    if (ImGui::SliderInt("Budget (MB)", &budgetMB, 4, 1024))
+        m_snapshots.SetBudget((std::size_t)budgetMB * 1024 * 1024);
+
+    // 命中率 = 被实际访问的预取 / 完成的预取
+    DirPrefetcher::Stats prefetch = m_prefetcher.GetStats();
+    ImGui::SeparatorText("Prefetch");
+    ImGui::Text("Requested: %llu  Completed: %llu", (unsigned long long)prefetch.requested,
+                (unsigned long long)prefetch.completed);
+    ImGui::Text("Cancelled: %llu  Skipped: %llu", (unsigned long long)prefetch.cancelled,
+                (unsigned long long)prefetch.skipped);
+    ImGui::Text("Used: %llu  Hit rate: %.1f%%", (unsigned long long)prefetch.used,
+                prefetch.completed ? 100.0 * prefetch.used / prefetch.completed : 0.0);
+}
+// -----------------------------------------------------------------------------
+// Folder sizes
+// -----------------------------------------------------------------------------
+
+void FileList::StartFolderSizes(bool useCache) {
+    // 槽 k 对应第 k 个文件夹；按存储索引升序，悬停时可二分查找
+    std::vector<fs::path::string_type> names;
+    m_sizedRows.clear();
+    for (std::size_t i = 0; i < m_entries.Size(); ++i) {
+        if (!m_entries.IsDirectory((EntryStore::Index)i))
+            continue;
+        EntryStore::NameView name = m_entries.GetName((EntryStore::Index)i);
+        names.emplace_back(name.data(), name.size());
+        m_sizedRows.push_back((EntryStore::Index)i);
+    }
+    m_sizer.Start(m_currentPath, names, useCache);
+    m_sizedGeneration = m_entriesGeneration;
+    m_shownSizes.assign(m_sizedRows.size(), ~0ULL);
+    m_sizesAppliedTime = {};
+    m_sizesFinal = false;
+}
+
+void FileList::PollFolderSizes() {
+    // 列表被替换或合并过：旧的槽已对不上，按新列表重新计算（未变的文件夹走缓存）
+    if (m_sizedGeneration != m_entriesGeneration) {
+        m_sizer.Cancel();
+        m_sizedRows.clear();
+        bool listingReady = !(m_scanning && !m_revalidating);
+        if (!m_folderSizes || IsVirtual() || !listingReady)
+            return;
+        StartFolderSizes(true);
+    }
+    if (m_sizesFinal)
+        return;
+
+    // 先读运行状态：已结束时随后取到的槽就是最终值
+    bool running = m_sizer.IsRunning();
+    auto now = std::chrono::steady_clock::now();
+    if (running && now - m_sizesAppliedTime < kFolderSizeInterval)
+        return;
+    m_sizesAppliedTime = now;
+    m_sizesFinal = !running;
+    if (ApplyFolderSizes() && SortsBySize(m_sortSpec))
+        ResortView();
+}
+
+bool FileList::ApplyFolderSizes() {
+    m_sizer.GetSlots(m_sizerSlots);
+    bool changed = false;
+    for (std::size_t k = 0; k < m_sizedRows.size() && k < m_sizerSlots.size(); ++k) {
+        const DirSizer::Slot& slot = m_sizerSlots[k];
+        EntryStore::Index index = m_sizedRows[k];
+        m_rowFlags[index] = slot.done ? (m_rowFlags[index] & (std::uint8_t)~kRowSizing)
+                                      : (m_rowFlags[index] | kRowSizing);
+        std::uint64_t size = m_sizeOnDisk ? slot.totals.allocated : slot.totals.logical;
+        if (size == m_shownSizes[k] || index >= m_sortKeys->Size())
+            continue;
+        // 后台排序可能仍持有键：第一次改写前复制一份
+        if (!changed && m_sortKeys.use_count() > 1)
+            m_sortKeys = std::make_shared<SortKeys>(*m_sortKeys);
+        m_sortKeys->SetSize(index, size);
+        m_display.SetSize(index, size);
+        m_shownSizes[k] = size;
+        changed = true;
+    }
+    return changed;
+}
+
+void FileList::ClearFolderSizes() {
+    m_sizer.Cancel();
+    bool changed = !m_sizedRows.empty();
+    if (changed && m_sortKeys.use_count() > 1)
+        m_sortKeys = std::make_shared<SortKeys>(*m_sortKeys);
+    for (EntryStore::Index index : m_sizedRows) {
+        if (index < m_sortKeys->Size())
+            m_sortKeys->SetSize(index, m_entries.GetSize(index));
+        m_display.ClearSize(index);
+        m_rowFlags[index] &= (std::uint8_t)~kRowSizing;
+    }
+    m_sizedRows.clear();
+    m_sizedGeneration = 0;
+    if (changed && SortsBySize(m_sortSpec))
+        ResortView();
+}
+
+void FileList::DrawFolderSizeBar() {
+    ImGui::SetNextItemWidth(110.0f);
+    int mode = m_sizeOnDisk ? 1 : 0;
+    if (ImGui::Combo("##sizeMode", &mode, "Size\0Size on disk\0")) {
+        // 下一次轮询全部重写
+        m_sizeOnDisk = mode == 1;
+        m_shownSizes.assign(m_sizedRows.size(), ~0ULL);
+        m_sizesAppliedTime = {};
+        m_sizesFinal = false;
+    }
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Recompute") && !IsVirtual() && m_sizedGeneration == m_entriesGeneration)
+        StartFolderSizes(false);
+
+    DirSizer::Stats stats = m_sizer.GetStats();
+    char logical[32], allocated[32];
+    DisplayStrings::FormatSize(stats.total.logical, logical, sizeof(logical));
+    DisplayStrings::FormatSize(stats.total.allocated, allocated, sizeof(allocated));
+    ImGui::SameLine();
+    if (IsVirtual()) {
+        ImGui::TextDisabled("Not available for this listing");
+    } else if (m_sizedGeneration != m_entriesGeneration) {
+        ImGui::TextDisabled("Waiting for the listing...");
+    } else {
+        ImGui::TextDisabled("%s %s (%s on disk), %llu files, %llu folders, %.2f s",
+                            stats.running ? "Computing..." : "Total:", logical, allocated,
+                            (unsigned long long)stats.total.files, (unsigned long long)stats.total.folders,
+                            stats.time.count() / 1e6);
+    }
+}
+
+void FileList::DrawFolderSizeTooltip(EntryStore::Index index) {
+    auto it = std::lower_bound(m_sizedRows.begin(), m_sizedRows.end(), index);
+    if (it == m_sizedRows.end() || *it != index)
+        return;
+    std::size_t k = (std::size_t)(it - m_sizedRows.begin());
+    if (k >= m_sizerSlots.size())
+        return;
+    const DirSizer::Slot& slot = m_sizerSlots[k];
+    char logical[32], allocated[32];
+    DisplayStrings::FormatSize(slot.totals.logical, logical, sizeof(logical));
+    DisplayStrings::FormatSize(slot.totals.allocated, allocated, sizeof(allocated));
+    ImGui::BeginTooltip();
+    ImGui::Text("Size: %s (%llu bytes)", logical, (unsigned long long)slot.totals.logical);
+    ImGui::Text("Size on disk: %s (%llu bytes)", allocated, (unsigned long long)slot.totals.allocated);
+    ImGui::Text("%llu files, %llu folders%s", (unsigned long long)slot.totals.files,
+                (unsigned long long)slot.totals.folders, slot.done ? "" : " (still counting)");
+    ImGui::EndTooltip();
+}
+
+// -----------------------------------------------------------------------------
+// Checksums
+// -----------------------------------------------------------------------------
+
+void FileList::ResetChecksums() {
+    m_checksums.ClearSlots();
+    m_rowChecksums.assign(m_entries.Size(), 0);
+    m_checksumGeneration = m_entriesGeneration;
+    // 选中的文件不在可见范围内也要计算
+    for (EntryStore::Index index = 0; index < m_rowFlags.size(); ++index) {
+        if (m_rowFlags[index] & kRowSelected)
+            PinChecksum(index);
+    }
+}
+
+void FileList::PinChecksum(EntryStore::Index index) {
+    if (!m_showChecksums || index >= m_rowChecksums.size() || m_entries.IsDirectory(index))
+        return;
+    std::uint32_t& slot = m_rowChecksums[index];
+    if (slot == 0)
+        slot = m_checksums.Request(EntryPath(index), true);
+    else
+        m_checksums.Pin(slot);
+}
+
+void FileList::DrawChecksumCell(EntryStore::Index index, bool rowHovered) {
+    std::uint32_t& slot = m_rowChecksums[index];
+    if (slot == 0)
+        slot = m_checksums.Request(EntryPath(index), (m_rowFlags[index] & kRowSelected) != 0);
+    char text[ChecksumCache::kTextSize];
+    switch (m_checksums.Get(slot, text, sizeof(text))) {
+        case ChecksumCache::State::Done:
+            ImGui::TextUnformatted(text);
+            // 列宽放不下 SHA-256：悬停时显示完整值
+            if (rowHovered && ImGui::IsMouseHoveringRect(ImGui::GetItemRectMin(), ImGui::GetItemRectMax()))
+                ImGui::SetTooltip("%s %s",
+                                  m_checksums.GetAlgorithm() == ChecksumCache::Algorithm::Sha256 ? "SHA-256" : "XXH64",
+                                  text);
+            break;
+        case ChecksumCache::State::Failed:
+            ImGui::TextDisabled("unreadable");
+            break;
+        default:
+            ImGui::TextDisabled("...");
+            break;
+    }
+}
@@ -0,0 +1,121 @@
+// FuzzyBenchmark.cpp
+// Fuzzy finder benchmark implementation for FileMgr
+//
+// Key features:
+// - Deterministic synthetic relative paths held in memory
+// - Ingest time and candidate memory
+// - Queries typed one character at a time: latency, paths scored, narrowing
+// - Planted path checked to rank first for its query
+//
+
+#include "../include/FuzzyBenchmark.hpp"
+#include "../include/Common.hpp"
+#include "../include/FuzzyFinder.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <random>
+
+namespace {
+    // 埋入的路径及能找到它的查询
+    const char* const kPlantedPath = "platform/windows/shell/FileManagerWindow.cpp";
+    const char* const kPlantedQuery = "filemanagerwindow";
+
+    // 逐字输入的查询：常见的、按词首缩写的、没有匹配的
+    const char* const kQueries[] = { "srcmain.cpp", "listctrl", "texturepng", "fmgr", "zzqx", kPlantedQuery };
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+int FuzzyBenchmark::Run(const Options& options) {
+    std::vector<std::string> paths = Generate(options.paths);
+    const std::size_t count = paths.size();
+    std::size_t bytes = 0;
+    for (const std::string& path : paths)
+        bytes += path.size();
+
+    FuzzyFinder finder;
+    auto start = std::chrono::steady_clock::now();
+    finder.AddCandidates(std::move(paths));
+    finder.WaitIdle();
+    FuzzyFinder::Stats stats = finder.GetLastStats();
+    LOG_INFO("Fuzzy benchmark: %d paths (%.1f bytes each) ingested in %.1f ms, %.1f MB", (int)count,
+             count ? (double)bytes / count : 0.0, ElapsedSince(start).count() / 1e3,
+             stats.memoryBytes / 1048576.0);
+
+    int keystrokes = 0, narrowed = 0;
+    double totalUs = 0, worstUs = 0;
+    bool plantedFirst = false;
+    FuzzyFinder::Result result;
+    for (const char* query : kQueries) {
+        std::string text(query);
+        double queryWorstUs = 0;
+        for (std::size_t n = 1; n <= text.size(); ++n) {
+            auto keystroke = std::chrono::steady_clock::now();
+            finder.SetQuery(text.substr(0, n));
+            finder.WaitIdle();
+            double us = (double)ElapsedSince(keystroke).count();
+            finder.Poll(result);
+            stats = finder.GetLastStats();
+            ++keystrokes;
+            narrowed += stats.narrowed ? 1 : 0;
+            totalUs += us;
+            queryWorstUs = std::max(queryWorstUs, us);
+            worstUs = std::max(worstUs, us);
+        }
+        LOG_INFO("%-18s %7d matches, worst keystroke %.2f ms, last %.2f ms (%d scored, %s); top: %s (%d)", query,
+                 (int)result.matchCount, queryWorstUs / 1e3, stats.queryTime.count() / 1e3, (int)stats.scored,
+                 stats.narrowed ? "narrowed" : "full", result.matches.empty() ? "-" : result.matches[0].path.c_str(),
+                 result.matches.empty() ? 0 : result.matches[0].score);
+        if (text == kPlantedQuery)
+            plantedFirst = !result.matches.empty() && result.matches[0].path == kPlantedPath;
+    }
+
+    if (!plantedFirst)
+        LOG_ERROR("Fuzzy benchmark: %s did not rank first for \"%s\"", kPlantedPath, kPlantedQuery);
+    LOG_INFO("Fuzzy benchmark: %s (%d keystrokes, %.2f ms average, worst %.2f ms, %d narrowed, %d threads)",
+             plantedFirst ? "passed" : "FAILED", keystrokes, keystrokes ? totalUs / keystrokes / 1e3 : 0.0,
+             worstUs / 1e3, narrowed, stats.threads);
+    return plantedFirst ? 0 : 1;
+}
+
+// -----------------------------------------------------------------------------
+// Private methods
+// -----------------------------------------------------------------------------
+
+std::vector<std::string> FuzzyBenchmark::Generate(int count) {
+    static const char* const kDirs[] = { "src", "include", "lib", "core", "util", "render", "net", "tests",
+                                         "docs", "assets", "build", "third_party", "imgui", "backends",
+                                         "platform", "windows", "linux", "models", "shaders", "textures" };
+    static const char* const kStems[] = { "main", "file", "list", "manager", "sidebar", "tree", "entry",
+                                          "store", "sorter", "filter", "watcher", "scanner", "display",
+                                          "strings", "config", "window", "render", "buffer", "cache",
+                                          "index", "thread", "pool", "parser", "lexer", "token" };
+    static const char* const kExtensions[] = { ".cpp", ".hpp", ".c", ".h", ".txt", ".md", ".png", ".json",
+                                               ".py", ".obj" };
+    std::mt19937 rng(42);
+    std::vector<std::string> paths;
+    paths.reserve((std::size_t)count + 1);
+    for (int k = 0; k < count; ++k) {
+        std::string path;
+        int depth = 1 + (int)(rng() % 5);
+        for (int d = 0; d < depth; ++d) {
+            path += kDirs[rng() % 20];
+            if (rng() % 3 == 0)
+                path += std::to_string(rng() % 100);
+            path += '/';
+        }
+        path += kStems[rng() % 25];
+        // 一半的名字是驼峰式的两个词
+        if (rng() % 2) {
+            path += (char)('A' + rng() % 26);
+            path += kStems[rng() % 25];
+        }
+        path += std::to_string(k % 1000);
+        path += kExtensions[rng() % 10];
+        paths.push_back(std::move(path));
+    }
+    paths.insert(paths.begin() + count / 2, kPlantedPath);
+    return paths;
+}
@@ -0,0 +1,627 @@
+// FuzzyFinder.cpp
+// Fuzzy "go to file" search implementation for FileMgr
+//
+// Key features:
+// - Breadth-first walk on its own thread, paths streamed in batches
+// - fzf-style scoring: word-start, camelCase and run bonuses, gap penalties
+// - Parallel scoring over the candidate buffer, cancelled by newer queries
+// - Extended queries re-score only the previous matches
+//
+
+#include "../include/FuzzyFinder.hpp"
+#include "../include/Common.hpp"
+#include "../include/DirEnumerator.hpp"
+#include "../include/EntrySorter.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <deque>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr std::size_t kParallelThreshold = 16384;  // 小于该规模时单线程更快
+    constexpr std::size_t kWalkBatchSize = 4096;        // 每批交给排名线程的路径数
+    constexpr auto kWalkFlushInterval = std::chrono::milliseconds(50);
+    constexpr std::size_t kMaxCandidates = 4000000;     // 候选路径上限
+    constexpr int kMaxDepth = 64;                       // 防止符号链接环无限下探
+    constexpr std::size_t kCancelCheck = 4096;          // 每打分多少条检查一次取消
+
+    // 打分常量（与 fzf v1 相同）
+    constexpr int kScoreMatch = 16;
+    constexpr int kScoreGapStart = -3;
+    constexpr int kScoreGapExtension = -1;
+    constexpr int kBonusBoundary = kScoreMatch / 2;
+    constexpr int kBonusNonWord = kScoreMatch / 2;
+    constexpr int kBonusCamel = kBonusBoundary + kScoreGapExtension;
+    constexpr int kBonusConsecutive = -(kScoreGapStart + kScoreGapExtension);
+    constexpr int kBonusBoundaryWhite = kBonusBoundary + 2;
+    constexpr int kBonusBoundaryDelimiter = kBonusBoundary + 1;
+    constexpr int kBonusFirstCharMultiplier = 2;
+    constexpr int kBonusFileName = kScoreMatch;          // 整个匹配落在文件名内
+
+    enum CharClass { kWhite, kNonWord, kDelimiter, kLower, kUpper, kNumber, kClassCount };
+
+    // 只折叠 ASCII；UTF-8 多字节字符原样比较
+    inline char FoldCase(char c) {
+        return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+    }
+
+    CharClass ClassifyByte(unsigned char c) {
+        if (c >= 'a' && c <= 'z')
+            return kLower;
+        if (c >= 'A' && c <= 'Z')
+            return kUpper;
+        if (c >= '0' && c <= '9')
+            return kNumber;
+        switch (c) {
+        case ' ':
+        case '\t':
+            return kWhite;
+        case '/':
+        case '\\':
+            return kDelimiter;
+        case '_':
+        case '-':
+        case '.':
+        case ',':
+        case ';':
+        case ':':
+        case '(':
+        case ')':
+        case '[':
+        case ']':
+        case '+':
+            return kNonWord;
+        default:
+            return kLower;   // 非 ASCII 字节按字母处理
+        }
+    }
+
+    int BonusFor(CharClass prev, CharClass cur) {
+        if (cur >= kLower) {
+            if (prev == kWhite)
+                return kBonusBoundaryWhite;
+            if (prev == kDelimiter)
+                return kBonusBoundaryDelimiter;
+            if (prev == kNonWord)
+                return kBonusBoundary;
+        }
+        if ((prev == kLower && cur == kUpper) || (prev != kNumber && cur == kNumber))
+            return kBonusCamel;
+        if (cur == kNonWord || cur == kDelimiter)
+            return kBonusNonWord;
+        if (cur == kWhite)
+            return kBonusBoundaryWhite;
+        return 0;
+    }
+
+    // 打分循环里查表，避免逐字节分支
+    struct ScoreTables {
+        std::uint8_t classOf[256];
+        std::uint8_t bonus[kClassCount][kClassCount];
+
+        ScoreTables() {
+            for (int c = 0; c < 256; ++c)
+                classOf[c] = (std::uint8_t)ClassifyByte((unsigned char)c);
+            for (int p = 0; p < kClassCount; ++p)
+                for (int c = 0; c < kClassCount; ++c)
+                    bonus[p][c] = (std::uint8_t)BonusFor((CharClass)p, (CharClass)c);
+        }
+    };
+    const ScoreTables g_tables;
+
+    inline int ClassOf(char c) {
+        return g_tables.classOf[(unsigned char)c];
+    }
+
+    // 字符集位图：a-z、0-9 各占一位，其余字节散列到剩下的位
+    // 路径缺少查询中的任一字符时无需逐字节扫描
+    inline std::uint64_t CharBit(char c) {
+        unsigned char u = (unsigned char)FoldCase(c);
+        if (u >= 'a' && u <= 'z')
+            return 1ULL << (u - 'a');
+        if (u >= '0' && u <= '9')
+            return 1ULL << (26 + u - '0');
+        return 1ULL << (36 + u % 28);
+    }
+
+    std::uint64_t CharMask(const char* text, std::size_t size) {
+        std::uint64_t mask = 0;
+        for (std::size_t i = 0; i < size; ++i)
+            mask |= CharBit(text[i]);
+        return mask;
+    }
+
+    // 旧查询是新查询的子序列时，新查询的匹配必然是旧查询匹配的子集
+    bool IsSubsequence(const std::string& small, const std::string& large) {
+        std::size_t i = 0;
+        for (char c : large) {
+            if (i < small.size() && small[i] == c)
+                ++i;
+        }
+        return i == small.size();
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Construction / Destruction
+// -----------------------------------------------------------------------------
+
+FuzzyFinder::FuzzyFinder()
+    : m_stop(false), m_hasRoot(false), m_walkGeneration(0), m_rankedWalk(0), m_queryGeneration(0),
+      m_rankedQuery(0), m_cancel(false), m_walking(false), m_walkEnded(false), m_busy(false),
+      m_resultGeneration(0), m_hasResult(false), m_threads(EntrySorter::DefaultThreadCount()) {
+    m_walker = std::thread(&FuzzyFinder::WalkLoop, this);
+    m_ranker = std::thread(&FuzzyFinder::RankLoop, this);
+}
+
+FuzzyFinder::~FuzzyFinder() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        ++m_walkGeneration;
+        m_cancel = true;
+    }
+    m_walkCv.notify_all();
+    m_rankCv.notify_all();
+    m_walker.join();
+    m_ranker.join();
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+void FuzzyFinder::SetRoot(const fs::path& root) {
+    m_root = root;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_walkGeneration; // 正在进行的遍历尽快放弃
+        m_walkRoot = root;
+        m_hasRoot = true;
+        m_walking = true;
+        m_incoming.clear();
+        m_hasResult = false;
+        m_stats.candidates = 0;
+        m_stats.directories = 0;
+        m_stats.walkTime = std::chrono::microseconds(0);
+        m_cancel = true;
+    }
+    m_walkCv.notify_one();
+    m_rankCv.notify_one();
+}
+
+void FuzzyFinder::SetQuery(const std::string& query) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (query == m_query)
+            return;
+        m_query = query;
+        ++m_queryGeneration;
+        m_cancel = true;
+    }
+    m_rankCv.notify_one();
+}
+
+bool FuzzyFinder::Poll(Result& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_hasResult)
+        return false;
+    out = std::move(m_result);
+    m_hasResult = false;
+    return true;
+}
+
+FuzzyFinder::Stats FuzzyFinder::GetLastStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void FuzzyFinder::AddCandidates(std::vector<std::string> paths) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.candidates += paths.size();
+        if (m_incoming.empty())
+            m_incoming = std::move(paths);
+        else
+            m_incoming.insert(m_incoming.end(), std::make_move_iterator(paths.begin()),
+                              std::make_move_iterator(paths.end()));
+    }
+    m_rankCv.notify_one();
+}
+
+void FuzzyFinder::WaitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCv.wait(lock, [this] {
+        return m_stop || (!m_busy && m_incoming.empty() && !m_walkEnded && m_rankedQuery == m_queryGeneration &&
+                          m_rankedWalk == m_walkGeneration.load());
+    });
+}
+
+int FuzzyFinder::Score(const std::string& query, const char* path, std::size_t size, std::size_t nameStart) {
+    const std::size_t qn = query.size();
+    if (qn == 0 || qn > size)
+        return -1;
+
+    // 正向找到包含整个查询的最短前缀，再反向收紧起点，得到最紧凑的匹配窗口
+    std::size_t qi = 0, end = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (FoldCase(path[i]) == query[qi] && ++qi == qn) {
+            end = i + 1;
+            break;
+        }
+    }
+    if (qi < qn)
+        return -1;
+    std::size_t start = end;
+    qi = qn;
+    while (qi > 0) {
+        --start;
+        if (FoldCase(path[start]) == query[qi - 1])
+            --qi;
+    }
+
+    int score = 0;
+    int consecutive = 0;
+    int firstBonus = 0;
+    bool inGap = false;
+    int prev = start > 0 ? ClassOf(path[start - 1]) : kDelimiter;
+    qi = 0;
+    for (std::size_t i = start; i < end; ++i) {
+        char c = path[i];
+        int cls = ClassOf(c);
+        if (qi < qn && FoldCase(c) == query[qi]) {
+            score += kScoreMatch;
+            int bonus = g_tables.bonus[prev][cls];
+            if (consecutive == 0) {
+                firstBonus = bonus;
+            } else {
+                // 连续段沿用段首的加分（段内遇到更强的边界时更新）
+                if (bonus >= kBonusBoundary && bonus > firstBonus)
+                    firstBonus = bonus;
+                bonus = std::max(std::max(bonus, firstBonus), kBonusConsecutive);
+            }
+            score += qi == 0 ? bonus * kBonusFirstCharMultiplier : bonus;
+            inGap = false;
+            ++consecutive;
+            ++qi;
+        } else {
+            score += inGap ? kScoreGapExtension : kScoreGapStart;
+            inGap = true;
+            consecutive = 0;
+            firstBonus = 0;
+        }
+        prev = cls;
+    }
+    if (start >= nameStart)
+        score += kBonusFileName;
+    return score;
+}
+
+// -----------------------------------------------------------------------------
+// Walker thread
+// -----------------------------------------------------------------------------
+
+void FuzzyFinder::WalkLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_walkCv.wait(lock, [this] { return m_stop || m_hasRoot; });
+        if (m_stop)
+            return;
+        fs::path root = m_walkRoot;
+        std::uint64_t generation = m_walkGeneration.load();
+        m_hasRoot = false;
+        lock.unlock();
+
+        Walk(root, generation);
+
+        lock.lock();
+    }
+}
+
+void FuzzyFinder::Walk(const fs::path& root, std::uint64_t generation) {
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<DirEnumerator> enumerator = DirEnumerator::Create(EnumBackend::Auto);
+    const char separator = (char)fs::path::preferred_separator;
+
+    struct Pending {
+        fs::path dir;
+        std::string prefix;     // 相对路径前缀（UTF-8，以分隔符结尾）
+        int depth;
+    };
+    std::deque<Pending> queue;
+    queue.push_back({root, std::string(), 0});
+
+    std::vector<std::string> batch;
+    std::size_t found = 0, directories = 0;
+    auto lastFlush = start;
+    bool cancelled = false;
+
+    // 把当前批次交给排名线程；返回 false 表示已换了根目录
+    auto flush = [&]() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_walkGeneration.load() != generation)
+            return false;
+        m_stats.candidates += batch.size();
+        m_stats.directories = directories;
+        m_stats.walkTime = ElapsedSince(start);
+        if (m_incoming.empty())
+            m_incoming = std::move(batch);
+        else
+            m_incoming.insert(m_incoming.end(), std::make_move_iterator(batch.begin()),
+                              std::make_move_iterator(batch.end()));
+        batch.clear();
+        lastFlush = std::chrono::steady_clock::now();
+        m_rankCv.notify_one();
+        return true;
+    };
+
+    while (!queue.empty() && !cancelled && found < kMaxCandidates) {
+        Pending current = std::move(queue.front());
+        queue.pop_front();
+        ++directories;
+
+        std::error_code ec;
+        enumerator->Enumerate(current.dir, [&](std::vector<ScanEntry>& chunk) {
+            if (m_walkGeneration.load(std::memory_order_relaxed) != generation) {
+                cancelled = true;
+                return false;
+            }
+            for (auto& se : chunk) {
+                std::string relative = current.prefix + fs::path(se.name).u8string();
+                if (se.isDirectory) {
+                    if (current.depth < kMaxDepth) {
+                        relative += separator;
+                        queue.push_back({current.dir / se.name, std::move(relative), current.depth + 1});
+                    }
+                } else if (found < kMaxCandidates) {
+                    batch.push_back(std::move(relative));
+                    ++found;
+                }
+            }
+            return true;
+        }, ec);
+        // 无权限等错误只跳过该目录，不记日志（大目录树里会很多）
+
+        if (batch.size() >= kWalkBatchSize || std::chrono::steady_clock::now() - lastFlush >= kWalkFlushInterval) {
+            if (!flush())
+                cancelled = true;
+        }
+    }
+    if (!cancelled && !flush())
+        cancelled = true;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_walkGeneration.load() == generation) {
+            m_walking = false;
+            m_walkEnded = true;
+            m_stats.walkTime = ElapsedSince(start);
+        }
+    }
+    m_rankCv.notify_one();
+
+    auto elapsed = ElapsedSince(start);
+    LOG_INFO("Finder walk of %s: %llu files in %llu folders, %.2f ms%s", root.string().c_str(),
+             (unsigned long long)found, (unsigned long long)directories, elapsed.count() / 1000.0,
+             cancelled ? " (cancelled)" : "");
+}
+
+// -----------------------------------------------------------------------------
+// Ranking thread
+// -----------------------------------------------------------------------------
+
+void FuzzyFinder::RankLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_rankCv.wait(lock, [this] {
+            return m_stop || !m_incoming.empty() || m_walkEnded || m_rankedQuery != m_queryGeneration ||
+                   m_rankedWalk != m_walkGeneration.load();
+        });
+        if (m_stop)
+            return;
+
+        // 换了根目录：丢弃全部候选
+        std::uint64_t walkGeneration = m_walkGeneration.load();
+        bool reset = m_rankedWalk != walkGeneration;
+        m_rankedWalk = walkGeneration;
+        std::vector<std::string> incoming = std::move(m_incoming);
+        m_incoming.clear();
+        std::string query = m_query;
+        std::uint64_t queryGeneration = m_queryGeneration;
+        bool queryChanged = queryGeneration != m_rankedQuery;
+        bool walking = m_walking;
+        m_walkEnded = false;
+        m_cancel = false;
+        m_busy = true;
+        lock.unlock();
+
+        if (reset) {
+            m_text.clear();
+            m_offsets.clear();
+            m_nameStarts.clear();
+            m_masks.clear();
+            m_hits.clear();
+            m_ranked.clear();
+        }
+        std::size_t first = Count();
+        AppendCandidates(incoming);
+        incoming.clear();
+        incoming.shrink_to_fit();
+
+        std::string lowered(query);
+        for (char& c : lowered)
+            c = FoldCase(c);
+
+        const auto start = std::chrono::steady_clock::now();
+        bool done = true;
+        bool narrowed = false;
+        std::size_t scored = 0;
+        if (queryChanged || reset) {
+            std::vector<Hit> hits;
+            if (!lowered.empty()) {
+                // 查询只是变长（旧查询是新查询的子序列）：只复查上次的匹配，新到的路径另行打分
+                narrowed = !m_ranked.empty() && IsSubsequence(m_ranked, lowered);
+                if (narrowed) {
+                    scored = m_hits.size() + (Count() - first);
+                    done = ScoreHits(lowered, hits) && ScoreRange(first, lowered, hits);
+                } else {
+                    scored = Count();
+                    done = ScoreRange(0, lowered, hits);
+                }
+            }
+            if (done) {
+                m_hits = std::move(hits);
+                m_ranked = lowered;
+            }
+        } else if (!m_ranked.empty()) {
+            scored = Count() - first;
+            done = ScoreRange(first, m_ranked, m_hits);
+        }
+        if (!done) {
+            // 被更新的查询打断：新到的路径没有打过分，下次整体重算
+            m_hits.clear();
+            m_ranked.clear();
+        }
+        auto elapsed = ElapsedSince(start);
+
+        if (done)
+            Publish(walkGeneration, query, walking);
+
+        lock.lock();
+        if (done) {
+            m_rankedQuery = queryGeneration;
+            if (queryChanged) {
+                m_stats.scored = scored;
+                m_stats.narrowed = narrowed;
+                m_stats.threads = scored >= kParallelThreshold ? m_threads : 1;
+                m_stats.queryTime = elapsed;
+            }
+        }
+        m_stats.memoryBytes = m_text.capacity() + m_offsets.capacity() * sizeof(std::uint32_t) +
+                              m_nameStarts.capacity() * sizeof(std::uint16_t) +
+                              m_masks.capacity() * sizeof(std::uint64_t) + m_hits.capacity() * sizeof(Hit);
+        m_busy = false;
+        m_idleCv.notify_all();
+    }
+}
+
+void FuzzyFinder::AppendCandidates(const std::vector<std::string>& paths) {
+    if (paths.empty())
+        return;
+    const char separator = (char)fs::path::preferred_separator;
+    if (m_offsets.empty())
+        m_offsets.push_back(0);
+
+    std::size_t bytes = 0;
+    for (const std::string& p : paths)
+        bytes += p.size() + 1;
+    m_text.reserve(m_text.size() + bytes);
+    m_offsets.reserve(m_offsets.size() + paths.size());
+    m_nameStarts.reserve(m_nameStarts.size() + paths.size());
+    m_masks.reserve(m_masks.size() + paths.size());
+
+    for (const std::string& p : paths) {
+        // 偏移量为 32 位：缓冲区装满后不再接收
+        if (p.size() > 0xFFFF || m_text.size() + p.size() + 1 > 0xFFFFFFFFu)
+            continue;
+        std::size_t slash = p.find_last_of(separator);
+        m_text.insert(m_text.end(), p.begin(), p.end());
+        m_text.push_back('\0');
+        m_offsets.push_back((std::uint32_t)m_text.size());
+        m_nameStarts.push_back((std::uint16_t)(slash == std::string::npos ? 0 : slash + 1));
+        m_masks.push_back(CharMask(p.data(), p.size()));
+    }
+}
+
+bool FuzzyFinder::ScoreRange(std::size_t first, const std::string& query, std::vector<Hit>& out) {
+    std::size_t count = Count();
+    if (first >= count)
+        return true;
+    std::size_t n = count - first;
+    int threads = n >= kParallelThreshold ? m_threads : 1;
+    const std::uint64_t queryMask = CharMask(query.data(), query.size());
+
+    // 每个线程写自己的结果表，最后按顺序拼接，匹配项保持下标递增
+    std::vector<std::vector<Hit>> parts(threads);
+    EntrySorter::ParallelFor(threads, n, [&](int t, std::size_t b, std::size_t e) {
+        std::vector<Hit>& part = parts[t];
+        for (std::size_t k = b; k < e; ++k) {
+            if ((k - b) % kCancelCheck == 0 && m_cancel.load(std::memory_order_relaxed))
+                return;
+            std::size_t i = first + k;
+            if ((m_masks[i] & queryMask) != queryMask)
+                continue;
+            std::size_t begin = m_offsets[i];
+            int score = Score(query, m_text.data() + begin, m_offsets[i + 1] - 1 - begin, m_nameStarts[i]);
+            if (score >= 0)
+                part.push_back({(std::uint32_t)i, score});
+        }
+    });
+    if (m_cancel.load())
+        return false;
+    for (auto& part : parts)
+        out.insert(out.end(), part.begin(), part.end());
+    return true;
+}
+
+bool FuzzyFinder::ScoreHits(const std::string& query, std::vector<Hit>& out) {
+    std::size_t n = m_hits.size();
+    int threads = n >= kParallelThreshold ? m_threads : 1;
+    const std::uint64_t queryMask = CharMask(query.data(), query.size());
+
+    std::vector<std::vector<Hit>> parts(threads);
+    EntrySorter::ParallelFor(threads, n, [&](int t, std::size_t b, std::size_t e) {
+        std::vector<Hit>& part = parts[t];
+        for (std::size_t k = b; k < e; ++k) {
+            if ((k - b) % kCancelCheck == 0 && m_cancel.load(std::memory_order_relaxed))
+                return;
+            std::uint32_t i = m_hits[k].index;
+            if ((m_masks[i] & queryMask) != queryMask)
+                continue;
+            std::size_t begin = m_offsets[i];
+            int score = Score(query, m_text.data() + begin, m_offsets[i + 1] - 1 - begin, m_nameStarts[i]);
+            if (score >= 0)
+                part.push_back({i, score});
+        }
+    });
+    if (m_cancel.load())
+        return false;
+    out.reserve(n);
+    for (auto& part : parts)
+        out.insert(out.end(), part.begin(), part.end());
+    return true;
+}
+
+void FuzzyFinder::Publish(std::uint64_t walkGeneration, const std::string& query, bool walking) {
+    // 分数高者在前；同分时路径短者在前
+    auto better = [this](const Hit& a, const Hit& b) {
+        if (a.score != b.score)
+            return a.score > b.score;
+        std::uint32_t la = m_offsets[a.index + 1] - m_offsets[a.index];
+        std::uint32_t lb = m_offsets[b.index + 1] - m_offsets[b.index];
+        if (la != lb)
+            return la < lb;
+        return a.index < b.index;
+    };
+    std::vector<Hit> top(std::min(kMaxResults, m_hits.size()));
+    std::partial_sort_copy(m_hits.begin(), m_hits.end(), top.begin(), top.end(), better);
+
+    Result result;
+    result.query = query;
+    result.matchCount = m_hits.size();
+    result.candidates = Count();
+    result.walking = walking;
+    result.matches.reserve(top.size());
+    for (const Hit& hit : top) {
+        std::size_t begin = m_offsets[hit.index];
+        result.matches.push_back({std::string(m_text.data() + begin, m_offsets[hit.index + 1] - 1 - begin), hit.score});
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (walkGeneration != m_walkGeneration.load())
+        return;
+    result.generation = ++m_resultGeneration;
+    m_result = std::move(result);
+    m_hasResult = true;
+}
@@ -0,0 +1,174 @@
+// IndexPanel.cpp
+// "Name Index" window implementation for FileMgr
+//
+// Key features:
+// - Build the index for the current drive or folder, or load the saved one
+// - Query on every keystroke with match count and latency
+// - Preview of the first matches; double-click opens an entry
+// - Matches shown in the file list as a virtual listing
+//
+
+#include "../include/IndexPanel.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace fs = std::filesystem;
+
+void IndexPanel::LoadSaved() {
+    std::error_code ec;
+    fs::path file = NameIndex::GetDefaultPath();
+    if (fs::exists(file, ec))
+        m_index.StartLoad(file);
+}
+
+void IndexPanel::SaveIfChanged() {
+    m_index.SaveIfChanged(NameIndex::GetDefaultPath());
+}
+
+void IndexPanel::Open(const fs::path& current) {
+    m_current = current;
+    m_open = true;
+    m_focusQuery = true;
+}
+
+void IndexPanel::Draw() {
+    if (!m_open)
+        return;
+
+    ImGui::SetNextWindowSize(ImVec2(720, 460), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Name Index", &m_open)) {
+        ImGui::End();
+        return;
+    }
+
+    // 索引换新或实时更新之后，当前查询重新执行（根目录只在换新时取一次）
+    NameIndex::Stats stats = m_index.GetStats();
+    if (stats.generation != m_seenGeneration) {
+        m_seenGeneration = stats.generation;
+        m_root = m_index.GetRoot();
+        m_rootLabel = m_root.u8string();
+        m_seenUpdates = ~stats.updates;
+    }
+    if (stats.updates != m_seenUpdates) {
+        m_seenUpdates = stats.updates;
+        if (m_query[0] != '\0')
+            RunQuery();
+    }
+
+    if (stats.building && m_buildLabel.empty()) {
+        ImGui::Text("Loading the saved index...");
+    } else if (stats.building) {
+        ImGui::Text("Indexing %s... %d entries (%.1f s)", m_buildLabel.c_str(), (int)stats.walked,
+                    stats.buildTime.count() / 1e6);
+    } else if (stats.ready) {
+        ImGui::Text("%s: %d files, %d folders", m_rootLabel.c_str(), (int)stats.files, (int)stats.folders);
+    } else {
+        ImGui::TextDisabled("No index yet. Index a drive or folder to search it by name.");
+    }
+    if (stats.ready) {
+        std::size_t records = std::max<std::size_t>(1, stats.files + stats.folders);
+        ImGui::TextDisabled("%.1f MB (%.1f bytes per entry), %s in %.2f s  |  Live updates: %s, %llu applied%s",
+                            stats.memoryBytes / 1e6, (double)stats.memoryBytes / records,
+                            stats.loaded ? "loaded" : "built", stats.buildTime.count() / 1e6, stats.liveBackend,
+                            (unsigned long long)stats.updates, stats.stale ? "  (may be out of date)" : "");
+    }
+
+    ImGui::BeginDisabled(stats.building || m_current.empty());
+    if (ImGui::Button(stats.ready ? "Rebuild for this drive" : "Index this drive"))
+        StartBuild(m_current.root_path());
+    ImGui::SameLine();
+    if (ImGui::Button("Index this folder"))
+        StartBuild(m_current);
+    ImGui::EndDisabled();
+
+    if (m_focusQuery) {
+        ImGui::SetKeyboardFocusHere();
+        m_focusQuery = false;
+    }
+    ImGui::SetNextItemWidth(-260.0f);
+    bool edited = ImGui::InputTextWithHint("##query", "File name (* and ? for wildcards)", m_query, sizeof(m_query));
+    bool submit = ImGui::IsItemDeactivated() && ImGui::IsKeyPressed(ImGuiKey_Enter);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(110.0f);
+    if (ImGui::Combo("##mode", &m_mode, "Contains\0Starts with\0"))
+        edited = true;
+    ImGui::SameLine();
+    ImGui::BeginDisabled(m_query[0] == '\0' || m_index.GetLastQueryStats().matches == 0);
+    if (ImGui::Button("Show in file list") || submit)
+        ShowInList();
+    ImGui::EndDisabled();
+    if (edited)
+        RunQuery();
+
+    const NameIndex::QueryStats& query = m_index.GetLastQueryStats();
+    if (m_query[0] != '\0' && stats.ready)
+        ImGui::TextDisabled("%d matches in %.2f ms%s", (int)query.matches, query.time.count() / 1000.0,
+                            query.narrowed ? " (narrowed)" : "");
+
+    // 只提交可见行
+    ImGui::BeginChild("##preview", ImVec2(0, 0), ImGuiChildFlags_Borders);
+    ImGuiListClipper clipper;
+    clipper.Begin((int)m_preview.size());
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            ImGui::PushID(row);
+            if (ImGui::Selectable(m_preview[row].c_str(), m_selected == row, ImGuiSelectableFlags_AllowDoubleClick)) {
+                m_selected = row;
+                if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left) && m_onOpen)
+                    m_onOpen(m_root / fs::u8path(m_preview[row]));
+            }
+            ImGui::PopID();
+        }
+    }
+    if (query.matches > m_preview.size())
+        ImGui::TextDisabled("... %d more", (int)(query.matches - m_preview.size()));
+    ImGui::EndChild();
+    ImGui::End();
+}
+
+void IndexPanel::DrawStats() {
+    NameIndex::Stats stats = m_index.GetStats();
+    ImGui::SeparatorText("Name index");
+    if (!stats.ready && !stats.building) {
+        ImGui::TextDisabled("Not built");
+        return;
+    }
+    ImGui::Text("Entries: %d  Memory: %.1f MB (%.1f bytes per entry)", (int)(stats.files + stats.folders),
+                stats.memoryBytes / (1024.0 * 1024.0),
+                (double)stats.memoryBytes / std::max<std::size_t>(1, stats.files + stats.folders));
+    ImGui::Text("%s: %.2f s, %d threads%s", stats.loaded ? "Load" : "Build", stats.buildTime.count() / 1e6,
+                stats.threads, stats.building ? " (running)" : "");
+    ImGui::Text("Live updates: %s, %llu applied%s", stats.liveBackend, (unsigned long long)stats.updates,
+                stats.stale ? " (stale)" : "");
+    const NameIndex::QueryStats& query = m_index.GetLastQueryStats();
+    ImGui::Text("Last query: %.2f ms, %d matches (%s)", query.time.count() / 1000.0, (int)query.matches,
+                query.narrowed ? "narrowed" : "full");
+}
+
+void IndexPanel::RunQuery() {
+    const std::vector<NameIndex::Id>& ids =
+        m_index.Query(m_query, m_mode == 1 ? FilterMode::Prefix : FilterMode::Substring);
+    // 预览只取前几百条路径；路径在按键时拼好，绘制时不再分配
+    m_preview.clear();
+    std::size_t count = std::min(ids.size(), kMaxPreview);
+    for (std::size_t k = 0; k < count; ++k)
+        m_preview.push_back(m_index.GetRelativePath(ids[k]));
+    m_selected = -1;
+}
+
+void IndexPanel::ShowInList() {
+    if (!m_onShow)
+        return;
+    const std::vector<NameIndex::Id>& ids = m_index.GetMatches();
+    EntryStore entries;
+    m_index.FillEntries(ids, kMaxShown, entries);
+    char label[512];
+    std::snprintf(label, sizeof(label), "Name index: \"%s\" in %s (%d of %d)", m_query, m_rootLabel.c_str(),
+                  (int)entries.Size(), (int)ids.size());
+    m_onShow(m_root, label, std::move(entries));
+}
+
+void IndexPanel::StartBuild(const fs::path& root) {
+    m_buildLabel = root.u8string();
+    m_index.StartBuild(root, NameIndex::GetDefaultPath());
+}
@@ -0,0 +1,288 @@
+// ListBenchmark.cpp
+// File list benchmark implementation for FileMgr
+//
+// Key features:
+// - Deterministic synthetic listing (folders, numbered photos, build output)
+// - Heap bytes per entry of the full-path, ScanEntry and EntryStore layouts
+// - Headless FileList frames (no window, no renderer): us and allocations per frame
+// - Filter box typed one character at a time: keystroke to updated rows
+//
+
+#include "../include/ListBenchmark.hpp"
+#include "../include/AllocCounter.hpp"
+#include "../include/Common.hpp"
+#include "../include/EntryStore.hpp"
+#include "../include/FileList.hpp"
+#include "../include/log.hpp"
+#include <imgui.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // 旧版 FileList 每个条目的布局：完整路径 + 元数据
+    struct PathEntry {
+        fs::path path;
+        bool isDirectory;
+        std::uintmax_t size;
+        fs::file_time_type lastWriteTime;
+    };
+
+    // 旧布局里每个条目都重复的父目录
+#ifdef _WIN32
+    const wchar_t* const kParent = L"C:\\Users\\Public\\Documents\\Projects\\build\\output";
+#else
+    const char* const kParent = "/home/user/projects/build/output";
+#endif
+
+    constexpr int kWarmupFrames = 10;                   // 计时前先画的帧数（行文本、图标标记等就绪）
+    constexpr double kMaxFrameRatio = 2.0;              // 大列表每帧耗时最多为 1 万条的两倍
+    constexpr auto kFrameBudget = std::chrono::microseconds(16667); // 60 Hz 的一帧
+
+    // 逐字输入的过滤文本；含 * 或 ? 的按通配符匹配
+    struct TypedFilter {
+        const char* text;
+        FilterMode mode;
+    };
+    const TypedFilter kTypedFilters[] = {
+        { "report-12", FilterMode::Substring },
+        { "build_output_00", FilterMode::Prefix },
+        { "img_*.jpg", FilterMode::Substring },
+        { "quarterly summary 9", FilterMode::Substring },
+        { "*_test.?pp", FilterMode::Substring },
+    };
+
+    // 本线程自 start 以来向 operator new 申请的字节数
+    std::uint64_t BytesSince(const AllocCounter::Totals& start) {
+        return AllocCounter::GetThreadTotals().bytes - start.bytes;
+    }
+
+    // 无窗口的 ImGui 上下文；与主程序相同，ImGui 的分配也计入 AllocCounter
+    ImGuiContext* CreateHeadlessContext() {
+        IMGUI_CHECKVERSION();
+        ImGui::SetAllocatorFunctions(AllocCounter::ImGuiAlloc, AllocCounter::ImGuiFree);
+        ImGuiContext* context = ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        io.DisplaySize = ImVec2(1280.0f, 720.0f);
+        io.IniFilename = nullptr;
+        // 没有渲染后端：字体图集由 ImGui 自己维护，不上传
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures;
+        return context;
+    }
+
+    // 一帧：列表铺满窗口，只构建绘制数据，不渲染
+    void DrawFrame(FileList& list) {
+        ImGuiIO& io = ImGui::GetIO();
+        io.DeltaTime = 1.0f / 60.0f;
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(io.DisplaySize);
+        ImGui::Begin("File list", nullptr, ImGuiWindowFlags_NoDecoration);
+        list.Draw();
+        ImGui::End();
+        ImGui::Render();
+    }
+
+    // 画到列表格式化、排序完成为止
+    void DrawUntilSorted(FileList& list) {
+        for (int k = 0; k < kWarmupFrames || list.IsSorting(); ++k) {
+            DrawFrame(list);
+            if (list.IsSorting())
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+int ListBenchmark::RunMemory(const Options& options) {
+    EntryStore source;
+    Generate(source, options.entries);
+    const std::size_t count = source.Size();
+    const double perEntry = count ? 1.0 / count : 0.0;
+    LOG_INFO("Memory benchmark: %d entries, %.1f name characters per entry", (int)count,
+             source.GetNameChars() * perEntry);
+
+    // 旧布局：每个条目一个完整路径
+    std::uint64_t pathBytes;
+    {
+        AllocCounter::Totals start = AllocCounter::GetThreadTotals();
+        std::vector<PathEntry> entries;
+        entries.reserve(count);
+        fs::path parent(kParent);
+        for (EntryStore::Index i = 0; i < count; ++i) {
+            entries.push_back({ parent / fs::path::string_type(source.GetName(i)), source.IsDirectory(i),
+                                source.GetSize(i), fs::file_time_type() });
+        }
+        pathBytes = BytesSince(start);
+    }
+
+    // 扫描器的传输格式：每个条目一个名字字符串
+    std::uint64_t scanBytes;
+    {
+        AllocCounter::Totals start = AllocCounter::GetThreadTotals();
+        std::vector<ScanEntry> entries;
+        entries.reserve(count);
+        for (EntryStore::Index i = 0; i < count; ++i) {
+            entries.push_back({ fs::path::string_type(source.GetName(i)), source.IsDirectory(i), false,
+                                source.GetSize(i), source.GetWriteTime(i) });
+        }
+        scanBytes = BytesSince(start);
+    }
+
+    // 列式存储：名字放在一个字符区里
+    std::uint64_t storeBytes;
+    std::size_t storeMemory;
+    {
+        AllocCounter::Totals start = AllocCounter::GetThreadTotals();
+        EntryStore store;
+        store.Reserve(count, source.GetNameChars());
+        for (EntryStore::Index i = 0; i < count; ++i)
+            store.Add(source.GetName(i), source.IsDirectory(i), source.GetSize(i), source.GetWriteTime(i));
+        storeBytes = BytesSince(start);
+        storeMemory = store.GetMemoryBytes();
+    }
+
+    LOG_INFO("Full-path FileEntry (before): %.1f bytes per entry", pathBytes * perEntry);
+    LOG_INFO("vector<ScanEntry>:            %.1f bytes per entry", scanBytes * perEntry);
+    LOG_INFO("EntryStore (after):           %.1f bytes per entry (%.1f of them name characters, "
+             "GetMemoryBytes %.1f)",
+             storeBytes * perEntry, source.GetNameChars() * sizeof(EntryStore::Char) * perEntry,
+             storeMemory * perEntry);
+    LOG_INFO("EntryStore uses %.1fx less memory than full-path entries",
+             storeBytes ? (double)pathBytes / storeBytes : 0.0);
+    return storeBytes < pathBytes ? 0 : 1;
+}
+
+int ListBenchmark::RunFrames(const Options& options) {
+    ImGuiContext* context = CreateHeadlessContext();
+    const int counts[] = { 10, 10000, options.entries };
+    double tenThousandUs = 0, largestUs = 0;
+    for (int count : counts) {
+        EntryStore store;
+        Generate(store, count);
+        FileList list(nullptr);
+        list.ShowVirtualListing(fs::path(kParent), "Frame benchmark", std::move(store));
+
+        // 第一帧为所有行生成显示文本；大列表在后台排序，等它完成
+        auto start = std::chrono::steady_clock::now();
+        DrawFrame(list);
+        double firstMs = ElapsedSince(start).count() / 1e3;
+        DrawUntilSorted(list);
+
+        double totalUs = 0, worstUs = 0;
+        AllocCounter::Totals allocStart = AllocCounter::GetThreadTotals();
+        for (int k = 0; k < options.frames; ++k) {
+            auto frameStart = std::chrono::steady_clock::now();
+            DrawFrame(list);
+            double us = (double)ElapsedSince(frameStart).count();
+            totalUs += us;
+            worstUs = std::max(worstUs, us);
+        }
+        double perFrame = options.frames > 0 ? totalUs / options.frames : 0.0;
+        std::uint64_t allocations = AllocCounter::GetThreadTotals().count - allocStart.count;
+        LOG_INFO("%8d entries: %.1f us per frame (worst %.1f us), %.2f allocations per frame, first frame %.1f ms",
+                 count, perFrame, worstUs, options.frames > 0 ? (double)allocations / options.frames : 0.0, firstMs);
+        if (count == 10000)
+            tenThousandUs = perFrame;
+        largestUs = perFrame;
+    }
+    ImGui::DestroyContext(context);
+
+    bool ok = largestUs <= tenThousandUs * kMaxFrameRatio;
+    LOG_INFO("Frame benchmark: %s (%d entries cost %.2fx the frame time of 10000)", ok ? "passed" : "FAILED",
+             options.entries, tenThousandUs > 0 ? largestUs / tenThousandUs : 0.0);
+    return ok ? 0 : 1;
+}
+
+int ListBenchmark::RunFilter(const Options& options) {
+    ImGuiContext* context = CreateHeadlessContext();
+    EntryStore store;
+    Generate(store, options.entries);
+    FileList list(nullptr);
+    list.ShowVirtualListing(fs::path(kParent), "Filter benchmark", std::move(store));
+    DrawUntilSorted(list);
+
+    // 获得焦点：建小写名字缓冲区（不算在按键里）
+    auto start = std::chrono::steady_clock::now();
+    list.SetFilter("", FilterMode::Substring);
+    LOG_INFO("Filter benchmark: %d entries, name buffer built in %.2f ms on focus", (int)list.GetEntryCount(),
+             ElapsedSince(start).count() / 1e3);
+
+    // 逐字输入再逐字删除；每次按键后画一帧显示结果
+    int keystrokes = 0, overBudget = 0;
+    double totalUs = 0, worstUs = 0;
+    std::string worstText;
+    auto press = [&](const std::string& text, FilterMode mode) {
+        list.SetFilter(text, mode);
+        double us = (double)list.GetFilterTime().count();
+        DrawFrame(list);
+        ++keystrokes;
+        totalUs += us;
+        if (us > worstUs) {
+            worstUs = us;
+            worstText = text;
+        }
+        if (us > kFrameBudget.count())
+            ++overBudget;
+        return us;
+    };
+    for (const TypedFilter& typed : kTypedFilters) {
+        std::string text(typed.text);
+        double typeUs = 0, eraseUs = 0;
+        for (std::size_t n = 1; n <= text.size(); ++n)
+            typeUs = std::max(typeUs, press(text.substr(0, n), typed.mode));
+        std::size_t matches = list.GetDisplayedCount();
+        for (std::size_t n = text.size(); n-- > 0;)
+            eraseUs = std::max(eraseUs, press(text.substr(0, n), typed.mode));
+        FilterMode mode = EntryFilter::DetectMode(text, typed.mode);
+        const char* kind = mode == FilterMode::Glob ? "glob" : mode == FilterMode::Prefix ? "prefix" : "substring";
+        LOG_INFO("%-22s %-9s %7d rows: worst keystroke %.2f ms typing, %.2f ms erasing", typed.text, kind,
+                 (int)matches, typeUs / 1e3, eraseUs / 1e3);
+    }
+    ImGui::DestroyContext(context);
+
+    bool ok = overBudget == 0;
+    LOG_INFO("Filter benchmark: %s (%d keystrokes, %.2f ms average, worst %.2f ms for \"%s\", %d over %.1f ms)",
+             ok ? "passed" : "FAILED", keystrokes, keystrokes ? totalUs / keystrokes / 1e3 : 0.0, worstUs / 1e3,
+             worstText.c_str(), overBudget, kFrameBudget.count() / 1e3);
+    return ok ? 0 : 1;
+}
+
+// -----------------------------------------------------------------------------
+// Private methods
+// -----------------------------------------------------------------------------
+
+void ListBenchmark::Generate(EntryStore& store, int entries) {
+    static const char* const kExtensions[] = { ".cpp", ".hpp", ".obj", ".txt", ".jpg", ".log", ".json", ".dat" };
+    static const char* const kStems[] = { "IMG_%08u", "report-%u-final", "build_output_%07u", "frame%06u",
+                                          "Quarterly Summary %u", "module_%u_test" };
+    store.Clear();
+    store.Reserve((std::size_t)entries, (std::size_t)entries * 20);
+    std::uint32_t state = 12345;
+    auto now = std::chrono::system_clock::now();
+    for (int k = 0; k < entries; ++k) {
+        state = state * 1664525u + 1013904223u;
+        char name[96];
+        bool isDirectory = k % 10 == 0;
+        int n;
+        if (isDirectory)
+            n = std::snprintf(name, sizeof(name), "folder_%06d", k / 10);
+        else
+            n = std::snprintf(name, sizeof(name), kStems[state % 6], (unsigned)k);
+        if (!isDirectory)
+            n += std::snprintf(name + n, sizeof(name) - n, "%s", kExtensions[(state >> 8) % 8]);
+        EntryStore::Char wide[96];
+        for (int c = 0; c <= n; ++c)
+            wide[c] = (EntryStore::Char)name[c];
+        store.Add(EntryStore::NameView(wide, (std::size_t)n), isDirectory,
+                  isDirectory ? 0 : (state >> 4) % (64u << 20), now - std::chrono::seconds(state % (86400 * 365)));
+    }
+}
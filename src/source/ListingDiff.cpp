@@ -0,0 +1,52 @@
+// ListingDiff.cpp
+// Listing comparison implementation for FileMgr
+//
+// Key features:
+// - Linear merge-join over the two sorted default orders
+// - Index mappings in both directions for carrying derived data over
+//
+
+#include "../include/ListingDiff.hpp"
+
+namespace {
+    // 与 EntryStore::Less 相同的顺序，但比较的是两个不同存储中的条目
+    int CompareEntries(const EntryStore& a, EntryStore::Index i, const EntryStore& b, EntryStore::Index j) {
+        bool dirA = a.IsDirectory(i), dirB = b.IsDirectory(j);
+        if (dirA != dirB)
+            return dirA ? -1 : 1;
+        return a.GetName(i).compare(b.GetName(j));
+    }
+}
+
+ListingDiff ListingDiff::Compute(const EntryStore& before, const EntryStore& after) {
+    ListingDiff diff;
+    diff.previous.assign(after.Size(), EntryStore::kNoIndex);
+    diff.reuse.assign(after.Size(), EntryStore::kNoIndex);
+    diff.current.assign(before.Size(), EntryStore::kNoIndex);
+
+    const std::vector<Index>& oldOrder = before.GetOrder();
+    const std::vector<Index>& newOrder = after.GetOrder();
+    std::size_t i = 0, j = 0;
+    while (i < oldOrder.size() || j < newOrder.size()) {
+        int c = i == oldOrder.size() ? 1 : j == newOrder.size() ? -1
+              : CompareEntries(before, oldOrder[i], after, newOrder[j]);
+        if (c < 0) {
+            ++diff.removed;
+            ++i;
+        } else if (c > 0) {
+            ++diff.added;
+            diff.changed.push_back(newOrder[j++]);
+        } else {
+            Index o = oldOrder[i++], n = newOrder[j++];
+            diff.previous[n] = o;
+            if (before.GetSize(o) == after.GetSize(n) && before.GetWriteTime(o) == after.GetWriteTime(n)) {
+                diff.reuse[n] = o;
+                diff.current[o] = n;
+            } else {
+                ++diff.modified;
+                diff.changed.push_back(n);
+            }
+        }
+    }
+    return diff;
+}
@@ -0,0 +1,439 @@
+// ListingStore.cpp
+// Persistent listing cache implementation for FileMgr
+//
+// The file is mapped read-only and never parsed up front: lookups binary
+// search the sorted directory table in place and only the requested
+// directory is turned into a heap snapshot. Every offset read from the file
+// is bounds-checked, so a truncated or corrupted cache is simply ignored.
+//
+// Key features:
+// - Versioned header (magic, version, character width)
+// - Memory-mapped reads (MapViewOfFile / mmap)
+// - Atomic save via temporary file + rename
+//
+
+#include "../include/ListingStore.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <unordered_set>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    using CharT = fs::path::value_type;
+    using StringView = std::basic_string_view<CharT>;
+
+    constexpr char kMagic[8] = { 'F', 'M', 'L', 'I', 'S', 'T', 0, 0 };
+    constexpr std::uint32_t kVersion = 1;
+    constexpr std::size_t kMaxDirs = 4096;                  // 最多保存的目录数
+    constexpr std::size_t kMaxFileBytes = 64 * 1024 * 1024; // 文件大小上限
+
+    constexpr std::uint32_t kFlagDirectory = 1;
+
+    struct FileHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t charSize;            // sizeof(path::value_type) of the writer
+        std::uint64_t fileSize;
+        std::uint32_t dirCount;
+        std::uint32_t expandedCount;
+        std::uint64_t dirTableOffset;
+        std::uint64_t expandedOffset;
+        std::uint64_t lastLocationOffset;
+        std::uint32_t lastLocationLength;
+        std::uint32_t reserved;
+    };
+
+    struct DirRecord {
+        std::uint64_t pathOffset;
+        std::uint32_t pathLength;
+        std::uint32_t entryCount;
+        std::uint64_t entriesOffset;
+        std::int64_t dirWriteTime;         // ns since Unix epoch
+    };
+
+    struct EntryRecord {
+        std::uint64_t nameOffset;
+        std::uint32_t nameLength;
+        std::uint32_t flags;
+        std::uint64_t size;
+        std::int64_t writeTime;            // ns since Unix epoch
+    };
+
+    struct PathRecord {
+        std::uint64_t offset;
+        std::uint32_t length;
+        std::uint32_t reserved;
+    };
+
+    std::int64_t ToNanos(std::chrono::system_clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    }
+
+    std::chrono::system_clock::time_point FromNanos(std::int64_t ns) {
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+    }
+
+    // 从映射内存中安全读取一个定长记录（越界返回 false）
+    template <typename T>
+    bool ReadRecord(const unsigned char* data, std::size_t size, std::uint64_t offset, T& out) {
+        if (offset > size || size - offset < sizeof(T))
+            return false;
+        std::memcpy(&out, data + offset, sizeof(T));
+        return true;
+    }
+
+    // 在映射内存上取字符串视图（越界或未对齐返回 false）
+    bool ViewString(const unsigned char* data, std::size_t size, std::uint64_t offset,
+                    std::uint32_t length, StringView& out) {
+        std::uint64_t bytes = (std::uint64_t)length * sizeof(CharT);
+        if (offset > size || size - offset < bytes || offset % sizeof(CharT))
+            return false;
+        out = StringView(reinterpret_cast<const CharT*>(data + offset), length);
+        return true;
+    }
+
+    // 写文件时的字符池
+    class PoolWriter {
+    public:
+        // 返回字符在池中的下标
+        std::uint64_t Add(StringView s) {
+            std::uint64_t index = m_chars.size();
+            m_chars.insert(m_chars.end(), s.begin(), s.end());
+            return index;
+        }
+        const std::vector<CharT>& GetChars() const { return m_chars; }
+    private:
+        std::vector<CharT> m_chars;
+    };
+}
+
+ListingStore::ListingStore()
+    : m_data(nullptr), m_size(0), m_fileHandle(nullptr), m_mapHandle(nullptr) {}
+
+ListingStore::~ListingStore() {
+    Close();
+}
+
+fs::path ListingStore::GetDefaultPath() {
+#ifdef _WIN32
+    const wchar_t* base = _wgetenv(L"LOCALAPPDATA");
+    fs::path dir = base ? fs::path(base) : fs::temp_directory_path();
+#else
+    const char* xdg = std::getenv("XDG_CACHE_HOME");
+    const char* home = std::getenv("HOME");
+    fs::path dir = xdg ? fs::path(xdg) : home ? fs::path(home) / ".cache" : fs::temp_directory_path();
+#endif
+    return dir / "FileMgr" / "listing.cache";
+}
+
+bool ListingStore::Open(const fs::path& file) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE h = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                           nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(h, &size) || size.QuadPart < (LONGLONG)sizeof(FileHeader)) {
+        CloseHandle(h);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingW(h, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(h);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(h);
+        return false;
+    }
+    m_fileHandle = h;
+    m_mapHandle = mapping;
+    m_data = static_cast<const unsigned char*>(view);
+    m_size = (std::size_t)size.QuadPart;
+#else
+    int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(FileHeader)) {
+        ::close(fd);
+        return false;
+    }
+    void* view = ::mmap(nullptr, (std::size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    m_fileHandle = reinterpret_cast<void*>((intptr_t)fd);
+    m_data = static_cast<const unsigned char*>(view);
+    m_size = (std::size_t)st.st_size;
+#endif
+
+    // 校验文件头：魔数、版本、字符宽度、记录的文件大小
+    FileHeader header;
+    ReadRecord(m_data, m_size, 0, header);
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.charSize != sizeof(CharT) || header.fileSize != m_size) {
+        LOG_INFO("Ignoring listing cache %s: incompatible format", file.string().c_str());
+        Close();
+        return false;
+    }
+    LOG_INFO("Mapped listing cache %s: %u directories", file.string().c_str(), header.dirCount);
+    return true;
+}
+
+void ListingStore::Close() {
+    if (!m_data)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(static_cast<HANDLE>(m_mapHandle));
+    CloseHandle(static_cast<HANDLE>(m_fileHandle));
+#else
+    ::munmap(const_cast<unsigned char*>(m_data), m_size);
+    ::close((int)reinterpret_cast<intptr_t>(m_fileHandle));
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_fileHandle = nullptr;
+    m_mapHandle = nullptr;
+}
+
+std::size_t ListingStore::GetDirCount() const {
+    FileHeader header;
+    if (!m_data || !ReadRecord(m_data, m_size, 0, header))
+        return 0;
+    return header.dirCount;
+}
+
+bool ListingStore::ReadString(std::uint64_t offset, std::uint32_t length,
+                              fs::path::string_type& out) const {
+    std::uint64_t bytes = (std::uint64_t)length * sizeof(CharT);
+    if (offset > m_size || m_size - offset < bytes)
+        return false;
+    out.resize(length);
+    std::memcpy(out.data(), m_data + offset, bytes);
+    return true;
+}
+
+std::shared_ptr<DirSnapshot> ListingStore::LoadDir(std::size_t index) const {
+    FileHeader header;
+    DirRecord dir;
+    ReadRecord(m_data, m_size, 0, header);
+    if (!ReadRecord(m_data, m_size, header.dirTableOffset + index * sizeof(DirRecord), dir))
+        return nullptr;
+    // 条目表必须完整位于文件内，防止损坏的计数导致巨量分配
+    if (dir.entriesOffset > m_size ||
+        (m_size - dir.entriesOffset) / sizeof(EntryRecord) < dir.entryCount)
+        return nullptr;
+
+    auto snapshot = std::make_shared<DirSnapshot>();
+    fs::path::string_type dirPath;
+    if (!ReadString(dir.pathOffset, dir.pathLength, dirPath))
+        return nullptr;
+    snapshot->dir = fs::path(std::move(dirPath));
+    snapshot->dirWriteTime = FromNanos(dir.dirWriteTime);
+    snapshot->entries.Reserve(dir.entryCount, 0);
+
+    // 条目按显示顺序保存，名字直接从映射内存拷入快照的名字池
+    for (std::uint32_t i = 0; i < dir.entryCount; ++i) {
+        EntryRecord rec;
+        StringView name;
+        if (!ReadRecord(m_data, m_size, dir.entriesOffset + (std::uint64_t)i * sizeof(EntryRecord), rec) ||
+            !ViewString(m_data, m_size, rec.nameOffset, rec.nameLength, name))
+            return nullptr;
+        snapshot->entries.Add(name, (rec.flags & kFlagDirectory) != 0, rec.size, FromNanos(rec.writeTime));
+    }
+    return snapshot;
+}
+
+std::shared_ptr<DirSnapshot> ListingStore::Find(const fs::path& dir) const {
+    FileHeader header;
+    if (!m_data || !ReadRecord(m_data, m_size, 0, header))
+        return nullptr;
+
+    // 目录表按规范化路径排序，直接在映射内存上二分查找，不产生分配
+    fs::path::string_type key = SnapshotCache::MakeKey(dir);
+    std::size_t lo = 0, hi = header.dirCount;
+    while (lo < hi) {
+        std::size_t mid = lo + (hi - lo) / 2;
+        DirRecord rec;
+        if (!ReadRecord(m_data, m_size, header.dirTableOffset + mid * sizeof(DirRecord), rec))
+            return nullptr;
+        StringView stored;
+        if (!ViewString(m_data, m_size, rec.pathOffset, rec.pathLength, stored))
+            return nullptr;
+        int cmp = stored.compare(key);
+        if (cmp == 0)
+            return LoadDir(mid);
+        if (cmp < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return nullptr;
+}
+
+std::optional<fs::path> ListingStore::GetLastLocation() const {
+    FileHeader header;
+    if (!m_data || !ReadRecord(m_data, m_size, 0, header) || header.lastLocationLength == 0)
+        return std::nullopt;
+    fs::path::string_type location;
+    if (!ReadString(header.lastLocationOffset, header.lastLocationLength, location))
+        return std::nullopt;
+    return fs::path(std::move(location));
+}
+
+std::vector<fs::path> ListingStore::GetExpandedPaths() const {
+    std::vector<fs::path> paths;
+    FileHeader header;
+    if (!m_data || !ReadRecord(m_data, m_size, 0, header))
+        return paths;
+    for (std::uint32_t i = 0; i < header.expandedCount; ++i) {
+        PathRecord rec;
+        fs::path::string_type s;
+        if (!ReadRecord(m_data, m_size, header.expandedOffset + (std::uint64_t)i * sizeof(PathRecord), rec) ||
+            !ReadString(rec.offset, rec.length, s))
+            break;
+        paths.emplace_back(std::move(s));
+    }
+    return paths;
+}
+
+bool ListingStore::Save(const fs::path& file,
+                        const std::vector<std::shared_ptr<const DirSnapshot>>& snapshots,
+                        const std::vector<fs::path>& expanded,
+                        const fs::path& lastLocation) {
+    // 收集要保存的快照：先是内存中的，再补上旧文件里未被覆盖的目录
+    std::vector<std::shared_ptr<const DirSnapshot>> dirs;
+    std::unordered_set<fs::path::string_type> seen;
+    std::size_t totalBytes = sizeof(FileHeader);
+    auto addDir = [&](std::shared_ptr<const DirSnapshot> snapshot) {
+        if (!snapshot || dirs.size() >= kMaxDirs)
+            return;
+        const EntryStore& entries = snapshot->entries;
+        std::size_t bytes = sizeof(DirRecord) + snapshot->dir.native().size() * sizeof(CharT) +
+                            entries.Size() * sizeof(EntryRecord) + entries.GetNameChars() * sizeof(CharT);
+        if (totalBytes + bytes > kMaxFileBytes)
+            return;
+        if (!seen.insert(SnapshotCache::MakeKey(snapshot->dir)).second)
+            return;
+        totalBytes += bytes;
+        dirs.push_back(std::move(snapshot));
+    };
+    for (const auto& snapshot : snapshots)
+        addDir(snapshot);
+    for (std::size_t i = 0, n = GetDirCount(); i < n && dirs.size() < kMaxDirs; ++i)
+        addDir(LoadDir(i));
+
+    std::sort(dirs.begin(), dirs.end(), [](const auto& a, const auto& b) {
+        return SnapshotCache::MakeKey(a->dir) < SnapshotCache::MakeKey(b->dir);
+    });
+
+    // 计算各段偏移
+    std::size_t entryCount = 0;
+    for (const auto& d : dirs)
+        entryCount += d->entries.Size();
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.charSize = sizeof(CharT);
+    header.dirCount = (std::uint32_t)dirs.size();
+    header.expandedCount = (std::uint32_t)expanded.size();
+    header.dirTableOffset = sizeof(FileHeader);
+    std::uint64_t entriesOffset = header.dirTableOffset + dirs.size() * sizeof(DirRecord);
+    header.expandedOffset = entriesOffset + entryCount * sizeof(EntryRecord);
+    std::uint64_t poolOffset = header.expandedOffset + expanded.size() * sizeof(PathRecord);
+    auto poolAddr = [&](std::uint64_t index) { return poolOffset + index * sizeof(CharT); };
+
+    PoolWriter pool;
+    std::vector<DirRecord> dirRecords;
+    std::vector<EntryRecord> entryRecords;
+    std::vector<PathRecord> pathRecords;
+    dirRecords.reserve(dirs.size());
+    entryRecords.reserve(entryCount);
+
+    for (const auto& d : dirs) {
+        fs::path::string_type key = SnapshotCache::MakeKey(d->dir);
+        DirRecord rec{};
+        rec.pathOffset = poolAddr(pool.Add(key));
+        rec.pathLength = (std::uint32_t)key.size();
+        rec.entryCount = (std::uint32_t)d->entries.Size();
+        rec.entriesOffset = entriesOffset + entryRecords.size() * sizeof(EntryRecord);
+        rec.dirWriteTime = ToNanos(d->dirWriteTime);
+        dirRecords.push_back(rec);
+        const EntryStore& entries = d->entries;
+        for (EntryStore::Index i : entries.GetOrder()) {
+            StringView name = entries.GetName(i);
+            EntryRecord er{};
+            er.nameOffset = poolAddr(pool.Add(name));
+            er.nameLength = (std::uint32_t)name.size();
+            er.flags = entries.IsDirectory(i) ? kFlagDirectory : 0;
+            er.size = entries.GetSize(i);
+            er.writeTime = ToNanos(entries.GetWriteTime(i));
+            entryRecords.push_back(er);
+        }
+    }
+    for (const auto& p : expanded) {
+        PathRecord rec{};
+        rec.offset = poolAddr(pool.Add(p.native()));
+        rec.length = (std::uint32_t)p.native().size();
+        pathRecords.push_back(rec);
+    }
+    header.lastLocationOffset = poolAddr(pool.Add(lastLocation.native()));
+    header.lastLocationLength = (std::uint32_t)lastLocation.native().size();
+    header.fileSize = poolOffset + pool.GetChars().size() * sizeof(CharT);
+
+    // Windows 上无法替换仍被映射的文件，先解除映射
+    Close();
+
+    std::error_code ec;
+    fs::create_directories(file.parent_path(), ec);
+    fs::path tmp = file;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            LOG_ERROR("Cannot write listing cache %s", tmp.string().c_str());
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(dirRecords.data()), dirRecords.size() * sizeof(DirRecord));
+        out.write(reinterpret_cast<const char*>(entryRecords.data()), entryRecords.size() * sizeof(EntryRecord));
+        out.write(reinterpret_cast<const char*>(pathRecords.data()), pathRecords.size() * sizeof(PathRecord));
+        out.write(reinterpret_cast<const char*>(pool.GetChars().data()), pool.GetChars().size() * sizeof(CharT));
+        if (!out) {
+            LOG_ERROR("Failed writing listing cache %s", tmp.string().c_str());
+            return false;
+        }
+    }
+    fs::rename(tmp, file, ec);
+    if (ec) {
+        LOG_ERROR("Cannot replace listing cache %s: %s", file.string().c_str(), ec.message().c_str());
+        fs::remove(tmp, ec);
+        return false;
+    }
+    LOG_INFO("Saved listing cache %s: %u directories, %llu bytes", file.string().c_str(),
+             header.dirCount, (unsigned long long)header.fileSize);
+    return true;
+}
@@ -0,0 +1,142 @@
+// ManifestPanel.cpp
+// "Verify Manifest" window implementation for FileMgr
+//
+// Key features:
+// - Starts as soon as a manifest is opened; Stop / Verify again
+// - Byte progress bar, read throughput and result counts while running
+// - Mismatched, missing and unreadable files listed as they are found
+// - Virtualized problem table (ImGuiListClipper); double-click shows the folder
+//
+
+#include "../include/ManifestPanel.hpp"
+#include "../include/DisplayStrings.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char* ResultText(ManifestVerifier::Result result) {
+        switch (result) {
+            case ManifestVerifier::Result::Ok:       return "OK";
+            case ManifestVerifier::Result::Mismatch: return "Mismatch";
+            case ManifestVerifier::Result::Missing:  return "Missing";
+            default:                                 return "Unreadable";
+        }
+    }
+}
+
+void ManifestPanel::Open(const fs::path& manifest) {
+    m_manifest = manifest;
+    m_manifestLabel = manifest.u8string();
+    m_open = true;
+    StartVerify();
+}
+
+void ManifestPanel::Draw() {
+    if (!m_open)
+        return;
+
+    ImGui::SetNextWindowSize(ImVec2(680, 420), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Verify Manifest", &m_open)) {
+        ImGui::End();
+        return;
+    }
+
+    m_verifier.Poll(m_problems);
+    ManifestVerifier::Stats stats = m_verifier.GetStats();
+
+    ImGui::SetNextItemWidth(60.0f);
+    if (ImGui::InputInt("Files at once", &m_threads, 0))
+        m_threads = std::max(1, std::min(m_threads, 16));
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Files read at the same time; 1 is fastest on a spinning disk");
+    ImGui::SameLine();
+    if (stats.running) {
+        if (ImGui::Button("Stop"))
+            m_verifier.Cancel();
+    } else {
+        ImGui::BeginDisabled(m_manifest.empty());
+        if (ImGui::Button("Verify again"))
+            StartVerify();
+        ImGui::EndDisabled();
+    }
+
+    ImGui::TextDisabled("%s (%s)", m_manifestLabel.c_str(), ManifestVerifier::AlgorithmName(stats.algorithm));
+    if (stats.loading) {
+        ImGui::TextDisabled("Reading the manifest... %d files listed", (int)stats.files);
+    } else {
+        char bytes[32], total[32], overlay[64];
+        DisplayStrings::FormatSize(stats.bytes, bytes, sizeof(bytes));
+        DisplayStrings::FormatSize(stats.totalBytes, total, sizeof(total));
+        std::snprintf(overlay, sizeof(overlay), "%s of %s", bytes, total);
+        float fraction = stats.totalBytes ? (float)((double)stats.bytes / stats.totalBytes)
+                                          : stats.files ? (float)stats.checked / stats.files : 0.0f;
+        ImGui::ProgressBar(fraction, ImVec2(-1.0f, 0.0f), overlay);
+
+        double seconds = stats.time.count() / 1e6;
+        ImGui::TextDisabled("%d of %d files, %.0f MB/s, %.1f s%s", (int)stats.checked, (int)stats.files,
+                            seconds > 0 ? stats.bytes / 1e6 / seconds : 0.0, seconds,
+                            stats.running ? "  (verifying...)" : stats.cancelled ? "  (stopped)" : "");
+        ImGui::Text("%d OK, %d mismatched, %d missing, %d unreadable", (int)stats.ok, (int)stats.mismatched,
+                    (int)stats.missing, (int)stats.failed);
+        if (stats.malformed > 0) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(%d lines skipped: not a checksum entry)", (int)stats.malformed);
+        }
+    }
+
+    DrawProblems();
+    ImGui::End();
+}
+
+// -----------------------------------------------------------------------------
+// Private methods
+// -----------------------------------------------------------------------------
+
+void ManifestPanel::StartVerify() {
+    m_problems.clear();
+    m_selected = -1;
+    ManifestVerifier::Options options;
+    options.threads = m_threads;
+    m_verifier.Start(m_manifest, options);
+}
+
+void ManifestPanel::DrawProblems() {
+    if (!ImGui::BeginTable("##problems", 3,
+                           ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_Resizable |
+                               ImGuiTableFlags_ScrollY))
+        return;
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("File", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Result", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+    ImGui::TableSetupColumn("Actual checksum / error", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableHeadersRow();
+
+    ImGuiListClipper clipper;
+    clipper.Begin((int)m_problems.size());
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            const ManifestVerifier::Problem& problem = m_problems[row];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::PushID(row);
+            if (ImGui::Selectable(problem.file.c_str(), m_selected == row,
+                                  ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowDoubleClick)) {
+                m_selected = row;
+                // 名字相对于清单所在的文件夹
+                if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left) && m_onNavigate) {
+                    fs::path name = fs::u8path(problem.file);
+                    fs::path file = name.is_absolute() ? name : m_verifier.GetManifest().parent_path() / name;
+                    m_onNavigate(file.parent_path());
+                }
+            }
+            ImGui::PopID();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(ResultText(problem.result));
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(problem.detail.c_str());
+        }
+    }
+    ImGui::EndTable();
+}
@@ -0,0 +1,525 @@
+// ManifestVerifier.cpp
+// Checksum manifest verification implementation for FileMgr
+//
+// Key features:
+// - GNU ("<hex>  name", "<hex> *name", escaped names) and BSD tagged lines
+// - SHA-256 or MD5 chosen by extension, tag or checksum length
+// - Sizes looked up first, so progress is measured in bytes
+// - 4 MB sequential reads with the next block in flight while hashing
+// - Mismatches, missing and unreadable files streamed as they are found
+//
+
+#include "../include/ManifestVerifier.hpp"
+#include "../include/Common.hpp"
+#include "../include/Md5.hpp"
+#include "../include/Sha256.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr std::size_t kMinReadSize = 64 << 10;      // 单次读取的下限
+    constexpr std::size_t kMaxReadSize = 64 << 20;      // 单次读取的上限
+
+    bool EndsWithNoCase(const std::string& text, const char* suffix) {
+        std::size_t length = std::strlen(suffix);
+        if (text.size() < length)
+            return false;
+        for (std::size_t k = 0; k < length; ++k) {
+            char c = text[text.size() - length + k];
+            if (c >= 'A' && c <= 'Z')
+                c = (char)(c - 'A' + 'a');
+            if (c != suffix[k])
+                return false;
+        }
+        return true;
+    }
+
+    // 按扩展名判断算法
+    ManifestVerifier::Algorithm AlgorithmForName(const std::string& name) {
+        if (EndsWithNoCase(name, ".sha256") || EndsWithNoCase(name, ".sha256sum"))
+            return ManifestVerifier::Algorithm::Sha256;
+        if (EndsWithNoCase(name, ".md5") || EndsWithNoCase(name, ".md5sum"))
+            return ManifestVerifier::Algorithm::Md5;
+        return ManifestVerifier::Algorithm::Unknown;
+    }
+
+    std::size_t DigestSize(ManifestVerifier::Algorithm algorithm) {
+        return algorithm == ManifestVerifier::Algorithm::Sha256 ? Sha256::kDigestSize : Md5::kDigestSize;
+    }
+
+    int HexValue(char c) {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    // 十六进制校验和；长度须为 32（MD5）或 64（SHA-256）
+    ManifestVerifier::Algorithm ParseHex(const std::string& hex, unsigned char* digest) {
+        if (hex.size() != 2 * Md5::kDigestSize && hex.size() != 2 * Sha256::kDigestSize)
+            return ManifestVerifier::Algorithm::Unknown;
+        for (std::size_t k = 0; k < hex.size(); k += 2) {
+            int high = HexValue(hex[k]), low = HexValue(hex[k + 1]);
+            if (high < 0 || low < 0)
+                return ManifestVerifier::Algorithm::Unknown;
+            digest[k / 2] = (unsigned char)(high << 4 | low);
+        }
+        return hex.size() == 2 * Sha256::kDigestSize ? ManifestVerifier::Algorithm::Sha256
+                                                     : ManifestVerifier::Algorithm::Md5;
+    }
+
+    // 还原 sha256sum 对含反斜杠或换行的名字所做的转义
+    std::string Unescape(const std::string& name) {
+        std::string out;
+        out.reserve(name.size());
+        for (std::size_t k = 0; k < name.size(); ++k) {
+            if (name[k] == '\\' && k + 1 < name.size()) {
+                char next = name[++k];
+                out += next == 'n' ? '\n' : next == 'r' ? '\r' : next;
+            } else {
+                out += name[k];
+            }
+        }
+        return out;
+    }
+
+    // 解析一行：GNU 格式 "<hex>  name" / "<hex> *name"，或 BSD 格式 "SHA256 (name) = <hex>"
+    // @return 校验和长度对应的算法，不是校验和行时为 Unknown
+    ManifestVerifier::Algorithm ParseLine(std::string line, std::string& name, unsigned char* digest) {
+        bool escaped = !line.empty() && line[0] == '\\';
+        if (escaped)
+            line.erase(0, 1);
+
+        for (const char* tag : { "SHA256 (", "MD5 (" }) {
+            std::size_t tagLength = std::strlen(tag);
+            if (line.compare(0, tagLength, tag) != 0)
+                continue;
+            std::size_t close = line.rfind(") = ");
+            if (close == std::string::npos || close < tagLength)
+                return ManifestVerifier::Algorithm::Unknown;
+            name = line.substr(tagLength, close - tagLength);
+            ManifestVerifier::Algorithm algorithm = ParseHex(line.substr(close + 4), digest);
+            bool tagMatches = (algorithm == ManifestVerifier::Algorithm::Sha256) == (tag[0] == 'S');
+            if (escaped)
+                name = Unescape(name);
+            return tagMatches ? algorithm : ManifestVerifier::Algorithm::Unknown;
+        }
+
+        std::size_t space = line.find(' ');
+        if (space == std::string::npos || space + 2 > line.size() || (line[space + 1] != ' ' && line[space + 1] != '*'))
+            return ManifestVerifier::Algorithm::Unknown;
+        name = line.substr(space + 2);
+        if (name.empty())
+            return ManifestVerifier::Algorithm::Unknown;
+        if (escaped)
+            name = Unescape(name);
+        return ParseHex(line.substr(0, space), digest);
+    }
+
+    // 顺序流式读取：当前块被哈希时下一块已经在读
+    // （Windows 用重叠 I/O 双缓冲，其他平台用预读提示）
+    class StreamReader {
+    public:
+        // @param buffers 至少 2 * blockSize 字节
+        StreamReader(const fs::path& path, std::vector<char>& buffers, std::size_t blockSize)
+            : m_buffers(buffers.data()), m_blockSize(blockSize) {
+#ifdef _WIN32
+            m_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                   nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (m_handle == INVALID_HANDLE_VALUE) {
+                m_error = (int)GetLastError();
+                return;
+            }
+            m_event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            if (!m_event) {
+                m_error = (int)GetLastError();
+                return;
+            }
+            Issue();
+#else
+            m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (m_fd < 0) {
+                m_error = errno;
+                return;
+            }
+#ifdef POSIX_FADV_SEQUENTIAL
+            ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+#endif
+        }
+
+        ~StreamReader() {
+#ifdef _WIN32
+            // 缓冲区属于调用方：关闭前等待未完成的读取
+            if (m_pending) {
+                DWORD read = 0;
+                CancelIo(m_handle);
+                GetOverlappedResult(m_handle, &m_overlapped, &read, TRUE);
+            }
+            if (m_event)
+                CloseHandle(m_event);
+            if (m_handle != INVALID_HANDLE_VALUE)
+                CloseHandle(m_handle);
+#else
+            if (m_fd >= 0)
+                ::close(m_fd);
+#endif
+        }
+
+        StreamReader(const StreamReader&) = delete;
+        StreamReader& operator=(const StreamReader&) = delete;
+
+        // 打开失败时的错误码（0 表示已打开）
+        int Error() const { return m_error; }
+
+        // 取下一块（数据在下一次调用前有效）
+        // @return 字节数，0 表示结尾，-1 表示出错（见 Error()）
+        std::int64_t Next(const char*& data) {
+#ifdef _WIN32
+            if (!m_pending)
+                return m_error == 0 ? 0 : -1;
+            DWORD read = 0;
+            BOOL ok = GetOverlappedResult(m_handle, &m_overlapped, &read, TRUE);
+            m_pending = false;
+            if (!ok) {
+                DWORD error = GetLastError();
+                if (error == ERROR_HANDLE_EOF)
+                    return 0;
+                m_error = (int)error;
+                return -1;
+            }
+            if (read == 0)
+                return 0;
+            data = m_buffers + m_slot * m_blockSize;
+            m_offset += read;
+            m_slot ^= 1;
+            Issue();
+            return read;
+#else
+            ssize_t read;
+            do {
+                read = ::read(m_fd, m_buffers, m_blockSize);
+            } while (read < 0 && errno == EINTR);
+            if (read < 0) {
+                m_error = errno;
+                return -1;
+            }
+            m_offset += (std::uint64_t)read;
+#ifdef POSIX_FADV_WILLNEED
+            // 哈希这一块的同时让内核读下一块
+            if (read > 0)
+                ::posix_fadvise(m_fd, (off_t)m_offset, (off_t)m_blockSize, POSIX_FADV_WILLNEED);
+#endif
+            data = m_buffers;
+            return read;
+#endif
+        }
+
+    private:
+#ifdef _WIN32
+        // 发出下一块的读取（读到 m_slot 指向的缓冲区）
+        void Issue() {
+            m_overlapped = {};
+            m_overlapped.Offset = (DWORD)m_offset;
+            m_overlapped.OffsetHigh = (DWORD)(m_offset >> 32);
+            m_overlapped.hEvent = m_event;
+            if (ReadFile(m_handle, m_buffers + m_slot * m_blockSize, (DWORD)m_blockSize, nullptr, &m_overlapped) ||
+                GetLastError() == ERROR_IO_PENDING) {
+                m_pending = true;
+            } else if (GetLastError() != ERROR_HANDLE_EOF) {
+                m_error = (int)GetLastError();
+            }
+        }
+
+        HANDLE m_handle = INVALID_HANDLE_VALUE;
+        HANDLE m_event = nullptr;
+        OVERLAPPED m_overlapped = {};
+        bool m_pending = false;
+        std::size_t m_slot = 0;                 // 正在读入的缓冲区
+#else
+        int m_fd = -1;
+#endif
+        char* m_buffers;
+        std::size_t m_blockSize;
+        std::uint64_t m_offset = 0;
+        int m_error = 0;
+    };
+}
+
+// -----------------------------------------------------------------------------
+// Construction / Destruction
+// -----------------------------------------------------------------------------
+
+ManifestVerifier::~ManifestVerifier() {
+    Cancel();
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+void ManifestVerifier::Start(const fs::path& manifest, const Options& options) {
+    Cancel();
+    m_manifest = manifest;
+    m_options = options;
+    m_options.threads = std::max(1, std::min(options.threads, 16));
+    m_options.readSize = std::max(kMinReadSize, std::min(options.readSize, kMaxReadSize));
+    m_items.clear();
+    m_algorithm = Algorithm::Unknown;
+    m_cancel = false;
+    m_nextItem = 0;
+    m_bytes = 0;
+    m_startTime = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_problems.clear();
+        m_problemCount = 0;
+        m_stats = Stats();
+        m_stats.loading = true;
+        m_stats.running = true;
+    }
+    m_thread = std::thread(&ManifestVerifier::Run, this);
+}
+
+void ManifestVerifier::Cancel() {
+    if (!m_thread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancel = true;
+        if (m_stats.running) {
+            m_stats.running = false;
+            m_stats.cancelled = true;
+            m_stats.bytes = m_bytes;
+            m_stats.time = ElapsedSince(m_startTime);
+        }
+    }
+    m_thread.join();
+}
+
+bool ManifestVerifier::Poll(std::vector<Problem>& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_problems.empty())
+        return false;
+    for (Problem& problem : m_problems)
+        out.push_back(std::move(problem));
+    m_problems.clear();
+    return true;
+}
+
+bool ManifestVerifier::IsRunning() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats.running;
+}
+
+ManifestVerifier::Stats ManifestVerifier::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    if (stats.running) {
+        stats.bytes = m_bytes;
+        stats.time = ElapsedSince(m_startTime);
+    }
+    return stats;
+}
+
+bool ManifestVerifier::IsManifestName(const char* name) {
+    return AlgorithmForName(name) != Algorithm::Unknown;
+}
+
+const char* ManifestVerifier::AlgorithmName(Algorithm algorithm) {
+    switch (algorithm) {
+        case Algorithm::Md5:    return "MD5";
+        case Algorithm::Sha256: return "SHA-256";
+        default:                return "unknown";
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Worker threads
+// -----------------------------------------------------------------------------
+
+void ManifestVerifier::Run() {
+    bool loaded = Load();
+    int threads = (int)std::min<std::size_t>((std::size_t)m_options.threads, std::max<std::size_t>(1, m_items.size()));
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.loading = false;
+        m_stats.threads = loaded ? threads : 0;
+    }
+
+    if (loaded && !m_cancel) {
+        // 本线程也作为一个工作线程
+        std::vector<std::thread> helpers;
+        for (int k = 1; k < threads; ++k)
+            helpers.emplace_back(&ManifestVerifier::WorkerLoop, this);
+        WorkerLoop();
+        for (std::thread& helper : helpers)
+            helper.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stats.running) {
+        m_stats.running = false;
+        m_stats.bytes = m_bytes;
+        m_stats.time = ElapsedSince(m_startTime);
+        double seconds = m_stats.time.count() / 1e6;
+        LOG_INFO("Verify %s (%s): %d of %d files ok, %d mismatched, %d missing, %d failed, %d malformed lines, "
+                 "%.1f MB in %.2f s (%.0f MB/s)",
+                 m_manifest.u8string().c_str(), AlgorithmName(m_stats.algorithm), (int)m_stats.ok,
+                 (int)m_stats.files, (int)m_stats.mismatched, (int)m_stats.missing, (int)m_stats.failed,
+                 (int)m_stats.malformed, m_stats.bytes / 1e6, seconds,
+                 seconds > 0 ? m_stats.bytes / 1e6 / seconds : 0.0);
+    }
+}
+
+bool ManifestVerifier::Load() {
+    std::ifstream in(m_manifest, std::ios::binary);
+    if (!in) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_problems.push_back({ m_manifest.filename().u8string(), Result::Failed, "Cannot open the manifest" });
+        ++m_problemCount;
+        LOG_ERROR("Verify %s: cannot open the manifest", m_manifest.u8string().c_str());
+        return false;
+    }
+
+    // 扩展名决定算法；否则取第一行有效校验和的长度（或 BSD 标签）
+    m_algorithm = AlgorithmForName(m_manifest.filename().u8string());
+    fs::path folder = m_manifest.parent_path();
+    std::size_t malformed = 0;
+    std::string line;
+    bool first = true;
+    while (std::getline(in, line)) {
+        if (first && line.compare(0, 3, "\xEF\xBB\xBF") == 0)
+            line.erase(0, 3);
+        first = false;
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        Item item;
+        Algorithm algorithm = ParseLine(line, item.name, item.expected);
+        if (algorithm != Algorithm::Unknown && m_algorithm == Algorithm::Unknown)
+            m_algorithm = algorithm;
+        if (algorithm == Algorithm::Unknown || algorithm != m_algorithm) {
+            ++malformed;
+            continue;
+        }
+        fs::path name = fs::u8path(item.name);
+        item.path = name.is_absolute() ? name : folder / name;
+        m_items.push_back(std::move(item));
+        if (m_cancel)
+            return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.algorithm = m_algorithm;
+        m_stats.files = m_items.size();
+        m_stats.malformed = malformed;
+    }
+
+    // 先取得所有文件的大小：进度按字节计算
+    std::uint64_t totalBytes = 0;
+    for (Item& item : m_items) {
+        if (m_cancel)
+            return false;
+        std::error_code ec;
+        std::uint64_t size = fs::file_size(item.path, ec);
+        if (ec) {
+            item.missing = !fs::exists(item.path, ec) && !ec;
+            continue;
+        }
+        item.size = size;
+        totalBytes += size;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.totalBytes = totalBytes;
+    return true;
+}
+
+void ManifestVerifier::WorkerLoop() {
+    // 两个读缓冲区：一个在哈希，一个在读
+    std::vector<char> buffers(2 * m_options.readSize);
+    while (!m_cancel) {
+        std::size_t index = m_nextItem++;
+        if (index >= m_items.size())
+            break;
+        const Item& item = m_items[index];
+        std::string detail;
+        Result result = item.missing ? Result::Missing : Check(item, buffers, detail);
+        if (m_cancel)
+            break;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.checked;
+        switch (result) {
+            case Result::Ok:       ++m_stats.ok; break;
+            case Result::Mismatch: ++m_stats.mismatched; break;
+            case Result::Missing:  ++m_stats.missing; break;
+            case Result::Failed:   ++m_stats.failed; break;
+        }
+        if (result != Result::Ok && m_problemCount < kMaxProblems) {
+            m_problems.push_back({ item.name, result, std::move(detail) });
+            ++m_problemCount;
+        }
+    }
+}
+
+ManifestVerifier::Result ManifestVerifier::Check(const Item& item, std::vector<char>& buffers, std::string& detail) {
+    StreamReader reader(item.path, buffers, m_options.readSize);
+    if (reader.Error() != 0) {
+        detail = ErrorText(reader.Error());
+        return Result::Failed;
+    }
+
+    Sha256 sha;
+    Md5 md5;
+    const char* data = nullptr;
+    for (;;) {
+        if (m_cancel) {
+            detail = "Stopped";
+            return Result::Failed;
+        }
+        std::int64_t read = reader.Next(data);
+        if (read < 0) {
+            detail = ErrorText(reader.Error());
+            return Result::Failed;
+        }
+        if (read == 0)
+            break;
+        if (m_algorithm == Algorithm::Sha256)
+            sha.Update(data, (std::size_t)read);
+        else
+            md5.Update(data, (std::size_t)read);
+        m_bytes += (std::uint64_t)read;
+    }
+
+    unsigned char digest[Sha256::kDigestSize];
+    if (m_algorithm == Algorithm::Sha256)
+        sha.Digest(digest);
+    else
+        md5.Digest(digest);
+    std::size_t size = DigestSize(m_algorithm);
+    if (std::memcmp(digest, item.expected, size) == 0)
+        return Result::Ok;
+    detail = ToHex(digest, size);
+    return Result::Mismatch;
+}
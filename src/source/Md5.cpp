@@ -0,0 +1,122 @@
+// Md5.cpp
+// MD5 implementation for FileMgr
+//
+// Key features:
+// - RFC 1321 compression function on 64-byte blocks
+// - Streaming updates of any size with a 64-byte carry buffer
+//
+
+#include "../include/Md5.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr std::uint32_t kSine[64] = {
+        0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+        0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+        0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+        0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+        0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+        0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+        0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+        0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+    };
+    constexpr int kShift[64] = {
+        7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+        5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+        4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+        6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21,
+    };
+
+    inline std::uint32_t RotateLeft(std::uint32_t x, int r) {
+        return (x << r) | (x >> (32 - r));
+    }
+
+    // 小端读取
+    inline std::uint32_t ReadLittle32(const unsigned char* p) {
+        return (std::uint32_t)p[0] | ((std::uint32_t)p[1] << 8) | ((std::uint32_t)p[2] << 16) |
+               ((std::uint32_t)p[3] << 24);
+    }
+}
+
+void Md5::Reset() {
+    m_state[0] = 0x67452301;
+    m_state[1] = 0xefcdab89;
+    m_state[2] = 0x98badcfe;
+    m_state[3] = 0x10325476;
+    m_total = 0;
+    m_buffered = 0;
+}
+
+void Md5::Update(const void* data, std::size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    m_total += size;
+
+    // 先补齐上次剩下的不完整块
+    if (m_buffered > 0) {
+        std::size_t take = std::min(size, sizeof(m_buffer) - m_buffered);
+        std::memcpy(m_buffer + m_buffered, p, take);
+        m_buffered += take;
+        p += take;
+        size -= take;
+        if (m_buffered < sizeof(m_buffer))
+            return;
+        Transform(m_buffer);
+        m_buffered = 0;
+    }
+    for (; size >= 64; p += 64, size -= 64)
+        Transform(p);
+    std::memcpy(m_buffer, p, size);
+    m_buffered = size;
+}
+
+void Md5::Digest(unsigned char* digest) const {
+    // 在副本上补位：0x80、零和 64 位小端位长
+    Md5 copy = *this;
+    std::uint64_t bits = m_total * 8;
+    unsigned char padding[72] = { 0x80 };
+    std::size_t padSize = (m_buffered < 56 ? 56 : 120) - m_buffered;
+    for (int k = 0; k < 8; ++k)
+        padding[padSize + k] = (unsigned char)(bits >> (8 * k));
+    copy.Update(padding, padSize + 8);
+    for (int k = 0; k < 4; ++k) {
+        digest[4 * k] = (unsigned char)copy.m_state[k];
+        digest[4 * k + 1] = (unsigned char)(copy.m_state[k] >> 8);
+        digest[4 * k + 2] = (unsigned char)(copy.m_state[k] >> 16);
+        digest[4 * k + 3] = (unsigned char)(copy.m_state[k] >> 24);
+    }
+}
+
+void Md5::Transform(const unsigned char* block) {
+    std::uint32_t m[16];
+    for (int k = 0; k < 16; ++k)
+        m[k] = ReadLittle32(block + 4 * k);
+
+    std::uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+    for (int k = 0; k < 64; ++k) {
+        std::uint32_t f;
+        int g;
+        if (k < 16) {
+            f = (b & c) | (~b & d);
+            g = k;
+        } else if (k < 32) {
+            f = (d & b) | (~d & c);
+            g = (5 * k + 1) & 15;
+        } else if (k < 48) {
+            f = b ^ c ^ d;
+            g = (3 * k + 5) & 15;
+        } else {
+            f = c ^ (b | ~d);
+            g = (7 * k) & 15;
+        }
+        std::uint32_t next = d;
+        d = c;
+        c = b;
+        b = b + RotateLeft(a + f + kSine[k] + m[g], kShift[k]);
+        a = next;
+    }
+    m_state[0] += a;
+    m_state[1] += b;
+    m_state[2] += c;
+    m_state[3] += d;
+}
@@ -0,0 +1,220 @@
+// NameBenchmark.cpp
+// File name index benchmark implementation for FileMgr
+//
+// Key features:
+// - Deterministic tree of empty files (the names repeat words, like real trees)
+// - Build time, bytes per file in memory and on disk, load time
+// - Substring, prefix, glob and narrowing query latency
+// - Query results checked against the generated names
+//
+
+#include "../include/NameBenchmark.hpp"
+#include "../include/Common.hpp"
+#include "../include/NameIndex.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr int kProjects = 100;                      // 顶层文件夹数
+    constexpr int kSubfolders = 100;                    // 每个顶层文件夹下的子文件夹数
+    constexpr int kFilesPerFolder = 500;
+    constexpr int kQueryRuns = 3;                       // 每个查询取 3 次中最快的一次
+
+    const char* const kWords[] = { "report", "image", "main", "config", "data", "index", "readme",
+                                   "test", "util", "photo", "draft", "backup", "notes", "invoice",
+                                   "module", "player", "video", "song", "sample", "build" };
+    const char* const kExtensions[] = { ".txt", ".jpg", ".cpp", ".h", ".json", ".md", ".png", ".mp3", ".pdf",
+                                        ".log" };
+
+    // 对照查询：生成的名字里有多少个含（或以之开头）这些文本
+    const char* const kCheckedSubstring = "backup_note";
+    const char* const kCheckedPrefix = "invoice_photo";
+
+    // 查询及其方式；含 * 或 ? 的按通配符匹配
+    struct NameQuery {
+        const char* pattern;
+        FilterMode mode;
+    };
+    const NameQuery kQueries[] = {
+        { "readme", FilterMode::Substring },
+        { "readme_backup", FilterMode::Substring },
+        { "readme_backup_4", FilterMode::Substring },
+        { "zzzq", FilterMode::Substring },
+        { "e", FilterMode::Substring },
+        { "inv", FilterMode::Prefix },
+        { "invoice_photo", FilterMode::Prefix },
+        { "*.pdf", FilterMode::Substring },
+        { "read*2?.md", FilterMode::Substring },
+    };
+    const char* const kTypedQuery = "readme_backup";
+
+    // 第 k 个文件的名字；state 依次推进，与生成时的顺序相同
+    void NextName(std::uint32_t& state, char* name, std::size_t size) {
+        state = state * 1103515245u + 12345u;
+        std::snprintf(name, size, "%s_%s_%u%s", kWords[(state >> 8) % 20], kWords[(state >> 16) % 20],
+                      (state >> 4) % 100000, kExtensions[(state >> 20) % 10]);
+    }
+
+    const char* ModeName(const std::string& pattern, FilterMode mode) {
+        mode = EntryFilter::DetectMode(pattern, mode);
+        return mode == FilterMode::Glob ? "glob" : mode == FilterMode::Prefix ? "prefix" : "substring";
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+int NameBenchmark::Run(const fs::path& dir, const Options& options) {
+    fs::path tree = dir / "names";
+    fs::path file = dir / "names.index";
+    auto start = std::chrono::steady_clock::now();
+    if (!Generate(tree, options))
+        return 1;
+    LOG_INFO("Name index benchmark: tree %s ready (%.1f s)", tree.string().c_str(), ElapsedSince(start).count() / 1e6);
+
+    // 构建（含保存索引文件）
+    NameIndex index;
+    start = std::chrono::steady_clock::now();
+    index.StartBuild(tree, file, options.threads);
+    index.WaitIdle();
+    double buildSeconds = ElapsedSince(start).count() / 1e6;
+    NameIndex::Stats stats = index.GetStats();
+    if (!stats.ready) {
+        LOG_ERROR("Name index benchmark: indexing %s failed", tree.string().c_str());
+        return 1;
+    }
+    std::error_code ec;
+    std::uintmax_t fileBytes = fs::file_size(file, ec);
+    const std::size_t records = stats.files + stats.folders;
+    const double perFile = stats.files ? 1.0 / stats.files : 0.0;
+    LOG_INFO("Build: %d files, %d folders in %.2f s (walk %.2f s, %.0f files/s, %d threads)", (int)stats.files,
+             (int)stats.folders, buildSeconds, stats.buildTime.count() / 1e6,
+             buildSeconds > 0 ? stats.files / buildSeconds : 0.0, stats.threads);
+    LOG_INFO("Size: %.1f MB in memory = %.1f bytes per file (%.1f per record), %.1f MB file = %.1f bytes per file",
+             stats.memoryBytes / 1e6, stats.memoryBytes * perFile,
+             records ? (double)stats.memoryBytes / records : 0.0, ec ? 0.0 : fileBytes / 1e6,
+             ec ? 0.0 : fileBytes * perFile);
+    {
+        NameIndex loaded;
+        loaded.StartLoad(file);
+        loaded.WaitIdle();
+        LOG_INFO("Load: %.2f s", loaded.GetStats().buildTime.count() / 1e6);
+    }
+
+    // 每个查询先清空，使其完整扫描而不是沿用上次的结果
+    double totalMs = 0, worstMs = 0;
+    for (const NameQuery& query : kQueries) {
+        std::chrono::microseconds best = std::chrono::microseconds::max();
+        std::size_t matches = 0;
+        int threads = 0;
+        for (int run = 0; run < kQueryRuns; ++run) {
+            index.Query("", query.mode);
+            matches = index.Query(query.pattern, query.mode).size();
+            best = std::min(best, index.GetLastQueryStats().time);
+            threads = index.GetLastQueryStats().threads;
+        }
+        totalMs += best.count() / 1e3;
+        worstMs = std::max(worstMs, best.count() / 1e3);
+        LOG_INFO("Query %-16s %-9s %8d matches in %.2f ms (%d threads)", query.pattern,
+                 ModeName(query.pattern, query.mode), (int)matches, best.count() / 1e3, threads);
+    }
+    LOG_INFO("Queries: %.2f ms average, worst %.2f ms", totalMs / (sizeof(kQueries) / sizeof(kQueries[0])), worstMs);
+
+    // 逐字输入：每次按键只复查上次的匹配项
+    index.Query("", FilterMode::Substring);
+    std::string typed(kTypedQuery);
+    double typedWorstMs = 0;
+    int narrowed = 0;
+    for (std::size_t n = 1; n <= typed.size(); ++n) {
+        index.Query(typed.substr(0, n), FilterMode::Substring);
+        const NameIndex::QueryStats& queryStats = index.GetLastQueryStats();
+        typedWorstMs = std::max(typedWorstMs, queryStats.time.count() / 1e3);
+        narrowed += queryStats.narrowed ? 1 : 0;
+    }
+    LOG_INFO("Typing \"%s\": worst keystroke %.2f ms, %d of %d narrowed", kTypedQuery, typedWorstMs, narrowed,
+             (int)typed.size());
+
+    // 与生成的名字对照
+    std::size_t substring = index.Query(kCheckedSubstring, FilterMode::Substring).size();
+    std::size_t expectedSubstring = CountNames(options, kCheckedSubstring, false);
+    std::size_t prefix = index.Query(kCheckedPrefix, FilterMode::Prefix).size();
+    std::size_t expectedPrefix = CountNames(options, kCheckedPrefix, true);
+    bool ok = substring == expectedSubstring && prefix == expectedPrefix;
+    LOG_INFO("Check: \"%s\" %d of %d, \"%s\" prefix %d of %d", kCheckedSubstring, (int)substring,
+             (int)expectedSubstring, kCheckedPrefix, (int)prefix, (int)expectedPrefix);
+    LOG_INFO("Name index benchmark: %s", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+// -----------------------------------------------------------------------------
+// Tree
+// -----------------------------------------------------------------------------
+
+bool NameBenchmark::Generate(const fs::path& tree, const Options& options) {
+    // 树是确定的；完成标记记下文件数，相同时直接复用
+    std::error_code ec;
+    fs::path complete = tree.parent_path() / "names.complete";
+    {
+        std::ifstream in(complete);
+        int files = -1;
+        if (in >> files && files == options.files)
+            return true;
+    }
+    LOG_INFO("Name index benchmark: writing %d files to %s", options.files, tree.string().c_str());
+    fs::remove_all(tree, ec);
+    fs::remove(complete, ec);
+    fs::create_directories(tree, ec);
+
+    std::uint32_t state = 1;
+    int written = 0;
+    char name[256];
+    for (int a = 0; a < kProjects && written < options.files; ++a) {
+        std::snprintf(name, sizeof(name), "proj_%s_%d", kWords[a % 20], a);
+        fs::path project = tree / name;
+        for (int b = 0; b < kSubfolders && written < options.files; ++b) {
+            std::snprintf(name, sizeof(name), "%s_dir%d", kWords[(a + b) % 20], b);
+            fs::path folder = project / name;
+            fs::create_directories(folder, ec);
+            for (int c = 0; c < kFilesPerFolder && written < options.files; ++c, ++written) {
+                NextName(state, name, sizeof(name));
+                std::ofstream out(folder / name, std::ios::binary | std::ios::trunc);
+                if (!out) {
+                    LOG_ERROR("Name index benchmark: cannot write %s", (folder / name).string().c_str());
+                    return false;
+                }
+            }
+        }
+    }
+    std::ofstream(complete) << options.files << "\n";
+    return true;
+}
+
+std::size_t NameBenchmark::CountNames(const Options& options, const char* text, bool prefix) {
+    // 树最多容纳 kProjects * kSubfolders * kFilesPerFolder 个文件；
+    // 同一文件夹里重名的文件只有一个
+    int files = std::min(options.files, kProjects * kSubfolders * kFilesPerFolder);
+    std::uint32_t state = 1;
+    std::size_t count = 0;
+    std::size_t length = std::strlen(text);
+    std::vector<std::string> folder;
+    char name[256];
+    for (int k = 0; k < files; ++k) {
+        NextName(state, name, sizeof(name));
+        if (prefix ? std::strncmp(name, text, length) == 0 : std::strstr(name, text) != nullptr)
+            folder.push_back(name);
+        if ((k + 1) % kFilesPerFolder == 0 || k + 1 == files) {
+            std::sort(folder.begin(), folder.end());
+            count += std::unique(folder.begin(), folder.end()) - folder.begin();
+            folder.clear();
+        }
+    }
+    return count;
+}
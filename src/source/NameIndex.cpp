@@ -0,0 +1,1264 @@
+// NameIndex.cpp
+// Whole-volume file name index implementation for FileMgr
+//
+// Key features:
+// - Columnar records with parent links (one name per record, no full paths)
+// - Parallel build walk that stays on the root's filesystem
+// - Binary index file (temporary file, then rename) loaded on later runs
+// - Parallel SSE2 substring / glob scan, binary-searched prefix order
+// - Narrowing: extended queries re-check only the previous matches
+// - Live updates from fanotify (Linux) or recursive ReadDirectoryChangesW
+//
+
+#include "../include/NameIndex.hpp"
+#include "../include/Common.hpp"
+#include "../include/DirEnumerator.hpp"
+#include "../include/EntrySorter.hpp"
+#include "../include/ListingStore.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/fanotify.h>
+#endif
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NAMEINDEX_SSE2 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr char kMagic[4] = { 'F', 'M', 'N', 'I' };
+    constexpr std::uint32_t kVersion = 1;
+
+    constexpr std::uint8_t kFlagDirectory = 1;
+    constexpr std::uint8_t kFlagDeleted = 2;
+
+    constexpr int kMaxDepth = 64;                           // 防止符号链接环无限下探
+    constexpr std::size_t kParallelThreshold = 65536;       // 记录少于该数时单线程扫描
+    constexpr auto kUpdateDelay = std::chrono::milliseconds(200);   // 变更事件合并的时间窗
+
+    struct FileHeader {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t count;               // Records
+        std::uint32_t rangeCount;
+        std::uint64_t nameBytes;
+        std::uint64_t extraCount;
+        std::uint64_t sortedCount;
+        std::uint64_t folders;
+        std::uint64_t deletedFiles;
+        std::uint64_t deletedFolders;
+        std::uint32_t rootLength;          // UTF-8 bytes of the root path (follows the header)
+        std::uint32_t reserved;
+    };
+
+    std::int64_t ToNanos(std::chrono::system_clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    }
+
+    std::chrono::system_clock::time_point FromNanos(std::int64_t ns) {
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+    }
+
+    // 只折叠 ASCII；UTF-8 多字节字符原样比较
+    inline char FoldCase(char c) {
+        return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+    }
+
+    inline char OtherCase(char c) {
+        if (c >= 'a' && c <= 'z')
+            return char(c - 'a' + 'A');
+        if (c >= 'A' && c <= 'Z')
+            return char(c - 'A' + 'a');
+        return c;
+    }
+
+    // 按折叠后的字节比较两个以 '\0' 结尾的名字
+    inline bool FoldedLess(const char* a, const char* b) {
+        for (;; ++a, ++b) {
+            unsigned char x = (unsigned char)FoldCase(*a), y = (unsigned char)FoldCase(*b);
+            if (x != y)
+                return x < y;
+            if (x == 0)
+                return false;
+        }
+    }
+
+    // 名字（折叠后）是否小于前缀；以前缀开头的名字不算小于
+    inline bool FoldedBeforePrefix(const char* name, const std::string& prefix) {
+        for (std::size_t k = 0; k < prefix.size(); ++k) {
+            unsigned char x = (unsigned char)FoldCase(name[k]), y = (unsigned char)prefix[k];
+            if (x != y)
+                return x < y;
+        }
+        return false;
+    }
+
+    inline bool FoldedStartsWith(const char* name, std::size_t size, const std::string& prefix) {
+        if (size < prefix.size())
+            return false;
+        for (std::size_t k = 0; k < prefix.size(); ++k) {
+            if (FoldCase(name[k]) != prefix[k])
+                return false;
+        }
+        return true;
+    }
+
+    // 同一目录下的名字比较：Windows 不区分大小写（只折叠 ASCII），其余平台逐字节
+    inline bool SameName(const char* a, std::size_t aSize, const char* b, std::size_t bSize) {
+        if (aSize != bSize)
+            return false;
+#ifdef _WIN32
+        for (std::size_t k = 0; k < aSize; ++k) {
+            if (FoldCase(a[k]) != FoldCase(b[k]))
+                return false;
+        }
+        return true;
+#else
+        return std::memcmp(a, b, aSize) == 0;
+#endif
+    }
+
+    // 名字转成 UTF-8（Linux 上本来就是字节串，直接复制）
+    inline void ToUtf8(const fs::path::string_type& name, std::string& out) {
+#ifdef _WIN32
+        out = fs::path(name).u8string();
+#else
+        out = name;
+#endif
+    }
+
+#ifdef NAMEINDEX_SSE2
+    inline int LowestBit(unsigned mask) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (int)index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+#endif
+
+    // 在 text[pos, stop) 中查找小写字面量（不区分 ASCII 大小写）
+    // @return 第一次出现的位置，没有则返回 stop
+    std::size_t FindFolded(const char* text, std::size_t pos, std::size_t stop, const std::string& needle) {
+        std::size_t n = needle.size();
+        if (stop - pos < n)
+            return stop;
+        auto verify = [&](std::size_t at) {
+            for (std::size_t k = 1; k < n; ++k) {
+                if (FoldCase(text[at + k]) != needle[k])
+                    return false;
+            }
+            return true;
+        };
+
+#ifdef NAMEINDEX_SSE2
+        // 16 个位置同时比较首字节和末字节（两种大小写都比较）
+        const char f = needle[0], l = needle[n - 1];
+        const __m128i first = _mm_set1_epi8(f), first2 = _mm_set1_epi8(OtherCase(f));
+        const __m128i last = _mm_set1_epi8(l), last2 = _mm_set1_epi8(OtherCase(l));
+        for (; pos + n - 1 + 16 <= stop; pos += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + pos));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + pos + n - 1));
+            __m128i ma = _mm_or_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(a, first2));
+            __m128i mb = _mm_or_si128(_mm_cmpeq_epi8(b, last), _mm_cmpeq_epi8(b, last2));
+            unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(ma, mb));
+            while (mask) {
+                std::size_t at = pos + LowestBit(mask);
+                if (verify(at))
+                    return at;
+                mask &= mask - 1;
+            }
+        }
+#endif
+        // 剩余部分（或无 SSE2 时）逐个定位首字节
+        for (; pos + n <= stop; ++pos) {
+            if (FoldCase(text[pos]) == needle[0] && verify(pos))
+                return pos;
+        }
+        return stop;
+    }
+
+    // 通配符的最长连续字面量（用于预筛）
+    std::string LongestLiteral(const std::string& glob) {
+        std::string literal;
+        std::size_t runStart = 0;
+        for (std::size_t i = 0; i <= glob.size(); ++i) {
+            if (i == glob.size() || glob[i] == '*' || glob[i] == '?') {
+                if (i - runStart > literal.size())
+                    literal = glob.substr(runStart, i - runStart);
+                runStart = i + 1;
+            }
+        }
+        return literal;
+    }
+
+    // 折叠后做通配符匹配（名字很短，用栈上缓冲区）
+    bool GlobMatchFolded(const std::string& glob, const char* name, std::size_t size) {
+        char folded[512];
+        std::string heap;
+        char* buffer = folded;
+        if (size > sizeof(folded)) {
+            heap.resize(size);
+            buffer = &heap[0];
+        }
+        for (std::size_t k = 0; k < size; ++k)
+            buffer[k] = FoldCase(name[k]);
+        return EntryFilter::GlobMatch(glob, buffer, size);
+    }
+
+    template <typename T>
+    void WriteArray(std::ofstream& out, const std::vector<T>& v) {
+        out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+    }
+
+    template <typename T>
+    bool ReadArray(std::ifstream& in, std::vector<T>& v, std::size_t count) {
+        v.resize(count);
+        in.read(reinterpret_cast<char*>(v.data()), count * sizeof(T));
+        return (bool)in;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Watch
+// -----------------------------------------------------------------------------
+
+// 通知句柄在遍历开始之前打开：构建期间发生的变化由内核缓存，换入新索引后再应用
+struct NameIndex::Watch {
+    fs::path root;
+    const char* backend = "none";
+#ifdef _WIN32
+    HANDLE dir = INVALID_HANDLE_VALUE;
+    HANDLE event = nullptr;
+    OVERLAPPED overlapped{};
+    std::vector<DWORD> buffer;                     // DWORD 对齐
+    bool pending = false;                          // A read is outstanding
+
+    bool Issue() {
+        const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE |
+                             FILE_NOTIFY_CHANGE_LAST_WRITE;
+        ResetEvent(event);
+        pending = ReadDirectoryChangesW(dir, buffer.data(), (DWORD)(buffer.size() * sizeof(DWORD)), TRUE, filter,
+                                        nullptr, &overlapped, nullptr) != FALSE;
+        return pending;
+    }
+
+    ~Watch() {
+        if (pending) {
+            DWORD ignored;
+            CancelIoEx(dir, &overlapped);
+            GetOverlappedResult(dir, &overlapped, &ignored, TRUE);
+        }
+        if (event)
+            CloseHandle(event);
+        if (dir != INVALID_HANDLE_VALUE)
+            CloseHandle(dir);
+    }
+#elif defined(__linux__) && defined(FAN_REPORT_DFID_NAME)
+    int fan = -1;
+    int mountFd = -1;                              // Any descriptor on the filesystem (for open_by_handle_at)
+
+    ~Watch() {
+        if (mountFd >= 0)
+            close(mountFd);
+        if (fan >= 0)
+            close(fan);
+    }
+#endif
+};
+
+// -----------------------------------------------------------------------------
+// Data
+// -----------------------------------------------------------------------------
+
+NameIndex::Id NameIndex::Data::Add(Id parent, const char* name, std::size_t size, bool isDir, std::uint64_t bytes,
+                                   std::int64_t time) {
+    Id id = Count();
+    if (offsets.empty())
+        offsets.push_back(0);
+    names.insert(names.end(), name, name + size);
+    names.push_back('\0');
+    offsets.push_back((std::uint32_t)names.size());
+    parents.push_back(parent);
+    sizes.push_back(bytes);
+    times.push_back(time);
+    flags.push_back(isDir ? kFlagDirectory : 0);
+    if (isDir)
+        ++folders;
+    return id;
+}
+
+std::size_t NameIndex::Data::MemoryBytes() const {
+    return names.capacity() + offsets.capacity() * sizeof(std::uint32_t) + parents.capacity() * sizeof(Id) +
+           sizes.capacity() * sizeof(std::uint64_t) + times.capacity() * sizeof(std::int64_t) + flags.capacity() +
+           ranges.capacity() * sizeof(DirRange) + extra.size() * (2 * sizeof(Id) + 2 * sizeof(void*)) +
+           sorted.capacity() * sizeof(Id);
+}
+
+// -----------------------------------------------------------------------------
+// Construction / Destruction
+// -----------------------------------------------------------------------------
+
+NameIndex::NameIndex()
+    : m_dataGeneration(0), m_cancelBuild(false), m_stopWatch(false), m_dirty(false),
+      m_lastMode(FilterMode::Substring), m_lastGeneration(~0ULL) {
+#ifdef _WIN32
+    m_watchStopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+#else
+    m_watchWakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+#endif
+}
+
+NameIndex::~NameIndex() {
+    StopThreads();
+#ifdef _WIN32
+    if (m_watchStopEvent)
+        CloseHandle((HANDLE)m_watchStopEvent);
+#else
+    if (m_watchWakeFd >= 0)
+        close(m_watchWakeFd);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+void NameIndex::StartBuild(const fs::path& root, const fs::path& file, int threads) {
+    // 旧索引在新索引建好之前继续可用，只停掉正在进行的构建
+    m_cancelBuild = true;
+    if (m_worker.joinable())
+        m_worker.join();
+    m_cancelBuild = false;
+
+    threads = threads > 0 ? std::min(threads, 64) : EntrySorter::DefaultThreadCount();
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_stats.building = true;
+        m_stats.walked = 0;
+        m_stats.threads = threads;
+        m_buildStart = std::chrono::steady_clock::now();
+    }
+    m_worker = std::thread([this, root, file, threads] {
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<Watch> watch = OpenWatch(root);
+        std::unique_ptr<Data> data = Build(root, threads);
+        if (!data) {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_stats.building = false;
+            m_idleCv.notify_all();
+            return;
+        }
+        Finish(*data, threads);
+        std::chrono::microseconds time = ElapsedSince(start);
+        std::size_t count = data->Count();
+        LOG_INFO("Name index of %s: %llu records in %.2f s (%d threads), %.1f bytes per record",
+                 root.string().c_str(), (unsigned long long)count, time.count() / 1e6, threads,
+                 (double)data->MemoryBytes() / std::max<std::size_t>(count, 1));
+        if (!file.empty())
+            Write(*data, file);
+        Install(std::move(data), std::move(watch), false, time);
+    });
+}
+
+void NameIndex::StartLoad(const fs::path& file) {
+    m_cancelBuild = true;
+    if (m_worker.joinable())
+        m_worker.join();
+    m_cancelBuild = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_stats.building = true;
+        m_stats.walked = 0;
+        m_buildStart = std::chrono::steady_clock::now();
+    }
+    m_worker = std::thread([this, file] {
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<Data> data = Read(file);
+        if (!data) {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_stats.building = false;
+            m_idleCv.notify_all();
+            return;
+        }
+        Install(std::move(data), nullptr, true, ElapsedSince(start));
+    });
+}
+
+bool NameIndex::SaveIfChanged(const fs::path& file) {
+    std::shared_lock<std::shared_mutex> lock(m_dataMutex);
+    if (!m_data || !m_dirty)
+        return true;
+    if (!Write(*m_data, file))
+        return false;
+    m_dirty = false;
+    return true;
+}
+
+NameIndex::Stats NameIndex::GetStats() const {
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        stats = m_stats;
+        if (stats.building)
+            stats.buildTime = ElapsedSince(m_buildStart);
+    }
+    std::shared_lock<std::shared_mutex> lock(m_dataMutex);
+    if (m_data) {
+        const Data& data = *m_data;
+        stats.folders = data.folders - 1 - data.deletedFolders;       // 根目录不计
+        stats.files = data.Count() - data.folders - data.deletedFiles;
+        stats.memoryBytes = data.MemoryBytes();
+        stats.ready = true;
+    }
+    return stats;
+}
+
+fs::path NameIndex::GetRoot() const {
+    std::shared_lock<std::shared_mutex> lock(m_dataMutex);
+    return m_data ? m_data->root : fs::path();
+}
+
+const std::vector<NameIndex::Id>& NameIndex::Query(const std::string& pattern, FilterMode mode) {
+    auto start = std::chrono::steady_clock::now();
+    std::string lower = pattern;
+    for (char& c : lower)
+        c = FoldCase(c);
+    mode = EntryFilter::DetectMode(lower, mode);
+    m_queryStats = QueryStats();
+
+    std::shared_lock<std::shared_mutex> lock(m_dataMutex);
+    if (!m_data || lower.empty()) {
+        m_matches.clear();
+        m_lastPattern.clear();
+        m_queryStats.time = ElapsedSince(start);
+        return m_matches;
+    }
+    const Data& data = *m_data;
+    int threads = data.Count() < kParallelThreshold ? 1 : EntrySorter::DefaultThreadCount();
+
+    // 只是在上次的基础上追加字符：新结果一定是旧结果的子集
+    bool narrow = m_lastGeneration == m_dataGeneration && mode == m_lastMode && !m_lastPattern.empty() &&
+                  ((mode == FilterMode::Substring && lower.find(m_lastPattern) != std::string::npos) ||
+                   (mode == FilterMode::Prefix && lower.compare(0, m_lastPattern.size(), m_lastPattern) == 0));
+    if (narrow) {
+        m_queryStats.checked = m_matches.size();
+        m_queryStats.narrowed = true;
+        std::size_t kept = 0;
+        for (Id id : m_matches) {
+            if (MatchRecord(data, id, lower, mode))
+                m_matches[kept++] = id;
+        }
+        m_matches.resize(kept);
+    } else if (mode == FilterMode::Prefix) {
+        // 排序好的部分二分查找，实时更新加入的记录（不在排序中）逐个检查
+        m_matches.clear();
+        auto it = std::partition_point(data.sorted.begin(), data.sorted.end(),
+                                       [&](Id id) { return FoldedBeforePrefix(data.Name(id), lower); });
+        for (; it != data.sorted.end(); ++it) {
+            if (!FoldedStartsWith(data.Name(*it), data.NameSize(*it), lower))
+                break;
+            if (!(data.flags[*it] & kFlagDeleted))
+                m_matches.push_back(*it);
+        }
+        Id tail = (Id)data.sorted.size() + 1;
+        for (Id id = tail; id < data.Count(); ++id) {
+            if (MatchRecord(data, id, lower, mode))
+                m_matches.push_back(id);
+        }
+        m_queryStats.checked = data.Count() - tail;
+    } else {
+        m_matches.clear();
+        if (mode == FilterMode::Glob)
+            ScanRecords(data, LongestLiteral(lower), lower, m_matches, threads);
+        else
+            ScanRecords(data, lower, std::string(), m_matches, threads);
+        m_queryStats.threads = threads;
+    }
+
+    m_lastPattern = lower;
+    m_lastMode = mode;
+    m_lastGeneration = m_dataGeneration;
+    m_queryStats.matches = m_matches.size();
+    m_queryStats.time = ElapsedSince(start);
+    return m_matches;
+}
+
+std::string NameIndex::GetRelativePath(Id id) const {
+    std::string path;
+    std::shared_lock<std::shared_mutex> lock(m_dataMutex);
+    if (m_data && id > 0 && id < m_data->Count())
+        AppendPath(*m_data, id, path);
+    return path;
+}
+
+void NameIndex::FillEntries(const std::vector<Id>& ids, std::size_t limit, EntryStore& out) const {
+    out.Clear();
+    std::shared_lock<std::shared_mutex> lock(m_dataMutex);
+    if (!m_data)
+        return;
+    const Data& data = *m_data;
+    std::size_t count = std::min(ids.size(), limit);
+    out.Reserve(count, count * 48);
+    std::string relative;
+    for (std::size_t k = 0; k < count; ++k) {
+        Id id = ids[k];
+        if (id == 0 || id >= data.Count())
+            continue;
+        relative.clear();
+        AppendPath(data, id, relative);
+        fs::path native = fs::u8path(relative);
+        out.Add(native.native(), (data.flags[id] & kFlagDirectory) != 0, data.sizes[id], FromNanos(data.times[id]));
+    }
+    out.Sort();
+}
+
+void NameIndex::WaitIdle() {
+    std::unique_lock<std::mutex> lock(m_statsMutex);
+    m_idleCv.wait(lock, [this] { return !m_stats.building; });
+}
+
+fs::path NameIndex::GetDefaultPath() {
+    return ListingStore::GetDefaultPath().parent_path() / "names.index";
+}
+
+// -----------------------------------------------------------------------------
+// Build and load
+// -----------------------------------------------------------------------------
+
+void NameIndex::StopThreads() {
+    m_cancelBuild = true;
+    if (m_worker.joinable())
+        m_worker.join();
+    StopWatcher();
+}
+
+void NameIndex::StopWatcher() {
+    if (!m_watcher.joinable())
+        return;
+    m_stopWatch = true;
+#ifdef _WIN32
+    SetEvent((HANDLE)m_watchStopEvent);
+#else
+    std::uint64_t value = 1;
+    (void)!write(m_watchWakeFd, &value, sizeof(value));
+#endif
+    m_watcher.join();
+#ifdef _WIN32
+    ResetEvent((HANDLE)m_watchStopEvent);
+#else
+    (void)!read(m_watchWakeFd, &value, sizeof(value));
+#endif
+    m_stopWatch = false;
+}
+
+std::unique_ptr<NameIndex::Data> NameIndex::Build(const fs::path& root, int threads) {
+    auto data = std::make_unique<Data>();
+    data->root = root;
+    data->Add(kNoId, "", 0, true, 0, 0);
+
+#ifndef _WIN32
+    // 不跨越挂载点（/proc、网络盘等各自是单独的文件系统）
+    struct stat rootStat;
+    if (::stat(root.c_str(), &rootStat) != 0) {
+        LOG_ERROR("Name index: cannot open %s", root.string().c_str());
+        return nullptr;
+    }
+    const dev_t rootDevice = rootStat.st_dev;
+#endif
+
+    struct Work {
+        fs::path path;
+        Id id;
+        int depth;
+    };
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Work> folders{ { root, 0, 0 } };
+    int idle = 0;
+    bool done = false;
+
+    auto worker = [&] {
+        std::unique_ptr<DirEnumerator> enumerator = DirEnumerator::Create(EnumBackend::Auto);
+        std::vector<ScanEntry> entries;
+        std::vector<std::string> names;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!m_cancelBuild) {
+            if (folders.empty()) {
+                // 所有线程都空闲且栈为空：遍历结束
+                if (++idle == threads) {
+                    done = true;
+                    cv.notify_all();
+                    break;
+                }
+                cv.wait(lock, [&] { return done || m_cancelBuild || !folders.empty(); });
+                if (done)
+                    break;
+                --idle;
+                continue;
+            }
+            Work work = std::move(folders.back());
+            folders.pop_back();
+            lock.unlock();
+
+            entries.clear();
+            bool sameDevice = true;
+#ifndef _WIN32
+            struct stat st;
+            sameDevice = ::stat(work.path.c_str(), &st) == 0 && st.st_dev == rootDevice;
+#endif
+            std::error_code ec;
+            if (sameDevice) {
+                enumerator->Enumerate(work.path, [&](std::vector<ScanEntry>& chunk) {
+                    if (m_cancelBuild.load(std::memory_order_relaxed))
+                        return false;
+                    for (auto& se : chunk)
+                        entries.push_back(std::move(se));
+                    return true;
+                }, ec);
+            }
+            // 名字在锁外转换好，锁内只做追加
+            names.resize(entries.size());
+            for (std::size_t k = 0; k < entries.size(); ++k)
+                ToUtf8(entries[k].name, names[k]);
+
+            lock.lock();
+            // 同一目录的子项连续存放，目录只需记录一段范围
+            Id first = data->Count();
+            for (std::size_t k = 0; k < entries.size(); ++k) {
+                const ScanEntry& se = entries[k];
+                Id id = data->Add(work.id, names[k].data(), names[k].size(), se.isDirectory,
+                                  se.isDirectory ? 0 : se.size, ToNanos(se.lastWriteTime));
+                if (se.isDirectory && work.depth < kMaxDepth)
+                    folders.push_back({ work.path / se.name, id, work.depth + 1 });
+            }
+            if (!entries.empty())
+                data->ranges.push_back({ work.id, first, (Id)entries.size() });
+            {
+                std::lock_guard<std::mutex> statsLock(m_statsMutex);
+                m_stats.walked = data->Count() - 1;
+            }
+            if (folders.size() > 1)
+                cv.notify_all();
+        }
+        // 取消时唤醒其余等待中的线程
+        if (m_cancelBuild) {
+            done = true;
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool)
+        th.join();
+
+    if (m_cancelBuild)
+        return nullptr;
+    return data;
+}
+
+void NameIndex::Finish(Data& data, int threads) {
+    // 遍历时按倍增追加，收尾时归还多余的容量
+    data.names.shrink_to_fit();
+    data.offsets.shrink_to_fit();
+    data.parents.shrink_to_fit();
+    data.sizes.shrink_to_fit();
+    data.times.shrink_to_fit();
+    data.flags.shrink_to_fit();
+    data.ranges.shrink_to_fit();
+    std::sort(data.ranges.begin(), data.ranges.end(),
+              [](const DirRange& a, const DirRange& b) { return a.dir < b.dir; });
+
+    // 按折叠后的名字排序：分段并行排序，再逐级两两归并
+    Id count = data.Count();
+    data.sorted.resize(count > 0 ? count - 1 : 0);
+    std::iota(data.sorted.begin(), data.sorted.end(), (Id)1);
+    auto less = [&](Id a, Id b) { return FoldedLess(data.Name(a), data.Name(b)); };
+    std::size_t n = data.sorted.size();
+    if (n < kParallelThreshold)
+        threads = 1;
+    std::size_t chunk = (n + threads - 1) / std::max(threads, 1);
+    EntrySorter::ParallelFor(threads, n, [&](int, std::size_t b, std::size_t e) {
+        std::sort(data.sorted.begin() + b, data.sorted.begin() + e, less);
+    });
+    for (std::size_t width = chunk; width > 0 && width < n; width *= 2) {
+        for (std::size_t b = 0; b + width < n; b += 2 * width) {
+            std::size_t mid = b + width, e = std::min(n, b + 2 * width);
+            std::inplace_merge(data.sorted.begin() + b, data.sorted.begin() + mid, data.sorted.begin() + e, less);
+        }
+    }
+}
+
+void NameIndex::Install(std::unique_ptr<Data> data, std::unique_ptr<Watch> watch, bool loaded,
+                        std::chrono::microseconds time) {
+    // 先停掉旧根目录的实时更新，再换入新数据
+    StopWatcher();
+
+    if (!watch)
+        watch = OpenWatch(data->root);
+    {
+        std::unique_lock<std::shared_mutex> lock(m_dataMutex);
+        m_data = std::move(data);
+        ++m_dataGeneration;
+        m_dirty = false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_stats.building = false;
+        ++m_stats.generation;
+        m_stats.loaded = loaded;
+        m_stats.liveBackend = watch->backend;
+        // 程序关闭期间（或没有变更通知时）的变化无从得知
+        m_stats.stale = loaded || std::strcmp(watch->backend, "none") == 0;
+        m_stats.updates = 0;
+        m_stats.buildTime = time;
+    }
+    m_watcher = std::thread(&NameIndex::WatchLoop, this, std::move(watch));
+    m_idleCv.notify_all();
+}
+
+bool NameIndex::Write(const Data& data, const fs::path& file) {
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.count = data.Count();
+    header.rangeCount = (std::uint32_t)data.ranges.size();
+    header.nameBytes = data.names.size();
+    header.extraCount = data.extra.size();
+    header.sortedCount = data.sorted.size();
+    header.folders = data.folders;
+    header.deletedFiles = data.deletedFiles;
+    header.deletedFolders = data.deletedFolders;
+    std::string root = data.root.u8string();
+    header.rootLength = (std::uint32_t)root.size();
+
+    std::vector<Id> extra;
+    extra.reserve(data.extra.size() * 2);
+    for (const auto& pair : data.extra) {
+        extra.push_back(pair.first);
+        extra.push_back(pair.second);
+    }
+
+    std::error_code ec;
+    fs::create_directories(file.parent_path(), ec);
+    fs::path tmp = file;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            LOG_ERROR("Cannot write name index %s", tmp.string().c_str());
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(root.data(), root.size());
+        WriteArray(out, data.names);
+        WriteArray(out, data.offsets);
+        WriteArray(out, data.parents);
+        WriteArray(out, data.sizes);
+        WriteArray(out, data.times);
+        WriteArray(out, data.flags);
+        WriteArray(out, data.ranges);
+        WriteArray(out, extra);
+        WriteArray(out, data.sorted);
+        if (!out) {
+            LOG_ERROR("Failed writing name index %s", tmp.string().c_str());
+            return false;
+        }
+    }
+    fs::rename(tmp, file, ec);
+    if (ec) {
+        LOG_ERROR("Cannot replace name index %s: %s", file.string().c_str(), ec.message().c_str());
+        fs::remove(tmp, ec);
+        return false;
+    }
+    LOG_INFO("Saved name index %s: %u records", file.string().c_str(), header.count);
+    return true;
+}
+
+std::unique_ptr<NameIndex::Data> NameIndex::Read(const fs::path& file) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in)
+        return nullptr;
+    FileHeader header{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.count == 0 || header.sortedCount >= header.count) {
+        LOG_ERROR("Name index %s is invalid or from another version", file.string().c_str());
+        return nullptr;
+    }
+
+    auto data = std::make_unique<Data>();
+    std::string root(header.rootLength, '\0');
+    in.read(&root[0], root.size());
+    data->root = fs::u8path(root);
+    std::vector<Id> extra;
+    bool ok = in && ReadArray(in, data->names, header.nameBytes) &&
+              ReadArray(in, data->offsets, (std::size_t)header.count + 1) &&
+              ReadArray(in, data->parents, header.count) && ReadArray(in, data->sizes, header.count) &&
+              ReadArray(in, data->times, header.count) && ReadArray(in, data->flags, header.count) &&
+              ReadArray(in, data->ranges, header.rangeCount) && ReadArray(in, extra, header.extraCount * 2) &&
+              ReadArray(in, data->sorted, header.sortedCount);
+    if (!ok || data->offsets.back() != data->names.size()) {
+        LOG_ERROR("Name index %s is truncated", file.string().c_str());
+        return nullptr;
+    }
+    for (std::size_t k = 0; k + 1 < extra.size(); k += 2)
+        data->extra.emplace(extra[k], extra[k + 1]);
+    data->folders = header.folders;
+    data->deletedFiles = header.deletedFiles;
+    data->deletedFolders = header.deletedFolders;
+    LOG_INFO("Loaded name index %s: %s, %u records", file.string().c_str(), root.c_str(), header.count);
+    return data;
+}
+
+// -----------------------------------------------------------------------------
+// Live updates
+// -----------------------------------------------------------------------------
+
+std::unique_ptr<NameIndex::Watch> NameIndex::OpenWatch(const fs::path& root) {
+    auto watch = std::make_unique<Watch>();
+    watch->root = root;
+#ifdef _WIN32
+    // 根目录上一个递归 ReadDirectoryChangesW，覆盖整个子树
+    watch->dir = CreateFileW(root.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                             nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (watch->dir == INVALID_HANDLE_VALUE)
+        return watch;
+    watch->event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    watch->overlapped.hEvent = watch->event;
+    watch->buffer.resize(16384);                   // 64 KB
+    if (watch->Issue())
+        watch->backend = "ReadDirectoryChangesW";
+#elif defined(__linux__) && defined(FAN_REPORT_DFID_NAME)
+    // fanotify 文件系统级标记：一个描述符覆盖整个卷，事件带父目录句柄和名字
+    // （需要 CAP_SYS_ADMIN；否则索引只能手动重建）
+    watch->fan = fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK | FAN_REPORT_DFID_NAME,
+                               O_RDONLY | O_CLOEXEC | O_LARGEFILE);
+    const std::uint64_t mask = FAN_CREATE | FAN_DELETE | FAN_MOVED_FROM | FAN_MOVED_TO | FAN_MODIFY | FAN_ATTRIB |
+                               FAN_ONDIR;
+    if (watch->fan < 0 ||
+        fanotify_mark(watch->fan, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, mask, AT_FDCWD, root.c_str()) != 0) {
+        LOG_INFO("Name index: fanotify unavailable for %s (%s); no live updates", root.string().c_str(),
+                 std::strerror(errno));
+        return watch;
+    }
+    watch->mountFd = open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (watch->mountFd >= 0)
+        watch->backend = "fanotify";
+#endif
+    return watch;
+}
+
+void NameIndex::WatchLoop(std::unique_ptr<Watch> watch) {
+    std::vector<Change> changes;
+    std::chrono::steady_clock::time_point flushAt;
+    auto add = [&](Change::Kind kind, fs::path relative) {
+        if (changes.empty())
+            flushAt = std::chrono::steady_clock::now() + kUpdateDelay;
+        changes.push_back({ kind, std::move(relative) });
+    };
+    auto timeout = [&]() -> int {
+        if (changes.empty())
+            return -1;
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(flushAt - std::chrono::steady_clock::now());
+        return (int)std::max<long long>(0, left.count());
+    };
+    auto flush = [&] {
+        if (!changes.empty() && std::chrono::steady_clock::now() >= flushAt) {
+            ApplyChanges(changes);
+            changes.clear();
+        }
+    };
+    // 事件丢失（队列溢出）后索引可能已不准确
+    auto markStale = [&] {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_stats.stale = true;
+    };
+
+#ifdef _WIN32
+    HANDLE handles[2] = { watch->event, (HANDLE)m_watchStopEvent };
+    while (!m_stopWatch && watch->pending) {
+        int wait = timeout();
+        DWORD result = WaitForMultipleObjects(2, handles, FALSE, wait < 0 ? INFINITE : (DWORD)wait);
+        if (m_stopWatch || result == WAIT_OBJECT_0 + 1)
+            break;
+        if (result == WAIT_OBJECT_0) {
+            DWORD bytes = 0;
+            watch->pending = false;
+            if (!GetOverlappedResult(watch->dir, &watch->overlapped, &bytes, FALSE) || bytes == 0) {
+                // 缓冲区溢出：丢失了事件
+                markStale();
+            } else {
+                const char* p = reinterpret_cast<const char*>(watch->buffer.data());
+                for (;;) {
+                    const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(p);
+                    fs::path relative(std::wstring(info->FileName, info->FileNameLength / sizeof(WCHAR)));
+                    switch (info->Action) {
+                    case FILE_ACTION_ADDED:
+                    case FILE_ACTION_RENAMED_NEW_NAME:
+                        add(Change::Created, std::move(relative));
+                        break;
+                    case FILE_ACTION_REMOVED:
+                    case FILE_ACTION_RENAMED_OLD_NAME:
+                        add(Change::Removed, std::move(relative));
+                        break;
+                    default:
+                        add(Change::Modified, std::move(relative));
+                        break;
+                    }
+                    if (info->NextEntryOffset == 0)
+                        break;
+                    p += info->NextEntryOffset;
+                }
+            }
+            if (!watch->Issue())
+                markStale();
+        }
+        flush();
+    }
+#elif defined(__linux__) && defined(FAN_REPORT_DFID_NAME)
+    std::string rootText = watch->root.native();
+    while (rootText.size() > 1 && rootText.back() == '/')
+        rootText.pop_back();
+    alignas(fanotify_event_metadata) char buffer[65536];
+    char link[64];
+    char dirPath[4096];
+
+    while (!m_stopWatch && watch->fan >= 0 && watch->mountFd >= 0) {
+        pollfd fds[2] = { { watch->fan, POLLIN, 0 }, { m_watchWakeFd, POLLIN, 0 } };
+        if (::poll(fds, 2, timeout()) < 0 && errno != EINTR)
+            break;
+        if (m_stopWatch)
+            break;
+        for (;;) {
+            ssize_t n = read(watch->fan, buffer, sizeof(buffer));
+            if (n <= 0)
+                break;
+            const fanotify_event_metadata* meta = reinterpret_cast<const fanotify_event_metadata*>(buffer);
+            for (; FAN_EVENT_OK(meta, n); meta = FAN_EVENT_NEXT(meta, n)) {
+                if (meta->mask & FAN_Q_OVERFLOW) {
+                    markStale();
+                    continue;
+                }
+                const auto* info = reinterpret_cast<const fanotify_event_info_fid*>(meta + 1);
+                if (meta->event_len <= sizeof(*meta) || info->hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME)
+                    continue;
+                // 父目录句柄转成路径；名字紧跟在句柄之后
+                file_handle* handle = reinterpret_cast<file_handle*>(const_cast<unsigned char*>(info->handle));
+                const char* name = reinterpret_cast<const char*>(handle->f_handle + handle->handle_bytes);
+                if (std::strcmp(name, ".") == 0)
+                    continue;
+                int dirFd = open_by_handle_at(watch->mountFd, handle, O_PATH | O_CLOEXEC);
+                if (dirFd < 0)
+                    continue;
+                std::snprintf(link, sizeof(link), "/proc/self/fd/%d", dirFd);
+                ssize_t length = readlink(link, dirPath, sizeof(dirPath) - 1);
+                close(dirFd);
+                if (length <= 0)
+                    continue;
+                std::string parent(dirPath, (std::size_t)length);
+                // 索引根目录之外的事件（同一文件系统的其他位置）忽略
+                if (parent.compare(0, rootText.size(), rootText) != 0 ||
+                    (parent.size() > rootText.size() && rootText != "/" && parent[rootText.size()] != '/'))
+                    continue;
+                std::string relative = parent.substr(std::min(parent.size(), rootText.size()));
+                while (!relative.empty() && relative.front() == '/')
+                    relative.erase(0, 1);
+                if (!relative.empty())
+                    relative += '/';
+                relative += name;
+                if (meta->mask & (FAN_DELETE | FAN_MOVED_FROM))
+                    add(Change::Removed, fs::path(relative));
+                else if (meta->mask & (FAN_CREATE | FAN_MOVED_TO))
+                    add(Change::Created, fs::path(relative));
+                else
+                    add(Change::Modified, fs::path(relative));
+            }
+        }
+        flush();
+    }
+#else
+    (void)add;
+    (void)timeout;
+    (void)markStale;
+#endif
+    // 退出前把已收集的变化应用掉
+    if (!changes.empty()) {
+        flushAt = std::chrono::steady_clock::now();
+        flush();
+    }
+}
+
+void NameIndex::ApplyChanges(const std::vector<Change>& changes) {
+    // 锁外先取元数据、遍历新建的目录，锁内只做插入
+    struct Pending {
+        Id parent;                         // Index into subtree, or kNoId for the changed record itself
+        std::string name;
+        bool isDir;
+        std::uint64_t size;
+        std::int64_t time;
+    };
+    struct Prepared {
+        Change::Kind kind;
+        std::vector<std::string> parts;    // UTF-8 path components below the root
+        bool exists = false;
+        bool isDir = false;
+        std::uint64_t size = 0;
+        std::int64_t time = 0;
+        std::vector<Pending> subtree;      // Contents of a created folder
+    };
+
+    fs::path root;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_dataMutex);
+        if (!m_data)
+            return;
+        root = m_data->root;
+    }
+
+    std::unique_ptr<DirEnumerator> enumerator;
+    std::vector<Prepared> prepared;
+    prepared.reserve(changes.size());
+    for (const Change& change : changes) {
+        Prepared p;
+        p.kind = change.kind;
+        for (const fs::path& part : change.relative)
+            p.parts.push_back(part.u8string());
+        if (p.parts.empty())
+            continue;
+        if (change.kind != Change::Removed) {
+            fs::path full = root / change.relative;
+            std::error_code ec;
+            fs::file_status status = fs::symlink_status(full, ec);
+            p.exists = !ec && fs::exists(status);
+            if (p.exists) {
+                p.isDir = fs::is_directory(status);
+                p.size = fs::is_regular_file(status) ? fs::file_size(full, ec) : 0;
+                std::chrono::system_clock::time_point time;
+                if (QueryWriteTime(full, time))
+                    p.time = ToNanos(time);
+            }
+            // 新建（或移入）的目录：整棵子树一起加入
+            if (p.exists && p.isDir && change.kind == Change::Created) {
+                if (!enumerator)
+                    enumerator = DirEnumerator::Create(EnumBackend::Auto);
+                struct Work {
+                    fs::path path;
+                    Id index;
+                    int depth;
+                };
+                std::vector<Work> stack{ { full, kNoId, 0 } };
+                while (!stack.empty() && !m_stopWatch) {
+                    Work work = std::move(stack.back());
+                    stack.pop_back();
+                    enumerator->Enumerate(work.path, [&](std::vector<ScanEntry>& chunk) {
+                        for (auto& se : chunk) {
+                            Pending pending{ work.index, std::string(), se.isDirectory,
+                                             se.isDirectory ? 0 : se.size, ToNanos(se.lastWriteTime) };
+                            ToUtf8(se.name, pending.name);
+                            if (se.isDirectory && work.depth < kMaxDepth)
+                                stack.push_back({ work.path / se.name, (Id)p.subtree.size(), work.depth + 1 });
+                            p.subtree.push_back(std::move(pending));
+                        }
+                        return !m_stopWatch.load(std::memory_order_relaxed);
+                    }, ec);
+                }
+            }
+        }
+        prepared.push_back(std::move(p));
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_dataMutex);
+    if (!m_data || m_data->root != root)
+        return;
+    Data& data = *m_data;
+    std::vector<Id> ids;
+    for (const Prepared& p : prepared) {
+        // 逐级找到父目录；父目录不在索引中（例如在忽略的挂载点下）就跳过
+        Id parent = 0;
+        for (std::size_t k = 0; k + 1 < p.parts.size() && parent != kNoId; ++k) {
+            parent = FindChild(data, parent, p.parts[k].data(), p.parts[k].size());
+            if (parent != kNoId && !(data.flags[parent] & kFlagDirectory))
+                parent = kNoId;
+        }
+        if (parent == kNoId)
+            continue;
+        const std::string& name = p.parts.back();
+        Id existing = FindChild(data, parent, name.data(), name.size());
+
+        if (p.kind == Change::Removed || !p.exists) {
+            if (existing != kNoId)
+                MarkDeleted(data, existing);
+            continue;
+        }
+        if (existing != kNoId && ((data.flags[existing] & kFlagDirectory) != 0) == p.isDir) {
+            data.sizes[existing] = p.size;
+            data.times[existing] = p.time;
+            if (p.kind != Change::Created || p.subtree.empty())
+                continue;
+            // 目录被移走又移回：旧记录作废，按新内容重建
+        }
+        if (existing != kNoId)
+            MarkDeleted(data, existing);
+
+        Id id = data.Add(parent, name.data(), name.size(), p.isDir, p.size, p.time);
+        data.extra.emplace(parent, id);
+        ids.clear();
+        for (const Pending& pending : p.subtree) {
+            Id dir = pending.parent == kNoId ? id : ids[pending.parent];
+            Id child = data.Add(dir, pending.name.data(), pending.name.size(), pending.isDir, pending.size,
+                                pending.time);
+            data.extra.emplace(dir, child);
+            ids.push_back(child);
+        }
+    }
+    ++m_dataGeneration;
+    m_dirty = true;
+    lock.unlock();
+
+    std::lock_guard<std::mutex> statsLock(m_statsMutex);
+    m_stats.updates += changes.size();
+}
+
+void NameIndex::AppendPath(const Data& data, Id id, std::string& out) {
+    // 沿父链收集各级名字，再倒序拼接
+    Id chain[kMaxDepth + 2];
+    int depth = 0;
+    for (Id p = id; p != 0 && p != kNoId && depth < kMaxDepth + 2; p = data.parents[p])
+        chain[depth++] = p;
+    for (int k = depth - 1; k >= 0; --k) {
+        out.append(data.Name(chain[k]), data.NameSize(chain[k]));
+        if (k > 0)
+            out += (char)fs::path::preferred_separator;
+    }
+}
+
+NameIndex::Id NameIndex::FindChild(const Data& data, Id dir, const char* name, std::size_t size) {
+    auto range = std::lower_bound(data.ranges.begin(), data.ranges.end(), dir,
+                                  [](const DirRange& r, Id d) { return r.dir < d; });
+    if (range != data.ranges.end() && range->dir == dir) {
+        for (Id id = range->first; id < range->first + range->count; ++id) {
+            if (!(data.flags[id] & kFlagDeleted) && SameName(data.Name(id), data.NameSize(id), name, size))
+                return id;
+        }
+    }
+    auto added = data.extra.equal_range(dir);
+    for (auto it = added.first; it != added.second; ++it) {
+        Id id = it->second;
+        if (!(data.flags[id] & kFlagDeleted) && SameName(data.Name(id), data.NameSize(id), name, size))
+            return id;
+    }
+    return kNoId;
+}
+
+void NameIndex::MarkDeleted(Data& data, Id id) {
+    std::vector<Id> stack{ id };
+    while (!stack.empty()) {
+        Id current = stack.back();
+        stack.pop_back();
+        if (data.flags[current] & kFlagDeleted)
+            continue;
+        data.flags[current] |= kFlagDeleted;
+        if (!(data.flags[current] & kFlagDirectory)) {
+            ++data.deletedFiles;
+            continue;
+        }
+        ++data.deletedFolders;
+        auto range = std::lower_bound(data.ranges.begin(), data.ranges.end(), current,
+                                      [](const DirRange& r, Id d) { return r.dir < d; });
+        if (range != data.ranges.end() && range->dir == current) {
+            for (Id child = range->first; child < range->first + range->count; ++child)
+                stack.push_back(child);
+        }
+        auto added = data.extra.equal_range(current);
+        for (auto it = added.first; it != added.second; ++it)
+            stack.push_back(it->second);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Matching
+// -----------------------------------------------------------------------------
+
+void NameIndex::ScanRecords(const Data& data, const std::string& literal, const std::string& glob,
+                            std::vector<Id>& out, int threads) {
+    // 根记录（下标 0）不参与匹配
+    std::size_t count = data.Count() - 1;
+    std::vector<std::vector<Id>> parts(std::max(threads, 1));
+    EntrySorter::ParallelFor(threads, count, [&](int t, std::size_t b, std::size_t e) {
+        std::vector<Id>& part = parts[t];
+        Id first = (Id)b + 1, end = (Id)e + 1;
+        if (literal.empty()) {
+            for (Id id = first; id < end; ++id) {
+                if (!(data.flags[id] & kFlagDeleted) && GlobMatchFolded(glob, data.Name(id), data.NameSize(id)))
+                    part.push_back(id);
+            }
+            return;
+        }
+        // 整段名字缓冲区一次扫描，命中后用二分找到所在记录并跳到下一个名字
+        const char* text = data.names.data();
+        std::size_t pos = data.offsets[first], stop = data.offsets[end];
+        auto offsetsEnd = data.offsets.begin() + end + 1;
+        Id row = first;
+        for (;;) {
+            std::size_t hit = FindFolded(text, pos, stop, literal);
+            if (hit >= stop)
+                break;
+            row = (Id)(std::upper_bound(data.offsets.begin() + row, offsetsEnd, (std::uint32_t)hit) -
+                       data.offsets.begin() - 1);
+            if (!(data.flags[row] & kFlagDeleted) &&
+                (glob.empty() || GlobMatchFolded(glob, data.Name(row), data.NameSize(row))))
+                part.push_back(row);
+            pos = data.offsets[row + 1];
+        }
+    });
+    std::size_t total = 0;
+    for (const auto& part : parts)
+        total += part.size();
+    out.reserve(total);
+    for (const auto& part : parts)
+        out.insert(out.end(), part.begin(), part.end());
+}
+
+bool NameIndex::MatchRecord(const Data& data, Id id, const std::string& pattern, FilterMode mode) {
+    if (id == 0 || (data.flags[id] & kFlagDeleted))
+        return false;
+    const char* name = data.Name(id);
+    std::size_t size = data.NameSize(id);
+    switch (mode) {
+    case FilterMode::Prefix:
+        return FoldedStartsWith(name, size, pattern);
+    case FilterMode::Glob:
+        return GlobMatchFolded(pattern, name, size);
+    default:
+        return FindFolded(name, 0, size, pattern) < size;
+    }
+}
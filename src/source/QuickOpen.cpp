@@ -0,0 +1,112 @@
+// QuickOpen.cpp
+// Ctrl+P "go to file" window implementation for FileMgr
+//
+// Key features:
+// - Query box with keyboard selection (Up/Down, Enter, Escape)
+// - Matches streamed from the background finder while the walk runs
+// - Walk and ranking statistics for the statistics window
+//
+
+#include "../include/QuickOpen.hpp"
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+void QuickOpen::Open(const fs::path& root) {
+    // 同一目录再次打开时沿用已找到的路径
+    if (root != m_finder.GetRoot())
+        m_finder.SetRoot(root);
+    m_open = true;
+    m_focusQuery = true;
+}
+
+void QuickOpen::Draw() {
+    if (!m_open)
+        return;
+
+    // 结果变化时才取回（Poll 会移动整块结果）
+    if (m_finder.Poll(m_result))
+        m_selected = std::min(m_selected, std::max(0, (int)m_result.matches.size() - 1));
+
+    const ImGuiViewport* viewport = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x * 0.5f, viewport->WorkPos.y + 60.0f),
+                            ImGuiCond_Appearing, ImVec2(0.5f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(640, 420), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Go to File", &m_open, ImGuiWindowFlags_NoCollapse)) {
+        ImGui::End();
+        return;
+    }
+
+    if (m_focusQuery) {
+        ImGui::SetKeyboardFocusHere();
+        m_focusQuery = false;
+    }
+    ImGui::SetNextItemWidth(-FLT_MIN);
+    if (ImGui::InputTextWithHint("##query", "File name or path fragments", m_query, sizeof(m_query),
+                                 ImGuiInputTextFlags_AutoSelectAll)) {
+        m_finder.SetQuery(m_query);
+        m_selected = 0;
+        m_scrollToSelected = true;
+    }
+
+    // 方向键移动选中项，回车打开，Esc 关闭
+    int count = (int)m_result.matches.size();
+    bool focused = ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
+    bool chosen = false;
+    if (focused) {
+        if (ImGui::IsKeyPressed(ImGuiKey_DownArrow) && m_selected + 1 < count) {
+            ++m_selected;
+            m_scrollToSelected = true;
+        }
+        if (ImGui::IsKeyPressed(ImGuiKey_UpArrow) && m_selected > 0) {
+            --m_selected;
+            m_scrollToSelected = true;
+        }
+        if (ImGui::IsKeyPressed(ImGuiKey_Enter) || ImGui::IsKeyPressed(ImGuiKey_KeypadEnter))
+            chosen = count > 0;
+        if (ImGui::IsKeyPressed(ImGuiKey_Escape))
+            m_open = false;
+    }
+
+    if (m_query[0] == '\0')
+        ImGui::TextDisabled("%d files%s", (int)m_result.candidates, m_result.walking ? " (searching...)" : "");
+    else
+        ImGui::TextDisabled("%d of %d files%s", (int)m_result.matchCount, (int)m_result.candidates,
+                            m_result.walking ? " (searching...)" : "");
+
+    ImGui::BeginChild("##matches", ImVec2(0, 0), ImGuiChildFlags_Borders);
+    for (int i = 0; i < count; ++i) {
+        ImGui::PushID(i);
+        if (ImGui::Selectable(m_result.matches[i].path.c_str(), i == m_selected)) {
+            m_selected = i;
+            chosen = true;
+        }
+        if (i == m_selected && m_scrollToSelected) {
+            ImGui::SetScrollHereY();
+            m_scrollToSelected = false;
+        }
+        ImGui::PopID();
+    }
+    ImGui::EndChild();
+    ImGui::End();
+
+    if (chosen && m_selected < count)
+        Choose(m_selected);
+}
+
+void QuickOpen::DrawStats() {
+    FuzzyFinder::Stats stats = m_finder.GetLastStats();
+    ImGui::SeparatorText("Go to file");
+    ImGui::Text("Files: %d in %d folders  Walk: %.1f ms", (int)stats.candidates, (int)stats.directories,
+                stats.walkTime.count() / 1000.0);
+    ImGui::Text("Last query: %.2f ms, %d scored (%s), %d threads", stats.queryTime.count() / 1000.0,
+                (int)stats.scored, stats.narrowed ? "narrowed" : "full", stats.threads);
+    ImGui::Text("Memory: %.1f MB", stats.memoryBytes / (1024.0 * 1024.0));
+}
+
+void QuickOpen::Choose(int row) {
+    fs::path path = m_finder.GetRoot() / fs::u8path(m_result.matches[row].path);
+    m_open = false;
+    if (m_onOpen)
+        m_onOpen(path);
+}
@@ -0,0 +1,184 @@
+// SearchBenchmark.cpp
+// Content search benchmark implementation for FileMgr
+//
+// Key features:
+// - Deterministic synthetic corpus of several GB (text, large and binary files)
+// - Throughput per thread count, ignoring and matching case
+// - Matches and skipped binary files checked against the planted counts
+// - Cancellation latency
+//
+
+#include "../include/SearchBenchmark.hpp"
+#include "../include/Common.hpp"
+#include "../include/ContentSearch.hpp"
+#include "../include/EntrySorter.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr int kFolders = 200;                       // 文件分散到 200 个文件夹
+    constexpr int kLargeEvery = 500;                    // 每 500 个文件一个大文件（走内存映射）
+    constexpr std::size_t kLargeSize = 64u << 20;
+    constexpr int kBinaryEvery = 97;                    // 每 97 个文件一个二进制文件
+    constexpr int kNeedleEvery = 5000;                  // 平均每 5000 行一行含目标串
+    const char* const kNeedle = "Xyzzy_Needle";
+    const char* const kNeedleUpper = "XYZZY_NEEDLE";    // 每 4 个目标串有 1 个是大写
+
+    // 完整搜索一遍，收集所有匹配行
+    ContentSearch::Stats Search(ContentSearch& search, const fs::path& root, bool matchCase, int threads,
+                                std::size_t& delivered) {
+        ContentSearch::Options options;
+        options.matchCase = matchCase;
+        options.threads = threads;
+        options.maxMatches = ~std::size_t(0);
+        options.maxPerFile = ~std::size_t(0);
+        ContentSearch::Results results;
+        search.Start(root, kNeedle, options);
+        while (search.IsRunning()) {
+            search.Poll(results);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        search.Poll(results);
+        delivered = results.matches.size();
+        return search.GetStats();
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+int SearchBenchmark::Run(const fs::path& dir, const Options& options) {
+    fs::path folder = dir / "search";
+    Corpus corpus;
+    auto start = std::chrono::steady_clock::now();
+    if (!Generate(folder, options, corpus))
+        return 1;
+    LOG_INFO("Search benchmark: %d files (%d binary), %.2f GB, %llu needle lines (%llu as written) ready (%.1f s)",
+             corpus.files, corpus.binary, corpus.bytes / 1e9, (unsigned long long)corpus.planted,
+             (unsigned long long)corpus.exact, ElapsedSince(start).count() / 1e6);
+
+    // 先搜一遍让语料进入页缓存（语料大于内存时后面的结果受磁盘限制）
+    ContentSearch search;
+    std::size_t delivered = 0;
+    const int maxThreads = options.threads > 0 ? std::min(options.threads, 64) : EntrySorter::DefaultThreadCount();
+    ContentSearch::Stats stats = Search(search, folder, false, maxThreads, delivered);
+    LOG_INFO("Warm-up: %.2f s", stats.time.count() / 1e6);
+
+    bool ok = true;
+    for (int threads = 1;; threads *= 2) {
+        threads = std::min(threads, maxThreads);
+        for (bool matchCase : { false, true }) {
+            stats = Search(search, folder, matchCase, threads, delivered);
+            std::uint64_t expected = matchCase ? corpus.exact : corpus.planted;
+            bool correct = stats.matches == expected && delivered == expected && (int)stats.binary == corpus.binary &&
+                           stats.failed == 0 && !stats.truncated;
+            double seconds = stats.time.count() / 1e6;
+            LOG_INFO("%2d threads, %-12s %.2f GB in %.2f s = %.2f GB/s; %d files, %d binary skipped, %d matches%s",
+                     threads, matchCase ? "match case:" : "ignore case:", stats.bytes / 1e9, seconds,
+                     seconds > 0 ? stats.bytes / 1e9 / seconds : 0.0, (int)stats.files, (int)stats.binary,
+                     (int)stats.matches, correct ? "" : " (MISMATCH)");
+            ok = ok && correct;
+        }
+        if (threads == maxThreads)
+            break;
+    }
+
+    // 取消：开始后不久取消，工作线程在 4 MB 段之间停下
+    ContentSearch::Options cancelOptions;
+    cancelOptions.threads = maxThreads;
+    search.Start(folder, kNeedle, cancelOptions);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    bool wasRunning = search.IsRunning();
+    auto cancelStart = std::chrono::steady_clock::now();
+    search.Cancel();
+    double cancelMs = ElapsedSince(cancelStart).count() / 1e3;
+    bool cancelled = search.GetStats().cancelled || !wasRunning;
+    LOG_INFO("Cancel after 100 ms: %.2f ms%s", cancelMs, cancelled ? "" : " (NOT CANCELLED)");
+    ok = ok && cancelled;
+
+    LOG_INFO("Search benchmark: %s", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+// -----------------------------------------------------------------------------
+// Corpus
+// -----------------------------------------------------------------------------
+
+bool SearchBenchmark::Generate(const fs::path& folder, const Options& options, Corpus& corpus) {
+    // 语料是确定的；完成标记记下大小和内容，大小相同时直接复用
+    std::error_code ec;
+    fs::path complete = folder.parent_path() / "search.complete";
+    {
+        std::ifstream in(complete);
+        int megabytes = -1;
+        unsigned long long bytes, planted, exact;
+        if (in >> megabytes >> corpus.files >> corpus.binary >> bytes >> planted >> exact &&
+            megabytes == options.megabytes) {
+            corpus.bytes = bytes;
+            corpus.planted = planted;
+            corpus.exact = exact;
+            return true;
+        }
+    }
+    LOG_INFO("Search benchmark: writing %d MB to %s", options.megabytes, folder.string().c_str());
+    fs::remove_all(folder, ec);
+    fs::remove(complete, ec);
+    corpus = Corpus();
+
+    static const char* const kWords[] = { "alpha", "beta", "gamma", "delta", "return", "int", "const", "void",
+                                          "namespace", "std::vector", "for", "while", "if", "else", "class",
+                                          "struct", "template", "auto", "nullptr", "size_t" };
+    std::mt19937_64 rng(7);
+    const std::uint64_t target = (std::uint64_t)options.megabytes << 20;
+    std::string text;
+    while (corpus.bytes < target) {
+        int k = corpus.files;
+        char name[64];
+        std::snprintf(name, sizeof(name), "d%02d/s%03d", k % kFolders / 20, k % kFolders);
+        fs::create_directories(folder / name, ec);
+        std::snprintf(name, sizeof(name), "d%02d/s%03d/f%06d.txt", k % kFolders / 20, k % kFolders, k);
+
+        std::size_t size = k % kLargeEvery == 0 ? kLargeSize : 20000 + (std::size_t)(rng() % 200000);
+        bool binary = k % kBinaryEvery == 5;
+        text.clear();
+        if (binary)
+            text.push_back('\0');
+        while (text.size() < size) {
+            int words = 3 + (int)(rng() % 12);
+            for (int w = 0; w < words; ++w) {
+                text += kWords[rng() % 20];
+                text += ' ';
+            }
+            if (rng() % kNeedleEvery == 0) {
+                // 二进制文件里的目标串不会被找到，不计数
+                bool upper = rng() % 4 == 0;
+                text += upper ? kNeedleUpper : kNeedle;
+                if (!binary) {
+                    ++corpus.planted;
+                    corpus.exact += upper ? 0 : 1;
+                }
+            }
+            text += '\n';
+        }
+        std::ofstream out(folder / name, std::ios::binary | std::ios::trunc);
+        out.write(text.data(), (std::streamsize)text.size());
+        if (!out) {
+            LOG_ERROR("Search benchmark: cannot write %s", (folder / name).string().c_str());
+            return false;
+        }
+        corpus.bytes += text.size();
+        corpus.binary += binary ? 1 : 0;
+        ++corpus.files;
+    }
+    std::ofstream(complete) << options.megabytes << " " << corpus.files << " " << corpus.binary << " "
+                            << corpus.bytes << " " << corpus.planted << " " << corpus.exact << "\n";
+    return true;
+}
@@ -0,0 +1,203 @@
+// SearchPanel.cpp
+// "Find in Files" window implementation for FileMgr
+//
+// Key features:
+// - Text, case and thread count controls with Search / Stop
+// - Matches streamed from the background search every frame
+// - Virtualized result table (ImGuiListClipper) with file:line context
+// - Opt-in text index per folder: build, update, and indexed all-words search
+//
+
+#include "../include/SearchPanel.hpp"
+#include "../include/EntrySorter.hpp"
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+void SearchPanel::Open(const fs::path& root) {
+    if (!m_search.IsRunning() && root != m_root) {
+        m_root = root;
+        m_rootLabel = root.u8string();
+        m_seenGeneration = ~0ULL;
+        // 该文件夹（或上级）建过文本索引时载入并按修改时间更新
+        if (!m_index.GetStats().building) {
+            fs::path indexed = TextIndex::FindIndexedRoot(root);
+            if (!indexed.empty() && indexed != m_index.GetRoot())
+                m_index.StartLoad(indexed, true);
+        }
+    }
+    if (m_threads == 0)
+        m_threads = EntrySorter::DefaultThreadCount();
+    m_open = true;
+    m_focusText = true;
+}
+
+void SearchPanel::Draw() {
+    if (!m_open)
+        return;
+
+    ImGui::SetNextWindowSize(ImVec2(760, 480), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Find in Files", &m_open)) {
+        ImGui::End();
+        return;
+    }
+
+    // 后台搜索到的匹配每帧取回，追加到结果表
+    m_search.Poll(m_results);
+    ContentSearch::Stats stats = m_search.GetStats();
+
+    if (m_focusText) {
+        ImGui::SetKeyboardFocusHere();
+        m_focusText = false;
+    }
+    ImGui::SetNextItemWidth(-260.0f);
+    bool submit = ImGui::InputTextWithHint("##text", "Text to find", m_text, sizeof(m_text),
+                                           ImGuiInputTextFlags_EnterReturnsTrue);
+    ImGui::SameLine();
+    ImGui::Checkbox("Match case", &m_matchCase);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(60.0f);
+    if (ImGui::InputInt("Threads", &m_threads, 0))
+        m_threads = std::max(1, std::min(m_threads, 64));
+    ImGui::SameLine();
+    if (stats.running) {
+        if (ImGui::Button("Stop"))
+            m_search.Cancel();
+    } else if (ImGui::Button("Search") || submit) {
+        StartSearch();
+    }
+
+    ImGui::TextDisabled("In %s", m_rootLabel.c_str());
+    DrawIndex();
+    if (m_indexed)
+        ImGui::TextDisabled("Index: %d files contain every word (%.2f ms), searching them for \"%s\"",
+                            (int)m_indexedFiles, m_index.GetLastQueryStats().time.count() / 1000.0,
+                            m_index.GetLastQueryStats().rarest.c_str());
+    if (stats.threads > 0 && !(m_indexed && m_indexedFiles == 0)) {
+        double seconds = stats.time.count() / 1e6;
+        ImGui::TextDisabled("%d matches in %d files  |  %d files, %.1f MB searched (%.0f MB/s), %d binary skipped%s%s",
+                            (int)stats.matches, (int)m_results.files.size(), (int)stats.files, stats.bytes / 1e6,
+                            seconds > 0 ? stats.bytes / 1e6 / seconds : 0.0, (int)stats.binary,
+                            stats.running ? "  (searching...)" : stats.cancelled ? "  (stopped)" : "",
+                            stats.truncated ? "  (result limit reached)" : "");
+    }
+
+    // 只提交可见行
+    if (ImGui::BeginTable("##matches", 2,
+                          ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_Resizable |
+                              ImGuiTableFlags_ScrollY | ImGuiTableFlags_ScrollX)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Location", ImGuiTableColumnFlags_WidthFixed, 280.0f);
+        ImGui::TableSetupColumn("Line", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+
+        ImGuiListClipper clipper;
+        clipper.Begin((int)m_results.matches.size());
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                const ContentSearch::Match& match = m_results.matches[row];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::PushID(row);
+                // 位置列用格式化输出，不拼接字符串
+                bool clicked = ImGui::Selectable("##row", m_selected == row,
+                                                 ImGuiSelectableFlags_SpanAllColumns |
+                                                     ImGuiSelectableFlags_AllowDoubleClick);
+                if (clicked) {
+                    m_selected = row;
+                    if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left) && m_onOpen)
+                        m_onOpen(m_search.GetRoot() / fs::u8path(m_results.files[match.file]));
+                }
+                ImGui::SameLine(0.0f, 0.0f);
+                ImGui::Text("%s:%u", m_results.files[match.file].c_str(), match.line);
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(match.text.c_str(), match.text.c_str() + match.text.size());
+                ImGui::PopID();
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+void SearchPanel::StartSearch() {
+    m_results.Clear();
+    m_selected = -1;
+    m_indexed = false;
+    if (m_text[0] == '\0')
+        return;
+    ContentSearch::Options options;
+    options.matchCase = m_matchCase;
+    options.threads = m_threads;
+    if (!m_useIndex || !m_indexCovers) {
+        m_search.Start(m_root, m_text, options);
+        return;
+    }
+
+    // 索引给出包含所有词的文件，只读这些文件，列出含最少见词的行
+    m_indexed = true;
+    const std::vector<TextIndex::DocId>& docs = m_index.Query(m_text);
+    for (TextIndex::DocId doc : docs) {
+        std::string path = m_index.GetPath(doc);
+        if (path.compare(0, m_indexPrefix.size(), m_indexPrefix) == 0)
+            options.files.push_back(path.substr(m_indexPrefix.size()));
+    }
+    m_indexedFiles = options.files.size();
+    if (options.files.empty()) {
+        m_search.Cancel();
+        return;
+    }
+    options.matchCase = false;
+    m_search.Start(m_root, m_index.GetLastQueryStats().rarest, options);
+}
+
+void SearchPanel::DrawIndex() {
+    TextIndex::Stats stats = m_index.GetStats();
+    if (stats.generation != m_seenGeneration) {
+        m_seenGeneration = stats.generation;
+        UpdateIndexCoverage();
+    }
+
+    if (stats.building) {
+        ImGui::TextDisabled("Text index: %s %d files, %d read, %.1f MB (%.1f s)...",
+                            stats.ready ? "updating," : "indexing,", (int)stats.walked, (int)stats.read,
+                            stats.bytes / 1e6, stats.buildTime.count() / 1e6);
+        return;
+    }
+    if (!m_indexCovers) {
+        ImGui::TextDisabled("No text index for this folder.");
+        ImGui::SameLine();
+        ImGui::BeginDisabled(m_root.empty());
+        if (ImGui::SmallButton("Index this folder"))
+            m_index.StartBuild(m_root);
+        ImGui::EndDisabled();
+        return;
+    }
+
+    ImGui::Checkbox("Use index (whole words, all of them)", &m_useIndex);
+    ImGui::SameLine();
+    ImGui::TextDisabled("%s: %d files, %d words, %.1f MB postings  |  last pass: %d read, %d unchanged in %.2f s",
+                        m_indexLabel.c_str(), (int)stats.documents, (int)stats.words, stats.postingBytes / 1e6,
+                        (int)stats.read, (int)stats.reused, stats.buildTime.count() / 1e6);
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Update"))
+        m_index.StartUpdate();
+}
+
+void SearchPanel::UpdateIndexCoverage() {
+    // 根目录或索引变化时才计算，绘制时不分配
+    fs::path indexRoot = m_index.GetRoot();
+    m_indexLabel = indexRoot.u8string();
+    m_indexPrefix.clear();
+    m_indexCovers = false;
+    if (indexRoot.empty() || m_root.empty())
+        return;
+    fs::path relative = m_root.lexically_normal().lexically_relative(indexRoot);
+    if (relative.empty() || *relative.begin() == "..")
+        return;
+    m_indexCovers = true;
+    if (relative != ".") {
+        m_indexPrefix = relative.u8string();
+        m_indexPrefix += (char)fs::path::preferred_separator;
+    }
+}
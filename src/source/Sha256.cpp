@@ -0,0 +1,118 @@
+// Sha256.cpp
+// SHA-256 implementation for FileMgr
+//
+// Key features:
+// - FIPS 180-4 compression function on 64-byte blocks
+// - Streaming updates of any size with a 64-byte carry buffer
+//
+
+#include "../include/Sha256.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr std::uint32_t kRound[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+    };
+
+    inline std::uint32_t RotateRight(std::uint32_t x, int r) {
+        return (x >> r) | (x << (32 - r));
+    }
+
+    // 大端读取
+    inline std::uint32_t ReadBig32(const unsigned char* p) {
+        return ((std::uint32_t)p[0] << 24) | ((std::uint32_t)p[1] << 16) | ((std::uint32_t)p[2] << 8) | p[3];
+    }
+}
+
+void Sha256::Reset() {
+    static const std::uint32_t initial[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                              0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    std::memcpy(m_state, initial, sizeof(m_state));
+    m_total = 0;
+    m_buffered = 0;
+}
+
+void Sha256::Update(const void* data, std::size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    m_total += size;
+
+    // 先补齐上次剩下的不完整块
+    if (m_buffered > 0) {
+        std::size_t take = std::min(size, sizeof(m_buffer) - m_buffered);
+        std::memcpy(m_buffer + m_buffered, p, take);
+        m_buffered += take;
+        p += take;
+        size -= take;
+        if (m_buffered < sizeof(m_buffer))
+            return;
+        Transform(m_buffer);
+        m_buffered = 0;
+    }
+    for (; size >= 64; p += 64, size -= 64)
+        Transform(p);
+    std::memcpy(m_buffer, p, size);
+    m_buffered = size;
+}
+
+void Sha256::Digest(unsigned char* digest) const {
+    // 在副本上补位：0x80、零和 64 位大端位长
+    Sha256 copy = *this;
+    std::uint64_t bits = m_total * 8;
+    unsigned char padding[72] = { 0x80 };
+    std::size_t padSize = (m_buffered < 56 ? 56 : 120) - m_buffered;
+    for (int k = 0; k < 8; ++k)
+        padding[padSize + k] = (unsigned char)(bits >> (56 - 8 * k));
+    copy.Update(padding, padSize + 8);
+    for (int k = 0; k < 8; ++k) {
+        digest[4 * k] = (unsigned char)(copy.m_state[k] >> 24);
+        digest[4 * k + 1] = (unsigned char)(copy.m_state[k] >> 16);
+        digest[4 * k + 2] = (unsigned char)(copy.m_state[k] >> 8);
+        digest[4 * k + 3] = (unsigned char)copy.m_state[k];
+    }
+}
+
+void Sha256::Transform(const unsigned char* block) {
+    std::uint32_t w[64];
+    for (int k = 0; k < 16; ++k)
+        w[k] = ReadBig32(block + 4 * k);
+    for (int k = 16; k < 64; ++k) {
+        std::uint32_t s0 = RotateRight(w[k - 15], 7) ^ RotateRight(w[k - 15], 18) ^ (w[k - 15] >> 3);
+        std::uint32_t s1 = RotateRight(w[k - 2], 17) ^ RotateRight(w[k - 2], 19) ^ (w[k - 2] >> 10);
+        w[k] = w[k - 16] + s0 + w[k - 7] + s1;
+    }
+
+    std::uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+    std::uint32_t e = m_state[4], f = m_state[5], g = m_state[6], h = m_state[7];
+    for (int k = 0; k < 64; ++k) {
+        std::uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+        std::uint32_t choose = (e & f) ^ (~e & g);
+        std::uint32_t t1 = h + s1 + choose + kRound[k] + w[k];
+        std::uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+        std::uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+        std::uint32_t t2 = s0 + majority;
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    m_state[0] += a;
+    m_state[1] += b;
+    m_state[2] += c;
+    m_state[3] += d;
+    m_state[4] += e;
+    m_state[5] += f;
+    m_state[6] += g;
+    m_state[7] += h;
+}
@@ -8,9 +8,12 @@
 // Key features:
 // - Shows all logical drives on Windows
 // - Recursive directory tree expansion
-// - Caching of directory contents
+// - Caching of directory contents (shared with the file list)
+// - Labels and icons cached per node (no allocation while drawing)
+// - Cached listings dropped on filesystem change notifications
+// - Expanded nodes and listings restored from the listing store
 // - Integration with IconCache for drive/folder icons
-// - Click-to-navigate callback system
+// - Click-to-navigate and hover (prefetch) callbacks
 // 
 
 #include "../include/SidebarTree.hpp"
@@ -22,75 +25,177 @@
 
 namespace fs = std::filesystem;
 
-SidebarTree::SidebarTree(IconCache* iconCache) : m_iconCache(iconCache) {}
+namespace {
+    constexpr std::size_t kRevalidatePerFrame = 8; // 每帧最多校验的目录数
+}
+
+SidebarTree::SidebarTree(IconCache* iconCache, SnapshotCache* snapshots, const ListingStore* store)
+    : m_iconCache(iconCache), m_snapshots(snapshots), m_store(store), m_expandedGeneration(0),
+      m_firstFrameDrawn(false) {
+    if (m_store) {
+        for (const auto& p : m_store->GetExpandedPaths())
+            m_expanded.insert(p.native());
+    }
+}
+
+std::vector<fs::path> SidebarTree::GetExpandedPaths() const {
+    std::vector<fs::path> paths;
+    paths.reserve(m_expanded.size());
+    for (const auto& key : m_expanded)
+        paths.emplace_back(key);
+    return paths;
+}
+
+void SidebarTree::Invalidate(const fs::path& path) {
+    // 子目录列表和共享快照一起丢弃，节点下次绘制时重新读取
+    m_dirCache.erase(path.native());
+    m_snapshots->Erase(path);
+}
 
 void SidebarTree::Draw() {
     DWORD drives = GetLogicalDrives();
     for (int i = 0; i < 26; ++i) {
         if (drives & (1 << i)) {
-            wchar_t root[4] = { wchar_t(L'A' + i), L':', L'\\', L'\0' };
-            fs::path drivePath(root);
-            std::string display = std::string(1, char('A' + i)) + ": Drive";
-            DrawTreeNode(drivePath, display);
+            Node& drive = m_drives[i];
+            if (drive.path.empty()) {
+                wchar_t root[4] = { wchar_t(L'A' + i), L':', L'\\', L'\0' };
+                drive.path = root;
+                drive.label = std::string(1, char('A' + i)) + ": Drive";
+            }
+            DrawTreeNode(drive);
         }
     }
+
+    // 首帧完全依赖缓存绘制；之后每帧少量校验，避免一次性 stat 大量目录
+    if (m_firstFrameDrawn)
+        RevalidateSeeded(kRevalidatePerFrame);
+    m_firstFrameDrawn = true;
+}
+
+void SidebarTree::RevalidateSeeded(std::size_t maxChecks) {
+    for (std::size_t i = 0; i < maxChecks && !m_revalidateQueue.empty(); ++i) {
+        fs::path path = std::move(m_revalidateQueue.back());
+        m_revalidateQueue.pop_back();
+        auto it = m_dirCache.find(path.native());
+        if (it == m_dirCache.end())
+            continue;
+        std::chrono::system_clock::time_point writeTime;
+        if (QueryWriteTime(path, writeTime) && writeTime == it->second.lastWriteTime)
+            continue;
+        // 目录已变化（或已不存在）：丢弃旧列表，下一帧重新读取
+        m_dirCache.erase(it);
+        m_snapshots->Erase(path);
+    }
 }
 
-void SidebarTree::DrawTreeNode(const fs::path& path, const std::string& displayName) {
-    ImGui::PushID(path.string().c_str());
+void SidebarTree::DrawTreeNode(Node& node) {
+    // ID 直接取路径的原生字符串字节，不做编码转换
+    const PathKey& key = node.path.native();
+    const char* idBegin = reinterpret_cast<const char*>(key.data());
+    ImGui::PushID(idBegin, idBegin + key.size() * sizeof(PathKey::value_type));
 
     ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick;
-    bool hasChildren = false;
-    try {
-        if (fs::exists(path) && fs::is_directory(path)) {
-            for (auto& entry : fs::directory_iterator(path)) {
-                if (entry.is_directory()) {
-                    hasChildren = true;
-                    break;
-                }
-            }
-        }
-    } catch (...) {
-    }
+    // 子目录列表来自缓存，不再每帧遍历目录
+    std::vector<Node>& subDirs = GetSubDirectories(node.path);
+    bool hasChildren = !subDirs.empty();
 
     if (!hasChildren)
         flags |= ImGuiTreeNodeFlags_Leaf;
 
-    ImTextureID iconTex = m_iconCache->GetTexture(path, true);
-    ImGui::Image(iconTex, ImVec2(16, 16)); ImGui::SameLine();
-
-    bool nodeOpen = ImGui::TreeNodeEx(path.c_str(), flags, "%s", displayName.c_str());
+    if (!node.iconLoaded) {
+        node.icon = m_iconCache->GetTexture(node.path, true);
+        node.iconLoaded = true;
+    }
+    ImGui::Image(node.icon, ImVec2(16, 16)); ImGui::SameLine();
+
+    // 恢复上次会话展开的节点（ID 已由 PushID 区分，节点本身用固定 ID）
+    if (m_expanded.count(key))
+        ImGui::SetNextItemOpen(true, ImGuiCond_Once);
+    bool nodeOpen = ImGui::TreeNodeEx("node", flags, "%s", node.label.c_str());
+    // 展开集合变化时递增计数，监视器据此更新监视的目录
+    if (nodeOpen && hasChildren) {
+        if (m_expanded.insert(key).second)
+            ++m_expandedGeneration;
+    } else if (m_expanded.erase(key)) {
+        ++m_expandedGeneration;
+    }
 
     if (ImGui::IsItemClicked() && m_onFolderSelected) {
-        m_onFolderSelected(path);
+        m_onFolderSelected(node.path);
+    }
+    // 每次悬停只通知一次
+    bool hovered = ImGui::IsItemHovered(ImGuiHoveredFlags_DelayShort | ImGuiHoveredFlags_NoSharedDelay);
+    if (m_onFolderHovered && hovered && !node.hovered) {
+        m_onFolderHovered(node.path);
     }
+    node.hovered = hovered;
 
     if (nodeOpen) {
-        if (hasChildren) {
-            const auto& subDirs = GetSubDirectories(path);
-            for (const auto& subPath : subDirs) {
-                std::string subName = subPath.filename().u8string();
-                DrawTreeNode(subPath, subName);
-            }
-        }
+        for (Node& child : subDirs)
+            DrawTreeNode(child);
         ImGui::TreePop();
     }
 
     ImGui::PopID();
 }
 
-const std::vector<fs::path>& SidebarTree::GetSubDirectories(const fs::path& path) {
-    auto it = m_dirCache.find(path.wstring());
+// 显示名在缓存目录时生成一次，绘制时直接使用
+SidebarTree::Node SidebarTree::MakeNode(fs::path path) {
+    Node node;
+    node.label = path.filename().u8string();
+    node.path = std::move(path);
+    return node;
+}
+
+std::vector<SidebarTree::Node>& SidebarTree::GetSubDirectories(const fs::path& path) {
+    auto it = m_dirCache.find(path.native());
     if (it != m_dirCache.end()) {
         return it->second.subDirs;
     }
 
     DirCache cache;
+    // 先查共享快照缓存，再查上次会话保存的列表；首帧拿到的列表稍后按 mtime 校验
+    std::shared_ptr<const DirSnapshot> snapshot = m_snapshots->Peek(path);
+    if (!snapshot && m_store && m_store->IsOpen()) {
+        if (std::shared_ptr<DirSnapshot> stored = m_store->Find(path)) {
+            m_snapshots->Put(stored);
+            snapshot = stored;
+        }
+    }
+    if (snapshot) {
+        const EntryStore& entries = snapshot->entries;
+        for (EntryStore::Index i : entries.GetOrder()) {
+            if (entries.IsDirectory(i))
+                cache.subDirs.push_back(MakeNode(path / fs::path(entries.GetName(i))));
+        }
+        cache.lastWriteTime = snapshot->dirWriteTime;
+        if (!m_firstFrameDrawn)
+            m_revalidateQueue.push_back(path);
+        DirCache& entry = m_dirCache[path.native()];
+        entry = std::move(cache);
+        return entry.subDirs;
+    }
+
     try {
-        for (auto& entry : fs::directory_iterator(path)) {
-            if (entry.is_directory()) {
-                cache.subDirs.push_back(entry.path());
+        auto listing = std::make_shared<DirSnapshot>();
+        listing->dir = path;
+        bool haveWriteTime = QueryWriteTime(path, listing->dirWriteTime);
+        std::error_code ec;
+        DirEnumerator::Create(EnumBackend::Auto)->Enumerate(path, [&](std::vector<ScanEntry>& chunk) {
+            for (const auto& se : chunk) {
+                if (se.isDirectory)
+                    cache.subDirs.push_back(MakeNode(path / se.name));
             }
+            listing->entries.Append(chunk);
+            return true;
+        }, ec);
+        if (ec) {
+            LOG_ERROR("Filesystem error in GetSubDirectories for path %s: %s", path.string().c_str(), ec.message().c_str());
+        } else if (haveWriteTime) {
+            // 完整列表放入共享缓存，文件列表打开该目录时可直接使用
+            cache.lastWriteTime = listing->dirWriteTime;
+            listing->entries.Sort();
+            m_snapshots->Put(std::move(listing));
         }
     } catch (const fs::filesystem_error& e) {
         LOG_ERROR("Filesystem error in GetSubDirectories for path %s: %s", path.string().c_str(), e.what());
@@ -101,8 +206,9 @@ const std::vector<fs::path>& SidebarTree::GetSubDirectories(const fs::path& path
     }
 
     std::sort(cache.subDirs.begin(), cache.subDirs.end(),
-        [](const fs::path& a, const fs::path& b) { return a.filename() < b.filename(); });
+        [](const Node& a, const Node& b) { return a.path.filename() < b.path.filename(); });
 
-    m_dirCache[path.wstring()] = std::move(cache);
-    return m_dirCache[path.wstring()].subDirs;
+    DirCache& entry = m_dirCache[path.native()];
+    entry = std::move(cache);
+    return entry.subDirs;
 }
\ No newline at end of file
@@ -0,0 +1,117 @@
+// SnapshotCache.cpp
+// LRU directory snapshot cache implementation for FileMgr
+//
+// A classic list + hash map LRU. The list owns shared pointers so a snapshot
+// handed out by Get() stays valid for the caller even if it is evicted or
+// replaced in the meantime.
+//
+// Key features:
+// - Memory-budgeted (approximate bytes, not entry count)
+// - Hit / miss / eviction counters
+// - Thread-safe (UI thread and background workers)
+//
+
+#include "../include/SnapshotCache.hpp"
+
+namespace fs = std::filesystem;
+
+SnapshotCache::SnapshotCache(std::size_t budgetBytes) {
+    m_stats.budget = budgetBytes;
+}
+
+SnapshotCache::Key SnapshotCache::MakeKey(const fs::path& dir) {
+    // 统一去掉末尾分隔符，"C:\foo\" 与 "C:\foo" 视为同一目录
+    fs::path normal = dir.lexically_normal();
+    if (!normal.has_filename() && normal.has_relative_path())
+        normal = normal.parent_path();
+    return normal.native();
+}
+
+std::size_t SnapshotCache::EstimateBytes(const EntryStore& entries) {
+    return sizeof(DirSnapshot) - sizeof(EntryStore) + entries.GetMemoryBytes();
+}
+
+std::shared_ptr<const DirSnapshot> SnapshotCache::Get(const fs::path& dir) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(MakeKey(dir));
+    if (it == m_index.end()) {
+        ++m_stats.misses;
+        return nullptr;
+    }
+    ++m_stats.hits;
+    // 移到链表头部（最近使用）
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return *it->second;
+}
+
+std::shared_ptr<const DirSnapshot> SnapshotCache::Peek(const fs::path& dir) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(MakeKey(dir));
+    return it == m_index.end() ? nullptr : *it->second;
+}
+
+void SnapshotCache::Put(std::shared_ptr<DirSnapshot> snapshot) {
+    if (!snapshot)
+        return;
+    // 缓存的快照不再增长，释放多余容量
+    snapshot->entries.ShrinkToFit();
+    snapshot->bytes = EstimateBytes(snapshot->entries);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Key key = MakeKey(snapshot->dir);
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_stats.bytes -= (*it->second)->bytes;
+        m_lru.erase(it->second);
+        m_index.erase(it);
+    }
+    // 单个快照超过整个预算时不缓存，否则会把其他所有条目挤出去
+    if (snapshot->bytes > m_stats.budget) {
+        m_stats.count = m_index.size();
+        return;
+    }
+
+    m_stats.bytes += snapshot->bytes;
+    m_lru.push_front(std::move(snapshot));
+    m_index[key] = m_lru.begin();
+    EvictToBudget();
+    m_stats.count = m_index.size();
+}
+
+void SnapshotCache::Erase(const fs::path& dir) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(MakeKey(dir));
+    if (it == m_index.end())
+        return;
+    m_stats.bytes -= (*it->second)->bytes;
+    m_lru.erase(it->second);
+    m_index.erase(it);
+    m_stats.count = m_index.size();
+}
+
+void SnapshotCache::SetBudget(std::size_t budgetBytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.budget = budgetBytes;
+    EvictToBudget();
+    m_stats.count = m_index.size();
+}
+
+SnapshotCache::Stats SnapshotCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+std::vector<std::shared_ptr<const DirSnapshot>> SnapshotCache::GetAll() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::vector<std::shared_ptr<const DirSnapshot>>(m_lru.begin(), m_lru.end());
+}
+
+void SnapshotCache::EvictToBudget() {
+    while (m_stats.bytes > m_stats.budget && !m_lru.empty()) {
+        const auto& victim = m_lru.back();
+        m_stats.bytes -= victim->bytes;
+        m_index.erase(MakeKey(victim->dir));
+        m_lru.pop_back();
+        ++m_stats.evictions;
+    }
+}
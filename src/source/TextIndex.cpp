@@ -0,0 +1,1064 @@
+// TextIndex.cpp
+// Full-text inverted index implementation for FileMgr
+//
+// Key features:
+// - Parallel walk, then parallel tokenizing into per-worker postings
+// - Varint delta postings with a skip table every 128 documents
+// - AND queries: rarest list first, skip-table intersection with the others
+// - Incremental update by size / modification time, compaction of deleted documents
+// - One index file per root in the cache folder (temporary file, then rename)
+//
+
+#include "../include/TextIndex.hpp"
+#include "../include/Common.hpp"
+#include "../include/DirEnumerator.hpp"
+#include "../include/EntrySorter.hpp"
+#include "../include/ListingStore.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr char kMagic[4] = { 'F', 'M', 'T', 'I' };
+    constexpr std::uint32_t kVersion = 1;
+
+    constexpr std::uint32_t kSkipInterval = 128;        // 每 128 个文档记一个跳表项
+    constexpr std::size_t kReadChunk = 1 << 20;         // 每次读取 1 MB
+    constexpr std::size_t kBinaryProbe = 8192;          // 检查前 8 KB 是否有 NUL
+    constexpr std::size_t kArenaBlock = 1 << 16;        // 每个线程的词表存储块
+    constexpr int kMaxDepth = 64;                       // 防止符号链接环无限下探
+
+    struct FileHeader {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t documents;
+        std::uint32_t deleted;
+        std::uint64_t words;
+        std::uint64_t postings;
+        std::uint64_t pathBytes;           // Paths, each followed by '\0'
+        std::uint32_t rootLength;          // UTF-8 bytes of the root path (follows the header)
+        std::uint32_t reserved;
+    };
+
+    // Per-word header in the index file (followed by the word, the postings and the skips)
+    struct WordHeader {
+        std::uint32_t length;
+        std::uint32_t count;
+        std::uint32_t last;
+        std::uint32_t bytes;
+        std::uint32_t skips;
+    };
+
+    // 词字符映射：ASCII 字母转小写，数字、'_' 和 UTF-8 字节原样保留，其余为 0（分隔符）
+    struct WordTable {
+        unsigned char map[256];
+        constexpr WordTable() : map() {
+            for (int c = 0; c < 256; ++c) {
+                if (c >= 'A' && c <= 'Z')
+                    map[c] = (unsigned char)(c - 'A' + 'a');
+                else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_' || c >= 0x80)
+                    map[c] = (unsigned char)c;
+            }
+        }
+    };
+    constexpr WordTable kWords;
+
+    inline bool IsWordByte(char c) {
+        return kWords.map[(unsigned char)c] != 0;
+    }
+
+    // 把文本中的词就地转成小写，长度合适的词交给 fn(word, size)
+    template <typename Fn>
+    void ForEachWord(char* text, std::size_t size, Fn fn) {
+        std::size_t i = 0;
+        while (i < size) {
+            while (i < size && !IsWordByte(text[i]))
+                ++i;
+            std::size_t start = i;
+            for (unsigned char c; i < size && (c = kWords.map[(unsigned char)text[i]]) != 0; ++i)
+                text[i] = (char)c;
+            std::size_t n = i - start;
+            if (n >= TextIndex::kMinWord && n <= TextIndex::kMaxWord)
+                fn(text + start, n);
+        }
+    }
+
+    inline void PutVarint(std::vector<std::uint8_t>& out, std::uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back((std::uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((std::uint8_t)value);
+    }
+
+    inline std::uint32_t GetVarint(const std::uint8_t*& p) {
+        std::uint32_t value = *p & 0x7F;
+        for (int shift = 7; *p++ & 0x80; shift += 7)
+            value |= (std::uint32_t)(*p & 0x7F) << shift;
+        return value;
+    }
+
+    std::int64_t ToNanos(std::chrono::system_clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    }
+
+    // 名字转成 UTF-8（Linux 上本来就是字节串，直接复制）
+    inline void ToUtf8(const fs::path::string_type& name, std::string& out) {
+#ifdef _WIN32
+        out = fs::path(name).u8string();
+#else
+        out = name;
+#endif
+    }
+
+    // 去掉末尾的分隔符，同一文件夹只对应一个索引文件
+    fs::path NormalRoot(const fs::path& root) {
+        fs::path normal = root.lexically_normal();
+        if (!normal.has_filename() && normal != normal.root_path())
+            normal = normal.parent_path();
+        return normal;
+    }
+
+    template <typename T>
+    void WriteArray(std::ofstream& out, const std::vector<T>& v) {
+        out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+    }
+
+    template <typename T>
+    bool ReadArray(std::ifstream& in, std::vector<T>& v, std::size_t count) {
+        v.resize(count);
+        in.read(reinterpret_cast<char*>(v.data()), count * sizeof(T));
+        return (bool)in;
+    }
+
+    // 顺序读文件（只读共享打开）
+    class FileReader {
+    public:
+        explicit FileReader(const fs::path& path) {
+#ifdef _WIN32
+            m_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                   nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+#else
+            m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+        }
+
+        ~FileReader() {
+#ifdef _WIN32
+            if (m_handle != INVALID_HANDLE_VALUE)
+                CloseHandle(m_handle);
+#else
+            if (m_fd >= 0)
+                ::close(m_fd);
+#endif
+        }
+
+        bool IsOpen() const {
+#ifdef _WIN32
+            return m_handle != INVALID_HANDLE_VALUE;
+#else
+            return m_fd >= 0;
+#endif
+        }
+
+        // @return Bytes read (0 at the end of the file or on error)
+        std::size_t Read(char* buffer, std::size_t size) {
+#ifdef _WIN32
+            DWORD read = 0;
+            if (!ReadFile(m_handle, buffer, (DWORD)size, &read, nullptr))
+                return 0;
+            return read;
+#else
+            ssize_t r = ::read(m_fd, buffer, size);
+            return r > 0 ? (std::size_t)r : 0;
+#endif
+        }
+
+    private:
+#ifdef _WIN32
+        HANDLE m_handle;
+#else
+        int m_fd;
+#endif
+    };
+}
+
+// -----------------------------------------------------------------------------
+// Postings
+// -----------------------------------------------------------------------------
+
+void TextIndex::Postings::Append(DocId doc) {
+    // 跳表项记录块之前的文档号，从块首解码时以它为基准
+    if (count > 0 && count % kSkipInterval == 0)
+        skips.push_back({ last, (std::uint32_t)bytes.size() });
+    PutVarint(bytes, count == 0 ? doc : doc - last);
+    last = doc;
+    ++count;
+}
+
+std::size_t TextIndex::Postings::MemoryBytes() const {
+    return bytes.capacity() + skips.capacity() * sizeof(Skip);
+}
+
+class TextIndex::Cursor {
+public:
+    explicit Cursor(const Postings& postings)
+        : m_postings(postings), m_p(postings.bytes.data()), m_end(postings.bytes.data() + postings.bytes.size()) {
+        Next();
+    }
+
+    bool AtEnd() const { return m_done; }
+    DocId Doc() const { return m_doc; }
+    std::uint64_t Decoded() const { return m_decoded; }
+
+    void Next() {
+        if (m_p >= m_end) {
+            m_done = true;
+            return;
+        }
+        m_doc += GetVarint(m_p);
+        ++m_decoded;
+    }
+
+    // Advance to the first document >= target
+    void SkipTo(DocId target) {
+        if (m_done || m_doc >= target)
+            return;
+        // 跳过所有最后一个文档小于目标的块
+        const std::vector<Skip>& skips = m_postings.skips;
+        const std::uint8_t* base = m_postings.bytes.data();
+        while (m_skip < skips.size() && skips[m_skip].doc < target) {
+            if (base + skips[m_skip].offset >= m_p) {
+                m_p = base + skips[m_skip].offset;
+                m_doc = skips[m_skip].doc;
+            }
+            ++m_skip;
+        }
+        while (!m_done && m_doc < target)
+            Next();
+    }
+
+private:
+    const Postings& m_postings;
+    const std::uint8_t* m_p;
+    const std::uint8_t* m_end;
+    std::size_t m_skip = 0;
+    DocId m_doc = 0;
+    std::uint64_t m_decoded = 0;
+    bool m_done = false;
+};
+
+// Postings of one worker. Words live in the worker's own storage blocks and
+// are found through an open-addressing table whose slots also hold the last
+// document, so a repeated word costs one probe and no allocation.
+struct TextIndex::Segment {
+    struct Slot {
+        const char* word = nullptr;                // Null for an empty slot
+        std::uint32_t size = 0;
+        std::uint32_t hash = 0;
+        std::uint32_t index = 0;                   // Into postings
+        DocId last = 0;
+    };
+
+    std::vector<Slot> slots = std::vector<Slot>(1 << 12);
+    std::vector<Postings> postings;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::size_t used = kArenaBlock;
+
+    static std::uint32_t Hash(const char* word, std::size_t size) {
+        std::uint32_t hash = 2166136261u;
+        for (std::size_t k = 0; k < size; ++k)
+            hash = (hash ^ (unsigned char)word[k]) * 16777619u;
+        return hash;
+    }
+
+    // @return The slot of the word, or the empty slot where it belongs
+    Slot& Find(const char* word, std::size_t size, std::uint32_t hash) {
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t k = hash & mask;; k = (k + 1) & mask) {
+            Slot& slot = slots[k];
+            if (!slot.word || (slot.hash == hash && slot.size == size && std::memcmp(slot.word, word, size) == 0))
+                return slot;
+        }
+    }
+
+    void Add(const char* word, std::size_t size, DocId doc) {
+        std::uint32_t hash = Hash(word, size);
+        Slot* slot = &Find(word, size, hash);
+        if (slot->word) {
+            if (slot->last == doc)
+                return;     // 同一文件中重复出现
+        } else {
+            // 装载率超过一半时表扩大一倍
+            if ((postings.size() + 1) * 2 > slots.size()) {
+                Grow();
+                slot = &Find(word, size, hash);
+            }
+            if (used + size > kArenaBlock) {
+                blocks.emplace_back(new char[kArenaBlock]);
+                used = 0;
+            }
+            char* stored = blocks.back().get() + used;
+            std::memcpy(stored, word, size);
+            used += size;
+            *slot = { stored, (std::uint32_t)size, hash, (std::uint32_t)postings.size(), doc };
+            postings.emplace_back();
+        }
+        slot->last = doc;
+        postings[slot->index].Append(doc);
+    }
+
+    void Grow() {
+        std::vector<Slot> old(slots.size() * 2);
+        old.swap(slots);
+        std::size_t mask = slots.size() - 1;
+        for (const Slot& slot : old) {
+            if (!slot.word)
+                continue;
+            std::size_t k = slot.hash & mask;
+            while (slots[k].word)
+                k = (k + 1) & mask;
+            slots[k] = slot;
+        }
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Data
+// -----------------------------------------------------------------------------
+
+void TextIndex::Data::Measure() {
+    postingBytes = 0;
+    memoryBytes = 0;
+    for (const auto& word : words) {
+        postingBytes += word.second.MemoryBytes();
+        memoryBytes += word.first.capacity() + sizeof(word) + 2 * sizeof(void*);
+    }
+    memoryBytes += postingBytes + words.bucket_count() * sizeof(void*);
+    for (const std::string& path : paths)
+        memoryBytes += sizeof(path) + (path.size() > 15 ? path.capacity() : 0);
+    memoryBytes += sizes.capacity() * sizeof(std::uint64_t) + times.capacity() * sizeof(std::int64_t) +
+                   deleted.capacity();
+}
+
+// -----------------------------------------------------------------------------
+// Construction / Destruction
+// -----------------------------------------------------------------------------
+
+TextIndex::~TextIndex() {
+    m_cancel = true;
+    if (m_worker.joinable())
+        m_worker.join();
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+void TextIndex::StartBuild(const fs::path& root, int threads) {
+    threads = threads > 0 ? std::min(threads, 64) : EntrySorter::DefaultThreadCount();
+    BeginPass(threads);
+    m_worker = std::thread([this, root = NormalRoot(root), threads] {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<FileInfo> files;
+        auto data = std::make_unique<Data>();
+        data->root = root;
+        if (!Walk(root, threads, files) ||
+            !Tokenize(files, 0, threads, data->words, data->postingCount)) {
+            EndPass(ElapsedSince(start));
+            return;
+        }
+        for (FileInfo& file : files) {
+            data->paths.push_back(std::move(file.relative));
+            data->sizes.push_back(file.size);
+            data->times.push_back(file.time);
+        }
+        data->deleted.assign(files.size(), 0);
+        data->Measure();
+
+        std::chrono::microseconds time = ElapsedSince(start);
+        Stats stats = GetStats();
+        LOG_INFO("Text index of %s: %u files, %.1f MB in %.2f s (%.0f MB/s, %d threads), %llu words, "
+                 "%llu postings in %.1f MB",
+                 root.string().c_str(), data->Count(), stats.bytes / 1e6, time.count() / 1e6,
+                 time.count() > 0 ? stats.bytes / (double)time.count() : 0.0, threads,
+                 (unsigned long long)data->words.size(), (unsigned long long)data->postingCount,
+                 data->postingBytes / 1e6);
+        Write(*data, GetIndexPath(root));
+        Install(std::move(data));
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_stats.loaded = false;
+        }
+        EndPass(time);
+    });
+}
+
+void TextIndex::StartUpdate(int threads) {
+    {
+        std::shared_lock<std::shared_mutex> lock(m_dataMutex);
+        if (!m_data)
+            return;
+    }
+    threads = threads > 0 ? std::min(threads, 64) : EntrySorter::DefaultThreadCount();
+    BeginPass(threads);
+    m_worker = std::thread([this, threads] {
+        auto start = std::chrono::steady_clock::now();
+        if (Update(threads)) {
+            std::shared_lock<std::shared_mutex> lock(m_dataMutex);
+            Write(*m_data, GetIndexPath(m_data->root));
+        }
+        EndPass(ElapsedSince(start));
+    });
+}
+
+void TextIndex::StartLoad(const fs::path& root, bool update) {
+    int threads = EntrySorter::DefaultThreadCount();
+    BeginPass(threads);
+    m_worker = std::thread([this, root = NormalRoot(root), update, threads] {
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<Data> data = Read(GetIndexPath(root));
+        if (data && data->root != root) {
+            LOG_ERROR("Text index %s belongs to %s", GetIndexPath(root).string().c_str(),
+                      data->root.string().c_str());
+            data.reset();
+        }
+        if (!data) {
+            EndPass(ElapsedSince(start));
+            return;
+        }
+        Install(std::move(data));
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_stats.loaded = true;
+        }
+        // 载入后按大小和修改时间找出变化的文件
+        if (update && Update(threads)) {
+            std::shared_lock<std::shared_mutex> lock(m_dataMutex);
+            Write(*m_data, GetIndexPath(root));
+        }
+        EndPass(ElapsedSince(start));
+    });
+}
+
+TextIndex::Stats TextIndex::GetStats() const {
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        stats = m_stats;
+        if (stats.building)
+            stats.buildTime = ElapsedSince(m_passStart);
+    }
+    std::shared_lock<std::shared_mutex> lock(m_dataMutex);
+    stats.generation = m_dataGeneration;
+    if (m_data) {
+        const Data& data = *m_data;
+        stats.documents = data.Count() - data.deletedCount;
+        stats.deleted = data.deletedCount;
+        stats.words = data.words.size();
+        stats.postings = data.postingCount;
+        stats.postingBytes = data.postingBytes;
+        stats.memoryBytes = data.memoryBytes;
+        stats.ready = true;
+    }
+    return stats;
+}
+
+fs::path TextIndex::GetRoot() const {
+    std::shared_lock<std::shared_mutex> lock(m_dataMutex);
+    return m_data ? m_data->root : fs::path();
+}
+
+const std::vector<TextIndex::DocId>& TextIndex::Query(const std::string& text) {
+    auto start = std::chrono::steady_clock::now();
+    m_matches.clear();
+    m_queryStats = QueryStats();
+
+    // 查询词与文件内容用同一种切分和折叠
+    std::string folded = text;
+    std::vector<std::string> words;
+    ForEachWord(&folded[0], folded.size(), [&](const char* word, std::size_t size) {
+        std::string w(word, size);
+        if (std::find(words.begin(), words.end(), w) == words.end())
+            words.push_back(std::move(w));
+    });
+    m_queryStats.words = words.size();
+
+    std::shared_lock<std::shared_mutex> lock(m_dataMutex);
+    if (!m_data || words.empty()) {
+        m_queryStats.time = ElapsedSince(start);
+        return m_matches;
+    }
+    const Data& data = *m_data;
+
+    // 任何一个词不在索引中，结果就是空的
+    std::vector<std::pair<const Postings*, const std::string*>> lists;
+    for (const std::string& word : words) {
+        auto it = data.words.find(word);
+        if (it == data.words.end()) {
+            m_queryStats.rarest = word;
+            m_queryStats.time = ElapsedSince(start);
+            return m_matches;
+        }
+        lists.push_back({ &it->second, &word });
+    }
+    std::sort(lists.begin(), lists.end(), [](const auto& a, const auto& b) { return a.first->count < b.first->count; });
+    m_queryStats.rarest = *lists[0].second;
+    m_queryStats.shortest = lists[0].first->count;
+
+    // 最短的列表完整解码作为候选，其余列表借助跳表逐个求交
+    Cursor first(*lists[0].first);
+    for (; !first.AtEnd(); first.Next())
+        m_matches.push_back(first.Doc());
+    m_queryStats.decoded = first.Decoded();
+    for (std::size_t k = 1; k < lists.size() && !m_matches.empty(); ++k) {
+        Cursor cursor(*lists[k].first);
+        std::size_t kept = 0;
+        for (DocId doc : m_matches) {
+            cursor.SkipTo(doc);
+            if (cursor.AtEnd())
+                break;
+            if (cursor.Doc() == doc)
+                m_matches[kept++] = doc;
+        }
+        m_matches.resize(kept);
+        m_queryStats.decoded += cursor.Decoded();
+    }
+
+    // 已删除的文档（文件变化前的旧版本）不算
+    if (data.deletedCount > 0) {
+        m_matches.erase(std::remove_if(m_matches.begin(), m_matches.end(),
+                                       [&](DocId doc) { return data.deleted[doc] != 0; }),
+                        m_matches.end());
+    }
+    m_queryStats.matches = m_matches.size();
+    m_queryStats.time = ElapsedSince(start);
+    return m_matches;
+}
+
+std::string TextIndex::GetPath(DocId doc) const {
+    std::shared_lock<std::shared_mutex> lock(m_dataMutex);
+    if (!m_data || doc >= m_data->Count())
+        return std::string();
+    return m_data->paths[doc];
+}
+
+void TextIndex::WaitIdle() {
+    std::unique_lock<std::mutex> lock(m_statsMutex);
+    m_idleCv.wait(lock, [this] { return !m_stats.building; });
+}
+
+fs::path TextIndex::GetIndexPath(const fs::path& root) {
+    // 文件名取根路径的 FNV-1a 哈希（Windows 上不区分 ASCII 大小写）
+    std::string key = NormalRoot(root).u8string();
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (char c : key) {
+#ifdef _WIN32
+        if (c >= 'A' && c <= 'Z')
+            c = char(c - 'A' + 'a');
+#endif
+        hash = (hash ^ (unsigned char)c) * 1099511628211ULL;
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.index", (unsigned long long)hash);
+    return ListingStore::GetDefaultPath().parent_path() / "text" / name;
+}
+
+fs::path TextIndex::FindIndexedRoot(const fs::path& folder) {
+    std::error_code ec;
+    fs::path current = NormalRoot(folder);
+    while (!current.empty()) {
+        if (fs::exists(GetIndexPath(current), ec))
+            return current;
+        fs::path parent = current.parent_path();
+        if (parent == current)
+            break;
+        current = parent;
+    }
+    return fs::path();
+}
+
+// -----------------------------------------------------------------------------
+// Build and update
+// -----------------------------------------------------------------------------
+
+void TextIndex::BeginPass(int threads) {
+    m_cancel = true;
+    if (m_worker.joinable())
+        m_worker.join();
+    m_cancel = false;
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats.building = true;
+    m_stats.walked = 0;
+    m_stats.read = 0;
+    m_stats.reused = 0;
+    m_stats.removed = 0;
+    m_stats.binary = 0;
+    m_stats.bytes = 0;
+    m_stats.threads = threads;
+    m_passStart = std::chrono::steady_clock::now();
+}
+
+void TextIndex::EndPass(std::chrono::microseconds time) {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats.building = false;
+    m_stats.buildTime = time;
+    m_idleCv.notify_all();
+}
+
+bool TextIndex::Walk(const fs::path& root, int threads, std::vector<FileInfo>& out) {
+    struct Work {
+        fs::path path;
+        std::string relative;
+        int depth;
+    };
+    const char separator = (char)fs::path::preferred_separator;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Work> folders{ { root, std::string(), 0 } };
+    int idle = 0;
+    bool done = false;
+    bool rootFailed = false;
+
+    auto worker = [&] {
+        std::unique_ptr<DirEnumerator> enumerator = DirEnumerator::Create(EnumBackend::Auto);
+        std::vector<ScanEntry> entries;
+        std::vector<FileInfo> files;
+        std::vector<Work> found;
+        std::string name;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!m_cancel) {
+            if (folders.empty()) {
+                // 所有线程都空闲且栈为空：遍历结束
+                if (++idle == threads) {
+                    done = true;
+                    cv.notify_all();
+                    break;
+                }
+                cv.wait(lock, [&] { return done || m_cancel || !folders.empty(); });
+                if (done)
+                    break;
+                --idle;
+                continue;
+            }
+            Work work = std::move(folders.back());
+            folders.pop_back();
+            lock.unlock();
+
+            entries.clear();
+            std::error_code ec;
+            enumerator->Enumerate(work.path, [&](std::vector<ScanEntry>& chunk) {
+                if (m_cancel.load(std::memory_order_relaxed))
+                    return false;
+                for (auto& se : chunk)
+                    entries.push_back(std::move(se));
+                return true;
+            }, ec);
+            // 子目录的错误（无权限等）只跳过该目录
+            files.clear();
+            found.clear();
+            for (const ScanEntry& se : entries) {
+                ToUtf8(se.name, name);
+                std::string relative = work.relative;
+                if (!relative.empty())
+                    relative += separator;
+                relative += name;
+                if (se.isDirectory) {
+                    if (work.depth < kMaxDepth)
+                        found.push_back({ work.path / se.name, std::move(relative), work.depth + 1 });
+                } else {
+                    files.push_back({ work.path / se.name, std::move(relative), (std::uint64_t)se.size,
+                                      ToNanos(se.lastWriteTime) });
+                }
+            }
+
+            lock.lock();
+            if (ec && work.depth == 0)
+                rootFailed = true;
+            for (FileInfo& file : files)
+                out.push_back(std::move(file));
+            for (Work& folder : found)
+                folders.push_back(std::move(folder));
+            {
+                std::lock_guard<std::mutex> statsLock(m_statsMutex);
+                m_stats.walked = out.size();
+            }
+            if (folders.size() > 1)
+                cv.notify_all();
+        }
+        // 取消时唤醒其余等待中的线程
+        if (m_cancel) {
+            done = true;
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool)
+        th.join();
+
+    if (rootFailed)
+        LOG_ERROR("Text index: cannot open %s", root.string().c_str());
+    return !rootFailed && !m_cancel;
+}
+
+bool TextIndex::Tokenize(const std::vector<FileInfo>& files, DocId firstDoc, int threads,
+                         std::unordered_map<std::string, Postings>& words, std::uint64_t& postings) {
+    threads = std::max(1, std::min<int>(threads, (int)std::max<std::size_t>(files.size(), 1)));
+    std::vector<Segment> segments(threads);
+    std::atomic<std::size_t> next{0};
+
+    // 文件大小差别很大，线程逐个领取文件而不是预先分段
+    auto worker = [&](int t) {
+        Segment& segment = segments[t];
+        std::vector<char> buffer(kReadChunk + TextIndex::kMaxWord + 1);
+        for (std::size_t k; !m_cancel && (k = next.fetch_add(1)) < files.size();) {
+            DocId doc = firstDoc + (DocId)k;
+            FileReader reader(files[k].path);
+            if (!reader.IsOpen())
+                continue;
+            auto add = [&](const char* word, std::size_t size) { segment.Add(word, size, doc); };
+
+            // 按块读取；块尾未完的词移到下一块开头，超长的词整段跳过
+            std::size_t carry = 0, total = 0;
+            bool skipRun = false, binary = false;
+            for (bool first = true;; first = false) {
+                std::size_t n = reader.Read(buffer.data() + carry, kReadChunk);
+                if (first && std::memchr(buffer.data(), 0, std::min(n, kBinaryProbe))) {
+                    binary = true;
+                    break;
+                }
+                total += n;
+                char* text = buffer.data();
+                std::size_t size = carry + n;
+                if (skipRun) {
+                    while (size > 0 && IsWordByte(*text)) {
+                        ++text;
+                        --size;
+                    }
+                    skipRun = size == 0 && n > 0;
+                }
+                if (n == 0) {
+                    ForEachWord(text, size, add);
+                    break;
+                }
+                std::size_t cut = size;
+                while (cut > 0 && size - cut <= TextIndex::kMaxWord && IsWordByte(text[cut - 1]))
+                    --cut;
+                if (size - cut > TextIndex::kMaxWord) {
+                    ForEachWord(text, size, add);
+                    skipRun = true;
+                    carry = 0;
+                } else {
+                    ForEachWord(text, cut, add);
+                    carry = size - cut;
+                    std::memmove(buffer.data(), text + cut, carry);
+                }
+                if (m_cancel.load(std::memory_order_relaxed))
+                    break;
+            }
+
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            if (binary)
+                ++m_stats.binary;
+            else
+                ++m_stats.read;
+            m_stats.bytes += total;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back(worker, t);
+    worker(0);
+    for (auto& th : pool)
+        th.join();
+    if (m_cancel)
+        return false;
+
+    // 合并各线程的列表：只出现在一个线程中的词直接移交，其余解码后按文档号合并
+    // （已并入的列表被清空，count 为 0）
+    std::vector<DocId> docs;
+    std::vector<Postings*> parts;
+    for (std::size_t s = 0; s < segments.size(); ++s) {
+        for (const Segment::Slot& slot : segments[s].slots) {
+            if (!slot.word || segments[s].postings[slot.index].count == 0)
+                continue;
+            parts.assign(1, &segments[s].postings[slot.index]);
+            for (std::size_t other = s + 1; other < segments.size(); ++other) {
+                const Segment::Slot& found = segments[other].Find(slot.word, slot.size, slot.hash);
+                if (found.word)
+                    parts.push_back(&segments[other].postings[found.index]);
+            }
+            Postings& target = words[std::string(slot.word, slot.size)];
+            if (parts.size() == 1 && target.count == 0) {
+                postings += parts[0]->count;
+                target = std::move(*parts[0]);
+                parts[0]->count = 0;
+                continue;
+            }
+            docs.clear();
+            for (Postings* part : parts) {
+                for (Cursor cursor(*part); !cursor.AtEnd(); cursor.Next())
+                    docs.push_back(cursor.Doc());
+                *part = Postings();
+            }
+            std::sort(docs.begin(), docs.end());
+            for (DocId doc : docs)
+                target.Append(doc);
+            postings += docs.size();
+        }
+        segments[s] = Segment();
+    }
+    return true;
+}
+
+bool TextIndex::Update(int threads) {
+    // 只有本线程修改 m_data，读取不需要加锁
+    Data& data = *m_data;
+    std::vector<FileInfo> files;
+    if (!Walk(data.root, threads, files))
+        return false;
+
+    std::unordered_map<std::string_view, DocId> known;
+    known.reserve(data.Count());
+    for (DocId doc = 0; doc < data.Count(); ++doc) {
+        if (!data.deleted[doc])
+            known.emplace(data.paths[doc], doc);
+    }
+
+    // 大小和修改时间都没变的文件保留原文档，其余重新读取
+    std::vector<FileInfo> changed;
+    std::vector<DocId> removed;
+    std::size_t reused = 0;
+    for (FileInfo& file : files) {
+        auto it = known.find(file.relative);
+        if (it != known.end()) {
+            DocId doc = it->second;
+            known.erase(it);
+            if (data.sizes[doc] == file.size && data.times[doc] == file.time) {
+                ++reused;
+                continue;
+            }
+            removed.push_back(doc);
+        }
+        changed.push_back(std::move(file));
+    }
+    for (const auto& gone : known)
+        removed.push_back(gone.second);
+    known.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_stats.reused = reused;
+        m_stats.removed = removed.size();
+    }
+    if (changed.empty() && removed.empty())
+        return false;
+
+    std::unordered_map<std::string, Postings> added;
+    std::uint64_t addedPostings = 0;
+    if (!Tokenize(changed, data.Count(), threads, added, addedPostings))
+        return false;
+
+    // 新文档号都大于已有的文档号，直接追加到各个词的列表末尾
+    std::unique_lock<std::shared_mutex> lock(m_dataMutex);
+    for (auto& entry : added) {
+        Postings& target = data.words[entry.first];
+        if (target.count == 0) {
+            target = std::move(entry.second);
+            continue;
+        }
+        for (Cursor cursor(entry.second); !cursor.AtEnd(); cursor.Next())
+            target.Append(cursor.Doc());
+    }
+    data.postingCount += addedPostings;
+    for (DocId doc : removed)
+        data.deleted[doc] = 1;
+    data.deletedCount += removed.size();
+    for (FileInfo& file : changed) {
+        data.paths.push_back(std::move(file.relative));
+        data.sizes.push_back(file.size);
+        data.times.push_back(file.time);
+        data.deleted.push_back(0);
+    }
+    if (data.deletedCount * 4 > data.Count())
+        Compact(data);
+    data.Measure();
+    ++m_dataGeneration;
+    LOG_INFO("Text index of %s updated: %llu files read, %llu unchanged, %llu removed",
+             data.root.string().c_str(), (unsigned long long)changed.size(), (unsigned long long)reused,
+             (unsigned long long)removed.size());
+    return true;
+}
+
+void TextIndex::Compact(Data& data) {
+    // 旧文档号到新文档号的映射；已删除的文档映射为无效值
+    const DocId kGone = ~DocId(0);
+    std::vector<DocId> remap(data.Count(), kGone);
+    DocId live = 0;
+    for (DocId doc = 0; doc < data.Count(); ++doc) {
+        if (!data.deleted[doc]) {
+            if (live != doc)
+                data.paths[live] = std::move(data.paths[doc]);
+            data.sizes[live] = data.sizes[doc];
+            data.times[live] = data.times[doc];
+            remap[doc] = live++;
+        }
+    }
+    data.paths.resize(live);
+    data.sizes.resize(live);
+    data.times.resize(live);
+    data.deleted.assign(live, 0);
+
+    data.postingCount = 0;
+    for (auto it = data.words.begin(); it != data.words.end();) {
+        Postings compacted;
+        for (Cursor cursor(it->second); !cursor.AtEnd(); cursor.Next()) {
+            if (remap[cursor.Doc()] != kGone)
+                compacted.Append(remap[cursor.Doc()]);
+        }
+        if (compacted.count == 0) {
+            it = data.words.erase(it);
+            continue;
+        }
+        data.postingCount += compacted.count;
+        it->second = std::move(compacted);
+        ++it;
+    }
+    LOG_INFO("Text index of %s compacted: %llu deleted documents dropped", data.root.string().c_str(),
+             (unsigned long long)data.deletedCount);
+    data.deletedCount = 0;
+}
+
+void TextIndex::Install(std::unique_ptr<Data> data) {
+    std::unique_lock<std::shared_mutex> lock(m_dataMutex);
+    m_data = std::move(data);
+    ++m_dataGeneration;
+}
+
+bool TextIndex::Write(const Data& data, const fs::path& file) {
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.documents = data.Count();
+    header.deleted = (std::uint32_t)data.deletedCount;
+    header.words = data.words.size();
+    header.postings = data.postingCount;
+    std::string root = data.root.u8string();
+    header.rootLength = (std::uint32_t)root.size();
+
+    std::vector<char> paths;
+    for (const std::string& path : data.paths)
+        paths.insert(paths.end(), path.c_str(), path.c_str() + path.size() + 1);
+    header.pathBytes = paths.size();
+
+    std::error_code ec;
+    fs::create_directories(file.parent_path(), ec);
+    fs::path tmp = file;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            LOG_ERROR("Cannot write text index %s", tmp.string().c_str());
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(root.data(), root.size());
+        WriteArray(out, paths);
+        WriteArray(out, data.sizes);
+        WriteArray(out, data.times);
+        WriteArray(out, data.deleted);
+        for (const auto& entry : data.words) {
+            const Postings& postings = entry.second;
+            WordHeader word{ (std::uint32_t)entry.first.size(), postings.count, postings.last,
+                             (std::uint32_t)postings.bytes.size(), (std::uint32_t)postings.skips.size() };
+            out.write(reinterpret_cast<const char*>(&word), sizeof(word));
+            out.write(entry.first.data(), entry.first.size());
+            WriteArray(out, postings.bytes);
+            WriteArray(out, postings.skips);
+        }
+        if (!out) {
+            LOG_ERROR("Failed writing text index %s", tmp.string().c_str());
+            return false;
+        }
+    }
+    fs::rename(tmp, file, ec);
+    if (ec) {
+        LOG_ERROR("Cannot replace text index %s: %s", file.string().c_str(), ec.message().c_str());
+        fs::remove(tmp, ec);
+        return false;
+    }
+    LOG_INFO("Saved text index %s: %u files, %llu words", file.string().c_str(), header.documents,
+             (unsigned long long)header.words);
+    return true;
+}
+
+std::unique_ptr<TextIndex::Data> TextIndex::Read(const fs::path& file) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in)
+        return nullptr;
+    FileHeader header{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.deleted > header.documents) {
+        LOG_ERROR("Text index %s is invalid or from another version", file.string().c_str());
+        return nullptr;
+    }
+
+    auto data = std::make_unique<Data>();
+    std::string root(header.rootLength, '\0');
+    in.read(&root[0], root.size());
+    data->root = fs::u8path(root);
+    std::vector<char> paths;
+    bool ok = in && ReadArray(in, paths, header.pathBytes) && ReadArray(in, data->sizes, header.documents) &&
+              ReadArray(in, data->times, header.documents) && ReadArray(in, data->deleted, header.documents);
+    if (ok) {
+        data->paths.reserve(header.documents);
+        for (const char* p = paths.data(); p < paths.data() + paths.size(); p += data->paths.back().size() + 1)
+            data->paths.emplace_back(p);
+        ok = data->paths.size() == header.documents;
+    }
+    data->words.reserve(header.words);
+    std::string word;
+    for (std::uint64_t k = 0; ok && k < header.words; ++k) {
+        WordHeader wh{};
+        in.read(reinterpret_cast<char*>(&wh), sizeof(wh));
+        if (!in || wh.length > kMaxWord || wh.count == 0 || wh.skips != (wh.count - 1) / kSkipInterval) {
+            ok = false;
+            break;
+        }
+        word.resize(wh.length);
+        in.read(&word[0], word.size());
+        Postings& postings = data->words[word];
+        postings.count = wh.count;
+        postings.last = wh.last;
+        ok = in && ReadArray(in, postings.bytes, wh.bytes) && ReadArray(in, postings.skips, wh.skips) &&
+             !postings.bytes.empty() && (postings.bytes.back() & 0x80) == 0;
+    }
+    if (!ok) {
+        LOG_ERROR("Text index %s is truncated", file.string().c_str());
+        return nullptr;
+    }
+    data->deletedCount = header.deleted;
+    data->postingCount = header.postings;
+    data->Measure();
+    LOG_INFO("Loaded text index %s: %s, %u files, %llu words", file.string().c_str(), root.c_str(),
+             header.documents, (unsigned long long)header.words);
+    return data;
+}
@@ -0,0 +1,534 @@
+// Treemap.cpp
+// Disk usage treemap implementation for FileMgr
+//
+// Key features:
+// - Parallel scan into contiguous child ranges; folder totals grow as files arrive
+// - Squarified layout on a dedicated thread, recomputed while the scan runs
+// - Level-of-detail culling: small children merged, tiny folders not subdivided
+// - Colors by extension (files) and depth (folders), labels for large rectangles
+//
+
+#include "../include/Treemap.hpp"
+#include "../include/Common.hpp"
+#include "../include/DirEnumerator.hpp"
+#include "../include/EntrySorter.hpp"
+#include "../include/log.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr std::uint32_t kNodeFolder = 1;
+
+    constexpr int kMaxDepth = 256;                      // 超过该深度的文件夹不再下探
+    constexpr int kMaxLayoutDepth = 48;                 // 布局最多嵌套的层数
+    constexpr auto kLayoutInterval = std::chrono::milliseconds(200);   // 扫描期间重新布局的间隔
+    constexpr float kMinArea = 12.0f;                   // 小于该面积（像素²）的子项并入“小项”
+    constexpr float kMinNestSide = 10.0f;               // 短边小于该值的文件夹不再细分
+    constexpr float kPadding = 2.0f;                    // 文件夹边框与内容的间距
+    constexpr float kMinLabelWidth = 40.0f;             // 宽度够显示名字的最小矩形
+
+    // 名字转成 UTF-8 追加到 out（Linux 上本来就是字节串）
+    void AppendUtf8(const fs::path::string_type& name, std::vector<char>& out) {
+#ifdef _WIN32
+        std::string utf8 = fs::path(name).u8string();
+        out.insert(out.end(), utf8.begin(), utf8.end());
+#else
+        out.insert(out.end(), name.begin(), name.end());
+#endif
+        out.push_back('\0');
+    }
+
+    // 按 ImGui 的 ImU32 字节序打包（0xAABBGGRR）
+    std::uint32_t Pack(float r, float g, float b) {
+        auto channel = [](float v) { return (std::uint32_t)(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f); };
+        return 0xFF000000u | channel(b) << 16 | channel(g) << 8 | channel(r);
+    }
+
+    std::uint32_t FromHsv(float h, float s, float v) {
+        h = std::fmod(h, 1.0f) * 6.0f;
+        int sector = (int)h;
+        float f = h - sector, p = v * (1 - s), q = v * (1 - s * f), t = v * (1 - s * (1 - f));
+        switch (sector) {
+        case 0: return Pack(v, t, p);
+        case 1: return Pack(q, v, p);
+        case 2: return Pack(p, v, t);
+        case 3: return Pack(p, q, v);
+        case 4: return Pack(t, p, v);
+        default: return Pack(v, p, q);
+        }
+    }
+
+    // 文件按扩展名着色（同类文件同色），文件夹按深度由深到浅
+    std::uint32_t ColorOf(const char* name, bool folder, int depth) {
+        if (folder)
+            return FromHsv(0.6f, 0.15f, 0.28f + 0.06f * (depth % 6));
+        const char* dot = std::strrchr(name, '.');
+        if (!dot || dot == name)
+            return FromHsv(0.0f, 0.0f, 0.62f);
+        std::uint32_t hash = 2166136261u;
+        for (const char* p = dot + 1; *p; ++p) {
+            char c = (*p >= 'A' && *p <= 'Z') ? char(*p - 'A' + 'a') : *p;
+            hash = (hash ^ (unsigned char)c) * 16777619u;
+        }
+        return FromHsv((hash % 360) / 360.0f, 0.55f, 0.80f);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Construction / Destruction
+// -----------------------------------------------------------------------------
+
+Treemap::Treemap() : m_layout(std::make_shared<Layout>()) {
+    m_layoutThread = std::thread(&Treemap::LayoutLoop, this);
+}
+
+Treemap::~Treemap() {
+    Cancel();
+    {
+        std::lock_guard<std::mutex> lock(m_layoutMutex);
+        m_stopLayout = true;
+    }
+    m_layoutCv.notify_all();
+    if (m_layoutThread.joinable())
+        m_layoutThread.join();
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+void Treemap::Start(const fs::path& root, int threads) {
+    Cancel();
+    m_cancel = false;
+    threads = threads > 0 ? std::min(threads, 64) : EntrySorter::DefaultThreadCount();
+    {
+        std::unique_lock<std::shared_mutex> lock(m_treeMutex);
+        m_nodes.clear();
+        m_names.clear();
+        // 根节点的名字是完整路径（用作标题）
+        m_nodes.push_back({ kNoNode, kNoNode, 0, 0, 0, kNodeFolder });
+        std::string label = root.u8string();
+        m_names.assign(label.begin(), label.end());
+        m_names.push_back('\0');
+        m_root = root;
+        ++m_treeGeneration;
+    }
+    m_focus = kRoot;
+    m_files = 0;
+    m_folders = 0;
+    m_scanTime = 0;
+    m_threads = threads;
+    m_scanStart = std::chrono::steady_clock::now();
+    m_scanning = true;
+    {
+        // 新树换上之后才作废旧布局：之前开始的布局会被丢弃（见 LayoutLoop）
+        std::lock_guard<std::mutex> lock(m_layoutMutex);
+        ++m_scanId;
+        m_layout = std::make_shared<Layout>();
+        m_layoutCount = 0;
+    }
+    m_scanThread = std::thread(&Treemap::ScanLoop, this, root, threads);
+    RequestLayout();
+}
+
+void Treemap::Cancel() {
+    m_cancel = true;
+    WaitScan();
+}
+
+void Treemap::WaitScan() {
+    if (m_scanThread.joinable())
+        m_scanThread.join();
+}
+
+void Treemap::SetViewport(float width, float height, float labelHeight) {
+    {
+        std::lock_guard<std::mutex> lock(m_layoutMutex);
+        // 亚像素的变化不值得重新布局
+        if (std::fabs(width - m_width) < 0.5f && std::fabs(height - m_height) < 0.5f && labelHeight == m_labelHeight)
+            return;
+        m_width = width;
+        m_height = height;
+        m_labelHeight = labelHeight;
+        m_layoutRequested = true;
+    }
+    m_layoutCv.notify_one();
+}
+
+void Treemap::SetFocus(NodeId node) {
+    if (!IsFolder(node) || node == m_focus)
+        return;
+    m_focus = node;
+    RequestLayout();
+}
+
+std::shared_ptr<const Treemap::Layout> Treemap::GetLayout() const {
+    std::lock_guard<std::mutex> lock(m_layoutMutex);
+    return m_layout;
+}
+
+fs::path Treemap::GetPath(NodeId node) const {
+    std::shared_lock<std::shared_mutex> lock(m_treeMutex);
+    if (node >= m_nodes.size())
+        return fs::path();
+    std::vector<NodeId> chain;
+    for (; node != kRoot; node = m_nodes[node].parent)
+        chain.push_back(node);
+    fs::path path = m_root;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+        path /= fs::u8path(NameOf(*it));
+    return path;
+}
+
+Treemap::NodeId Treemap::GetParent(NodeId node) const {
+    std::shared_lock<std::shared_mutex> lock(m_treeMutex);
+    return node < m_nodes.size() ? m_nodes[node].parent : kNoNode;
+}
+
+std::uint64_t Treemap::GetSize(NodeId node) const {
+    std::shared_lock<std::shared_mutex> lock(m_treeMutex);
+    return node < m_nodes.size() ? m_nodes[node].size : 0;
+}
+
+bool Treemap::IsFolder(NodeId node) const {
+    std::shared_lock<std::shared_mutex> lock(m_treeMutex);
+    return node < m_nodes.size() && (m_nodes[node].flags & kNodeFolder);
+}
+
+Treemap::Stats Treemap::GetStats() const {
+    Stats stats;
+    stats.files = m_files;
+    stats.folders = m_folders;
+    stats.threads = m_threads;
+    stats.scanning = m_scanning;
+    stats.scanTime = stats.scanning ? ElapsedSince(m_scanStart) : std::chrono::microseconds(m_scanTime.load());
+    {
+        std::shared_lock<std::shared_mutex> lock(m_treeMutex);
+        stats.bytes = m_nodes.empty() ? 0 : m_nodes[kRoot].size;
+        stats.memoryBytes = m_nodes.capacity() * sizeof(Node) + m_names.capacity();
+    }
+    std::lock_guard<std::mutex> lock(m_layoutMutex);
+    stats.layouts = m_layoutCount;
+    return stats;
+}
+
+// -----------------------------------------------------------------------------
+// Scan
+// -----------------------------------------------------------------------------
+
+void Treemap::ScanLoop(fs::path root, int threads) {
+    struct Work {
+        fs::path path;
+        NodeId node;
+        int depth;
+    };
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Work> folders{ { root, kRoot, 0 } };
+    int idle = 0;
+    bool done = false;
+
+    auto worker = [&] {
+        std::unique_ptr<DirEnumerator> enumerator = DirEnumerator::Create(EnumBackend::Auto);
+        std::vector<ScanEntry> entries;
+        std::vector<Work> found;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!m_cancel) {
+            if (folders.empty()) {
+                // 所有线程都空闲且栈为空：扫描结束
+                if (++idle == threads) {
+                    done = true;
+                    cv.notify_all();
+                    break;
+                }
+                cv.wait(lock, [&] { return done || m_cancel || !folders.empty(); });
+                if (done)
+                    break;
+                --idle;
+                continue;
+            }
+            Work work = std::move(folders.back());
+            folders.pop_back();
+            lock.unlock();
+
+            entries.clear();
+            std::error_code ec;
+            enumerator->Enumerate(work.path, [&](std::vector<ScanEntry>& chunk) {
+                if (m_cancel.load(std::memory_order_relaxed))
+                    return false;
+                for (auto& se : chunk)
+                    entries.push_back(std::move(se));
+                return true;
+            }, ec);
+            if (ec && work.depth == 0)
+                LOG_ERROR("Treemap: cannot open %s", root.string().c_str());
+
+            // 子项连续追加，文件大小一路加到所有上级文件夹；
+            // 符号链接和联接算作空文件，不展开，避免重复计算和链接环
+            found.clear();
+            std::size_t files = 0;
+            {
+                std::unique_lock<std::shared_mutex> treeLock(m_treeMutex);
+                NodeId first = (NodeId)m_nodes.size();
+                std::uint64_t bytes = 0;
+                for (const ScanEntry& se : entries) {
+                    NodeId id = (NodeId)m_nodes.size();
+                    bool folder = se.isDirectory && !se.isLink;
+                    std::uint64_t size = se.isDirectory || se.isLink ? 0 : (std::uint64_t)se.size;
+                    m_nodes.push_back({ work.node, kNoNode, 0, (std::uint32_t)m_names.size(), size,
+                                        folder ? kNodeFolder : 0 });
+                    AppendUtf8(se.name, m_names);
+                    if (folder) {
+                        if (work.depth < kMaxDepth)
+                            found.push_back({ work.path / se.name, id, work.depth + 1 });
+                    } else {
+                        bytes += size;
+                        ++files;
+                    }
+                }
+                m_nodes[work.node].first = first;
+                m_nodes[work.node].count = (std::uint32_t)entries.size();
+                for (NodeId p = work.node; p != kNoNode && bytes; p = m_nodes[p].parent)
+                    m_nodes[p].size += bytes;
+                ++m_treeGeneration;
+            }
+            m_files.fetch_add(files, std::memory_order_relaxed);
+            m_folders.fetch_add(entries.size() - files, std::memory_order_relaxed);
+
+            lock.lock();
+            for (Work& folder : found)
+                folders.push_back(std::move(folder));
+            if (folders.size() > 1)
+                cv.notify_all();
+        }
+        // 取消时唤醒其余等待中的线程
+        if (m_cancel) {
+            done = true;
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool)
+        th.join();
+
+    m_scanTime = ElapsedSince(m_scanStart).count();
+    m_scanning = false;
+    if (!m_cancel) {
+        Stats stats = GetStats();
+        LOG_INFO("Treemap: scanned %s: %d files, %d folders, %.1f MB in %.2f s (%d threads, %.1f MB of nodes)",
+                 root.string().c_str(), (int)stats.files, (int)stats.folders, stats.bytes / 1e6,
+                 stats.scanTime.count() / 1e6, threads, stats.memoryBytes / 1e6);
+    }
+    RequestLayout();
+}
+
+// -----------------------------------------------------------------------------
+// Layout
+// -----------------------------------------------------------------------------
+
+void Treemap::RequestLayout() {
+    {
+        std::lock_guard<std::mutex> lock(m_layoutMutex);
+        m_layoutRequested = true;
+    }
+    m_layoutCv.notify_one();
+}
+
+void Treemap::LayoutLoop() {
+    std::uint64_t laidOut = ~0ULL;                 // Tree generation of the last layout
+    std::unique_lock<std::mutex> lock(m_layoutMutex);
+    while (!m_stopLayout) {
+        // 扫描期间树不断变化：每个间隔最多重新布局一次
+        m_layoutCv.wait_for(lock, kLayoutInterval, [this] { return m_stopLayout || m_layoutRequested; });
+        if (m_stopLayout)
+            break;
+        bool requested = m_layoutRequested;
+        m_layoutRequested = false;
+        float width = m_width, height = m_height, labelHeight = m_labelHeight;
+        std::uint64_t scanId = m_scanId;
+        if (width < 1.0f || height < 1.0f)
+            continue;
+        lock.unlock();
+
+        std::uint64_t generation;
+        {
+            std::shared_lock<std::shared_mutex> treeLock(m_treeMutex);
+            generation = m_treeGeneration;
+        }
+        if (requested || generation != laidOut) {
+            auto layout = std::make_shared<Layout>();
+            laidOut = ComputeLayout(*layout, width, height, labelHeight);
+            lock.lock();
+            // 计算期间换了新树：节点编号已失效
+            if (scanId != m_scanId) {
+                m_layoutRequested = true;
+                continue;
+            }
+            layout->generation = ++m_layoutGeneration;
+            m_layout = std::move(layout);
+            ++m_layoutCount;
+        } else {
+            lock.lock();
+        }
+    }
+}
+
+std::uint64_t Treemap::ComputeLayout(Layout& layout, float width, float height, float labelHeight) {
+    auto start = std::chrono::steady_clock::now();
+    layout.width = width;
+    layout.height = height;
+    std::shared_lock<std::shared_mutex> lock(m_treeMutex);
+    NodeId focus = m_focus;
+    if (focus >= m_nodes.size() || !(m_nodes[focus].flags & kNodeFolder))
+        focus = kRoot;
+    layout.focus = focus;
+    m_items.clear();
+    m_childRects.clear();
+    if (!m_nodes.empty())
+        LayoutNode(layout, focus, 0.0f, 0.0f, width, height, 0, labelHeight);
+    layout.time = ElapsedSince(start);
+    return m_treeGeneration;
+}
+
+void Treemap::LayoutNode(Layout& layout, NodeId node, float x0, float y0, float x1, float y1, int depth,
+                         float labelHeight) {
+    const Node& n = m_nodes[node];
+    bool folder = (n.flags & kNodeFolder) != 0;
+    float w = x1 - x0, h = y1 - y0;
+    Rect rect{ x0, y0, x1, y1, node, ColorOf(NameOf(node), folder, depth), ~0u, (std::uint16_t)depth,
+               (std::uint16_t)(folder ? kRectFolder : 0) };
+    if (w >= kMinLabelWidth && h >= labelHeight + 2.0f) {
+        const char* name = NameOf(node);
+        rect.label = (std::uint32_t)layout.labels.size();
+        layout.labels.insert(layout.labels.end(), name, name + std::strlen(name) + 1);
+    }
+    layout.rects.push_back(rect);
+    if (!folder || n.count == 0 || n.size == 0 || depth >= kMaxLayoutDepth)
+        return;
+    if (w < kMinNestSide || h < kMinNestSide)
+        return;
+
+    // 有名字的文件夹顶部留出标题栏
+    float top = rect.label != ~0u && h >= 3.0f * labelHeight ? labelHeight + 1.0f : kPadding;
+    float cx0 = x0 + kPadding, cy0 = y0 + top, cx1 = x1 - kPadding, cy1 = y1 - kPadding;
+    if (cx1 - cx0 < 2.0f || cy1 - cy0 < 2.0f)
+        return;
+
+    // 子项按大小降序；m_items 当作栈使用，本层占 [first, end)
+    std::size_t first = m_items.size();
+    double total = 0;
+    for (NodeId child = n.first; child < n.first + n.count; ++child) {
+        if (m_nodes[child].size > 0) {
+            m_items.push_back({ child, m_nodes[child].size });
+            total += (double)m_nodes[child].size;
+        }
+    }
+    if (m_items.size() == first)
+        return;
+    std::sort(m_items.begin() + first, m_items.end(), [](const Item& a, const Item& b) {
+        return a.size != b.size ? a.size > b.size : a.node < b.node;
+    });
+
+    // 细节层次：面积不足几个像素的尾部子项合并成一个“小项”矩形
+    double scale = (double)(cx1 - cx0) * (cy1 - cy0) / total;
+    std::size_t keep = first;
+    while (keep < m_items.size() && m_items[keep].size * scale >= kMinArea)
+        ++keep;
+    if (keep < m_items.size()) {
+        std::uint64_t small = 0;
+        for (std::size_t k = keep; k < m_items.size(); ++k)
+            small += m_items[k].size;
+        layout.culled += m_items.size() - keep;
+        m_items.resize(keep);
+        Item merged{ kNoNode, small };
+        auto at = std::upper_bound(m_items.begin() + first, m_items.end(), merged,
+                                   [](const Item& a, const Item& b) { return a.size > b.size; });
+        m_items.insert(at, merged);
+    }
+
+    std::size_t count = m_items.size() - first;
+    std::size_t rectFirst = m_childRects.size();
+    Squarify(first, m_items.size(), total, cx0, cy0, cx1, cy1);
+
+    // 递归会继续往两个栈上追加，这里只按下标访问
+    for (std::size_t k = 0; k < count; ++k) {
+        Item item = m_items[first + k];
+        Rect child = m_childRects[rectFirst + k];
+        if (item.node == kNoNode) {
+            child.node = node;
+            child.color = FromHsv(0.0f, 0.0f, 0.45f);
+            child.label = ~0u;
+            child.depth = (std::uint16_t)(depth + 1);
+            child.flags = kRectSmall;
+            layout.rects.push_back(child);
+        } else {
+            LayoutNode(layout, item.node, child.x0, child.y0, child.x1, child.y1, depth + 1, labelHeight);
+        }
+    }
+    m_items.resize(first);
+    m_childRects.resize(rectFirst);
+}
+
+void Treemap::Squarify(std::size_t first, std::size_t last, double total, float x0, float y0, float x1, float y1) {
+    double x = x0, y = y0, w = x1 - x0, h = y1 - y0;
+    double scale = w * h / total;
+    std::size_t i = first;
+    while (i < last) {
+        // 沿短边排一行：只要最差长宽比还在变好就继续加入下一项
+        double side = std::max(std::min(w, h), 1e-6);
+        double side2 = side * side;
+        double maxArea = m_items[i].size * scale;
+        double rowArea = 0, worst = std::numeric_limits<double>::infinity();
+        std::size_t j = i;
+        while (j < last) {
+            double area = m_items[j].size * scale;
+            double sum = rowArea + area;
+            double ratio = std::max(side2 * maxArea / (sum * sum), sum * sum / (side2 * area));
+            if (j > i && ratio > worst)
+                break;
+            worst = ratio;
+            rowArea = sum;
+            ++j;
+        }
+
+        // 放下这一行，剩余矩形缩小；行尾对齐边缘，避免浮点缝隙
+        bool column = w >= h;
+        double thickness = rowArea / side;
+        double along = column ? y : x;
+        double end = column ? y + h : x + w;
+        for (std::size_t k = i; k < j; ++k) {
+            double length = m_items[k].size * scale / thickness;
+            double next = k + 1 == j ? end : along + length;
+            Rect rect{};
+            if (column) {
+                rect.x0 = (float)x;
+                rect.x1 = (float)(x + thickness);
+                rect.y0 = (float)along;
+                rect.y1 = (float)next;
+            } else {
+                rect.x0 = (float)along;
+                rect.x1 = (float)next;
+                rect.y0 = (float)y;
+                rect.y1 = (float)(y + thickness);
+            }
+            m_childRects.push_back(rect);
+            along = next;
+        }
+        if (column) {
+            x += thickness;
+            w = std::max(w - thickness, 0.0);
+        } else {
+            y += thickness;
+            h = std::max(h - thickness, 0.0);
+        }
+        i = j;
+    }
+}
@@ -0,0 +1,194 @@
+// TreemapPanel.cpp
+// "Disk Usage" treemap pane implementation for FileMgr
+//
+// Key features:
+// - Scan of the file list's folder, shown while it runs
+// - Draw-list rendering of the latest layout with sub-pixel culling
+// - Hover outline and tooltip; click opens the folder in the file list
+// - Right-click zooms into a folder, "Up" zooms out
+//
+
+#include "../include/TreemapPanel.hpp"
+#include "../include/DisplayStrings.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr float kMinDrawSide = 0.5f;                // 两边都小于该值的矩形不画（被父矩形覆盖）
+    constexpr float kMinBorderSide = 4.0f;              // 够画边框的最小边长
+    constexpr ImU32 kBorderColor = IM_COL32(0, 0, 0, 96);
+    constexpr ImU32 kHoverColor = IM_COL32(255, 230, 80, 255);
+    constexpr ImU32 kFolderTextColor = IM_COL32(235, 235, 235, 255);
+    constexpr ImU32 kFileTextColor = IM_COL32(20, 20, 20, 255);
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+void TreemapPanel::Open(const fs::path& current) {
+    m_open = true;
+    if (!m_scanned || m_treemap.GetRoot() != current)
+        StartScan(current);
+}
+
+void TreemapPanel::Draw(const fs::path& current) {
+    if (!m_open)
+        return;
+
+    // 聚焦的文件夹变了才重新拼路径
+    Treemap::NodeId focus = m_treemap.GetFocus();
+    if (focus != m_shownFocus) {
+        m_shownFocus = focus;
+        m_focusLabel = m_treemap.GetPath(focus).u8string();
+    }
+
+    ImGui::BeginDisabled(focus == Treemap::kRoot);
+    if (ImGui::SmallButton("Up"))
+        m_treemap.SetFocus(m_treemap.GetParent(focus));
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Rescan"))
+        StartScan(m_treemap.GetRoot());
+    ImGui::SameLine();
+    ImGui::BeginDisabled(current.empty() || current == m_treemap.GetRoot());
+    if (ImGui::SmallButton("Scan this folder"))
+        StartScan(current);
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Close"))
+        m_open = false;
+
+    Treemap::Stats stats = m_treemap.GetStats();
+    char total[32];
+    DisplayStrings::FormatSize(focus == Treemap::kRoot ? stats.bytes : m_treemap.GetSize(focus), total,
+                               sizeof(total));
+    ImGui::TextUnformatted(m_focusLabel.c_str());
+    ImGui::TextDisabled("%s%s, %d files, %d folders, %.2f s", stats.scanning ? "Scanning... " : "", total,
+                        (int)stats.files, (int)stats.folders, stats.scanTime.count() / 1e6);
+
+    DrawCanvas();
+}
+
+void TreemapPanel::DrawStats() {
+    ImGui::SeparatorText("Disk usage");
+    if (!m_scanned) {
+        ImGui::TextDisabled("Not scanned");
+        return;
+    }
+    Treemap::Stats stats = m_treemap.GetStats();
+    std::shared_ptr<const Treemap::Layout> layout = m_treemap.GetLayout();
+    ImGui::Text("Nodes: %d  Memory: %.1f MB (%.1f bytes per node)", (int)(stats.files + stats.folders),
+                stats.memoryBytes / (1024.0 * 1024.0),
+                (double)stats.memoryBytes / std::max<std::size_t>(1, stats.files + stats.folders));
+    ImGui::Text("Scan: %.2f s, %d threads%s", stats.scanTime.count() / 1e6, stats.threads,
+                stats.scanning ? " (running)" : "");
+    ImGui::Text("Layout: %d rects, %d merged, %.2f ms (%d layouts)", (int)layout->rects.size(),
+                (int)layout->culled, layout->time.count() / 1000.0, (int)stats.layouts);
+}
+
+// -----------------------------------------------------------------------------
+// Private methods
+// -----------------------------------------------------------------------------
+
+void TreemapPanel::StartScan(const fs::path& root) {
+    if (root.empty())
+        return;
+    m_treemap.Start(root);
+    m_scanned = true;
+    m_shownFocus = Treemap::kNoNode;
+    m_hoverNode = Treemap::kNoNode;
+}
+
+void TreemapPanel::DrawCanvas() {
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImVec2 size = ImGui::GetContentRegionAvail();
+    size.x = std::max(std::floor(size.x), 1.0f);
+    size.y = std::max(std::floor(size.y), 1.0f);
+    ImGui::InvisibleButton("##treemap", size, ImGuiButtonFlags_MouseButtonLeft | ImGuiButtonFlags_MouseButtonRight);
+    bool hovered = ImGui::IsItemHovered();
+    bool leftClicked = ImGui::IsItemClicked(ImGuiMouseButton_Left);
+    bool rightClicked = ImGui::IsItemClicked(ImGuiMouseButton_Right);
+    m_treemap.SetViewport(size.x, size.y, ImGui::GetTextLineHeight());
+
+    // 新布局到来之前，按比例拉伸上一次的结果
+    std::shared_ptr<const Treemap::Layout> layout = m_treemap.GetLayout();
+    float sx = layout->width > 0 ? size.x / layout->width : 1.0f;
+    float sy = layout->height > 0 ? size.y / layout->height : 1.0f;
+
+    ImDrawList* draw = ImGui::GetWindowDrawList();
+    ImFont* font = ImGui::GetFont();
+    float fontSize = ImGui::GetFontSize();
+    ImVec2 clipMax(origin.x + size.x, origin.y + size.y);
+    draw->PushClipRect(origin, clipMax, true);
+    draw->AddRectFilled(origin, clipMax, ImGui::GetColorU32(ImGuiCol_FrameBg));
+    if (layout->rects.empty()) {
+        draw->AddText(ImVec2(origin.x + 6, origin.y + 4), ImGui::GetColorU32(ImGuiCol_TextDisabled),
+                      m_scanned ? "Scanning..." : "Nothing scanned");
+    }
+
+    // 父矩形先于子矩形，按顺序画即可覆盖；鼠标命中取最后（最深）一个
+    ImVec2 mouse = ImGui::GetIO().MousePos;
+    const Treemap::Rect* hit = nullptr;
+    for (const Treemap::Rect& r : layout->rects) {
+        ImVec2 p0(origin.x + r.x0 * sx, origin.y + r.y0 * sy);
+        ImVec2 p1(origin.x + r.x1 * sx, origin.y + r.y1 * sy);
+        float w = p1.x - p0.x, h = p1.y - p0.y;
+        if (w < kMinDrawSide && h < kMinDrawSide)
+            continue;
+        draw->AddRectFilled(p0, p1, r.color);
+        if (w >= kMinBorderSide && h >= kMinBorderSide)
+            draw->AddRect(p0, p1, kBorderColor);
+        if (r.label != ~0u) {
+            ImVec4 clip(p0.x + 2, p0.y, p1.x - 2, p1.y);
+            draw->AddText(font, fontSize, ImVec2(p0.x + 3, p0.y + 1),
+                          (r.flags & Treemap::kRectFolder) ? kFolderTextColor : kFileTextColor,
+                          layout->labels.data() + r.label, nullptr, 0.0f, &clip);
+        }
+        if (hovered && mouse.x >= p0.x && mouse.x < p1.x && mouse.y >= p0.y && mouse.y < p1.y)
+            hit = &r;
+    }
+
+    if (hit) {
+        ImVec2 p0(origin.x + hit->x0 * sx, origin.y + hit->y0 * sy);
+        ImVec2 p1(origin.x + hit->x1 * sx, origin.y + hit->y1 * sy);
+        draw->AddRect(p0, p1, kHoverColor, 0.0f, 0, 2.0f);
+    }
+    draw->PopClipRect();
+
+    if (!hit)
+        return;
+
+    // 悬停的矩形或布局变了才查路径和大小，其余帧不分配
+    if (hit->node != m_hoverNode || hit->flags != m_hoverFlags || layout->generation != m_hoverLayout) {
+        m_hoverNode = hit->node;
+        m_hoverFlags = hit->flags;
+        m_hoverLayout = layout->generation;
+        m_hoverPath = m_treemap.GetPath(hit->node).u8string();
+        m_hoverSize = m_treemap.GetSize(hit->node);
+    }
+    char bytes[32];
+    DisplayStrings::FormatSize(m_hoverSize, bytes, sizeof(bytes));
+    ImGui::BeginTooltip();
+    if (hit->flags & Treemap::kRectSmall)
+        ImGui::Text("Smaller items in %s", m_hoverPath.c_str());
+    else
+        ImGui::Text("%s\n%s (%llu bytes)", m_hoverPath.c_str(), bytes, (unsigned long long)m_hoverSize);
+    ImGui::TextDisabled("Click: open folder  Right-click: zoom in");
+    ImGui::EndTooltip();
+
+    Treemap::NodeId folder = FolderOf(hit->node, hit->flags);
+    if (leftClicked && m_onNavigate && folder != Treemap::kNoNode)
+        m_onNavigate(m_treemap.GetPath(folder));
+    if (rightClicked && folder != Treemap::kNoNode)
+        m_treemap.SetFocus(folder);
+}
+
+Treemap::NodeId TreemapPanel::FolderOf(Treemap::NodeId node, std::uint16_t flags) const {
+    // “小项”矩形的 node 是所属文件夹
+    if (flags & (Treemap::kRectFolder | Treemap::kRectSmall))
+        return node;
+    return m_treemap.GetParent(node);
+}
@@ -0,0 +1,398 @@
+// UringEnumerator.cpp
+// io_uring directory enumeration backend for FileMgr (Linux only)
+//
+// Names are read with getdents64 as in the synchronous Linux backend, but the
+// per-entry statx calls are queued as IORING_OP_STATX requests instead of
+// being issued one by one. The kernel completes them in parallel on its
+// worker pool and the results are collected in whatever order they finish.
+//
+// Key features:
+// - Raw io_uring syscalls (no liburing dependency)
+// - Bounded number of requests in flight (one slot per request)
+// - Requests submitted in large batches, completions reaped in bulk
+// - Returns null from CreateUringEnumerator() when io_uring or
+//   IORING_OP_STATX is unavailable, so callers fall back cleanly
+// - A failed submission retires the ring: requests the kernel may still own
+//   keep their slots, the rest of the listing uses synchronous statx and
+//   later scans use the getdents64 backend
+//
+
+#include "../include/DirEnumerator.hpp"
+
+#ifdef __linux__
+
+#include "../include/log.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr unsigned kQueueDepth = 256;      // 同时在途的 statx 请求上限
+    constexpr std::size_t kChunkSize = 1024;
+
+    // 某个队列提交失败后不再创建 io_uring 后端，之后的扫描都用 getdents64
+    std::atomic<bool> g_ringFailed{false};
+
+    struct LinuxDirent64 {
+        std::uint64_t d_ino;
+        std::int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+
+    // -------------------------------------------------------------------------
+    // Minimal io_uring wrapper (setup, mmap, submit, reap)
+    // -------------------------------------------------------------------------
+    class IoUring {
+    public:
+        IoUring() = default;
+        ~IoUring() { Close(); }
+
+        IoUring(const IoUring&) = delete;
+        IoUring& operator=(const IoUring&) = delete;
+
+        // 创建队列并映射共享内存；失败时返回 false（内核不支持或被禁用）
+        bool Init(unsigned entries) {
+            io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            m_fd = (int)::syscall(__NR_io_uring_setup, entries, &params);
+            if (m_fd < 0)
+                return false;
+
+            m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (singleMmap) {
+                if (m_cqRingSize > m_sqRingSize) m_sqRingSize = m_cqRingSize;
+                m_cqRingSize = m_sqRingSize;
+            }
+
+            m_sqRing = ::mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+            if (m_sqRing == MAP_FAILED) { m_sqRing = nullptr; Close(); return false; }
+
+            if (singleMmap) {
+                m_cqRing = m_sqRing;
+            } else {
+                m_cqRing = ::mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+                if (m_cqRing == MAP_FAILED) { m_cqRing = nullptr; Close(); return false; }
+            }
+
+            m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            m_sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE,
+                                                       MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES));
+            if (m_sqes == MAP_FAILED) { m_sqes = nullptr; Close(); return false; }
+
+            auto* sq = static_cast<char*>(m_sqRing);
+            m_sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+            m_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            m_sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            m_sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            m_sqEntries = params.sq_entries;
+
+            auto* cq = static_cast<char*>(m_cqRing);
+            m_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            m_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            m_cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+            return true;
+        }
+
+        // 通过 IORING_REGISTER_PROBE 检查内核是否支持某个操作码
+        bool SupportsOp(unsigned op) const {
+            constexpr unsigned kProbeOps = 256;
+            std::vector<char> buf(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op), 0);
+            auto* probe = reinterpret_cast<io_uring_probe*>(buf.data());
+            if (::syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_PROBE, probe, kProbeOps) < 0)
+                return false;
+            return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+        }
+
+        // 取一个空闲 SQE（调用方保证在途请求不超过队列深度）
+        io_uring_sqe* NextSqe() {
+            unsigned tail = *m_sqTail + m_pendingSqes;
+            io_uring_sqe* sqe = &m_sqes[tail & m_sqMask];
+            std::memset(sqe, 0, sizeof(*sqe));
+            m_sqArray[tail & m_sqMask] = tail & m_sqMask;
+            ++m_pendingSqes;
+            return sqe;
+        }
+
+        // 提交已准备的 SQE，并至少等待 minComplete 个完成事件
+        bool Submit(unsigned minComplete) {
+            unsigned toSubmit = m_pendingSqes;
+            if (toSubmit)
+                __atomic_store_n(m_sqTail, *m_sqTail + toSubmit, __ATOMIC_RELEASE);
+            m_pendingSqes = 0;
+            while (toSubmit || minComplete) {
+                int ret = (int)::syscall(__NR_io_uring_enter, m_fd, toSubmit, minComplete,
+                                         minComplete ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+                if (ret < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                toSubmit -= (unsigned)ret < toSubmit ? (unsigned)ret : toSubmit;
+                if (!toSubmit) break;
+            }
+            return true;
+        }
+
+        // 依次处理已完成的 CQE（顺序由内核决定）
+        template <typename Fn>
+        unsigned Reap(Fn&& fn) {
+            unsigned head = *m_cqHead;
+            unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+            unsigned count = 0;
+            for (; head != tail; ++head, ++count)
+                fn(m_cqes[head & m_cqMask]);
+            __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+            return count;
+        }
+
+        unsigned GetSqEntries() const { return m_sqEntries; }
+
+    private:
+        int m_fd = -1;
+        void* m_sqRing = nullptr;
+        void* m_cqRing = nullptr;
+        io_uring_sqe* m_sqes = nullptr;
+        std::size_t m_sqRingSize = 0, m_cqRingSize = 0, m_sqesSize = 0;
+
+        unsigned* m_sqHead = nullptr;
+        unsigned* m_sqTail = nullptr;
+        unsigned* m_sqArray = nullptr;
+        unsigned m_sqMask = 0;
+        unsigned m_sqEntries = 0;
+        unsigned m_pendingSqes = 0;
+
+        unsigned* m_cqHead = nullptr;
+        unsigned* m_cqTail = nullptr;
+        unsigned m_cqMask = 0;
+        io_uring_cqe* m_cqes = nullptr;
+
+        void Close() {
+            if (m_sqes) ::munmap(m_sqes, m_sqesSize);
+            if (m_cqRing && m_cqRing != m_sqRing) ::munmap(m_cqRing, m_cqRingSize);
+            if (m_sqRing) ::munmap(m_sqRing, m_sqRingSize);
+            if (m_fd >= 0) ::close(m_fd);
+            m_sqes = nullptr; m_cqRing = nullptr; m_sqRing = nullptr; m_fd = -1;
+        }
+    };
+
+    // -------------------------------------------------------------------------
+    // io_uring backend: getdents64 + batched IORING_OP_STATX
+    // -------------------------------------------------------------------------
+    class UringEnumerator : public DirEnumerator {
+    public:
+        ~UringEnumerator() override {
+            // 失效队列里的请求在关闭后仍可能由内核完成并写入槽位：槽位故意不释放
+            // （队列失效后不再创建新的后端，最多泄漏一次）
+            if (m_broken)
+                new std::vector<Slot>(std::move(m_slots));
+        }
+
+        const char* GetName() const override { return m_fallback ? m_fallback->GetName() : "io_uring"; }
+
+        bool Init() {
+            if (!m_ring.Init(kQueueDepth) || !m_ring.SupportsOp(IORING_OP_STATX))
+                return false;
+            m_depth = std::min<unsigned>(kQueueDepth, m_ring.GetSqEntries());
+            m_slots.resize(m_depth);
+            return true;
+        }
+
+        bool Enumerate(const fs::path& dir, const Sink& sink, std::error_code& ec) override {
+            // 队列已经失效：内核可能仍持有其中的槽位，整个枚举交给同步后端
+            if (m_broken) {
+                if (!m_fallback)
+                    m_fallback = DirEnumerator::Create(EnumBackend::Native);
+                return m_fallback->Enumerate(dir, sink, ec);
+            }
+
+            int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (fd < 0) {
+                ec.assign(errno, std::generic_category());
+                return false;
+            }
+
+            m_freeSlots.clear();
+            for (unsigned i = 0; i < m_depth; ++i)
+                m_freeSlots.push_back(m_depth - 1 - i);
+            m_inFlight = 0;
+            m_chunk.clear();
+            m_chunk.reserve(kChunkSize);
+            m_stopped = false;
+            m_sink = &sink;
+            m_dirFd = fd;
+
+            std::vector<char> buffer(64 * 1024);
+            while (!m_stopped) {
+                long n = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+                if (n < 0) {
+                    ec.assign(errno, std::generic_category());
+                    break;
+                }
+                if (n == 0)
+                    break;
+
+                for (long off = 0; off < n && !m_stopped;) {
+                    auto* d = reinterpret_cast<LinuxDirent64*>(buffer.data() + off);
+                    off += d->d_reclen;
+                    const char* name = d->d_name;
+                    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+                        continue;
+                    // 槽位用完时一次性提交整批请求，并等待至少四分之一完成
+                    if (!m_broken && m_freeSlots.empty())
+                        SubmitAndReap(m_depth / 4);
+                    if (m_broken) {
+                        // 队列失效后剩下的条目逐个同步 statx
+                        struct statx stx;
+                        Emit(name, d->d_type, stx, -EIO);
+                    } else {
+                        Queue(name, d->d_type);
+                    }
+                }
+            }
+
+            // 无论是否被取消都必须等所有在途请求完成，内核仍在写槽位里的 statx 缓冲区
+            while (m_inFlight > 0 && SubmitAndReap(1)) {
+            }
+            ::close(fd);
+
+            if (!m_stopped && !m_chunk.empty() && !sink(m_chunk))
+                m_stopped = true;
+            m_sink = nullptr;
+            return !m_stopped && !ec;
+        }
+
+    private:
+        // 每个在途请求占用一个槽位：保存文件名和 statx 结果缓冲区
+        struct Slot {
+            std::string name;
+            unsigned char dtype = DT_UNKNOWN;
+            bool busy = false;              // 已交给内核，完成事件还没收到
+            struct statx stx;
+        };
+
+        std::vector<Slot> m_slots;
+        IoUring m_ring;                     // 声明在 m_slots 之后：先关闭队列再释放槽位
+        unsigned m_depth = 0;
+        unsigned m_inFlight = 0;            // 等待完成事件的请求数
+        std::vector<unsigned> m_freeSlots;
+        std::vector<ScanEntry> m_chunk;
+        const Sink* m_sink = nullptr;
+        std::unique_ptr<DirEnumerator> m_fallback;  // 队列失效后使用的同步后端
+        int m_dirFd = -1;
+        bool m_stopped = false;
+        bool m_broken = false;              // 提交失败过，队列不再使用
+
+        void Queue(const char* name, unsigned char dtype) {
+            unsigned idx = m_freeSlots.back();
+            m_freeSlots.pop_back();
+            Slot& slot = m_slots[idx];
+            slot.name.assign(name);
+            slot.dtype = dtype;
+            slot.busy = true;
+            ++m_inFlight;
+
+            io_uring_sqe* sqe = m_ring.NextSqe();
+            sqe->opcode = IORING_OP_STATX;
+            sqe->fd = m_dirFd;
+            sqe->addr = (std::uint64_t)(uintptr_t)slot.name.c_str();
+            sqe->len = STATX_TYPE | STATX_SIZE | STATX_MTIME;
+            sqe->off = (std::uint64_t)(uintptr_t)&slot.stx;
+            sqe->statx_flags = AT_STATX_DONT_SYNC;
+            sqe->user_data = idx;
+        }
+
+        bool SubmitAndReap(unsigned minComplete) {
+            if (!m_ring.Submit(minComplete)) {
+                // 提交失败时内核可能仍持有已提交的 SQE：在途槽位不能回收，也不能再写。
+                // 先收下已经到达的完成事件，其余条目用槽位之外的缓冲区同步 statx 补齐，
+                // 槽位保持占用直到队列关闭，此后不再使用这个队列
+                int error = errno;
+                m_broken = true;
+                g_ringFailed = true;
+                LOG_ERROR("io_uring submission failed (%s), falling back to getdents64", std::strerror(error));
+                m_ring.Reap([this](const io_uring_cqe& cqe) {
+                    Complete((unsigned)cqe.user_data, cqe.res);
+                });
+                for (Slot& slot : m_slots) {
+                    if (slot.busy) {
+                        struct statx stx;
+                        Emit(slot.name.c_str(), slot.dtype, stx, -EIO);
+                    }
+                }
+                m_inFlight = 0;
+                return false;
+            }
+            m_ring.Reap([this](const io_uring_cqe& cqe) {
+                Complete((unsigned)cqe.user_data, cqe.res);
+            });
+            return true;
+        }
+
+        void Complete(unsigned idx, int res) {
+            Slot& slot = m_slots[idx];
+            Emit(slot.name.c_str(), slot.dtype, slot.stx, res);
+            slot.busy = false;
+            --m_inFlight;
+            m_freeSlots.push_back(idx);
+        }
+
+        // 把一个条目加入当前块；res < 0 时 stx 无效，改用同步 statx 填写
+        void Emit(const char* name, unsigned char dtype, struct statx& stx, int res) {
+            if (m_stopped)
+                return;
+            ScanEntry se;
+            se.name = name;
+            se.isLink = dtype == DT_LNK;
+            // 异步失败时退回同步 statx（例如内核把请求拒绝为 -EAGAIN）
+            if (res < 0 && ::statx(m_dirFd, name, AT_STATX_DONT_SYNC,
+                                   STATX_TYPE | STATX_SIZE | STATX_MTIME, &stx) == 0)
+                res = 0;
+            if (res >= 0) {
+                se.isDirectory = S_ISDIR(stx.stx_mode);
+                se.size = S_ISREG(stx.stx_mode) ? stx.stx_size : 0;
+                se.lastWriteTime = std::chrono::system_clock::time_point(
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                        std::chrono::seconds(stx.stx_mtime.tv_sec) +
+                        std::chrono::nanoseconds(stx.stx_mtime.tv_nsec)));
+            } else {
+                se.isDirectory = dtype == DT_DIR;
+                se.size = 0;
+                se.lastWriteTime = std::chrono::system_clock::time_point();
+            }
+            m_chunk.push_back(std::move(se));
+            if (m_chunk.size() >= kChunkSize) {
+                if (!(*m_sink)(m_chunk))
+                    m_stopped = true;
+                m_chunk.clear();
+            }
+        }
+    };
+}
+
+std::unique_ptr<DirEnumerator> CreateUringEnumerator() {
+    if (g_ringFailed)
+        return nullptr;
+    auto enumerator = std::make_unique<UringEnumerator>();
+    if (!enumerator->Init())
+        return nullptr;
+    return enumerator;
+}
+
+#endif // __linux__
@@ -0,0 +1,222 @@
+// WatchTest.cpp
+// Change notification consistency test implementation for FileMgr
+//
+// Key features:
+// - Writer threads create, rewrite and delete files in a folder and a subfolder
+// - Refresh path of FileList: queued rescans merged through ListingDiff
+// - Every merge checked to keep each entry exactly once
+// - Final listings compared with the disk after the changes settle
+//
+
+#include "../include/WatchTest.hpp"
+#include "../include/Common.hpp"
+#include "../include/DirScanner.hpp"
+#include "../include/DirWatcher.hpp"
+#include "../include/EntryStore.hpp"
+#include "../include/ListingDiff.hpp"
+#include "../include/log.hpp"
+#include <atomic>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr auto kFrame = std::chrono::milliseconds(16);  // 模拟界面帧间隔
+    constexpr int kSubEvery = 20;                           // 每 20 次操作有一次落在子文件夹
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+int WatchTest::Run(const fs::path& dir, const Options& options) {
+    fs::path folder = dir / "watched";
+    fs::path sub = folder / "sub";
+    std::error_code ec;
+    fs::remove_all(folder, ec);
+    fs::create_directories(sub, ec);
+    if (ec) {
+        LOG_ERROR("Watch test: cannot create %s: %s", sub.string().c_str(), ec.message().c_str());
+        return 1;
+    }
+
+    DirWatcher watcher;
+    if (!watcher.IsAvailable())
+        LOG_INFO("Watch test: change notifications unavailable, relying on polling");
+    watcher.SetWatchedDirs({ folder, sub });
+    // 监视在后台线程上建立：先让它生效，再读初始列表
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    EntryStore shown = ReadFolder(folder);
+    EntryStore shownSub = ReadFolder(sub);
+    EntryStore pending;
+    DirScanner scanner;
+    std::uint64_t scanGeneration = 0;
+    bool scanning = false;
+    bool refreshQueued = false;
+    int refreshes = 0, subRefreshes = 0, badMerges = 0;
+
+    // 与 FileList::Refresh() 相同：扫描中则排队，结束后再扫一遍
+    auto refresh = [&] {
+        if (scanning) {
+            refreshQueued = true;
+            return;
+        }
+        pending.Clear();
+        scanGeneration = scanner.Start(folder);
+        scanning = true;
+    };
+
+    // 与 FileList::ApplyDiff() 相同：未变条目换成新索引，新增和修改的条目追加
+    auto merge = [&] {
+        ListingDiff diff = ListingDiff::Compute(shown, pending);
+        std::vector<std::uint8_t> seen(pending.Size(), 0);
+        std::size_t kept = 0;
+        for (EntryStore::Index index : shown.GetOrder()) {
+            EntryStore::Index now = diff.current[index];
+            if (now != EntryStore::kNoIndex) {
+                ++seen[now];
+                ++kept;
+            }
+        }
+        for (EntryStore::Index index : diff.changed)
+            ++seen[index];
+        bool once = kept + diff.changed.size() == pending.Size();
+        for (std::uint8_t count : seen)
+            once = once && count == 1;
+        if (!once)
+            ++badMerges;
+        std::swap(shown, pending);
+        pending.Clear();
+        ++refreshes;
+    };
+
+    // 一帧：取回监视结果和扫描批次
+    std::vector<fs::path> changed;
+    std::vector<DirScanner::Batch> batches;
+    auto frame = [&] {
+        bool active = false;
+        if (watcher.Poll(changed)) {
+            active = true;
+            for (const fs::path& changedDir : changed) {
+                if (changedDir == folder) {
+                    refresh();
+                } else if (changedDir == sub) {
+                    shownSub = ReadFolder(sub);
+                    ++subRefreshes;
+                }
+            }
+        }
+        batches.clear();
+        if (scanning && scanner.Poll(batches)) {
+            std::size_t oldCount = pending.Size();
+            bool finished = false;
+            for (DirScanner::Batch& batch : batches) {
+                if (batch.generation != scanGeneration)
+                    continue;
+                pending.Append(batch.entries);
+                finished = finished || batch.finished;
+            }
+            pending.MergeSorted(oldCount);
+            if (finished) {
+                scanning = false;
+                merge();
+                if (refreshQueued) {
+                    refreshQueued = false;
+                    refresh();
+                }
+            }
+        }
+        return active || scanning;
+    };
+
+    // 写线程：随机创建（或改写）和删除文件，偶尔落在子文件夹
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> operations{0};
+    std::vector<std::thread> writers;
+    for (int w = 0; w < options.writers; ++w) {
+        writers.emplace_back([&, w] {
+            std::mt19937 rng(1234u + (unsigned)w);
+            std::string data(4096, 'x');
+            while (!stop) {
+                unsigned value = rng();
+                fs::path target = (value % kSubEvery == 0 ? sub : folder) /
+                                  ("f" + std::to_string(value / kSubEvery % (unsigned)options.names) + ".o");
+                std::error_code removeError;
+                if (value % 3 == 0) {
+                    fs::remove(target, removeError);
+                } else {
+                    std::ofstream out(target, std::ios::binary | std::ios::trunc);
+                    out.write(data.data(), (std::streamsize)(rng() % data.size()));
+                }
+                ++operations;
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (ElapsedSince(start) < std::chrono::seconds(options.seconds)) {
+        frame();
+        std::this_thread::sleep_for(kFrame);
+    }
+    stop = true;
+    for (std::thread& writer : writers)
+        writer.join();
+    double writeSeconds = ElapsedSince(start).count() / 1e6;
+
+    // 等最后的变化报告完、扫描结束，并保持安静 settleMs
+    auto quietSince = std::chrono::steady_clock::now();
+    while (ElapsedSince(quietSince) < std::chrono::milliseconds(options.settleMs)) {
+        if (frame())
+            quietSince = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(kFrame);
+    }
+
+    DirWatcher::Stats stats = watcher.GetStats();
+    LOG_INFO("Watch test: %llu file operations in %.1f s (%.0f/s) by %d writers; %llu events, %llu overflows, "
+             "%d folder refreshes, %d subfolder refreshes",
+             (unsigned long long)operations.load(), writeSeconds, writeSeconds > 0 ? operations / writeSeconds : 0.0,
+             options.writers, (unsigned long long)stats.events, (unsigned long long)stats.overflows, refreshes,
+             subRefreshes);
+    bool ok = SameListing("Folder", shown, ReadFolder(folder));
+    ok = SameListing("Subfolder", shownSub, ReadFolder(sub)) && ok;
+    if (badMerges > 0)
+        LOG_ERROR("Watch test: %d merges did not keep every entry exactly once", badMerges);
+    ok = ok && badMerges == 0 && refreshes > 0;
+    LOG_INFO("Watch test: %s", ok ? "passed" : "FAILED");
+    fs::remove_all(folder, ec);
+    return ok ? 0 : 1;
+}
+
+// -----------------------------------------------------------------------------
+// Private methods
+// -----------------------------------------------------------------------------
+
+EntryStore WatchTest::ReadFolder(const fs::path& folder) {
+    EntryStore store;
+    std::error_code ec;
+    DirEnumerator::Create(EnumBackend::Auto)->Enumerate(folder, [&](std::vector<ScanEntry>& chunk) {
+        store.Append(chunk);
+        return true;
+    }, ec);
+    store.Sort();
+    return store;
+}
+
+bool WatchTest::SameListing(const char* label, const EntryStore& shown, const EntryStore& disk) {
+    const std::vector<EntryStore::Index>& a = shown.GetOrder();
+    const std::vector<EntryStore::Index>& b = disk.GetOrder();
+    std::size_t differences = a.size() > b.size() ? a.size() - b.size() : b.size() - a.size();
+    for (std::size_t k = 0; k < a.size() && k < b.size(); ++k) {
+        if (shown.GetName(a[k]) != disk.GetName(b[k]) || shown.IsDirectory(a[k]) != disk.IsDirectory(b[k]) ||
+            shown.GetSize(a[k]) != disk.GetSize(b[k]))
+            ++differences;
+    }
+    LOG_INFO("%s: %d entries shown, %d on disk%s", label, (int)a.size(), (int)b.size(),
+             differences ? " (MISMATCH)" : "");
+    return differences == 0;
+}
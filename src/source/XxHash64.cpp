@@ -0,0 +1,151 @@
+// XxHash64.cpp
+// 64-bit xxHash (XXH64) implementation for FileMgr
+//
+// Key features:
+// - Four-lane 32-byte rounds, identical output to the reference XXH64
+// - Streaming updates of any size with a 32-byte carry buffer
+//
+
+#include "../include/XxHash64.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+    constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr std::uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+    constexpr std::uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr std::uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+    inline std::uint64_t RotateLeft(std::uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    // 按小端读取（x86 和 ARM 的 Windows 都是小端，memcpy 会被编译成单条加载）
+    inline std::uint64_t Read64(const unsigned char* p) {
+        std::uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline std::uint32_t Read32(const unsigned char* p) {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline std::uint64_t Round(std::uint64_t acc, std::uint64_t input) {
+        acc += input * kPrime2;
+        acc = RotateLeft(acc, 31);
+        return acc * kPrime1;
+    }
+
+    inline std::uint64_t MergeRound(std::uint64_t acc, std::uint64_t lane) {
+        acc ^= Round(0, lane);
+        return acc * kPrime1 + kPrime4;
+    }
+
+    // 处理尽可能多的 32 字节整轮
+    // @return 已处理的字节数
+    std::size_t Rounds(std::uint64_t* lanes, const unsigned char* p, std::size_t size) {
+        const unsigned char* start = p;
+        const unsigned char* stop = p + (size & ~std::size_t(31));
+        std::uint64_t v1 = lanes[0], v2 = lanes[1], v3 = lanes[2], v4 = lanes[3];
+        for (; p < stop; p += 32) {
+            v1 = Round(v1, Read64(p));
+            v2 = Round(v2, Read64(p + 8));
+            v3 = Round(v3, Read64(p + 16));
+            v4 = Round(v4, Read64(p + 24));
+        }
+        lanes[0] = v1;
+        lanes[1] = v2;
+        lanes[2] = v3;
+        lanes[3] = v4;
+        return (std::size_t)(p - start);
+    }
+
+    // 合并各通道并混入不足一轮的尾部
+    std::uint64_t Finish(const std::uint64_t* lanes, std::uint64_t seed, std::uint64_t total,
+                         const unsigned char* p, std::size_t size) {
+        std::uint64_t h;
+        if (total >= 32) {
+            h = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) +
+                RotateLeft(lanes[3], 18);
+            for (int k = 0; k < 4; ++k)
+                h = MergeRound(h, lanes[k]);
+        } else {
+            h = seed + kPrime5;
+        }
+        h += total;
+
+        for (; size >= 8; p += 8, size -= 8) {
+            h ^= Round(0, Read64(p));
+            h = RotateLeft(h, 27) * kPrime1 + kPrime4;
+        }
+        if (size >= 4) {
+            h ^= (std::uint64_t)Read32(p) * kPrime1;
+            h = RotateLeft(h, 23) * kPrime2 + kPrime3;
+            p += 4;
+            size -= 4;
+        }
+        for (; size > 0; ++p, --size) {
+            h ^= (*p) * kPrime5;
+            h = RotateLeft(h, 11) * kPrime1;
+        }
+
+        h ^= h >> 33;
+        h *= kPrime2;
+        h ^= h >> 29;
+        h *= kPrime3;
+        h ^= h >> 32;
+        return h;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+void XxHash64::Reset(std::uint64_t seed) {
+    m_seed = seed;
+    m_lanes[0] = seed + kPrime1 + kPrime2;
+    m_lanes[1] = seed + kPrime2;
+    m_lanes[2] = seed;
+    m_lanes[3] = seed - kPrime1;
+    m_total = 0;
+    m_buffered = 0;
+}
+
+void XxHash64::Update(const void* data, std::size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    m_total += size;
+
+    // 先补齐上次剩下的不完整一轮
+    if (m_buffered > 0) {
+        std::size_t take = std::min(size, sizeof(m_buffer) - m_buffered);
+        std::memcpy(m_buffer + m_buffered, p, take);
+        m_buffered += take;
+        p += take;
+        size -= take;
+        if (m_buffered < sizeof(m_buffer))
+            return;
+        Rounds(m_lanes, m_buffer, sizeof(m_buffer));
+        m_buffered = 0;
+    }
+
+    std::size_t done = Rounds(m_lanes, p, size);
+    m_buffered = size - done;
+    if (m_buffered > 0)
+        std::memcpy(m_buffer, p + done, m_buffered);
+}
+
+std::uint64_t XxHash64::Digest() const {
+    return Finish(m_lanes, m_seed, m_total, m_buffer, m_buffered);
+}
+
+std::uint64_t XxHash64::Hash(const void* data, std::size_t size, std::uint64_t seed) {
+    XxHash64 hash(seed);
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    std::size_t done = Rounds(hash.m_lanes, p, size);
+    return Finish(hash.m_lanes, seed, size, p + done, size - done);
+}